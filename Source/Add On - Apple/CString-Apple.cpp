@@ -34,14 +34,14 @@ static	CFStringEncoding	sGetCFStringEncodingForCStringEncoding(CString::Encoding
 // MARK: Lifecycle methods
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString() : CHashable()
+CString::CString() : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	mStringRef = CFSTR("");
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const CString& other, OV<Length> length) : CHashable()
+CString::CString(const CString& other, OV<Length> length) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	if (length.hasValue()) {
@@ -51,20 +51,22 @@ CString::CString(const CString& other, OV<Length> length) : CHashable()
 			// Truncate
 			::CFStringReplace((CFMutableStringRef) mStringRef,
 					CFRangeMake(*length, ::CFStringGetLength(mStringRef) - *length), CFSTR(""));
-	} else
+	} else {
 		// Make copy
 		mStringRef = (CFStringRef) ::CFRetain(other.mStringRef);
+		mHashValue = other.mHashValue.load(std::memory_order_relaxed);
+	}
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const OSStringVar(initialString), OV<Length> length) : CHashable()
+CString::CString(const OSStringVar(initialString), OV<Length> length) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	mStringRef = (CFStringRef) ::CFRetain(initialString);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const char* chars, Length charsCount, Encoding encoding) : CHashable()
+CString::CString(const char* chars, Length charsCount, Encoding encoding) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Parameter check
@@ -91,7 +93,7 @@ CString::CString(const char* chars, Length charsCount, Encoding encoding) : CHas
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const UTF16Char* chars, Length charsCount, Encoding encoding) : CHashable()
+CString::CString(const UTF16Char* chars, Length charsCount, Encoding encoding) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Parameter check
@@ -116,7 +118,7 @@ CString::CString(const UTF16Char* chars, Length charsCount, Encoding encoding) :
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const UTF32Char* chars, Length charsCount, Encoding encoding) : CHashable()
+CString::CString(const UTF32Char* chars, Length charsCount, Encoding encoding) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Parameter check
@@ -135,7 +137,8 @@ CString::CString(const UTF32Char* chars, Length charsCount, Encoding encoding) :
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(Float32 value, UInt32 fieldSize, UInt32 digitsAfterDecimalPoint, bool padWithZeros) : CHashable()
+CString::CString(Float32 value, UInt32 fieldSize, UInt32 digitsAfterDecimalPoint, bool padWithZeros) :
+		CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Check field size
@@ -150,7 +153,8 @@ CString::CString(Float32 value, UInt32 fieldSize, UInt32 digitsAfterDecimalPoint
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(Float64 value, UInt32 fieldSize, UInt32 digitsAfterDecimalPoint, bool padWithZeros) : CHashable()
+CString::CString(Float64 value, UInt32 fieldSize, UInt32 digitsAfterDecimalPoint, bool padWithZeros) :
+		CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Check field size
@@ -165,7 +169,7 @@ CString::CString(Float64 value, UInt32 fieldSize, UInt32 digitsAfterDecimalPoint
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(SInt8 value, UInt32 fieldSize, bool padWithZeros) : CHashable()
+CString::CString(SInt8 value, UInt32 fieldSize, bool padWithZeros) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Check field size
@@ -178,7 +182,7 @@ CString::CString(SInt8 value, UInt32 fieldSize, bool padWithZeros) : CHashable()
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(SInt16 value, UInt32 fieldSize, bool padWithZeros) : CHashable()
+CString::CString(SInt16 value, UInt32 fieldSize, bool padWithZeros) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Check field size
@@ -191,7 +195,7 @@ CString::CString(SInt16 value, UInt32 fieldSize, bool padWithZeros) : CHashable(
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(SInt32 value, UInt32 fieldSize, bool padWithZeros) : CHashable()
+CString::CString(SInt32 value, UInt32 fieldSize, bool padWithZeros) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Check field size
@@ -204,7 +208,7 @@ CString::CString(SInt32 value, UInt32 fieldSize, bool padWithZeros) : CHashable(
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(SInt64 value, UInt32 fieldSize, bool padWithZeros) : CHashable()
+CString::CString(SInt64 value, UInt32 fieldSize, bool padWithZeros) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Check field size
@@ -217,7 +221,7 @@ CString::CString(SInt64 value, UInt32 fieldSize, bool padWithZeros) : CHashable(
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(UInt8 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable()
+CString::CString(UInt8 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Check field size
@@ -234,7 +238,7 @@ CString::CString(UInt8 value, UInt32 fieldSize, bool padWithZeros, bool makeHex)
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(UInt16 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable()
+CString::CString(UInt16 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Check field size
@@ -251,7 +255,7 @@ CString::CString(UInt16 value, UInt32 fieldSize, bool padWithZeros, bool makeHex
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(UInt32 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable()
+CString::CString(UInt32 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Check field size
@@ -268,7 +272,7 @@ CString::CString(UInt32 value, UInt32 fieldSize, bool padWithZeros, bool makeHex
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(UInt64 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable()
+CString::CString(UInt64 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Check field size
@@ -285,7 +289,7 @@ CString::CString(UInt64 value, UInt32 fieldSize, bool padWithZeros, bool makeHex
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(OSType osType, bool isOSType, bool includeQuotes) : CHashable()
+CString::CString(OSType osType, bool isOSType, bool includeQuotes) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	osType = EndianU32_NtoB(osType);
@@ -295,14 +299,14 @@ CString::CString(OSType osType, bool isOSType, bool includeQuotes) : CHashable()
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const void* pointer) : CHashable()
+CString::CString(const void* pointer) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	mStringRef = ::CFStringCreateWithFormat(kCFAllocatorDefault, nil, CFSTR("%p"), pointer);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const TArray<CString>& components, const CString& separator) : CHashable()
+CString::CString(const TArray<CString>& components, const CString& separator) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Setup
@@ -324,7 +328,7 @@ CString::CString(const TArray<CString>& components, const CString& separator) :
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const CData& data, Encoding encoding) : CHashable()
+CString::CString(const CData& data, Encoding encoding) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	CFDataRef	dataRef = ::CFDataCreate(kCFAllocatorDefault, (const UInt8*) data.getBytePtr(), data.getSize());
@@ -718,6 +722,10 @@ ECompareResult CString::compareTo(const CString& other, CompareFlags compareFlag
 bool CString::equals(const CString& other, CompareFlags compareFlags) const
 //----------------------------------------------------------------------------------------------------------------------
 {
+	// Check for the same string (interned strings and their copies share the same CFStringRef)
+	if (mStringRef == other.mStringRef)
+		return true;
+
 	return ::CFStringCompare(mStringRef, other.mStringRef, sGetCFOptionFlagsForCStringOptionFlags(compareFlags)) ==
 			kCFCompareEqualTo;
 }
@@ -751,8 +759,10 @@ bool CString::contains(const CString& other, CompareFlags compareFlags) const
 CString& CString::operator=(const CString& other)
 //----------------------------------------------------------------------------------------------------------------------
 {
+	::CFRetain(other.mStringRef);
 	::CFRelease(mStringRef);
-	mStringRef = (CFStringRef) ::CFRetain(other.mStringRef);
+	mStringRef = other.mStringRef;
+	mHashValue = other.mHashValue.load(std::memory_order_relaxed);
 
 	return *this;
 }
@@ -767,6 +777,7 @@ CString& CString::operator+=(const CString& other)
 
 	::CFRelease(mStringRef);
 	mStringRef = stringRef;
+	mHashValue = 0;
 
 	return *this;
 }
@@ -874,6 +885,7 @@ void CString::init()
 //----------------------------------------------------------------------------------------------------------------------
 {
 	mStringRef = CFSTR("");
+	mHashValue = 0;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
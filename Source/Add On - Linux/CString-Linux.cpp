@@ -0,0 +1,2044 @@
+//----------------------------------------------------------------------------------------------------------------------
+//	CString-Linux.cpp			©2020 Stevo Brock	All rights reserved.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "CString.h"
+
+#include "CppToolboxAssert.h"
+#include "CData.h"
+#include "CLogServices.h"
+#include "TBuffer.h"
+
+#include <ctype.h>
+#include <wctype.h>
+
+/*
+	Strings are stored as UTF-8.  Short strings (up to kInlineCharsMaxByteCount bytes) live in the object itself so
+		the common small keys, labels, and numbers never touch the heap.  Lengths and character indexes are in UTF-16
+		units to match the other platforms.  When the string is all ASCII (length == byte count), indexes map directly
+		to bytes, otherwise we walk the UTF-8 to find the byte index.
+ */
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: Local types
+//	Case mapping tables are generated from the Unicode simple mappings so case changes do not depend on the C locale.
+//		Each entry covers mFirstUTF32Char through mLastUTF32Char, every mStride characters, mapped by adding mDelta.
+
+struct SCaseMapping {
+	UTF32Char	mFirstUTF32Char;
+	UTF32Char	mLastUTF32Char;
+	UInt8		mStride;
+	SInt32		mDelta;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: Local data
+
+static	const	CString::Length	kInlineCharsMaxByteCount = 22;
+
+static	const	UTF32Char		kReplacementUTF32Char = 0xFFFD;
+
+static	const	UTF16Char		sMacRomanUTF16Chars[] = {
+									0x00C4, 0x00C5, 0x00C7, 0x00C9, 0x00D1, 0x00D6, 0x00DC, 0x00E1,
+									0x00E0, 0x00E2, 0x00E4, 0x00E3, 0x00E5, 0x00E7, 0x00E9, 0x00E8,
+									0x00EA, 0x00EB, 0x00ED, 0x00EC, 0x00EE, 0x00EF, 0x00F1, 0x00F3,
+									0x00F2, 0x00F4, 0x00F6, 0x00F5, 0x00FA, 0x00F9, 0x00FB, 0x00FC,
+									0x2020, 0x00B0, 0x00A2, 0x00A3, 0x00A7, 0x2022, 0x00B6, 0x00DF,
+									0x00AE, 0x00A9, 0x2122, 0x00B4, 0x00A8, 0x2260, 0x00C6, 0x00D8,
+									0x221E, 0x00B1, 0x2264, 0x2265, 0x00A5, 0x00B5, 0x2202, 0x2211,
+									0x220F, 0x03C0, 0x222B, 0x00AA, 0x00BA, 0x03A9, 0x00E6, 0x00F8,
+									0x00BF, 0x00A1, 0x00AC, 0x221A, 0x0192, 0x2248, 0x2206, 0x00AB,
+									0x00BB, 0x2026, 0x00A0, 0x00C0, 0x00C3, 0x00D5, 0x0152, 0x0153,
+									0x2013, 0x2014, 0x201C, 0x201D, 0x2018, 0x2019, 0x00F7, 0x25CA,
+									0x00FF, 0x0178, 0x2044, 0x20AC, 0x2039, 0x203A, 0xFB01, 0xFB02,
+									0x2021, 0x00B7, 0x201A, 0x201E, 0x2030, 0x00C2, 0x00CA, 0x00C1,
+									0x00CB, 0x00C8, 0x00CD, 0x00CE, 0x00CF, 0x00CC, 0x00D3, 0x00D4,
+									0xF8FF, 0x00D2, 0x00DA, 0x00DB, 0x00D9, 0x0131, 0x02C6, 0x02DC,
+									0x00AF, 0x02D8, 0x02D9, 0x02DA, 0x00B8, 0x02DD, 0x02DB, 0x02C7,
+								};
+
+static	const	SCaseMapping	sLowercaseMappings[] = {
+									{0x0041, 0x005A, 1, 32}, {0x00C0, 0x00D6, 1, 32}, {0x00D8, 0x00DE, 1, 32},
+									{0x0100, 0x012E, 2, 1}, {0x0132, 0x0136, 2, 1}, {0x0139, 0x0147, 2, 1},
+									{0x014A, 0x0176, 2, 1}, {0x0178, 0x0178, 1, -121}, {0x0179, 0x017D, 2, 1},
+									{0x0181, 0x0181, 1, 210}, {0x0182, 0x0184, 2, 1}, {0x0186, 0x0186, 1, 206},
+									{0x0187, 0x0187, 1, 1}, {0x0189, 0x018A, 1, 205}, {0x018B, 0x018B, 1, 1},
+									{0x018E, 0x018E, 1, 79}, {0x018F, 0x018F, 1, 202}, {0x0190, 0x0190, 1, 203},
+									{0x0191, 0x0191, 1, 1}, {0x0193, 0x0193, 1, 205}, {0x0194, 0x0194, 1, 207},
+									{0x0196, 0x0196, 1, 211}, {0x0197, 0x0197, 1, 209}, {0x0198, 0x0198, 1, 1},
+									{0x019C, 0x019C, 1, 211}, {0x019D, 0x019D, 1, 213}, {0x019F, 0x019F, 1, 214},
+									{0x01A0, 0x01A4, 2, 1}, {0x01A6, 0x01A6, 1, 218}, {0x01A7, 0x01A7, 1, 1},
+									{0x01A9, 0x01A9, 1, 218}, {0x01AC, 0x01AC, 1, 1}, {0x01AE, 0x01AE, 1, 218},
+									{0x01AF, 0x01AF, 1, 1}, {0x01B1, 0x01B2, 1, 217}, {0x01B3, 0x01B5, 2, 1},
+									{0x01B7, 0x01B7, 1, 219}, {0x01B8, 0x01B8, 1, 1}, {0x01BC, 0x01BC, 1, 1},
+									{0x01C4, 0x01C4, 1, 2}, {0x01C5, 0x01C5, 1, 1}, {0x01C7, 0x01C7, 1, 2},
+									{0x01C8, 0x01C8, 1, 1}, {0x01CA, 0x01CA, 1, 2}, {0x01CB, 0x01DB, 2, 1},
+									{0x01DE, 0x01EE, 2, 1}, {0x01F1, 0x01F1, 1, 2}, {0x01F2, 0x01F4, 2, 1},
+									{0x01F6, 0x01F6, 1, -97}, {0x01F7, 0x01F7, 1, -56}, {0x01F8, 0x021E, 2, 1},
+									{0x0220, 0x0220, 1, -130}, {0x0222, 0x0232, 2, 1}, {0x023A, 0x023A, 1, 10795},
+									{0x023B, 0x023B, 1, 1}, {0x023D, 0x023D, 1, -163}, {0x023E, 0x023E, 1, 10792},
+									{0x0241, 0x0241, 1, 1}, {0x0243, 0x0243, 1, -195}, {0x0244, 0x0244, 1, 69},
+									{0x0245, 0x0245, 1, 71}, {0x0246, 0x024E, 2, 1}, {0x0370, 0x0372, 2, 1},
+									{0x0376, 0x0376, 1, 1}, {0x037F, 0x037F, 1, 116}, {0x0386, 0x0386, 1, 38},
+									{0x0388, 0x038A, 1, 37}, {0x038C, 0x038C, 1, 64}, {0x038E, 0x038F, 1, 63},
+									{0x0391, 0x03A1, 1, 32}, {0x03A3, 0x03AB, 1, 32}, {0x03CF, 0x03CF, 1, 8},
+									{0x03D8, 0x03EE, 2, 1}, {0x03F4, 0x03F4, 1, -60}, {0x03F7, 0x03F7, 1, 1},
+									{0x03F9, 0x03F9, 1, -7}, {0x03FA, 0x03FA, 1, 1}, {0x03FD, 0x03FF, 1, -130},
+									{0x0400, 0x040F, 1, 80}, {0x0410, 0x042F, 1, 32}, {0x0460, 0x0480, 2, 1},
+									{0x048A, 0x04BE, 2, 1}, {0x04C0, 0x04C0, 1, 15}, {0x04C1, 0x04CD, 2, 1},
+									{0x04D0, 0x052E, 2, 1}, {0x0531, 0x0556, 1, 48}, {0x10A0, 0x10C5, 1, 7264},
+									{0x10C7, 0x10C7, 1, 7264}, {0x10CD, 0x10CD, 1, 7264}, {0x13A0, 0x13EF, 1, 38864},
+									{0x13F0, 0x13F5, 1, 8}, {0x1C90, 0x1CBA, 1, -3008}, {0x1CBD, 0x1CBF, 1, -3008},
+									{0x1E00, 0x1E94, 2, 1}, {0x1E9E, 0x1E9E, 1, -7615}, {0x1EA0, 0x1EFE, 2, 1},
+									{0x1F08, 0x1F0F, 1, -8}, {0x1F18, 0x1F1D, 1, -8}, {0x1F28, 0x1F2F, 1, -8},
+									{0x1F38, 0x1F3F, 1, -8}, {0x1F48, 0x1F4D, 1, -8}, {0x1F59, 0x1F5F, 2, -8},
+									{0x1F68, 0x1F6F, 1, -8}, {0x1F88, 0x1F8F, 1, -8}, {0x1F98, 0x1F9F, 1, -8},
+									{0x1FA8, 0x1FAF, 1, -8}, {0x1FB8, 0x1FB9, 1, -8}, {0x1FBA, 0x1FBB, 1, -74},
+									{0x1FBC, 0x1FBC, 1, -9}, {0x1FC8, 0x1FCB, 1, -86}, {0x1FCC, 0x1FCC, 1, -9},
+									{0x1FD8, 0x1FD9, 1, -8}, {0x1FDA, 0x1FDB, 1, -100}, {0x1FE8, 0x1FE9, 1, -8},
+									{0x1FEA, 0x1FEB, 1, -112}, {0x1FEC, 0x1FEC, 1, -7}, {0x1FF8, 0x1FF9, 1, -128},
+									{0x1FFA, 0x1FFB, 1, -126}, {0x1FFC, 0x1FFC, 1, -9}, {0x2126, 0x2126, 1, -7517},
+									{0x212A, 0x212A, 1, -8383}, {0x212B, 0x212B, 1, -8262}, {0x2132, 0x2132, 1, 28},
+									{0x2160, 0x216F, 1, 16}, {0x2183, 0x2183, 1, 1}, {0x24B6, 0x24CF, 1, 26},
+									{0x2C00, 0x2C2F, 1, 48}, {0x2C60, 0x2C60, 1, 1}, {0x2C62, 0x2C62, 1, -10743},
+									{0x2C63, 0x2C63, 1, -3814}, {0x2C64, 0x2C64, 1, -10727}, {0x2C67, 0x2C6B, 2, 1},
+									{0x2C6D, 0x2C6D, 1, -10780}, {0x2C6E, 0x2C6E, 1, -10749},
+									{0x2C6F, 0x2C6F, 1, -10783}, {0x2C70, 0x2C70, 1, -10782}, {0x2C72, 0x2C72, 1, 1},
+									{0x2C75, 0x2C75, 1, 1}, {0x2C7E, 0x2C7F, 1, -10815}, {0x2C80, 0x2CE2, 2, 1},
+									{0x2CEB, 0x2CED, 2, 1}, {0x2CF2, 0x2CF2, 1, 1}, {0xA640, 0xA66C, 2, 1},
+									{0xA680, 0xA69A, 2, 1}, {0xA722, 0xA72E, 2, 1}, {0xA732, 0xA76E, 2, 1},
+									{0xA779, 0xA77B, 2, 1}, {0xA77D, 0xA77D, 1, -35332}, {0xA77E, 0xA786, 2, 1},
+									{0xA78B, 0xA78B, 1, 1}, {0xA78D, 0xA78D, 1, -42280}, {0xA790, 0xA792, 2, 1},
+									{0xA796, 0xA7A8, 2, 1}, {0xA7AA, 0xA7AA, 1, -42308}, {0xA7AB, 0xA7AB, 1, -42319},
+									{0xA7AC, 0xA7AC, 1, -42315}, {0xA7AD, 0xA7AD, 1, -42305},
+									{0xA7AE, 0xA7AE, 1, -42308}, {0xA7B0, 0xA7B0, 1, -42258},
+									{0xA7B1, 0xA7B1, 1, -42282}, {0xA7B2, 0xA7B2, 1, -42261}, {0xA7B3, 0xA7B3, 1, 928},
+									{0xA7B4, 0xA7C2, 2, 1}, {0xA7C4, 0xA7C4, 1, -48}, {0xA7C5, 0xA7C5, 1, -42307},
+									{0xA7C6, 0xA7C6, 1, -35384}, {0xA7C7, 0xA7C9, 2, 1}, {0xA7D0, 0xA7D0, 1, 1},
+									{0xA7D6, 0xA7D8, 2, 1}, {0xA7F5, 0xA7F5, 1, 1}, {0xFF21, 0xFF3A, 1, 32},
+									{0x10400, 0x10427, 1, 40}, {0x104B0, 0x104D3, 1, 40}, {0x10570, 0x1057A, 1, 39},
+									{0x1057C, 0x1058A, 1, 39}, {0x1058C, 0x10592, 1, 39}, {0x10594, 0x10595, 1, 39},
+									{0x10C80, 0x10CB2, 1, 64}, {0x118A0, 0x118BF, 1, 32}, {0x16E40, 0x16E5F, 1, 32},
+									{0x1E900, 0x1E921, 1, 34},
+									};
+static	const	UInt32			sLowercaseMappingsCount = sizeof(sLowercaseMappings) / sizeof(SCaseMapping);
+
+static	const	SCaseMapping	sUppercaseMappings[] = {
+									{0x0061, 0x007A, 1, -32}, {0x00B5, 0x00B5, 1, 743}, {0x00E0, 0x00F6, 1, -32},
+									{0x00F8, 0x00FE, 1, -32}, {0x00FF, 0x00FF, 1, 121}, {0x0101, 0x012F, 2, -1},
+									{0x0131, 0x0131, 1, -232}, {0x0133, 0x0137, 2, -1}, {0x013A, 0x0148, 2, -1},
+									{0x014B, 0x0177, 2, -1}, {0x017A, 0x017E, 2, -1}, {0x017F, 0x017F, 1, -300},
+									{0x0180, 0x0180, 1, 195}, {0x0183, 0x0185, 2, -1}, {0x0188, 0x0188, 1, -1},
+									{0x018C, 0x018C, 1, -1}, {0x0192, 0x0192, 1, -1}, {0x0195, 0x0195, 1, 97},
+									{0x0199, 0x0199, 1, -1}, {0x019A, 0x019A, 1, 163}, {0x019E, 0x019E, 1, 130},
+									{0x01A1, 0x01A5, 2, -1}, {0x01A8, 0x01A8, 1, -1}, {0x01AD, 0x01AD, 1, -1},
+									{0x01B0, 0x01B0, 1, -1}, {0x01B4, 0x01B6, 2, -1}, {0x01B9, 0x01B9, 1, -1},
+									{0x01BD, 0x01BD, 1, -1}, {0x01BF, 0x01BF, 1, 56}, {0x01C5, 0x01C5, 1, -1},
+									{0x01C6, 0x01C6, 1, -2}, {0x01C8, 0x01C8, 1, -1}, {0x01C9, 0x01C9, 1, -2},
+									{0x01CB, 0x01CB, 1, -1}, {0x01CC, 0x01CC, 1, -2}, {0x01CE, 0x01DC, 2, -1},
+									{0x01DD, 0x01DD, 1, -79}, {0x01DF, 0x01EF, 2, -1}, {0x01F2, 0x01F2, 1, -1},
+									{0x01F3, 0x01F3, 1, -2}, {0x01F5, 0x01F5, 1, -1}, {0x01F9, 0x021F, 2, -1},
+									{0x0223, 0x0233, 2, -1}, {0x023C, 0x023C, 1, -1}, {0x023F, 0x0240, 1, 10815},
+									{0x0242, 0x0242, 1, -1}, {0x0247, 0x024F, 2, -1}, {0x0250, 0x0250, 1, 10783},
+									{0x0251, 0x0251, 1, 10780}, {0x0252, 0x0252, 1, 10782}, {0x0253, 0x0253, 1, -210},
+									{0x0254, 0x0254, 1, -206}, {0x0256, 0x0257, 1, -205}, {0x0259, 0x0259, 1, -202},
+									{0x025B, 0x025B, 1, -203}, {0x025C, 0x025C, 1, 42319}, {0x0260, 0x0260, 1, -205},
+									{0x0261, 0x0261, 1, 42315}, {0x0263, 0x0263, 1, -207}, {0x0265, 0x0265, 1, 42280},
+									{0x0266, 0x0266, 1, 42308}, {0x0268, 0x0268, 1, -209}, {0x0269, 0x0269, 1, -211},
+									{0x026A, 0x026A, 1, 42308}, {0x026B, 0x026B, 1, 10743}, {0x026C, 0x026C, 1, 42305},
+									{0x026F, 0x026F, 1, -211}, {0x0271, 0x0271, 1, 10749}, {0x0272, 0x0272, 1, -213},
+									{0x0275, 0x0275, 1, -214}, {0x027D, 0x027D, 1, 10727}, {0x0280, 0x0280, 1, -218},
+									{0x0282, 0x0282, 1, 42307}, {0x0283, 0x0283, 1, -218}, {0x0287, 0x0287, 1, 42282},
+									{0x0288, 0x0288, 1, -218}, {0x0289, 0x0289, 1, -69}, {0x028A, 0x028B, 1, -217},
+									{0x028C, 0x028C, 1, -71}, {0x0292, 0x0292, 1, -219}, {0x029D, 0x029D, 1, 42261},
+									{0x029E, 0x029E, 1, 42258}, {0x0345, 0x0345, 1, 84}, {0x0371, 0x0373, 2, -1},
+									{0x0377, 0x0377, 1, -1}, {0x037B, 0x037D, 1, 130}, {0x03AC, 0x03AC, 1, -38},
+									{0x03AD, 0x03AF, 1, -37}, {0x03B1, 0x03C1, 1, -32}, {0x03C2, 0x03C2, 1, -31},
+									{0x03C3, 0x03CB, 1, -32}, {0x03CC, 0x03CC, 1, -64}, {0x03CD, 0x03CE, 1, -63},
+									{0x03D0, 0x03D0, 1, -62}, {0x03D1, 0x03D1, 1, -57}, {0x03D5, 0x03D5, 1, -47},
+									{0x03D6, 0x03D6, 1, -54}, {0x03D7, 0x03D7, 1, -8}, {0x03D9, 0x03EF, 2, -1},
+									{0x03F0, 0x03F0, 1, -86}, {0x03F1, 0x03F1, 1, -80}, {0x03F2, 0x03F2, 1, 7},
+									{0x03F3, 0x03F3, 1, -116}, {0x03F5, 0x03F5, 1, -96}, {0x03F8, 0x03F8, 1, -1},
+									{0x03FB, 0x03FB, 1, -1}, {0x0430, 0x044F, 1, -32}, {0x0450, 0x045F, 1, -80},
+									{0x0461, 0x0481, 2, -1}, {0x048B, 0x04BF, 2, -1}, {0x04C2, 0x04CE, 2, -1},
+									{0x04CF, 0x04CF, 1, -15}, {0x04D1, 0x052F, 2, -1}, {0x0561, 0x0586, 1, -48},
+									{0x10D0, 0x10FA, 1, 3008}, {0x10FD, 0x10FF, 1, 3008}, {0x13F8, 0x13FD, 1, -8},
+									{0x1C80, 0x1C80, 1, -6254}, {0x1C81, 0x1C81, 1, -6253}, {0x1C82, 0x1C82, 1, -6244},
+									{0x1C83, 0x1C84, 1, -6242}, {0x1C85, 0x1C85, 1, -6243}, {0x1C86, 0x1C86, 1, -6236},
+									{0x1C87, 0x1C87, 1, -6181}, {0x1C88, 0x1C88, 1, 35266}, {0x1D79, 0x1D79, 1, 35332},
+									{0x1D7D, 0x1D7D, 1, 3814}, {0x1D8E, 0x1D8E, 1, 35384}, {0x1E01, 0x1E95, 2, -1},
+									{0x1E9B, 0x1E9B, 1, -59}, {0x1EA1, 0x1EFF, 2, -1}, {0x1F00, 0x1F07, 1, 8},
+									{0x1F10, 0x1F15, 1, 8}, {0x1F20, 0x1F27, 1, 8}, {0x1F30, 0x1F37, 1, 8},
+									{0x1F40, 0x1F45, 1, 8}, {0x1F51, 0x1F57, 2, 8}, {0x1F60, 0x1F67, 1, 8},
+									{0x1F70, 0x1F71, 1, 74}, {0x1F72, 0x1F75, 1, 86}, {0x1F76, 0x1F77, 1, 100},
+									{0x1F78, 0x1F79, 1, 128}, {0x1F7A, 0x1F7B, 1, 112}, {0x1F7C, 0x1F7D, 1, 126},
+									{0x1FB0, 0x1FB1, 1, 8}, {0x1FBE, 0x1FBE, 1, -7205}, {0x1FD0, 0x1FD1, 1, 8},
+									{0x1FE0, 0x1FE1, 1, 8}, {0x1FE5, 0x1FE5, 1, 7}, {0x214E, 0x214E, 1, -28},
+									{0x2170, 0x217F, 1, -16}, {0x2184, 0x2184, 1, -1}, {0x24D0, 0x24E9, 1, -26},
+									{0x2C30, 0x2C5F, 1, -48}, {0x2C61, 0x2C61, 1, -1}, {0x2C65, 0x2C65, 1, -10795},
+									{0x2C66, 0x2C66, 1, -10792}, {0x2C68, 0x2C6C, 2, -1}, {0x2C73, 0x2C73, 1, -1},
+									{0x2C76, 0x2C76, 1, -1}, {0x2C81, 0x2CE3, 2, -1}, {0x2CEC, 0x2CEE, 2, -1},
+									{0x2CF3, 0x2CF3, 1, -1}, {0x2D00, 0x2D25, 1, -7264}, {0x2D27, 0x2D27, 1, -7264},
+									{0x2D2D, 0x2D2D, 1, -7264}, {0xA641, 0xA66D, 2, -1}, {0xA681, 0xA69B, 2, -1},
+									{0xA723, 0xA72F, 2, -1}, {0xA733, 0xA76F, 2, -1}, {0xA77A, 0xA77C, 2, -1},
+									{0xA77F, 0xA787, 2, -1}, {0xA78C, 0xA78C, 1, -1}, {0xA791, 0xA793, 2, -1},
+									{0xA794, 0xA794, 1, 48}, {0xA797, 0xA7A9, 2, -1}, {0xA7B5, 0xA7C3, 2, -1},
+									{0xA7C8, 0xA7CA, 2, -1}, {0xA7D1, 0xA7D1, 1, -1}, {0xA7D7, 0xA7D9, 2, -1},
+									{0xA7F6, 0xA7F6, 1, -1}, {0xAB53, 0xAB53, 1, -928}, {0xAB70, 0xABBF, 1, -38864},
+									{0xFF41, 0xFF5A, 1, -32}, {0x10428, 0x1044F, 1, -40}, {0x104D8, 0x104FB, 1, -40},
+									{0x10597, 0x105A1, 1, -39}, {0x105A3, 0x105B1, 1, -39}, {0x105B3, 0x105B9, 1, -39},
+									{0x105BB, 0x105BC, 1, -39}, {0x10CC0, 0x10CF2, 1, -64}, {0x118C0, 0x118DF, 1, -32},
+									{0x16E60, 0x16E7F, 1, -32}, {0x1E922, 0x1E943, 1, -34},
+									};
+static	const	UInt32			sUppercaseMappingsCount = sizeof(sUppercaseMappings) / sizeof(SCaseMapping);
+
+static	const	SCaseMapping	sFoldedMappings[] = {
+									{0x0041, 0x005A, 1, 32}, {0x00B5, 0x00B5, 1, 775}, {0x00C0, 0x00D6, 1, 32},
+									{0x00D8, 0x00DE, 1, 32}, {0x0100, 0x012E, 2, 1}, {0x0132, 0x0136, 2, 1},
+									{0x0139, 0x0147, 2, 1}, {0x014A, 0x0176, 2, 1}, {0x0178, 0x0178, 1, -121},
+									{0x0179, 0x017D, 2, 1}, {0x017F, 0x017F, 1, -268}, {0x0181, 0x0181, 1, 210},
+									{0x0182, 0x0184, 2, 1}, {0x0186, 0x0186, 1, 206}, {0x0187, 0x0187, 1, 1},
+									{0x0189, 0x018A, 1, 205}, {0x018B, 0x018B, 1, 1}, {0x018E, 0x018E, 1, 79},
+									{0x018F, 0x018F, 1, 202}, {0x0190, 0x0190, 1, 203}, {0x0191, 0x0191, 1, 1},
+									{0x0193, 0x0193, 1, 205}, {0x0194, 0x0194, 1, 207}, {0x0196, 0x0196, 1, 211},
+									{0x0197, 0x0197, 1, 209}, {0x0198, 0x0198, 1, 1}, {0x019C, 0x019C, 1, 211},
+									{0x019D, 0x019D, 1, 213}, {0x019F, 0x019F, 1, 214}, {0x01A0, 0x01A4, 2, 1},
+									{0x01A6, 0x01A6, 1, 218}, {0x01A7, 0x01A7, 1, 1}, {0x01A9, 0x01A9, 1, 218},
+									{0x01AC, 0x01AC, 1, 1}, {0x01AE, 0x01AE, 1, 218}, {0x01AF, 0x01AF, 1, 1},
+									{0x01B1, 0x01B2, 1, 217}, {0x01B3, 0x01B5, 2, 1}, {0x01B7, 0x01B7, 1, 219},
+									{0x01B8, 0x01B8, 1, 1}, {0x01BC, 0x01BC, 1, 1}, {0x01C4, 0x01C4, 1, 2},
+									{0x01C5, 0x01C5, 1, 1}, {0x01C7, 0x01C7, 1, 2}, {0x01C8, 0x01C8, 1, 1},
+									{0x01CA, 0x01CA, 1, 2}, {0x01CB, 0x01DB, 2, 1}, {0x01DE, 0x01EE, 2, 1},
+									{0x01F1, 0x01F1, 1, 2}, {0x01F2, 0x01F4, 2, 1}, {0x01F6, 0x01F6, 1, -97},
+									{0x01F7, 0x01F7, 1, -56}, {0x01F8, 0x021E, 2, 1}, {0x0220, 0x0220, 1, -130},
+									{0x0222, 0x0232, 2, 1}, {0x023A, 0x023A, 1, 10795}, {0x023B, 0x023B, 1, 1},
+									{0x023D, 0x023D, 1, -163}, {0x023E, 0x023E, 1, 10792}, {0x0241, 0x0241, 1, 1},
+									{0x0243, 0x0243, 1, -195}, {0x0244, 0x0244, 1, 69}, {0x0245, 0x0245, 1, 71},
+									{0x0246, 0x024E, 2, 1}, {0x0345, 0x0345, 1, 116}, {0x0370, 0x0372, 2, 1},
+									{0x0376, 0x0376, 1, 1}, {0x037F, 0x037F, 1, 116}, {0x0386, 0x0386, 1, 38},
+									{0x0388, 0x038A, 1, 37}, {0x038C, 0x038C, 1, 64}, {0x038E, 0x038F, 1, 63},
+									{0x0391, 0x03A1, 1, 32}, {0x03A3, 0x03AB, 1, 32}, {0x03C2, 0x03C2, 1, 1},
+									{0x03CF, 0x03CF, 1, 8}, {0x03D0, 0x03D0, 1, -30}, {0x03D1, 0x03D1, 1, -25},
+									{0x03D5, 0x03D5, 1, -15}, {0x03D6, 0x03D6, 1, -22}, {0x03D8, 0x03EE, 2, 1},
+									{0x03F0, 0x03F0, 1, -54}, {0x03F1, 0x03F1, 1, -48}, {0x03F4, 0x03F4, 1, -60},
+									{0x03F5, 0x03F5, 1, -64}, {0x03F7, 0x03F7, 1, 1}, {0x03F9, 0x03F9, 1, -7},
+									{0x03FA, 0x03FA, 1, 1}, {0x03FD, 0x03FF, 1, -130}, {0x0400, 0x040F, 1, 80},
+									{0x0410, 0x042F, 1, 32}, {0x0460, 0x0480, 2, 1}, {0x048A, 0x04BE, 2, 1},
+									{0x04C0, 0x04C0, 1, 15}, {0x04C1, 0x04CD, 2, 1}, {0x04D0, 0x052E, 2, 1},
+									{0x0531, 0x0556, 1, 48}, {0x10A0, 0x10C5, 1, 7264}, {0x10C7, 0x10C7, 1, 7264},
+									{0x10CD, 0x10CD, 1, 7264}, {0x13F8, 0x13FD, 1, -8}, {0x1C80, 0x1C80, 1, -6222},
+									{0x1C81, 0x1C81, 1, -6221}, {0x1C82, 0x1C82, 1, -6212}, {0x1C83, 0x1C84, 1, -6210},
+									{0x1C85, 0x1C85, 1, -6211}, {0x1C86, 0x1C86, 1, -6204}, {0x1C87, 0x1C87, 1, -6180},
+									{0x1C88, 0x1C88, 1, 35267}, {0x1C90, 0x1CBA, 1, -3008}, {0x1CBD, 0x1CBF, 1, -3008},
+									{0x1E00, 0x1E94, 2, 1}, {0x1E9B, 0x1E9B, 1, -58}, {0x1E9E, 0x1E9E, 1, -7615},
+									{0x1EA0, 0x1EFE, 2, 1}, {0x1F08, 0x1F0F, 1, -8}, {0x1F18, 0x1F1D, 1, -8},
+									{0x1F28, 0x1F2F, 1, -8}, {0x1F38, 0x1F3F, 1, -8}, {0x1F48, 0x1F4D, 1, -8},
+									{0x1F59, 0x1F5F, 2, -8}, {0x1F68, 0x1F6F, 1, -8}, {0x1F88, 0x1F8F, 1, -8},
+									{0x1F98, 0x1F9F, 1, -8}, {0x1FA8, 0x1FAF, 1, -8}, {0x1FB8, 0x1FB9, 1, -8},
+									{0x1FBA, 0x1FBB, 1, -74}, {0x1FBC, 0x1FBC, 1, -9}, {0x1FBE, 0x1FBE, 1, -7173},
+									{0x1FC8, 0x1FCB, 1, -86}, {0x1FCC, 0x1FCC, 1, -9}, {0x1FD8, 0x1FD9, 1, -8},
+									{0x1FDA, 0x1FDB, 1, -100}, {0x1FE8, 0x1FE9, 1, -8}, {0x1FEA, 0x1FEB, 1, -112},
+									{0x1FEC, 0x1FEC, 1, -7}, {0x1FF8, 0x1FF9, 1, -128}, {0x1FFA, 0x1FFB, 1, -126},
+									{0x1FFC, 0x1FFC, 1, -9}, {0x2126, 0x2126, 1, -7517}, {0x212A, 0x212A, 1, -8383},
+									{0x212B, 0x212B, 1, -8262}, {0x2132, 0x2132, 1, 28}, {0x2160, 0x216F, 1, 16},
+									{0x2183, 0x2183, 1, 1}, {0x24B6, 0x24CF, 1, 26}, {0x2C00, 0x2C2F, 1, 48},
+									{0x2C60, 0x2C60, 1, 1}, {0x2C62, 0x2C62, 1, -10743}, {0x2C63, 0x2C63, 1, -3814},
+									{0x2C64, 0x2C64, 1, -10727}, {0x2C67, 0x2C6B, 2, 1}, {0x2C6D, 0x2C6D, 1, -10780},
+									{0x2C6E, 0x2C6E, 1, -10749}, {0x2C6F, 0x2C6F, 1, -10783},
+									{0x2C70, 0x2C70, 1, -10782}, {0x2C72, 0x2C72, 1, 1}, {0x2C75, 0x2C75, 1, 1},
+									{0x2C7E, 0x2C7F, 1, -10815}, {0x2C80, 0x2CE2, 2, 1}, {0x2CEB, 0x2CED, 2, 1},
+									{0x2CF2, 0x2CF2, 1, 1}, {0xA640, 0xA66C, 2, 1}, {0xA680, 0xA69A, 2, 1},
+									{0xA722, 0xA72E, 2, 1}, {0xA732, 0xA76E, 2, 1}, {0xA779, 0xA77B, 2, 1},
+									{0xA77D, 0xA77D, 1, -35332}, {0xA77E, 0xA786, 2, 1}, {0xA78B, 0xA78B, 1, 1},
+									{0xA78D, 0xA78D, 1, -42280}, {0xA790, 0xA792, 2, 1}, {0xA796, 0xA7A8, 2, 1},
+									{0xA7AA, 0xA7AA, 1, -42308}, {0xA7AB, 0xA7AB, 1, -42319},
+									{0xA7AC, 0xA7AC, 1, -42315}, {0xA7AD, 0xA7AD, 1, -42305},
+									{0xA7AE, 0xA7AE, 1, -42308}, {0xA7B0, 0xA7B0, 1, -42258},
+									{0xA7B1, 0xA7B1, 1, -42282}, {0xA7B2, 0xA7B2, 1, -42261}, {0xA7B3, 0xA7B3, 1, 928},
+									{0xA7B4, 0xA7C2, 2, 1}, {0xA7C4, 0xA7C4, 1, -48}, {0xA7C5, 0xA7C5, 1, -42307},
+									{0xA7C6, 0xA7C6, 1, -35384}, {0xA7C7, 0xA7C9, 2, 1}, {0xA7D0, 0xA7D0, 1, 1},
+									{0xA7D6, 0xA7D8, 2, 1}, {0xA7F5, 0xA7F5, 1, 1}, {0xAB70, 0xABBF, 1, -38864},
+									{0xFF21, 0xFF3A, 1, 32}, {0x10400, 0x10427, 1, 40}, {0x104B0, 0x104D3, 1, 40},
+									{0x10570, 0x1057A, 1, 39}, {0x1057C, 0x1058A, 1, 39}, {0x1058C, 0x10592, 1, 39},
+									{0x10594, 0x10595, 1, 39}, {0x10C80, 0x10CB2, 1, 64}, {0x118A0, 0x118BF, 1, 32},
+									{0x16E40, 0x16E5F, 1, 32}, {0x1E900, 0x1E921, 1, 34},
+									};
+static	const	UInt32			sFoldedMappingsCount = sizeof(sFoldedMappings) / sizeof(SCaseMapping);
+
+static	CString	sErrorDomain(OSSTR("CString-Linux"));
+static	SError	sCreateFailedError(sErrorDomain, 1, CString(OSSTR("Unable to create")));
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - Local proc declarations
+
+static	bool			sDecodeUTF8(const UInt8*& bytes, const UInt8* bytesEnd, UTF32Char& utf32Char);
+static	CString::Length	sEncodeUTF8(UTF32Char utf32Char, char* buffer);
+static	bool			sValidateUTF8(const char* chars, CString::Length byteCount, CString::Length& outLength);
+static	CString::Length	sGetLength(const char* chars, CString::Length byteCount);
+static	CString::Length	sConvertToUTF8(const UInt8* bytes, CString::Length byteCount, CString::Encoding encoding,
+								char* buffer);
+static	CString::Length	sConvertFromUTF8(const char* chars, CString::Length byteCount, CString::Encoding encoding,
+								SInt8 lossCharacter, bool addBOM, UInt8* buffer, CString::Length bufferByteCount,
+								CString::Length& outByteCount);
+static	bool			sIsASCIICompatible(CString::Encoding encoding);
+static	bool			sIsWhitespace(char _char);
+static	UTF32Char		sGetFoldedUTF32Char(UTF32Char utf32Char);
+static	UTF32Char		sGetMappedUTF32Char(UTF32Char utf32Char, const SCaseMapping* caseMappings,
+								UInt32 caseMappingsCount);
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CString
+
+// MARK: Lifecycle methods
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString() : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	init();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(const CString& other, OV<Length> length) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Check for length
+	if (length.hasValue() && (*length < other.mLength)) {
+		// Truncate
+		Length	byteCount = other.getByteIndex(*length);
+		set(other.getChars(), byteCount,
+				(other.mLength == other.mByteCount) ? byteCount : sGetLength(other.getChars(), byteCount));
+	} else
+		// Copy
+		set(other);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(const char* chars, Length charsCount, Encoding encoding) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Parameter check
+	AssertNotNil(chars);
+
+	// Init
+	init();
+	if (chars == nil)
+		return;
+
+	// Check count
+	if (charsCount == (Length) ~0)
+		// Use entire string
+		charsCount = (Length) ::strlen(chars);
+
+	// Check if we can store directly (valid UTF-8 or plain ASCII in an ASCII-compatible encoding)
+	Length	length;
+	if (sValidateUTF8(chars, charsCount, length) &&
+			((encoding == kEncodingUTF8) || (sIsASCIICompatible(encoding) && (length == charsCount))))
+		// Store
+		set(chars, charsCount, length);
+	else {
+		// Convert
+		TBuffer<char>	buffer(charsCount * 3 + 1);
+		Length			byteCount = sConvertToUTF8((const UInt8*) chars, charsCount, encoding, *buffer);
+		set(*buffer, byteCount, sGetLength(*buffer, byteCount));
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(const UTF16Char* chars, Length charsCount, Encoding encoding) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Parameter check
+	AssertNotNil(chars);
+
+	bool	encodingIsValid =
+					(encoding == kEncodingUnicode) ||
+					(encoding == kEncodingUTF16) ||
+					(encoding == kEncodingUTF16BE) ||
+					(encoding == kEncodingUTF16LE);
+	AssertFailIf(!encodingIsValid);
+
+	// Init
+	init();
+	if ((chars == nil) || !encodingIsValid)
+		// Missing or invalid parameters
+		return;
+
+	// Convert
+	TBuffer<char>	buffer(charsCount * 3 + 1);
+	Length			byteCount =
+							sConvertToUTF8((const UInt8*) chars, charsCount * sizeof(UTF16Char), encoding, *buffer);
+	set(*buffer, byteCount, sGetLength(*buffer, byteCount));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(const UTF32Char* chars, Length charsCount, Encoding encoding) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Parameter check
+	AssertNotNil(chars);
+	AssertFailIf((encoding != kEncodingUTF32BE) && (encoding != kEncodingUTF32LE));
+
+	// Init
+	init();
+	if ((chars == nil) || ((encoding != kEncodingUTF32BE) && (encoding != kEncodingUTF32LE)))
+		// Missing or invalid parameters
+		return;
+
+	// Convert
+	TBuffer<char>	buffer(charsCount * 4 + 1);
+	Length			byteCount =
+							sConvertToUTF8((const UInt8*) chars, charsCount * sizeof(UTF32Char), encoding, *buffer);
+	set(*buffer, byteCount, sGetLength(*buffer, byteCount));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(Float32 value, UInt32 fieldSize, UInt32 digitsAfterDecimalPoint, bool padWithZeros) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Check field size
+	if (fieldSize == 0)
+		*this = make("%0.*f", (int) digitsAfterDecimalPoint, (double) value);
+	else
+		*this =
+				make(padWithZeros ? "%0*.*f" : "%*.*f", (int) fieldSize, (int) digitsAfterDecimalPoint,
+						(double) value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(Float64 value, UInt32 fieldSize, UInt32 digitsAfterDecimalPoint, bool padWithZeros) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Check field size
+	if (fieldSize == 0)
+		*this = make("%0.*f", (int) digitsAfterDecimalPoint, value);
+	else
+		*this = make(padWithZeros ? "%0*.*f" : "%*.*f", (int) fieldSize, (int) digitsAfterDecimalPoint, value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(SInt8 value, UInt32 fieldSize, bool padWithZeros) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Check field size
+	if (fieldSize == 0)
+		*this = make("%hi", (short) value);
+	else
+		*this = make(padWithZeros ? "%.*hi" : "%*hi", (int) fieldSize, (short) value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(SInt16 value, UInt32 fieldSize, bool padWithZeros) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Check field size
+	if (fieldSize == 0)
+		*this = make("%hi", value);
+	else
+		*this = make(padWithZeros ? "%.*hi" : "%*hi", (int) fieldSize, value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(SInt32 value, UInt32 fieldSize, bool padWithZeros) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Check field size
+	if (fieldSize == 0)
+		*this = make("%d", (int) value);
+	else
+		*this = make(padWithZeros ? "%.*d" : "%*d", (int) fieldSize, (int) value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(SInt64 value, UInt32 fieldSize, bool padWithZeros) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Check field size
+	if (fieldSize == 0)
+		*this = make("%lld", (long long) value);
+	else
+		*this = make(padWithZeros ? "%.*lld" : "%*lld", (int) fieldSize, (long long) value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(UInt8 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Check field size
+	if (fieldSize == 0)
+		*this = make("%hu", (unsigned short) value);
+	else if (makeHex)
+		*this = make(padWithZeros ? "%#.*x" : "%#*x", (int) fieldSize, (unsigned int) value);
+	else
+		*this = make(padWithZeros ? "%.*hu" : "%*hu", (int) fieldSize, (unsigned short) value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(UInt16 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Check field size
+	if (fieldSize == 0)
+		*this = make("%hu", value);
+	else if (makeHex)
+		*this = make(padWithZeros ? "%#.*x" : "%#*x", (int) fieldSize, (unsigned int) value);
+	else
+		*this = make(padWithZeros ? "%.*hu" : "%*hu", (int) fieldSize, value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(UInt32 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Check field size
+	if (fieldSize == 0)
+		*this = make("%u", (unsigned int) value);
+	else if (makeHex)
+		*this = make(padWithZeros ? "%#.*x" : "%#*x", (int) fieldSize, (unsigned int) value);
+	else
+		*this = make(padWithZeros ? "%.*u" : "%*u", (int) fieldSize, (unsigned int) value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(UInt64 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Check field size
+	if (fieldSize == 0)
+		*this = make("%llu", (unsigned long long) value);
+	else if (makeHex)
+		*this = make(padWithZeros ? "%#.*llx" : "%#*llx", (int) fieldSize, (unsigned long long) value);
+	else
+		*this = make(padWithZeros ? "%.*llu" : "%*llu", (int) fieldSize, (unsigned long long) value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(OSType osType, bool isOSType, bool includeQuotes) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Setup
+	osType = EndianU32_NtoB(osType);
+	*this = make(includeQuotes ? "\'%4.4s\'" : "%4.4s", (char*) &osType);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(const void* pointer) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Setup
+	*this = make("%p", pointer);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(const TArray<CString>& components, const CString& separator) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Iterate array
+	for (CArray::ItemIndex i = 0; i < components.getCount(); i++) {
+		// Check if need to add separator
+		if (i > 0)
+			// Add separator
+			append(separator.getChars(), separator.mByteCount, separator.mLength);
+
+		// Append this component
+		const	CString&	component = components[i];
+		append(component.getChars(), component.mByteCount, component.mLength);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CString(const CData& data, Encoding encoding) : CHashable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Init
+	init();
+
+	// Setup
+	const	char*	chars = (const char*) data.getBytePtr();
+			Length	charsCount = (Length) data.getSize();
+
+	// Check for UTF-8 BOM
+	if ((encoding == kEncodingUTF8) && (charsCount >= 3) && (::memcmp(chars, "\xEF\xBB\xBF", 3) == 0)) {
+		// Skip BOM
+		chars += 3;
+		charsCount -= 3;
+	}
+
+	// Check if we can store directly
+	Length	length;
+	if (sValidateUTF8(chars, charsCount, length) &&
+			((encoding == kEncodingUTF8) || (sIsASCIICompatible(encoding) && (length == charsCount))))
+		// Store
+		set(chars, charsCount, length);
+	else if (encoding == kEncodingUTF8)
+		// Not valid
+		LogError(sCreateFailedError, "creating CString from external representation");
+	else {
+		// Convert
+		TBuffer<char>	buffer(charsCount * 3 + 1);
+		Length			byteCount = sConvertToUTF8((const UInt8*) chars, charsCount, encoding, *buffer);
+		set(*buffer, byteCount, sGetLength(*buffer, byteCount));
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::~CString()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Cleanup
+	if (mHeapCapacity > 0)
+		::free(mHeapChars);
+}
+
+// MARK: Instance methods
+
+//----------------------------------------------------------------------------------------------------------------------
+OSStringType CString::getOSString() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return getChars();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const CString::C CString::getCString(Encoding encoding) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check encoding
+	if ((encoding == kEncodingUTF8) || (sIsASCIICompatible(encoding) && (mLength == mByteCount))) {
+		// Copy
+		C	c(mByteCount + 1);
+		::memcpy(c.mBuffer, getChars(), mByteCount + 1);
+
+		return c;
+	} else {
+		// Convert
+		Length	byteCount;
+		C		c(mLength * sizeof(UTF32Char) + 1);
+		sConvertFromUTF8(getChars(), mByteCount, encoding, 0, false, (UInt8*) c.mBuffer, mLength * sizeof(UTF32Char),
+				byteCount);
+		c.mBuffer[byteCount] = 0;
+
+		return c;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::Length CString::getLength() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mLength;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::Length CString::getLength(Encoding encoding, SInt8 lossCharacter, bool forExternalStorageOrTransmission) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check for quick answer
+	if ((encoding == kEncodingUTF8) || (sIsASCIICompatible(encoding) && (mLength == mByteCount)))
+		// Same as storage
+		return mByteCount;
+
+	// Count
+	Length	byteCount;
+	sConvertFromUTF8(getChars(), mByteCount, encoding, lossCharacter, forExternalStorageOrTransmission, nil, 0,
+			byteCount);
+
+	return byteCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::Length CString::get(char* buffer, Length bufferLen, bool addNull, Encoding encoding) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Parameter check
+	AssertNotNil(buffer);
+	if (buffer == nil)
+		return 0;
+
+	AssertFailIf(bufferLen == 0);
+	if (bufferLen == 0)
+		return 0;
+
+	// Save space for the null
+	if (addNull)
+		bufferLen--;
+
+	// Check for quick copy
+	Length	byteCount;
+	if (((encoding == kEncodingUTF8) || (sIsASCIICompatible(encoding) && (mLength == mByteCount))) &&
+			(mByteCount <= bufferLen)) {
+		// Copy
+		::memcpy(buffer, getChars(), mByteCount);
+		byteCount = mByteCount;
+	} else
+		// Convert as many characters as fit
+		sConvertFromUTF8(getChars(), mByteCount, encoding, 0, false, (UInt8*) buffer, bufferLen, byteCount);
+
+	// Add null if needed
+	if (addNull)
+		buffer[byteCount++] = 0;
+
+	return byteCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::Length CString::get(UTF16Char* buffer, Length bufferLen, Encoding encoding) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Parameter check
+	AssertNotNil(buffer);
+	if (buffer == nil)
+		return 0;
+
+	AssertFailIf((encoding != kEncodingUTF16BE) && (encoding != kEncodingUTF16LE));
+	if ((encoding != kEncodingUTF16BE) && (encoding != kEncodingUTF16LE))
+		return 0;
+
+	if (bufferLen > mLength)
+		bufferLen = mLength;
+
+	// Convert
+	Length	byteCount;
+
+	return sConvertFromUTF8(getChars(), mByteCount, encoding, 0, false, (UInt8*) buffer,
+			bufferLen * sizeof(UTF16Char), byteCount);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UTF32Char CString::getCharacterAtIndex(CharIndex index) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	AssertFailIf(index > mLength);
+	if (index >= mLength)
+		return 0;
+
+	// Decode
+	const	UInt8*		bytes = (const UInt8*) getChars() + getByteIndex(index);
+			UTF32Char	utf32Char;
+	sDecodeUTF8(bytes, (const UInt8*) getChars() + mByteCount, utf32Char);
+
+	return utf32Char;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Float32 CString::getFloat32() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return (Float32) ::strtod(getChars(), nil);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Float64 CString::getFloat64() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return ::strtod(getChars(), nil);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CData CString::getData(Encoding encoding, SInt8 lossCharacter) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check for quick copy
+	if ((encoding == kEncodingUTF8) || (sIsASCIICompatible(encoding) && (mLength == mByteCount)))
+		// Copy
+		return CData(getChars(), mByteCount);
+
+	// Count
+	Length	byteCount;
+	Length	length = sConvertFromUTF8(getChars(), mByteCount, encoding, lossCharacter, true, nil, 0, byteCount);
+	if (length == mLength) {
+		// Convert
+		CData	data((CData::Size) byteCount);
+		sConvertFromUTF8(getChars(), mByteCount, encoding, lossCharacter, true, (UInt8*) data.getMutableBytePtr(),
+				byteCount, byteCount);
+
+		return data;
+	} else {
+		// Failed
+		LogError(sCreateFailedError, "getting data");
+
+		return CData::mEmpty;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString CString::getSubString(CharIndex startIndex, Length charCount) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Limit to what we have
+	if (startIndex > mLength)
+		startIndex = mLength;
+	if (charCount > (mLength - startIndex))
+		charCount = mLength - startIndex;
+
+	// Setup
+	Length	startByteIndex = getByteIndex(startIndex);
+	Length	byteCount = getByteIndex(startIndex + charCount) - startByteIndex;
+
+	// Compose string
+	CString	string;
+	string.set(getChars() + startByteIndex, byteCount,
+			(mLength == mByteCount) ? byteCount : sGetLength(getChars() + startByteIndex, byteCount));
+
+	return string;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString CString::replacingSubStrings(const CString& subStringToReplace, const CString& replacementString) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check for nothing to find
+	if (subStringToReplace.mByteCount == 0)
+		return *this;
+
+	// Setup
+	const	char*	chars = getChars();
+	const	char*	charsEnd = chars + mByteCount;
+	const	char*	subStringChars = subStringToReplace.getChars();
+			CString	string;
+
+	// Find occurrences
+	const	char*	found;
+	while ((found =
+			(const char*) ::memmem(chars, charsEnd - chars, subStringChars, subStringToReplace.mByteCount)) != nil) {
+		// Append the part before and the replacement
+		string.append(chars, (Length) (found - chars), sGetLength(chars, (Length) (found - chars)));
+		string.append(replacementString.getChars(), replacementString.mByteCount, replacementString.mLength);
+
+		// Continue after
+		chars = found + subStringToReplace.mByteCount;
+	}
+
+	// Append the remainder
+	string.append(chars, (Length) (charsEnd - chars), sGetLength(chars, (Length) (charsEnd - chars)));
+
+	return string;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString CString::replacingCharacters(CharIndex startIndex, Length charCount, const CString& replacementString) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Limit to what we have
+	if (startIndex > mLength)
+		startIndex = mLength;
+	if (charCount > (mLength - startIndex))
+		charCount = mLength - startIndex;
+
+	// Setup
+	Length	startByteIndex = getByteIndex(startIndex);
+	Length	endByteIndex = getByteIndex(startIndex + charCount);
+
+	// Compose string
+	CString	string;
+	string.append(getChars(), startByteIndex, sGetLength(getChars(), startByteIndex));
+	string.append(replacementString.getChars(), replacementString.mByteCount, replacementString.mLength);
+	string.append(getChars() + endByteIndex, mByteCount - endByteIndex,
+			sGetLength(getChars() + endByteIndex, mByteCount - endByteIndex));
+
+	return string;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::Range CString::findSubString(const CString& subString, CharIndex startIndex, Length charCount) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Limit to what we have
+	if (startIndex > mLength)
+		startIndex = mLength;
+	if (charCount > (mLength - startIndex))
+		charCount = mLength - startIndex;
+
+	// Check for nothing to find
+	if (subString.mByteCount == 0)
+		return Range(0, 0);
+
+	// Setup
+	Length	startByteIndex = getByteIndex(startIndex);
+	Length	endByteIndex = getByteIndex(startIndex + charCount);
+
+	// Find
+	const	char*	found =
+							(const char*) ::memmem(getChars() + startByteIndex, endByteIndex - startByteIndex,
+									subString.getChars(), subString.mByteCount);
+
+	return (found != nil) ? Range(getCharIndex((Length) (found - getChars())), subString.mLength) : Range(0, 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString CString::lowercased() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	const	char*	chars = getChars();
+			CString	string;
+
+	// Check for ASCII
+	if (mLength == mByteCount) {
+		// Convert in place
+		string.set(chars, mByteCount, mLength);
+		char*	stringChars = (char*) string.getChars();
+		for (Length i = 0; i < mByteCount; i++)
+			// Lowercase
+			stringChars[i] = ((stringChars[i] >= 'A') && (stringChars[i] <= 'Z')) ? stringChars[i] + 32 :
+					stringChars[i];
+	} else {
+		// Convert each character
+		TBuffer<char>	buffer(mByteCount * 2 + 1);
+		const	UInt8*	bytes = (const UInt8*) chars;
+		const	UInt8*	bytesEnd = bytes + mByteCount;
+				Length	byteCount = 0;
+		while (bytes < bytesEnd) {
+			// Decode, lowercase, and encode
+			UTF32Char	utf32Char;
+			sDecodeUTF8(bytes, bytesEnd, utf32Char);
+			byteCount += sEncodeUTF8(sGetMappedUTF32Char(utf32Char, sLowercaseMappings, sLowercaseMappingsCount),
+					*buffer + byteCount);
+		}
+		string.set(*buffer, byteCount, sGetLength(*buffer, byteCount));
+	}
+
+	return string;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString CString::uppercased() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	const	char*	chars = getChars();
+			CString	string;
+
+	// Check for ASCII
+	if (mLength == mByteCount) {
+		// Convert in place
+		string.set(chars, mByteCount, mLength);
+		char*	stringChars = (char*) string.getChars();
+		for (Length i = 0; i < mByteCount; i++)
+			// Uppercase
+			stringChars[i] = ((stringChars[i] >= 'a') && (stringChars[i] <= 'z')) ? stringChars[i] - 32 :
+					stringChars[i];
+	} else {
+		// Convert each character
+		TBuffer<char>	buffer(mByteCount * 2 + 1);
+		const	UInt8*	bytes = (const UInt8*) chars;
+		const	UInt8*	bytesEnd = bytes + mByteCount;
+				Length	byteCount = 0;
+		while (bytes < bytesEnd) {
+			// Decode, uppercase, and encode
+			UTF32Char	utf32Char;
+			sDecodeUTF8(bytes, bytesEnd, utf32Char);
+			byteCount += sEncodeUTF8(sGetMappedUTF32Char(utf32Char, sUppercaseMappings, sUppercaseMappingsCount),
+					*buffer + byteCount);
+		}
+		string.set(*buffer, byteCount, sGetLength(*buffer, byteCount));
+	}
+
+	return string;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString CString::removingLeadingAndTrailingWhitespace() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	const	char*	chars = getChars();
+			Length	startByteIndex = 0;
+			Length	endByteIndex = mByteCount;
+
+	// Skip whitespace (all whitespace we remove is ASCII, so each is a single char)
+	while ((startByteIndex < endByteIndex) && sIsWhitespace(chars[startByteIndex]))
+		startByteIndex++;
+	while ((endByteIndex > startByteIndex) && sIsWhitespace(chars[endByteIndex - 1]))
+		endByteIndex--;
+
+	// Compose string
+	CString	string;
+	string.set(chars + startByteIndex, endByteIndex - startByteIndex,
+			mLength - startByteIndex - (mByteCount - endByteIndex));
+
+	return string;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString CString::removingAllWhitespace() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	const	char*			chars = getChars();
+			TBuffer<char>	buffer(mByteCount + 1);
+			Length			byteCount = 0;
+
+	// Copy all but whitespace
+	for (Length i = 0; i < mByteCount; i++) {
+		// Check this char
+		if (!sIsWhitespace(chars[i]))
+			// Keep
+			(*buffer)[byteCount++] = chars[i];
+	}
+
+	// Compose string
+	CString	string;
+	string.set(*buffer, byteCount, mLength - (mByteCount - byteCount));
+
+	return string;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString CString::removingLeadingAndTrailingQuotes() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	const	char*	chars = getChars();
+			Length	startByteIndex = 0;
+			Length	endByteIndex = mByteCount;
+
+	// Remove any leading quotes
+	if ((startByteIndex < endByteIndex) && (chars[startByteIndex] == '"'))
+		startByteIndex++;
+
+	// Remove any trailing quotes
+	if ((endByteIndex > startByteIndex) && (chars[endByteIndex - 1] == '"'))
+		endByteIndex--;
+
+	// Compose string
+	CString	string;
+	string.set(chars + startByteIndex, endByteIndex - startByteIndex,
+			mLength - startByteIndex - (mByteCount - endByteIndex));
+
+	return string;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString CString::getCommonPrefix(const CString& other) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	const	char*	chars = getChars();
+	const	char*	otherChars = other.getChars();
+			Length	byteCount = std::min<Length>(mByteCount, other.mByteCount);
+
+	// Find first difference
+	Length	byteIndex = 0;
+	while ((byteIndex < byteCount) && (chars[byteIndex] == otherChars[byteIndex]))
+		byteIndex++;
+
+	// Back up to the start of a character
+	if (byteIndex < byteCount)
+		while ((byteIndex > 0) && ((chars[byteIndex] & 0xC0) == 0x80))
+			byteIndex--;
+
+	// Compose string
+	CString	string;
+	string.set(chars, byteIndex, (mLength == mByteCount) ? byteIndex : sGetLength(chars, byteIndex));
+
+	return string;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+TArray<CString> CString::components(const CString& separator) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	TNArray<CString>	array;
+
+	// Check for separator
+	if (separator.mByteCount == 0) {
+		// No separator
+		array += *this;
+
+		return array;
+	}
+
+	// Setup
+	const	char*	chars = getChars();
+	const	char*	charsEnd = chars + mByteCount;
+	const	char*	separatorChars = separator.getChars();
+			bool	isASCII = mLength == mByteCount;
+
+	// Find separators
+	const	char*	found;
+	while ((found = (const char*) ::memmem(chars, charsEnd - chars, separatorChars, separator.mByteCount)) != nil) {
+		// Add component
+		CString	string;
+		string.set(chars, (Length) (found - chars),
+				isASCII ? (Length) (found - chars) : sGetLength(chars, (Length) (found - chars)));
+		array += string;
+
+		// Continue after
+		chars = found + separator.mByteCount;
+	}
+
+	// Add the last component
+	CString	string;
+	string.set(chars, (Length) (charsEnd - chars),
+			isASCII ? (Length) (charsEnd - chars) : sGetLength(chars, (Length) (charsEnd - chars)));
+	array += string;
+
+	return array;
+}
+
+// MARK: Comparison methods
+
+//----------------------------------------------------------------------------------------------------------------------
+ECompareResult CString::compareTo(const CString& other, CompareFlags compareFlags) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	const	UInt8*	bytes1 = (const UInt8*) getChars();
+	const	UInt8*	bytes1End = bytes1 + mByteCount;
+	const	UInt8*	bytes2 = (const UInt8*) other.getChars();
+	const	UInt8*	bytes2End = bytes2 + other.mByteCount;
+
+	// Check for literal compare (nonliteral and localized have no effect here)
+	if ((compareFlags & (kCompareFlagsCaseInsensitive | kCompareFlagsNumerically)) == 0) {
+		// UTF-8 byte order is code point order
+		int	result = ::memcmp(bytes1, bytes2, std::min<Length>(mByteCount, other.mByteCount));
+		if (result != 0)
+			return (result < 0) ? kCompareResultBefore : kCompareResultAfter;
+		else if (mByteCount != other.mByteCount)
+			return (mByteCount < other.mByteCount) ? kCompareResultBefore : kCompareResultAfter;
+		else
+			return kCompareResultEquivalent;
+	}
+
+	// Compare characters
+	while ((bytes1 < bytes1End) && (bytes2 < bytes2End)) {
+		// Check for numbers
+		if ((compareFlags & kCompareFlagsNumerically) && ::isdigit(*bytes1) && ::isdigit(*bytes2)) {
+			// Skip leading zeros
+			while ((bytes1 < (bytes1End - 1)) && (*bytes1 == '0') && ::isdigit(bytes1[1]))
+				bytes1++;
+			while ((bytes2 < (bytes2End - 1)) && (*bytes2 == '0') && ::isdigit(bytes2[1]))
+				bytes2++;
+
+			// Find the ends of the numbers
+			const	UInt8*	digits1End = bytes1;
+			while ((digits1End < bytes1End) && ::isdigit(*digits1End))
+				digits1End++;
+			const	UInt8*	digits2End = bytes2;
+			while ((digits2End < bytes2End) && ::isdigit(*digits2End))
+				digits2End++;
+
+			// More digits is a bigger number
+			if ((digits1End - bytes1) != (digits2End - bytes2))
+				return ((digits1End - bytes1) < (digits2End - bytes2)) ? kCompareResultBefore : kCompareResultAfter;
+
+			// Same number of digits
+			int	result = ::memcmp(bytes1, bytes2, digits1End - bytes1);
+			if (result != 0)
+				return (result < 0) ? kCompareResultBefore : kCompareResultAfter;
+
+			// Continue after
+			bytes1 = digits1End;
+			bytes2 = digits2End;
+			continue;
+		}
+
+		// Get characters
+		UTF32Char	utf32Char1, utf32Char2;
+		sDecodeUTF8(bytes1, bytes1End, utf32Char1);
+		sDecodeUTF8(bytes2, bytes2End, utf32Char2);
+
+		// Check case
+		if (compareFlags & kCompareFlagsCaseInsensitive) {
+			// Fold
+			utf32Char1 = sGetFoldedUTF32Char(utf32Char1);
+			utf32Char2 = sGetFoldedUTF32Char(utf32Char2);
+		}
+
+		// Compare
+		if (utf32Char1 != utf32Char2)
+			return (utf32Char1 < utf32Char2) ? kCompareResultBefore : kCompareResultAfter;
+	}
+
+	// Check remaining
+	if (bytes1 < bytes1End)
+		return kCompareResultAfter;
+	else if (bytes2 < bytes2End)
+		return kCompareResultBefore;
+	else
+		return kCompareResultEquivalent;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool CString::equals(const CString& other, CompareFlags compareFlags) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check for the same storage (interned strings and their copies share it)
+	if (getChars() == other.getChars())
+		return true;
+
+	// Check for literal compare
+	if ((compareFlags & (kCompareFlagsCaseInsensitive | kCompareFlagsNumerically)) == 0)
+		// Compare bytes
+		return (mByteCount == other.mByteCount) && (::memcmp(getChars(), other.getChars(), mByteCount) == 0);
+	else
+		// Compare
+		return compareTo(other, compareFlags) == kCompareResultEquivalent;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool CString::hasPrefix(const CString& other) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return (other.mByteCount > 0) && (other.mByteCount <= mByteCount) &&
+			(::memcmp(getChars(), other.getChars(), other.mByteCount) == 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool CString::hasSuffix(const CString& other) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return (other.mByteCount > 0) && (other.mByteCount <= mByteCount) &&
+			(::memcmp(getChars() + mByteCount - other.mByteCount, other.getChars(), other.mByteCount) == 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool CString::contains(const CString& other, CompareFlags compareFlags) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check case
+	if (compareFlags & kCompareFlagsCaseInsensitive)
+		// Compare lowercased
+		return lowercased().findSubString(other.lowercased()).isValid();
+	else
+		// Compare
+		return findSubString(other).isValid();
+}
+
+// MARK: Convenience operators
+
+//----------------------------------------------------------------------------------------------------------------------
+CString& CString::operator=(const CString& other)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check for self-assignment
+	if (this != &other)
+		// Copy
+		set(other);
+
+	return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString& CString::operator+=(const CString& other)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Append
+	append(other.getChars(), other.mByteCount, other.mLength);
+
+	return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString CString::operator+(const CString& other) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	CString	string(*this);
+	string.append(other.getChars(), other.mByteCount, other.mLength);
+
+	return string;
+}
+
+// MARK: Utility methods
+
+//----------------------------------------------------------------------------------------------------------------------
+CString CString::make(const char* format, va_list args)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	va_list	argsCopy;
+	va_copy(argsCopy, args);
+
+	// Try to format into a local buffer first
+	char	buffer[256];
+	int		count = ::vsnprintf(buffer, sizeof(buffer), format, args);
+	if (count < (int) sizeof(buffer)) {
+		// Done
+		va_end(argsCopy);
+
+		return (count > 0) ? CString(buffer, (Length) count) : CString();
+	}
+
+	// Format into a buffer large enough
+	TBuffer<char>	heapBuffer(count + 1);
+	::vsnprintf(*heapBuffer, count + 1, format, argsCopy);
+	va_end(argsCopy);
+
+	return CString(*heapBuffer, (Length) count);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool CString::isCharacterInSet(UTF32Char utf32Char, CharacterSet characterSet)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	switch (characterSet) {
+		case kCharacterSetControl:
+			return ::iswcntrl((wint_t) utf32Char);
+
+		case kCharacterSetWhitespace:
+			return (utf32Char != '\n') && (utf32Char != '\r') && ::iswblank((wint_t) utf32Char);
+
+		case kCharacterSetWhitespaceAndNewline:
+			return ::iswspace((wint_t) utf32Char) || (utf32Char == 0x85);
+
+		case kCharacterSetDecimalDigit:
+			return ::iswdigit((wint_t) utf32Char);
+
+		case kCharacterSetLetter:
+			return ::iswalpha((wint_t) utf32Char);
+
+		case kCharacterSetLowercaseLetter:
+			return ::iswlower((wint_t) utf32Char);
+
+		case kCharacterSetUppercaseLetter:
+			return ::iswupper((wint_t) utf32Char);
+
+		case kCharacterSetNonBase:
+			// Combining diacritical marks
+			return (utf32Char >= 0x0300) && (utf32Char <= 0x036F);
+
+		case kCharacterSetAlphaNumeric:
+			return ::iswalnum((wint_t) utf32Char);
+
+		case kCharacterSetPunctuation:
+			return ::iswpunct((wint_t) utf32Char);
+
+		case kCharacterSetIllegal:
+			return (utf32Char > 0x10FFFF) || ((utf32Char >= 0xD800) && (utf32Char <= 0xDFFF)) ||
+					((utf32Char & 0xFFFE) == 0xFFFE);
+
+		case kCharacterSetSymbol:
+			return ::iswpunct((wint_t) utf32Char) && !::iswalnum((wint_t) utf32Char);
+
+		case kCharacterSetDecomposable:
+		case kCharacterSetCapitalizedLetter:
+			// Not available from the C library
+			AssertFailUnimplemented();
+
+			return false;
+
+		default:
+			return false;
+	}
+}
+
+// MARK: Internal methods
+
+//----------------------------------------------------------------------------------------------------------------------
+void CString::init()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	mHashValue = 0;
+	mHeapChars = nil;
+	mHeapCapacity = 0;
+	mByteCount = 0;
+	mLength = 0;
+	mInlineChars[0] = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CString::set(const char* chars, Length byteCount, Length length)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check size
+	if (byteCount <= kInlineCharsMaxByteCount) {
+		// Store inline (chars may point into our own heap storage, so copy before releasing it)
+		::memmove(mInlineChars, chars, byteCount);
+		mInlineChars[byteCount] = 0;
+
+		if (mHeapCapacity > 0)
+			// Release heap storage
+			::free(mHeapChars);
+		mHeapChars = nil;
+		mHeapCapacity = 0;
+	} else if (byteCount < mHeapCapacity) {
+		// Reuse heap storage
+		::memmove(mHeapChars, chars, byteCount);
+		mHeapChars[byteCount] = 0;
+	} else {
+		// Allocate heap storage
+		char*	heapChars = (char*) ::malloc(byteCount + 1);
+		::memcpy(heapChars, chars, byteCount);
+		heapChars[byteCount] = 0;
+
+		if (mHeapCapacity > 0)
+			// Release previous heap storage
+			::free(mHeapChars);
+		mHeapChars = heapChars;
+		mHeapCapacity = byteCount + 1;
+	}
+
+	// Store
+	mByteCount = byteCount;
+	mLength = length;
+	mHashValue = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CString::set(const CString& other)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check for interned storage
+	if ((other.mHeapChars != nil) && (other.mHeapCapacity == 0)) {
+		// Share
+		if (mHeapCapacity > 0)
+			// Release heap storage
+			::free(mHeapChars);
+		mHeapChars = other.mHeapChars;
+		mHeapCapacity = 0;
+		mByteCount = other.mByteCount;
+		mLength = other.mLength;
+	} else
+		// Copy
+		set(other.getChars(), other.mByteCount, other.mLength);
+
+	// Hash is the same
+	mHashValue = other.mHashValue.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CString::append(const char* chars, Length byteCount, Length length)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if anything to append
+	if (byteCount == 0)
+		return;
+
+	// Setup
+	Length	totalByteCount = mByteCount + byteCount;
+
+	// Check size
+	if ((mHeapChars == nil) && (totalByteCount <= kInlineCharsMaxByteCount))
+		// Append inline
+		::memmove(mInlineChars + mByteCount, chars, byteCount);
+	else if (totalByteCount < mHeapCapacity)
+		// Append to heap storage
+		::memmove(mHeapChars + mByteCount, chars, byteCount);
+	else {
+		// Grow heap storage (geometrically so repeated appends stay linear)
+		Length	heapCapacity = std::max<Length>(totalByteCount + 1, mHeapCapacity * 2);
+		char*	heapChars = (char*) ::malloc(heapCapacity);
+		::memcpy(heapChars, getChars(), mByteCount);
+		::memcpy(heapChars + mByteCount, chars, byteCount);
+
+		if (mHeapCapacity > 0)
+			// Release previous heap storage
+			::free(mHeapChars);
+		mHeapChars = heapChars;
+		mHeapCapacity = heapCapacity;
+	}
+
+	// Store
+	((char*) getChars())[totalByteCount] = 0;
+	mByteCount = totalByteCount;
+	mLength += length;
+	mHashValue = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::Length CString::getByteIndex(CharIndex charIndex) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check for ASCII
+	if (mLength == mByteCount)
+		// Same
+		return std::min<Length>(charIndex, mByteCount);
+
+	// Walk characters
+	const	UInt8*	bytes = (const UInt8*) getChars();
+			Length	byteIndex = 0;
+	for (CharIndex i = 0; (i < charIndex) && (byteIndex < mByteCount); i++) {
+		// Check lead byte
+		UInt8	byte = bytes[byteIndex];
+		if (byte < 0x80)
+			// 1 byte
+			byteIndex += 1;
+		else if (byte < 0xE0)
+			// 2 bytes
+			byteIndex += 2;
+		else if (byte < 0xF0)
+			// 3 bytes
+			byteIndex += 3;
+		else {
+			// 4 bytes (2 UTF-16 units)
+			byteIndex += 4;
+			i++;
+		}
+	}
+
+	return std::min<Length>(byteIndex, mByteCount);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::CharIndex CString::getCharIndex(Length byteIndex) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return (mLength == mByteCount) ? byteIndex : sGetLength(getChars(), byteIndex);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CString::makeInterned()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if already interned
+	if ((mHeapChars != nil) && (mHeapCapacity == 0))
+		return;
+
+	// Move to storage that is never freed so all copies can share it
+	char*	chars = (char*) ::malloc(mByteCount + 1);
+	::memcpy(chars, getChars(), mByteCount + 1);
+
+	if (mHeapCapacity > 0)
+		// Release heap storage
+		::free(mHeapChars);
+	mHeapChars = chars;
+	mHeapCapacity = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - Local proc definitions
+
+//----------------------------------------------------------------------------------------------------------------------
+bool sDecodeUTF8(const UInt8*& bytes, const UInt8* bytesEnd, UTF32Char& utf32Char)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check lead byte
+	UInt8	byte = *bytes;
+	if (byte < 0x80) {
+		// ASCII
+		utf32Char = byte;
+		bytes++;
+
+		return true;
+	}
+
+	// Setup
+	UInt32		count;
+	UTF32Char	minUTF32Char;
+	if ((byte & 0xE0) == 0xC0) {
+		// 2 bytes
+		count = 1;
+		utf32Char = byte & 0x1F;
+		minUTF32Char = 0x80;
+	} else if ((byte & 0xF0) == 0xE0) {
+		// 3 bytes
+		count = 2;
+		utf32Char = byte & 0x0F;
+		minUTF32Char = 0x800;
+	} else if ((byte & 0xF8) == 0xF0) {
+		// 4 bytes
+		count = 3;
+		utf32Char = byte & 0x07;
+		minUTF32Char = 0x10000;
+	} else {
+		// Invalid lead byte
+		utf32Char = kReplacementUTF32Char;
+		bytes++;
+
+		return false;
+	}
+
+	// Check for truncated sequence
+	if ((UInt32) (bytesEnd - bytes) <= count) {
+		// Truncated
+		utf32Char = kReplacementUTF32Char;
+		bytes++;
+
+		return false;
+	}
+
+	// Decode continuation bytes
+	for (UInt32 i = 1; i <= count; i++) {
+		// Check continuation byte
+		if ((bytes[i] & 0xC0) != 0x80) {
+			// Invalid
+			utf32Char = kReplacementUTF32Char;
+			bytes++;
+
+			return false;
+		}
+		utf32Char = (utf32Char << 6) | (bytes[i] & 0x3F);
+	}
+
+	// Check for overlong, surrogate, or out of range
+	if ((utf32Char < minUTF32Char) || (utf32Char > 0x10FFFF) || ((utf32Char >= 0xD800) && (utf32Char <= 0xDFFF))) {
+		// Invalid
+		utf32Char = kReplacementUTF32Char;
+		bytes++;
+
+		return false;
+	}
+
+	bytes += count + 1;
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::Length sEncodeUTF8(UTF32Char utf32Char, char* buffer)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check value
+	if (utf32Char < 0x80) {
+		// 1 byte
+		buffer[0] = (char) utf32Char;
+
+		return 1;
+	} else if (utf32Char < 0x800) {
+		// 2 bytes
+		buffer[0] = (char) (0xC0 | (utf32Char >> 6));
+		buffer[1] = (char) (0x80 | (utf32Char & 0x3F));
+
+		return 2;
+	} else if (utf32Char < 0x10000) {
+		// 3 bytes
+		buffer[0] = (char) (0xE0 | (utf32Char >> 12));
+		buffer[1] = (char) (0x80 | ((utf32Char >> 6) & 0x3F));
+		buffer[2] = (char) (0x80 | (utf32Char & 0x3F));
+
+		return 3;
+	} else {
+		// 4 bytes
+		buffer[0] = (char) (0xF0 | (utf32Char >> 18));
+		buffer[1] = (char) (0x80 | ((utf32Char >> 12) & 0x3F));
+		buffer[2] = (char) (0x80 | ((utf32Char >> 6) & 0x3F));
+		buffer[3] = (char) (0x80 | (utf32Char & 0x3F));
+
+		return 4;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool sValidateUTF8(const char* chars, CString::Length byteCount, CString::Length& outLength)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	const	UInt8*			bytes = (const UInt8*) chars;
+	const	UInt8*			bytesEnd = bytes + byteCount;
+			CString::Length	length = 0;
+
+	while (bytes < bytesEnd) {
+		// Skip ASCII 8 bytes at a time
+		if ((bytesEnd - bytes) >= 8) {
+			// Check for all ASCII
+			UInt64	word;
+			::memcpy(&word, bytes, sizeof(UInt64));
+			if ((word & 0x8080808080808080ULL) == 0) {
+				// All ASCII
+				bytes += 8;
+				length += 8;
+				continue;
+			}
+		}
+
+		// Decode
+		UTF32Char	utf32Char;
+		if (!sDecodeUTF8(bytes, bytesEnd, utf32Char))
+			return false;
+		length += (utf32Char >= 0x10000) ? 2 : 1;
+	}
+
+	outLength = length;
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::Length sGetLength(const char* chars, CString::Length byteCount)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Count lead bytes, with 4-byte sequences taking 2 UTF-16 units
+	CString::Length	length = 0;
+	for (CString::Length i = 0; i < byteCount; i++) {
+		// Check byte
+		UInt8	byte = (UInt8) chars[i];
+		if ((byte & 0xC0) != 0x80)
+			length += (byte >= 0xF0) ? 2 : 1;
+	}
+
+	return length;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::Length sConvertToUTF8(const UInt8* bytes, CString::Length byteCount, CString::Encoding encoding,
+		char* buffer)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	const	UInt8*			bytesEnd = bytes + byteCount;
+			CString::Length	bufferByteCount = 0;
+
+	switch (encoding) {
+		case CString::kEncodingASCII:
+		case CString::kEncodingISOLatin:
+			// Bytes are code points
+			while (bytes < bytesEnd)
+				bufferByteCount += sEncodeUTF8(*bytes++, buffer + bufferByteCount);
+			break;
+
+		case CString::kEncodingMacRoman:
+			// Lookup upper half
+			while (bytes < bytesEnd) {
+				// Convert
+				UInt8	byte = *bytes++;
+				bufferByteCount +=
+						sEncodeUTF8((byte < 0x80) ? byte : sMacRomanUTF16Chars[byte - 0x80], buffer + bufferByteCount);
+			}
+			break;
+
+		case CString::kEncodingUTF8:
+			// Replace anything invalid
+			while (bytes < bytesEnd) {
+				// Convert
+				UTF32Char	utf32Char;
+				sDecodeUTF8(bytes, bytesEnd, utf32Char);
+				bufferByteCount += sEncodeUTF8(utf32Char, buffer + bufferByteCount);
+			}
+			break;
+
+		case CString::kEncodingUnicode:
+		case CString::kEncodingUTF16:
+		case CString::kEncodingUTF16BE:
+		case CString::kEncodingUTF16LE: {
+			// Setup
+			bool	isBigEndian =
+							(encoding == CString::kEncodingUTF16BE) ||
+							((encoding != CString::kEncodingUTF16LE) &&
+									(CString::kEncodingUTF16Native == CString::kEncodingUTF16BE));
+
+			// Check for BOM
+			if (((encoding == CString::kEncodingUnicode) || (encoding == CString::kEncodingUTF16)) &&
+					(byteCount >= 2)) {
+				// Check BOM
+				if ((bytes[0] == 0xFE) && (bytes[1] == 0xFF)) {
+					// Big endian
+					isBigEndian = true;
+					bytes += 2;
+				} else if ((bytes[0] == 0xFF) && (bytes[1] == 0xFE)) {
+					// Little endian
+					isBigEndian = false;
+					bytes += 2;
+				}
+			}
+
+			// Convert
+			while ((bytesEnd - bytes) >= 2) {
+				// Get UTF-16 unit
+				UTF32Char	utf32Char = isBigEndian ? ((bytes[0] << 8) | bytes[1]) : ((bytes[1] << 8) | bytes[0]);
+				bytes += 2;
+
+				// Check for surrogate
+				if ((utf32Char >= 0xD800) && (utf32Char <= 0xDBFF) && ((bytesEnd - bytes) >= 2)) {
+					// Check trailing surrogate
+					UTF32Char	utf32Char2 =
+										isBigEndian ? ((bytes[0] << 8) | bytes[1]) : ((bytes[1] << 8) | bytes[0]);
+					if ((utf32Char2 >= 0xDC00) && (utf32Char2 <= 0xDFFF)) {
+						// Combine
+						utf32Char = 0x10000 + ((utf32Char - 0xD800) << 10) + (utf32Char2 - 0xDC00);
+						bytes += 2;
+					}
+				}
+				if ((utf32Char >= 0xD800) && (utf32Char <= 0xDFFF))
+					// Unpaired surrogate
+					utf32Char = kReplacementUTF32Char;
+
+				bufferByteCount += sEncodeUTF8(utf32Char, buffer + bufferByteCount);
+			}
+			} break;
+
+		case CString::kEncodingUTF32:
+		case CString::kEncodingUTF32BE:
+		case CString::kEncodingUTF32LE: {
+			// Setup
+			bool	isBigEndian =
+							(encoding == CString::kEncodingUTF32BE) ||
+							((encoding != CString::kEncodingUTF32LE) &&
+									(CString::kEncodingUTF32Native == CString::kEncodingUTF32BE));
+
+			// Check for BOM
+			if ((encoding == CString::kEncodingUTF32) && (byteCount >= 4)) {
+				// Check BOM
+				if (::memcmp(bytes, "\x00\x00\xFE\xFF", 4) == 0) {
+					// Big endian
+					isBigEndian = true;
+					bytes += 4;
+				} else if (::memcmp(bytes, "\xFF\xFE\x00\x00", 4) == 0) {
+					// Little endian
+					isBigEndian = false;
+					bytes += 4;
+				}
+			}
+
+			// Convert
+			while ((bytesEnd - bytes) >= 4) {
+				// Get code point
+				UTF32Char	utf32Char =
+									isBigEndian ?
+											((bytes[0] << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3]) :
+											((bytes[3] << 24) | (bytes[2] << 16) | (bytes[1] << 8) | bytes[0]);
+				bytes += 4;
+				if ((utf32Char > 0x10FFFF) || ((utf32Char >= 0xD800) && (utf32Char <= 0xDFFF)))
+					// Invalid
+					utf32Char = kReplacementUTF32Char;
+
+				bufferByteCount += sEncodeUTF8(utf32Char, buffer + bufferByteCount);
+			}
+			} break;
+	}
+
+	return bufferByteCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CString::Length sConvertFromUTF8(const char* chars, CString::Length byteCount, CString::Encoding encoding,
+		SInt8 lossCharacter, bool addBOM, UInt8* buffer, CString::Length bufferByteCount,
+		CString::Length& outByteCount)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	const	UInt8*			bytes = (const UInt8*) chars;
+	const	UInt8*			bytesEnd = bytes + byteCount;
+			CString::Length	length = 0;
+			bool			isBigEndian =
+									(encoding == CString::kEncodingUTF16BE) ||
+									(encoding == CString::kEncodingUTF32BE) ||
+									(((encoding == CString::kEncodingUnicode) ||
+													(encoding == CString::kEncodingUTF16) ||
+													(encoding == CString::kEncodingUTF32)) &&
+											(CString::kEncodingUTF16Native == CString::kEncodingUTF16BE));
+			UInt8			encoded[4];
+			UInt32			encodedByteCount = 0;
+
+	outByteCount = 0;
+
+	// Check for BOM
+	if (addBOM &&
+			((encoding == CString::kEncodingUnicode) || (encoding == CString::kEncodingUTF16) ||
+					(encoding == CString::kEncodingUTF32))) {
+		// Compose BOM
+		if (encoding == CString::kEncodingUTF32) {
+			// UTF-32
+			::memcpy(encoded, isBigEndian ? "\x00\x00\xFE\xFF" : "\xFF\xFE\x00\x00", 4);
+			encodedByteCount = 4;
+		} else {
+			// UTF-16
+			::memcpy(encoded, isBigEndian ? "\xFE\xFF" : "\xFF\xFE", 2);
+			encodedByteCount = 2;
+		}
+
+		// Check if fits
+		if (buffer != nil) {
+			// Check space
+			if (encodedByteCount > bufferByteCount)
+				return 0;
+
+			// Store
+			::memcpy(buffer, encoded, encodedByteCount);
+		}
+		outByteCount += encodedByteCount;
+	}
+
+	// Convert characters
+	while (bytes < bytesEnd) {
+		// Get next character
+		const	UInt8*		charBytes = bytes;
+				UTF32Char	utf32Char;
+		sDecodeUTF8(bytes, bytesEnd, utf32Char);
+
+		// Encode
+		bool	isRepresentable = true;
+		switch (encoding) {
+			case CString::kEncodingASCII:
+			case CString::kEncodingISOLatin:
+				// Single byte
+				isRepresentable = utf32Char < ((encoding == CString::kEncodingASCII) ? 0x80 : 0x100);
+				encoded[0] = (UInt8) utf32Char;
+				encodedByteCount = 1;
+				break;
+
+			case CString::kEncodingMacRoman:
+				// Single byte
+				if (utf32Char < 0x80)
+					// ASCII
+					encoded[0] = (UInt8) utf32Char;
+				else {
+					// Lookup
+					const	UTF16Char*	macRomanUTF16Char =
+												std::find(sMacRomanUTF16Chars, sMacRomanUTF16Chars + 128, utf32Char);
+					isRepresentable = macRomanUTF16Char != (sMacRomanUTF16Chars + 128);
+					encoded[0] = (UInt8) (0x80 + (macRomanUTF16Char - sMacRomanUTF16Chars));
+				}
+				encodedByteCount = 1;
+				break;
+
+			case CString::kEncodingUTF8:
+				// Copy
+				encodedByteCount = (UInt32) (bytes - charBytes);
+				::memcpy(encoded, charBytes, encodedByteCount);
+				break;
+
+			case CString::kEncodingUnicode:
+			case CString::kEncodingUTF16:
+			case CString::kEncodingUTF16BE:
+			case CString::kEncodingUTF16LE:
+				// UTF-16
+				if (utf32Char < 0x10000) {
+					// Single unit
+					encoded[0] = (UInt8) (isBigEndian ? (utf32Char >> 8) : utf32Char);
+					encoded[1] = (UInt8) (isBigEndian ? utf32Char : (utf32Char >> 8));
+					encodedByteCount = 2;
+				} else {
+					// Surrogate pair
+					UTF32Char	leadUTF16Char = 0xD800 + ((utf32Char - 0x10000) >> 10);
+					UTF32Char	trailUTF16Char = 0xDC00 + ((utf32Char - 0x10000) & 0x3FF);
+					encoded[0] = (UInt8) (isBigEndian ? (leadUTF16Char >> 8) : leadUTF16Char);
+					encoded[1] = (UInt8) (isBigEndian ? leadUTF16Char : (leadUTF16Char >> 8));
+					encoded[2] = (UInt8) (isBigEndian ? (trailUTF16Char >> 8) : trailUTF16Char);
+					encoded[3] = (UInt8) (isBigEndian ? trailUTF16Char : (trailUTF16Char >> 8));
+					encodedByteCount = 4;
+				}
+				break;
+
+			case CString::kEncodingUTF32:
+			case CString::kEncodingUTF32BE:
+			case CString::kEncodingUTF32LE:
+				// UTF-32
+				for (UInt32 i = 0; i < 4; i++)
+					// Store byte
+					encoded[i] = (UInt8) (utf32Char >> (isBigEndian ? (24 - i * 8) : (i * 8)));
+				encodedByteCount = 4;
+				break;
+		}
+
+		// Check if representable
+		if (!isRepresentable) {
+			// Check loss character
+			if (lossCharacter == 0)
+				// Stop
+				break;
+
+			// Use loss character
+			encoded[0] = (UInt8) lossCharacter;
+			encodedByteCount = 1;
+		}
+
+		// Check if fits
+		if (buffer != nil) {
+			// Check space
+			if ((outByteCount + encodedByteCount) > bufferByteCount)
+				break;
+
+			// Store
+			::memcpy(buffer + outByteCount, encoded, encodedByteCount);
+		}
+
+		// Update
+		outByteCount += encodedByteCount;
+		length += (utf32Char >= 0x10000) ? 2 : 1;
+	}
+
+	return length;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool sIsASCIICompatible(CString::Encoding encoding)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return (encoding == CString::kEncodingASCII) || (encoding == CString::kEncodingMacRoman) ||
+			(encoding == CString::kEncodingUTF8) || (encoding == CString::kEncodingISOLatin);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool sIsWhitespace(char _char)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return (_char == ' ') || (_char == '\t') || (_char == '\n') || (_char == '\r');
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UTF32Char sGetFoldedUTF32Char(UTF32Char utf32Char)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check for ASCII
+	if (utf32Char < 0x80)
+		// ASCII
+		return ((utf32Char >= 'A') && (utf32Char <= 'Z')) ? utf32Char + 32 : utf32Char;
+	else
+		// Unicode
+		return sGetMappedUTF32Char(utf32Char, sFoldedMappings, sFoldedMappingsCount);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UTF32Char sGetMappedUTF32Char(UTF32Char utf32Char, const SCaseMapping* caseMappings, UInt32 caseMappingsCount)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Find the first entry that does not end before this character
+	UInt32	lowIndex = 0;
+	UInt32	highIndex = caseMappingsCount;
+	while (lowIndex < highIndex) {
+		// Check middle
+		UInt32	middleIndex = (lowIndex + highIndex) / 2;
+		if (caseMappings[middleIndex].mLastUTF32Char < utf32Char)
+			// Look above
+			lowIndex = middleIndex + 1;
+		else
+			// Look below
+			highIndex = middleIndex;
+	}
+
+	// Check if mapped
+	if ((lowIndex < caseMappingsCount) && (caseMappings[lowIndex].mFirstUTF32Char <= utf32Char) &&
+			(((utf32Char - caseMappings[lowIndex].mFirstUTF32Char) % caseMappings[lowIndex].mStride) == 0))
+		// Mapped
+		return (UTF32Char) ((SInt32) utf32Char + caseMappings[lowIndex].mDelta);
+	else
+		// Unchanged
+		return utf32Char;
+}
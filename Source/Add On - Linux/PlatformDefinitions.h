@@ -0,0 +1,75 @@
+//----------------------------------------------------------------------------------------------------------------------
+//	PlatformDefinitions.h	©2020 Stevo Brock	All rights reserved.
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+// Defines
+#define TARGET_OS_LINUX 1
+#define TARGET_RT_LITTLE_ENDIAN 1
+
+#define	nil	NULL
+
+#define	MAKE_OSTYPE(a,b,c,d)	((a << 24) | (b << 16) | (c << 8) | d)
+
+#define force_inline __attribute__((always_inline))
+
+#define EndianS16_BtoN(value)	((SInt16) __builtin_bswap16(value))
+#define EndianS16_NtoB(value)	((SInt16) __builtin_bswap16(value))
+#define EndianU16_BtoN(value)	((UInt16) __builtin_bswap16(value))
+#define EndianU16_NtoB(value)	((UInt16) __builtin_bswap16(value))
+#define EndianS32_BtoN(value)	((SInt32) __builtin_bswap32(value))
+#define EndianS32_NtoB(value)	((SInt32) __builtin_bswap32(value))
+#define EndianU32_BtoN(value)	((UInt32) __builtin_bswap32(value))
+#define EndianU32_NtoB(value)	((UInt32) __builtin_bswap32(value))
+#define EndianS64_BtoN(value)	((SInt64) __builtin_bswap64(value))
+#define EndianS64_NtoB(value)	((SInt64) __builtin_bswap64(value))
+#define EndianU64_BtoN(value)	((UInt64) __builtin_bswap64(value))
+#define EndianU64_NtoB(value)	((UInt64) __builtin_bswap64(value))
+
+#define EndianS16_LtoN(value)	value
+#define EndianS16_NtoL(value)	value
+#define EndianU16_LtoN(value)	value
+#define EndianU16_NtoL(value)	value
+#define EndianS32_LtoN(value)	value
+#define EndianS32_NtoL(value)	value
+#define EndianU32_LtoN(value)	value
+#define EndianU32_NtoL(value)	value
+#define EndianS64_LtoN(value)	value
+#define EndianS64_NtoL(value)	value
+#define EndianU64_LtoN(value)	value
+#define EndianU64_NtoL(value)	value
+
+//----------------------------------------------------------------------------------------------------------------------
+// Types
+typedef	float				Float32;
+typedef	double				Float64;
+typedef	int8_t				SInt8;
+typedef	int16_t				SInt16;
+typedef	int32_t				SInt32;
+typedef	long long			SInt64;
+typedef	uint8_t				UInt8;
+typedef	uint16_t			UInt16;
+typedef	uint32_t			UInt32;
+typedef	unsigned long long	UInt64;
+
+typedef	UInt32				OSType;
+
+typedef	UInt16				UTF16Char;
+typedef	UInt32				UTF32Char;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Lifecycle helpers
+#define Delete(x)		{ delete x; x = nil; }
+#define DeleteArray(x)	{ delete [] x; x = nil; }
@@ -8,6 +8,7 @@
 #include "CppToolboxAssert.h"
 #include "SError-POSIX.h"
 
+#include <atomic>
 #include <pthread.h>
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -42,7 +43,7 @@ class CThreadInternals {
 								return nil;
 							}
 
-		bool				mIsRunning;
+		std::atomic<bool>	mIsRunning;
 		CThread::ThreadProc	mThreadProc;
 		void*				mThreadProcUserData;
 		CString				mThreadName;
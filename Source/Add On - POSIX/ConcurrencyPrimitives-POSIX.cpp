@@ -5,6 +5,7 @@
 #include "ConcurrencyPrimitives.h"
 
 #include <pthread.h>
+#include <time.h>
 
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: CLockInternals
@@ -132,7 +133,7 @@ void CReadPreferringLock::unlockForWriting() const
 
 class CSemaphoreInternals {
 	public:
-		CSemaphoreInternals()
+		CSemaphoreInternals() : mSignalCount(0)
 			{
 				::pthread_cond_init(&mCond, nil);
 				::pthread_mutex_init(&mMutex, nil);
@@ -145,6 +146,7 @@ class CSemaphoreInternals {
 
 		pthread_cond_t	mCond;
 		pthread_mutex_t	mMutex;
+		UInt32			mSignalCount;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -173,12 +175,54 @@ CSemaphore::~CSemaphore()
 void CSemaphore::signal() const
 //----------------------------------------------------------------------------------------------------------------------
 {
+	// Record signal so it is not lost if no one is waiting yet
+	::pthread_mutex_lock(&mInternals->mMutex);
+	mInternals->mSignalCount++;
 	::pthread_cond_signal(&mInternals->mCond);
+	::pthread_mutex_unlock(&mInternals->mMutex);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void CSemaphore::waitFor() const
 //----------------------------------------------------------------------------------------------------------------------
 {
-	::pthread_cond_wait(&mInternals->mCond, &mInternals->mMutex);
+	// Wait for signal
+	::pthread_mutex_lock(&mInternals->mMutex);
+	while (mInternals->mSignalCount == 0)
+		// Wait
+		::pthread_cond_wait(&mInternals->mCond, &mInternals->mMutex);
+	mInternals->mSignalCount--;
+	::pthread_mutex_unlock(&mInternals->mMutex);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool CSemaphore::timedWaitFor(UniversalTimeInterval maxWaitTimeInterval) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	struct	timespec	timespec;
+	::clock_gettime(CLOCK_REALTIME, &timespec);
+	timespec.tv_sec += (time_t) maxWaitTimeInterval;
+	timespec.tv_nsec += (long) ((maxWaitTimeInterval - (time_t) maxWaitTimeInterval) * 1000000000.0);
+	if (timespec.tv_nsec >= 1000000000) {
+		// Carry
+		timespec.tv_sec++;
+		timespec.tv_nsec -= 1000000000;
+	}
+
+	// Wait for signal or timeout
+	int	result = 0;
+	::pthread_mutex_lock(&mInternals->mMutex);
+	while ((mInternals->mSignalCount == 0) && (result == 0))
+		// Wait
+		result = ::pthread_cond_timedwait(&mInternals->mCond, &mInternals->mMutex, &timespec);
+
+	// Check if signaled
+	bool	signaled = mInternals->mSignalCount > 0;
+	if (signaled)
+		// Consume
+		mInternals->mSignalCount--;
+	::pthread_mutex_unlock(&mInternals->mMutex);
+
+	return signaled;
 }
@@ -25,26 +25,28 @@
 // MARK: Lifecycle methods
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString() : CHashable(), mString()
+CString::CString() : CHashable(), mHashValue(0), mString()
 //----------------------------------------------------------------------------------------------------------------------
 {
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const CString& other, OV<Length> length) : CHashable()
+CString::CString(const CString& other, OV<Length> length) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Check for length
 	if (length.hasValue())
 		// Have length
 		mString = std::basic_string<TCHAR>(other.mString, length.getValue());
-	else
+	else {
 		// Don't have length
 		mString = other.mString;
+		mHashValue = other.mHashValue.load(std::memory_order_relaxed);
+	}
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(OSStringVar(initialString), OV<Length> length) : CHashable()
+CString::CString(OSStringVar(initialString), OV<Length> length) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Check for length
@@ -57,7 +59,7 @@ CString::CString(OSStringVar(initialString), OV<Length> length) : CHashable()
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const char* chars, Length charsCount, Encoding encoding) : CHashable()
+CString::CString(const char* chars, Length charsCount, Encoding encoding) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Parameter check
@@ -79,7 +81,7 @@ CString::CString(const char* chars, Length charsCount, Encoding encoding) : CHas
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const UTF16Char* chars, Length charsCount, Encoding encoding) : CHashable()
+CString::CString(const UTF16Char* chars, Length charsCount, Encoding encoding) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Parameter check
@@ -89,7 +91,7 @@ CString::CString(const UTF16Char* chars, Length charsCount, Encoding encoding) :
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const UTF32Char* chars, Length charsCount, Encoding encoding) : CHashable()
+CString::CString(const UTF32Char* chars, Length charsCount, Encoding encoding) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Parameter check
@@ -100,35 +102,37 @@ CString::CString(const UTF32Char* chars, Length charsCount, Encoding encoding) :
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(Float32 value, UInt32 fieldSize, UInt32 digitsAfterDecimalPoint, bool padWithZeros) : CHashable()
+CString::CString(Float32 value, UInt32 fieldSize, UInt32 digitsAfterDecimalPoint, bool padWithZeros) :
+		CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	AssertFailUnimplemented();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(Float64 value, UInt32 fieldSize, UInt32 digitsAfterDecimalPoint, bool padWithZeros) : CHashable()
+CString::CString(Float64 value, UInt32 fieldSize, UInt32 digitsAfterDecimalPoint, bool padWithZeros) :
+		CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	AssertFailUnimplemented();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(SInt8 value, UInt32 fieldSize, bool padWithZeros) : CHashable()
+CString::CString(SInt8 value, UInt32 fieldSize, bool padWithZeros) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	AssertFailUnimplemented();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(SInt16 value, UInt32 fieldSize, bool padWithZeros) : CHashable()
+CString::CString(SInt16 value, UInt32 fieldSize, bool padWithZeros) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	AssertFailUnimplemented();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(SInt32 value, UInt32 fieldSize, bool padWithZeros) : CHashable()
+CString::CString(SInt32 value, UInt32 fieldSize, bool padWithZeros) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Setup
@@ -146,7 +150,7 @@ CString::CString(SInt32 value, UInt32 fieldSize, bool padWithZeros) : CHashable(
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(SInt64 value, UInt32 fieldSize, bool padWithZeros) : CHashable()
+CString::CString(SInt64 value, UInt32 fieldSize, bool padWithZeros) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Setup
@@ -164,7 +168,7 @@ CString::CString(SInt64 value, UInt32 fieldSize, bool padWithZeros) : CHashable(
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(UInt8 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable()
+CString::CString(UInt8 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Setup
@@ -190,7 +194,7 @@ CString::CString(UInt8 value, UInt32 fieldSize, bool padWithZeros, bool makeHex)
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(UInt16 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable()
+CString::CString(UInt16 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Setup
@@ -216,7 +220,7 @@ CString::CString(UInt16 value, UInt32 fieldSize, bool padWithZeros, bool makeHex
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(UInt32 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable()
+CString::CString(UInt32 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Setup
@@ -242,7 +246,8 @@ CString::CString(UInt32 value, UInt32 fieldSize, bool padWithZeros, bool makeHex
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(UInt64 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) : CHashable(), mString()
+CString::CString(UInt64 value, UInt32 fieldSize, bool padWithZeros, bool makeHex) :
+		CHashable(), mHashValue(0), mString()
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Setup
@@ -268,7 +273,7 @@ CString::CString(UInt64 value, UInt32 fieldSize, bool padWithZeros, bool makeHex
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(OSType osType, bool isOSType, bool includeQuotes) : CHashable()
+CString::CString(OSType osType, bool isOSType, bool includeQuotes) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Setup
@@ -279,7 +284,7 @@ CString::CString(OSType osType, bool isOSType, bool includeQuotes) : CHashable()
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const void* pointer) : CHashable()
+CString::CString(const void* pointer) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Setup
@@ -293,7 +298,7 @@ CString::CString(const void* pointer) : CHashable()
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const TArray<CString>& components, const CString& separator) : CHashable(), mString()
+CString::CString(const TArray<CString>& components, const CString& separator) : CHashable(), mHashValue(0), mString()
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Iterate array
@@ -309,7 +314,7 @@ CString::CString(const TArray<CString>& components, const CString& separator) :
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(const CData& data, Encoding encoding) : CHashable()
+CString::CString(const CData& data, Encoding encoding) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Ensure we have something to convert
@@ -613,6 +618,7 @@ CString& CString::operator=(const CString& other)
 {
 	// Copy
 	mString = other.mString;
+	mHashValue = other.mHashValue.load(std::memory_order_relaxed);
 
 	return *this;
 }
@@ -623,6 +629,7 @@ CString& CString::operator+=(const CString& other)
 {
 	// Append
 	mString += other.mString;
+	mHashValue = 0;
 
 	return *this;
 }
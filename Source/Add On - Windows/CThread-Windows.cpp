@@ -11,6 +11,8 @@
 #include <Windows.h>
 #define Delete(x)	{ delete x; x = nil; }
 
+#include <atomic>
+
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: CThreadInternals
 
@@ -38,7 +40,7 @@ class CThreadInternals {
 								return 0;
 							}
 
-		bool				mIsRunning;
+		std::atomic<bool>	mIsRunning;
 		CThread::ThreadProc	mThreadProc;
 		void*				mThreadProcUserData;
 		CString				mThreadName;
@@ -182,3 +182,10 @@ void CSemaphore::waitFor() const
 {
 	WaitForSingleObject(mInternals->mHandle, INFINITE);
 }
+
+//----------------------------------------------------------------------------------------------------------------------
+bool CSemaphore::timedWaitFor(UniversalTimeInterval maxWaitTimeInterval) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return WaitForSingleObject(mInternals->mHandle, (DWORD) (maxWaitTimeInterval * 1000.0)) == WAIT_OBJECT_0;
+}
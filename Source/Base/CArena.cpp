@@ -0,0 +1,189 @@
+//----------------------------------------------------------------------------------------------------------------------
+//	CArena.cpp			©2021 Stevo Brock	All rights reserved.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "CArena.h"
+
+#include "TReferenceTracking.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: Local data
+
+static	const	UInt64	kMaximumBlockByteCount = 1024 * 1024;
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - SArenaBlock
+
+struct SArenaBlock {
+	// Properties
+	SArenaBlock*	mPreviousBlock;
+	UInt64			mByteCount;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CArenaInternals
+
+/*
+	Blocks are chained back to front from mBlock.  Each new regular block is twice the size of the previous one (up to
+		kMaximumBlockByteCount) so small arenas stay small and large ones only need a handful of blocks.  Requests too
+		big to fit comfortably in a regular block get a dedicated block which is linked in behind the current one so
+		the remaining space in the current block is not abandoned.
+*/
+
+class CArenaInternals : public TAtomicReferenceCountable<CArenaInternals> {
+	public:
+				CArenaInternals(UInt32 initialBlockByteCount) :
+					TAtomicReferenceCountable(),
+							mBlock(nil), mCurrentPtr(nil), mEndPtr(nil), mNextBlockByteCount(initialBlockByteCount),
+							mUsedByteCount(0), mReservedByteCount(0)
+					{}
+				~CArenaInternals()
+					{
+						// Free all blocks
+						while (mBlock != nil) {
+							// Free this block
+							SArenaBlock*	previousBlock = mBlock->mPreviousBlock;
+							::free(mBlock);
+							mBlock = previousBlock;
+						}
+					}
+
+		void*	allocate(UInt64 byteCount, UInt32 alignment)
+					{
+						// Try the current block
+						UInt8*	ptr =
+										(UInt8*)
+												(((uintptr_t) mCurrentPtr + alignment - 1) &
+														~((uintptr_t) alignment - 1));
+						if ((mCurrentPtr != nil) && (byteCount <= (UInt64) (mEndPtr - ptr))) {
+							// Fits
+							mCurrentPtr = ptr + byteCount;
+							mUsedByteCount += byteCount;
+
+							return ptr;
+						}
+
+						// Check size
+						if ((byteCount + alignment) > (mNextBlockByteCount / 4)) {
+							// Give this its own block
+							SArenaBlock*	block = addBlock(sizeof(SArenaBlock) + byteCount + alignment);
+							if (block->mPreviousBlock != nil) {
+								// Move behind the current block
+								mBlock = block->mPreviousBlock;
+								block->mPreviousBlock = mBlock->mPreviousBlock;
+								mBlock->mPreviousBlock = block;
+							} else {
+								// No current block
+								mCurrentPtr = nil;
+								mEndPtr = nil;
+							}
+							mUsedByteCount += byteCount;
+
+							return (void*)
+									(((uintptr_t) (block + 1) + alignment - 1) & ~((uintptr_t) alignment - 1));
+						}
+
+						// Start a new block
+						SArenaBlock*	block = addBlock(mNextBlockByteCount);
+						mCurrentPtr = (UInt8*) (block + 1);
+						mEndPtr = (UInt8*) block + block->mByteCount;
+						mNextBlockByteCount = std::min<UInt64>(mNextBlockByteCount * 2, kMaximumBlockByteCount);
+
+						return allocate(byteCount, alignment);
+					}
+
+	private:
+		SArenaBlock*	addBlock(UInt64 byteCount)
+							{
+								// Setup
+								SArenaBlock*	block = (SArenaBlock*) ::malloc(byteCount);
+								block->mPreviousBlock = mBlock;
+								block->mByteCount = byteCount;
+
+								// Update info
+								mBlock = block;
+								mReservedByteCount += byteCount;
+
+								return block;
+							}
+
+	public:
+		SArenaBlock*	mBlock;
+		UInt8*			mCurrentPtr;
+		UInt8*			mEndPtr;
+		UInt64			mNextBlockByteCount;
+		UInt64			mUsedByteCount;
+		UInt64			mReservedByteCount;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CArena
+
+// MARK: Lifecycle methods
+
+//----------------------------------------------------------------------------------------------------------------------
+CArena::CArena(UInt32 initialBlockByteCount)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	mInternals = new CArenaInternals(initialBlockByteCount);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CArena::CArena(const CArena& other)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	mInternals = other.mInternals->addReference();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CArena::~CArena()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Remove reference
+	mInternals->removeReference();
+}
+
+// MARK: Instance methods
+
+//----------------------------------------------------------------------------------------------------------------------
+void* CArena::allocate(UInt64 byteCount, UInt32 alignment)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mInternals->allocate(byteCount, alignment);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 CArena::getUsedByteCount() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mInternals->mUsedByteCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 CArena::getReservedByteCount() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mInternals->mReservedByteCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CArena& CArena::operator=(const CArena& other)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if assignment to self
+	if (this == &other)
+		return *this;
+
+	// Remove reference to ourselves
+	mInternals->removeReference();
+
+	// Add reference to other
+	mInternals = other.mInternals->addReference();
+
+	return *this;
+}
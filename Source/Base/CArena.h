@@ -0,0 +1,43 @@
+//----------------------------------------------------------------------------------------------------------------------
+//	CArena.h			©2021 Stevo Brock	All rights reserved.
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "PlatformDefinitions.h"
+
+#include <new>
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: CArena
+//	A monotonic allocator.  Allocations are carved sequentially out of large blocks and are never freed individually;
+//		all blocks are released together once the last reference to the arena goes away.  Containers built into an
+//		arena (CDictionary, TNArray and SValue payloads) hold a reference, so the arena lives exactly as long as
+//		anything that was built into it.
+//	Allocating is not thread safe and is intended for a single thread building a tree (such as a parser).  Once built,
+//		the tree can be shared like any other: a container stops using the arena as soon as its storage has been
+//		shared with a copy, and its next write (or the copy's) goes to the regular heap, even if the other reference
+//		is gone by then.  Containers that have never been copied keep using the arena, so they belong to the thread
+//		building the tree.
+
+class CArenaInternals;
+class CArena {
+	// Methods
+	public:
+						// Lifecycle methods
+						CArena(UInt32 initialBlockByteCount = 4 * 1024);
+						CArena(const CArena& other);
+						~CArena();
+
+						// Instance methods
+				void*	allocate(UInt64 byteCount, UInt32 alignment = sizeof(void*));
+
+				UInt64	getUsedByteCount() const;
+				UInt64	getReservedByteCount() const;
+
+				CArena&	operator=(const CArena& other);
+
+	// Properties
+	private:
+		CArenaInternals*	mInternals;
+};
@@ -4,17 +4,142 @@
 
 #include "CArray.h"
 
+#include "CCoreServices.h"
+#include "ConcurrencyPrimitives.h"
 #include "CppToolboxAssert.h"
+#include "CWorkItemQueue.h"
 
 //----------------------------------------------------------------------------------------------------------------------
-// MARK: SArraySortInfo
+// MARK: Local data
+
+// Arrays smaller than this are sorted on the calling thread
+static	const	CArray::ItemCount	kArrayParallelSortMinimumCount = 8192;
+static	const	CArray::ItemCount	kArrayParallelSortMinimumRunItemCount = 4096;
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - SArraySortInfo
 
 struct SArraySortInfo {
+			// Instance methods
+	bool	operator()(CArray::ItemRef itemRef1, CArray::ItemRef itemRef2) const
+				{ return mCompareProc(itemRef1, itemRef2, mUserData) == kCompareResultBefore; }
+
 	// Properties
 	CArray::CompareProc	mCompareProc;
 	void*				mUserData;
 };
 
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CArrayParallelSortPass
+//	A pass is a set of independent tasks: either sorting each run in place (no scratch item refs), or merging pairs of
+//		adjacent runs from the item refs into the scratch item refs.  Tasks are claimed by the sorting thread and any
+//		helper work items that get to run.  The pass is reference counted because a helper work item may not start
+//		until after the sorting thread has moved on.
+
+class CArrayParallelSortPass {
+	public:
+				CArrayParallelSortPass(const CArray::SortProcs& sortProcs, CArray::ItemRef* itemRefs,
+						CArray::ItemRef* scratchItemRefs, CArray::ItemCount count, CArray::ItemCount runItemCount,
+						UInt32 taskCount) :
+					mSortProcs(sortProcs), mItemRefs(itemRefs), mScratchItemRefs(scratchItemRefs), mCount(count),
+							mRunItemCount(runItemCount), mTaskCount(taskCount), mNextTaskIndex(0),
+							mCompletedTaskCount(0), mReferenceCount(1)
+					{}
+
+		void*	addReference()
+					{ mLock.lock(); mReferenceCount++; mLock.unlock(); return this; }
+		void	removeReference()
+					{
+						// Decrement reference count
+						mLock.lock();
+						bool	isLastReference = --mReferenceCount == 0;
+						mLock.unlock();
+
+						// Check if last reference
+						if (isLastReference) {
+							// Done
+							CArrayParallelSortPass*	THIS = this;
+							Delete(THIS);
+						}
+					}
+
+		void	performTasks()
+					{
+						// Claim tasks until there are none left
+						while (true) {
+							// Claim next task
+							mLock.lock();
+							UInt32	taskIndex = mNextTaskIndex;
+							if (taskIndex < mTaskCount)
+								// Claimed
+								mNextTaskIndex++;
+							mLock.unlock();
+
+							// Check if have a task
+							if (taskIndex >= mTaskCount)
+								// No more tasks
+								return;
+
+							// Perform task
+							performTask(taskIndex);
+
+							// Update completed task count
+							mLock.lock();
+							bool	isLastTask = ++mCompletedTaskCount == mTaskCount;
+							mLock.unlock();
+
+							// Check if last task
+							if (isLastTask)
+								// Signal
+								mSemaphore.signal();
+						}
+					}
+		void	performTask(UInt32 taskIndex)
+					{
+						// Check pass
+						if (mScratchItemRefs == nil) {
+							// Sort run
+							CArray::ItemIndex	startIndex = std::min(taskIndex * mRunItemCount, mCount);
+							mSortProcs.sort(mItemRefs + startIndex, std::min(mRunItemCount, mCount - startIndex));
+						} else {
+							// Merge runs
+							CArray::ItemIndex	startIndex1 = std::min(taskIndex * 2 * mRunItemCount, mCount);
+							CArray::ItemCount	count1 = std::min(mRunItemCount, mCount - startIndex1);
+							CArray::ItemIndex	startIndex2 = startIndex1 + count1;
+							CArray::ItemCount	count2 = std::min(mRunItemCount, mCount - startIndex2);
+							mSortProcs.merge(mItemRefs + startIndex1, count1, mItemRefs + startIndex2, count2,
+									mScratchItemRefs + startIndex1);
+						}
+					}
+		void	waitUntilCompleted()
+					{
+						// Wait until all tasks have been completed
+						mLock.lock();
+						while (mCompletedTaskCount < mTaskCount) {
+							// Wait
+							mLock.unlock();
+							mSemaphore.waitFor();
+							mLock.lock();
+						}
+						mLock.unlock();
+					}
+
+		CArray::SortProcs	mSortProcs;
+		CArray::ItemRef*	mItemRefs;
+		CArray::ItemRef*	mScratchItemRefs;
+		CArray::ItemCount	mCount;
+		CArray::ItemCount	mRunItemCount;
+		UInt32				mTaskCount;
+
+		CLock				mLock;
+		CSemaphore			mSemaphore;
+		UInt32				mNextTaskIndex;
+		UInt32				mCompletedTaskCount;
+		UInt32				mReferenceCount;
+};
+
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - CArrayIteratorInfo
@@ -49,26 +174,43 @@ class CArrayIteratorInfo : public CIterator::Info {
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - CArrayInternals
 
-class CArrayInternals : public TCopyOnWriteReferenceCountable<CArrayInternals> {
+class CArrayInternals : public TAtomicCopyOnWriteReferenceCountable<CArrayInternals> {
 	public:
 											CArrayInternals(CArray::ItemCount initialCapacity,
 													CArray::CopyProc copyProc, CArray::DisposeProc disposeProc) :
-												TCopyOnWriteReferenceCountable(),
+												TAtomicCopyOnWriteReferenceCountable(),
 														mCapacity(std::max(initialCapacity, (UInt32) 10)), mCount(0),
 														mItemRefs(
 																(CArray::ItemRef*)
 																		::calloc(mCapacity, sizeof(CArray::ItemRef))),
 														mCopyProc(copyProc),
-														mDisposeProc(disposeProc), mReference(0)
+														mDisposeProc(disposeProc), mArena(nil),
+														mArenaCopyProc(nil), mArenaDisposeProc(nil), mReference(0),
+														mIsShared(false)
+												{}
+											CArrayInternals(CArena& arena, CArray::ArenaCopyProc arenaCopyProc,
+													CArray::DisposeProc arenaDisposeProc, CArray::CopyProc copyProc,
+													CArray::DisposeProc disposeProc) :
+												TAtomicCopyOnWriteReferenceCountable(),
+														mCapacity(10), mCount(0),
+														mItemRefs(
+																(CArray::ItemRef*)
+																		::calloc(mCapacity, sizeof(CArray::ItemRef))),
+														mCopyProc(copyProc), mDisposeProc(disposeProc),
+														mArena(new (arena.allocate(sizeof(CArena))) CArena(arena)),
+														mArenaCopyProc(arenaCopyProc),
+														mArenaDisposeProc(arenaDisposeProc), mReference(0),
+														mIsShared(false)
 												{}
 											CArrayInternals(const CArrayInternals& other) :
-												TCopyOnWriteReferenceCountable(),
+												TAtomicCopyOnWriteReferenceCountable(),
 														mCapacity(other.mCount), mCount(other.mCount),
 														mItemRefs(
 																(CArray::ItemRef*)
 																		::calloc(mCapacity, sizeof(CArray::ItemRef))),
 														mCopyProc(other.mCopyProc), mDisposeProc(other.mDisposeProc),
-														mReference(0)
+														mArena(nil), mArenaCopyProc(nil), mArenaDisposeProc(nil),
+														mReference(0), mIsShared(false)
 												{
 													// Check if have copy proc
 													if (mCopyProc != nil) {
@@ -88,6 +230,11 @@ class CArrayInternals : public TCopyOnWriteReferenceCountable<CArrayInternals> {
 
 													// Cleanup
 													::free(mItemRefs);
+
+													// Check if have arena
+													if (mArena != nil)
+														// Release last as it lives in its own storage
+														mArena->~CArena();
 												}
 
 				OV<CArray::ItemIndex>		getIndexOf(const CArray::ItemRef itemRef) const
@@ -176,9 +323,10 @@ class CArrayInternals : public TCopyOnWriteReferenceCountable<CArrayInternals> {
 													CArrayInternals*	arrayInternals = prepareForWrite();
 
 													// Check if owns items
-													if (performDispose && (mDisposeProc != nil))
+													if (performDispose)
 														// Dispose
-														mDisposeProc(arrayInternals->mItemRefs[itemIndex]);
+														arrayInternals->disposeItem(
+																arrayInternals->mItemRefs[itemIndex]);
 
 													// Move following itemRefs forward
 													::memmove(arrayInternals->mItemRefs + itemIndex,
@@ -214,14 +362,55 @@ class CArrayInternals : public TCopyOnWriteReferenceCountable<CArrayInternals> {
 				void						removeAllInternal()
 												{
 													// Check if have item dispose proc
-													if (mDisposeProc != nil) {
+													if ((mDisposeProc != nil) || (mArena != nil)) {
 														// Dispose each item
 														for (CArray::ItemIndex i = 0; i < mCount; i++) {
 															// Dispose
-															mDisposeProc(mItemRefs[i]);
+															disposeItem(mItemRefs[i]);
 														}
 													}
 												}
+				void						noteShared()
+												{ mIsShared.store(true, std::memory_order_relaxed); }
+				CArrayInternals*			prepareForWrite()
+												{
+													// Check if in arena and have been shared.  The arena is not
+													//	thread safe and a copy may be on another thread, so copy to
+													//	the heap even if the other reference is gone by now.
+													if ((mArena != nil) && mIsShared.load(std::memory_order_relaxed)) {
+														// Stop using the arena
+														CArrayInternals*	arrayInternals = new CArrayInternals(*this);
+														removeReference();
+
+														return arrayInternals;
+													} else
+														// Copy on write as usual
+														return TAtomicCopyOnWriteReferenceCountable::prepareForWrite();
+												}
+				CArray::ItemRef				copyItem(const CArray::ItemRef itemRef) const
+												{
+													// Check if can place in arena.  Items are only placed in the
+													//	arena while we are the only reference and have never been
+													//	shared as otherwise the next write will make a copy on the
+													//	heap.
+													if ((mArena != nil) && (getReferenceCount() == 1) &&
+															!mIsShared.load(std::memory_order_relaxed))
+														// Place in arena
+														return mArenaCopyProc(itemRef, *mArena);
+													else
+														// Copy
+														return (mCopyProc != nil) ? mCopyProc(itemRef) : itemRef;
+												}
+				void						disposeItem(const CArray::ItemRef itemRef)
+												{
+													// Check if in arena
+													if (mArena != nil)
+														// Destroy in place
+														mArenaDisposeProc(itemRef);
+													else if (mDisposeProc != nil)
+														// Dispose
+														mDisposeProc(itemRef);
+												}
 
 				TIteratorS<CArray::ItemRef>	getIterator() const
 												{
@@ -244,19 +433,29 @@ class CArrayInternals : public TCopyOnWriteReferenceCountable<CArrayInternals> {
 												}
 
 	public:
-		CArray::ItemCount	mCapacity;
-		CArray::ItemCount	mCount;
-		CArray::ItemRef*	mItemRefs;
-		CArray::CopyProc	mCopyProc;
-		CArray::DisposeProc	mDisposeProc;
-		UInt32				mReference;
+		CArray::ItemCount		mCapacity;
+		CArray::ItemCount		mCount;
+		CArray::ItemRef*		mItemRefs;
+		CArray::CopyProc		mCopyProc;
+		CArray::DisposeProc		mDisposeProc;
+		CArena*					mArena;
+		CArray::ArenaCopyProc	mArenaCopyProc;
+		CArray::DisposeProc		mArenaDisposeProc;
+		UInt32					mReference;
+		std::atomic<bool>		mIsShared;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - Local proc declarations
 
-static	int sSortProc(void* info, const void* itemRef1, const void* itemRef2);
+static	void	sSortItemRefs(CArray::ItemRef* itemRefs, CArray::ItemCount count, void* userData);
+static	void	sMergeItemRefs(const CArray::ItemRef* itemRefs1, CArray::ItemCount count1,
+						const CArray::ItemRef* itemRefs2, CArray::ItemCount count2, CArray::ItemRef* outItemRefs,
+						void* userData);
+static	void	sPerformParallelSortPass(CArrayParallelSortPass& parallelSortPass, UInt32 helperCount);
+static	void	sPerformParallelSortPassWorkItem(CWorkItem& workItem, void* userData);
+static	void	sParallelSortPassWorkItemCancelled(CWorkItem& workItem, void* userData);
 
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
@@ -272,12 +471,22 @@ CArray::CArray(ItemCount initialCapacity, CopyProc copyProc, DisposeProc dispose
 	mInternals = new CArrayInternals(initialCapacity, copyProc, disposeProc);
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+CArray::CArray(CArena& arena, ArenaCopyProc arenaCopyProc, DisposeProc arenaDisposeProc, CopyProc copyProc,
+		DisposeProc disposeProc)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	mInternals = new CArrayInternals(arena, arenaCopyProc, arenaDisposeProc, copyProc, disposeProc);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 CArray::CArray(const CArray& other)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Setup
 	mInternals = other.mInternals->addReference();
+	mInternals->noteShared();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -294,7 +503,7 @@ CArray::~CArray()
 CArray::ItemRef CArray::copy(const ItemRef itemRef) const
 //----------------------------------------------------------------------------------------------------------------------
 {
-	return (mInternals->mCopyProc != nil) ? mInternals->mCopyProc(itemRef) : itemRef;
+	return mInternals->copyItem(itemRef);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -513,6 +722,13 @@ TIteratorS<CArray::ItemRef> CArray::getIterator() const
 	return mInternals->getIterator();
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+const CArray::ItemRef* CArray::getItemRefs() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mInternals->mItemRefs;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 CArray& CArray::apply(ApplyProc applyProc, void* userData)
 //----------------------------------------------------------------------------------------------------------------------
@@ -528,26 +744,60 @@ CArray& CArray::apply(ApplyProc applyProc, void* userData)
 //----------------------------------------------------------------------------------------------------------------------
 CArray& CArray::sort(CompareProc compareProc, void* userData)
 //----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	SArraySortInfo	sortInfo = {compareProc, userData};
+
+	return sort(SortProcs(sSortItemRefs, sMergeItemRefs, &sortInfo));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CArray& CArray::sort(const SortProcs& sortProcs)
+//----------------------------------------------------------------------------------------------------------------------
 {
 	// Prepare for write
 	mInternals = mInternals->prepareForWrite();
 
-	// Sort
-#if TARGET_OS_IOS || TARGET_OS_MACOS || TARGET_OS_TVOS || TARGET_OS_WATCHOS
-	// BSD platforms
-	SArraySortInfo	sortInfo = {compareProc, userData};
-	qsort_r(mInternals->mItemRefs, mInternals->mCount, sizeof(ItemRef), &sortInfo, sSortProc);
-#elif TARGET_OS_LINUX
-	// GLibc platforms
-	qsort_r(mInternals->mItemRefs, mInternals->mCount, sizeof(ItemRef), sSortProc, userData);
-#elif TARGET_OS_WINDOWS
-	// Windows platforms
-	SArraySortInfo	sortInfo = {compareProc, userData};
-	qsort_s((void*) *mInternals->mItemRefs, mInternals->mCount, sizeof(ItemRef), sSortProc, &sortInfo);
-#else
-	// Unknown platform
-	AssertFailUnimplemented();
-#endif
+	// Check count
+	ItemCount	count = mInternals->mCount;
+	UInt32		coresCount = CCoreServices::getTotalProcessorCoresCount();
+	if ((count < kArrayParallelSortMinimumCount) || (coresCount < 2)) {
+		// Sort on this thread
+		sortProcs.sort(mInternals->mItemRefs, count);
+
+		return *this;
+	}
+
+	// Setup runs.  The run count is a power of 2 so every merge pass pairs up runs evenly.
+	UInt32	runCount = 2;
+	while ((runCount < coresCount) && ((count / (runCount * 2)) >= kArrayParallelSortMinimumRunItemCount))
+		// Double
+		runCount *= 2;
+	ItemCount	runItemCount = (count + runCount - 1) / runCount;
+
+	// Sort each run, then merge pairs of runs until a single run remains
+	ItemRef*	itemRefs = mInternals->mItemRefs;
+	ItemRef*	scratchItemRefs = (ItemRef*) ::malloc(count * sizeof(ItemRef));
+	sPerformParallelSortPass(
+			*new CArrayParallelSortPass(sortProcs, itemRefs, nil, count, runItemCount, runCount), coresCount - 1);
+	for (; runItemCount < count; runItemCount *= 2, runCount = (runCount + 1) / 2) {
+		// Merge
+		sPerformParallelSortPass(
+				*new CArrayParallelSortPass(sortProcs, itemRefs, scratchItemRefs, count, runItemCount,
+						(runCount + 1) / 2),
+				coresCount - 1);
+		std::swap(itemRefs, scratchItemRefs);
+	}
+
+	// Check where the result ended up
+	if (itemRefs != mInternals->mItemRefs) {
+		// Copy back
+		::memcpy(mInternals->mItemRefs, itemRefs, count * sizeof(ItemRef));
+		scratchItemRefs = itemRefs;
+	}
+
+	// Cleanup
+	::free(scratchItemRefs);
 
 	return *this;
 }
@@ -596,6 +846,7 @@ CArray& CArray::operator=(const CArray& other)
 
 	// Add reference to other
 	mInternals = other.mInternals->addReference();
+	mInternals->noteShared();
 
 	return *this;
 }
@@ -605,11 +856,59 @@ CArray& CArray::operator=(const CArray& other)
 // MARK: - Local proc definitions
 
 //----------------------------------------------------------------------------------------------------------------------
-int sSortProc(void* info, const void* itemRef1, const void* itemRef2)
+void sSortItemRefs(CArray::ItemRef* itemRefs, CArray::ItemCount count, void* userData)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	std::stable_sort(itemRefs, itemRefs + count, *((SArraySortInfo*) userData));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void sMergeItemRefs(const CArray::ItemRef* itemRefs1, CArray::ItemCount count1, const CArray::ItemRef* itemRefs2,
+		CArray::ItemCount count2, CArray::ItemRef* outItemRefs, void* userData)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	std::merge(itemRefs1, itemRefs1 + count1, itemRefs2, itemRefs2 + count2, outItemRefs,
+			*((SArraySortInfo*) userData));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void sPerformParallelSortPass(CArrayParallelSortPass& parallelSortPass, UInt32 helperCount)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Queue helpers.  This thread performs tasks as well so the pass completes even if no helper ever gets to run,
+	//	as happens when sorting from a work item while all other work items are busy.
+	helperCount = std::min(helperCount, parallelSortPass.mTaskCount - 1);
+	for (UInt32 i = 0; i < helperCount; i++)
+		// Queue
+		CWorkItemQueue::main().add(sPerformParallelSortPassWorkItem, parallelSortPass.addReference(),
+				CWorkItem::kPriorityHigh, sParallelSortPassWorkItemCancelled);
+
+	// Perform tasks
+	parallelSortPass.performTasks();
+	parallelSortPass.waitUntilCompleted();
+
+	// Done
+	parallelSortPass.removeReference();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void sPerformParallelSortPassWorkItem(CWorkItem& workItem, void* userData)
 //----------------------------------------------------------------------------------------------------------------------
 {
-	SArraySortInfo*	sortInfo = (SArraySortInfo*) info;
+	// Setup
+	CArrayParallelSortPass&	parallelSortPass = *((CArrayParallelSortPass*) userData);
+
+	// Perform tasks
+	parallelSortPass.performTasks();
 
-	return (int) sortInfo->mCompareProc(*((CArray::ItemRef*) itemRef1), *((CArray::ItemRef*) itemRef2),
-			sortInfo->mUserData);
+	// Done
+	parallelSortPass.removeReference();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void sParallelSortPassWorkItemCancelled(CWorkItem& workItem, void* userData)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Done
+	((CArrayParallelSortPass*) userData)->removeReference();
 }
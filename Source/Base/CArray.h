@@ -4,12 +4,18 @@
 
 #pragma once
 
+#include "CArena.h"
 #include "CEquatable.h"
 #include "CIterator.h"
 #include "Compare.h"
 #include "SNumber.h"
+#include "TReferenceTracking.h"
 #include "TWrappers.h"
 
+#include <algorithm>
+#include <new>
+#include <utility>
+
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: CArray
 
@@ -26,9 +32,63 @@ class CArray : public CEquatable {
 		typedef	void			(*ApplyProc)(ItemRef itemRef, void* userData);
 		typedef	ECompareResult	(*CompareProc)(ItemRef itemRef1, ItemRef itemRef2, void* userData);
 		typedef	ItemRef			(*CopyProc)(ItemRef itemRef);
+		typedef	ItemRef			(*ArenaCopyProc)(ItemRef itemRef, CArena& arena);
 		typedef	void			(*DisposeProc)(ItemRef itemRef);
 		typedef bool			(*IsIncludedProc)(ItemRef itemRef, void* userData);
 
+	// Structs
+	public:
+		struct SortProcs {
+			// Procs
+			typedef	void	(*SortProc)(ItemRef* itemRefs, ItemCount count, void* userData);
+			typedef	void	(*MergeProc)(const ItemRef* itemRefs1, ItemCount count1, const ItemRef* itemRefs2,
+									ItemCount count2, ItemRef* outItemRefs, void* userData);
+
+					// Lifecycle methods
+					SortProcs(SortProc sortProc, MergeProc mergeProc, void* userData) :
+						mSortProc(sortProc), mMergeProc(mergeProc), mUserData(userData)
+						{}
+
+					// Instance methods
+			void	sort(ItemRef* itemRefs, ItemCount count) const
+						{ mSortProc(itemRefs, count, mUserData); }
+			void	merge(const ItemRef* itemRefs1, ItemCount count1, const ItemRef* itemRefs2, ItemCount count2,
+							ItemRef* outItemRefs) const
+						{ mMergeProc(itemRefs1, count1, itemRefs2, count2, outItemRefs, mUserData); }
+
+			// Properties
+			SortProc	mSortProc;
+			MergeProc	mMergeProc;
+			void*		mUserData;
+		};
+
+		// Sorts through an inlineable comparator, where compare(item1, item2) returns true if item1 sorts before item2
+		template <typename T, typename C> struct TCompareSortProcs : public SortProcs {
+			// Structs
+			struct Compare {
+						// Lifecycle methods
+						Compare(C& compare) : mCompare(compare) {}
+
+						// Instance methods
+				bool	operator()(ItemRef itemRef1, ItemRef itemRef2) const
+							{ return mCompare(*((T*) itemRef1), *((T*) itemRef2)); }
+
+				// Properties
+				C&	mCompare;
+			};
+
+							// Lifecycle methods
+							TCompareSortProcs(C& compare) : SortProcs(sort, merge, &compare) {}
+
+							// Class methods
+			static	void	sort(ItemRef* itemRefs, ItemCount count, void* userData)
+								{ std::stable_sort(itemRefs, itemRefs + count, Compare(*((C*) userData))); }
+			static	void	merge(const ItemRef* itemRefs1, ItemCount count1, const ItemRef* itemRefs2,
+									ItemCount count2, ItemRef* outItemRefs, void* userData)
+								{ std::merge(itemRefs1, itemRefs1 + count1, itemRefs2, itemRefs2 + count2, outItemRefs,
+										Compare(*((C*) userData))); }
+		};
+
 	// Methods
 	public:
 									// Lifecycle methods
@@ -49,6 +109,8 @@ class CArray : public CEquatable {
 									// Lifecycle methods
 									CArray(ItemCount initialCapacity = 0, CopyProc copyProc = nil,
 											DisposeProc disposeProc = nil);
+									CArray(CArena& arena, ArenaCopyProc arenaCopyProc, DisposeProc arenaDisposeProc,
+											CopyProc copyProc, DisposeProc disposeProc);
 									CArray(const CArray& other);
 
 									// Instance methods
@@ -81,10 +143,12 @@ class CArray : public CEquatable {
 				bool				equals(const CArray& other) const;
 
 				TIteratorS<ItemRef>	getIterator() const;
+		const	ItemRef*			getItemRefs() const;
 
 				CArray&				apply(ApplyProc applyProc, void* userData = nil);
 
 				CArray&				sort(CompareProc compareProc, void* userData = nil);
+				CArray&				sort(const SortProcs& sortProcs);
 				CArray				sorted(CompareProc compareProc, void* userData = nil) const;
 
 				CArray				filtered(IsIncludedProc isIncludedProc, void* userData = nil) const;
@@ -106,6 +170,32 @@ class CArray : public CEquatable {
 //		lifetime management.
 
 template <typename T> class TArray : public CArray {
+	// Iterator
+	public:
+		// Walks the item refs directly and does not allocate.  The array must not be modified while iterating.
+		class Iterator {
+			// Methods
+			public:
+							// Lifecycle methods
+							Iterator(const ItemRef* itemRef) : mItemRef(itemRef) {}
+
+							// Instance methods
+				T&			operator*() const
+								{ return *((T*) *mItemRef); }
+				T*			operator->() const
+								{ return (T*) *mItemRef; }
+				Iterator&	operator++()
+								{ mItemRef++; return *this; }
+				bool		operator==(const Iterator& other) const
+								{ return mItemRef == other.mItemRef; }
+				bool		operator!=(const Iterator& other) const
+								{ return mItemRef != other.mItemRef; }
+
+			// Properties
+			private:
+				const	ItemRef*	mItemRef;
+		};
+
 	// Methods
 	public:
 						// Lifecycle methods
@@ -206,10 +296,17 @@ template <typename T> class TArray : public CArray {
 		TIteratorD<T>	getIterator() const
 							{ TIteratorS<ItemRef> iterator = CArray::getIterator();
 								return TIteratorD<T>((TIteratorD<T>*) &iterator); }
+		Iterator		begin() const
+							{ return Iterator(getItemRefs()); }
+		Iterator		end() const
+							{ return Iterator(getItemRefs() + getCount()); }
 
 		TArray<T>&		sort(ECompareResult (compareProc)(const T& item1, const T& item2, void* userData),
 								void* userData = nil)
 							{ CArray::sort((CompareProc) compareProc, userData); return *this; }
+		template <typename C>
+		TArray<T>&		sort(C compare)
+							{ CArray::sort(TCompareSortProcs<T, C>(compare)); return *this; }
 
 						// Instance methods
 		OR<T>			getFirst(bool (proc)(const T& item, void* userData), void* userData = nil) const
@@ -276,6 +373,10 @@ template <typename T> class TArray : public CArray {
 	protected:
 						// Lifecycle methods
 						TArray(CopyProc copyProc, DisposeProc disposeProc) : CArray(0, copyProc, disposeProc) {}
+						TArray(CArena& arena, ArenaCopyProc arenaCopyProc, DisposeProc arenaDisposeProc,
+								CopyProc copyProc, DisposeProc disposeProc) :
+							CArray(arena, arenaCopyProc, arenaDisposeProc, copyProc, disposeProc)
+							{}
 						TArray(const T& item, CopyProc copyProc, DisposeProc disposeProc) :
 							CArray(0, copyProc, disposeProc)
 							{ add(item); }
@@ -283,6 +384,8 @@ template <typename T> class TArray : public CArray {
 
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - TNArray (TArray where copy happens through new T())
+//	When built into a CArena, items are placed in the arena (until the array's storage has been shared with a copy)
+//		and are destroyed in place.  detach() and move() hand out such items as-is, so they remain owned by the arena.
 
 template <typename T> class TNArray : public TArray<T> {
 	// Types
@@ -293,6 +396,11 @@ template <typename T> class TNArray : public TArray<T> {
 	public:
 									// Lifecycle methods
 									TNArray() : TArray<T>((CArray::CopyProc) copy, (CArray::DisposeProc) dispose) {}
+									TNArray(CArena& arena) :
+										TArray<T>(arena, (CArray::ArenaCopyProc) arenaCopy,
+												(CArray::DisposeProc) destroy, (CArray::CopyProc) copy,
+												(CArray::DisposeProc) dispose)
+										{}
 									TNArray(const T& item, ItemCount count = 1) :
 										TArray<T>((CArray::CopyProc) copy, (CArray::DisposeProc) dispose)
 										{
@@ -365,6 +473,10 @@ template <typename T> class TNArray : public TArray<T> {
 										{ return new T(*((T*) itemRef)); }
 		static	void				dispose(CArray::ItemRef itemRef)
 										{ T* t = (T*) itemRef; Delete(t); }
+		static	T*					arenaCopy(CArray::ItemRef itemRef, CArena& arena)
+										{ return new (arena.allocate(sizeof(T))) T(*((T*) itemRef)); }
+		static	void				destroy(CArray::ItemRef itemRef)
+										{ ((T*) itemRef)->~T(); }
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -414,84 +526,616 @@ template <typename T> class TSArray : public TArray<T> {
 
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - TNumericArray
+//	TNumericArray stores numeric values (UInt32, SInt64, OSType, Float32, etc) unboxed in a single contiguous buffer
+//		that grows geometrically.  The buffer is shared between copies until one of them is modified.
 
-template <typename T> class TNumericArray : public CArray {
+template <typename T> class TNumericArray : public CEquatable {
 	// Types
 	public:
 		typedef	T	(*MappingProc)(CArray::ItemRef item);
 
+	// Internals
+	private:
+		class Internals : public TAtomicCopyOnWriteReferenceCountable<Internals> {
+			public:
+										Internals(CArray::ItemCount initialCapacity) :
+											TAtomicCopyOnWriteReferenceCountable<Internals>(),
+													mValues(nil), mCount(0), mCapacity(0), mReference(0)
+											{ reserve(initialCapacity); }
+										Internals(const Internals& other) :
+											TAtomicCopyOnWriteReferenceCountable<Internals>(),
+													mValues(nil), mCount(other.mCount), mCapacity(0), mReference(0)
+											{
+												// Copy values
+												reserve(other.mCount);
+												::memcpy(mValues, other.mValues, mCount * sizeof(T));
+											}
+										~Internals()
+											{ ::free(mValues); }
+
+						Internals*		add(const T* values, CArray::ItemCount count)
+											{
+												// Prepare for write
+												Internals*	internals = this->prepareForWrite();
+
+												// Make room
+												if ((internals->mCount + count) > internals->mCapacity)
+													// Grow
+													internals->reserve(
+															std::max<CArray::ItemCount>(internals->mCount + count,
+																	internals->mCapacity * 2));
+
+												// Copy values
+												::memcpy(internals->mValues + internals->mCount, values,
+														count * sizeof(T));
+												internals->mCount += count;
+												internals->mReference++;
+
+												return internals;
+											}
+						Internals*		insertAtIndex(T value, CArray::ItemIndex index)
+											{
+												// Prepare for write
+												Internals*	internals = this->prepareForWrite();
+
+												// Make room
+												if (internals->mCount == internals->mCapacity)
+													// Grow
+													internals->reserve(
+															std::max<CArray::ItemCount>(internals->mCapacity * 2, 10));
+
+												// Insert value
+												::memmove(internals->mValues + index + 1, internals->mValues + index,
+														(internals->mCount - index) * sizeof(T));
+												internals->mValues[index] = value;
+												internals->mCount++;
+												internals->mReference++;
+
+												return internals;
+											}
+						Internals*		removeAtIndex(CArray::ItemIndex index)
+											{
+												// Prepare for write
+												Internals*	internals = this->prepareForWrite();
+
+												// Remove value
+												::memmove(internals->mValues + index, internals->mValues + index + 1,
+														(internals->mCount - index - 1) * sizeof(T));
+												internals->mCount--;
+												internals->mReference++;
+
+												return internals;
+											}
+						Internals*		removeAll()
+											{
+												// Check if empty
+												if (mCount == 0)
+													// Nothing to remove
+													return this;
+
+												// Prepare for write
+												Internals*	internals = this->prepareForWrite();
+
+												// Remove all
+												internals->mCount = 0;
+												internals->mReference++;
+
+												return internals;
+											}
+						Internals*		sort()
+											{
+												// Prepare for write
+												Internals*	internals = this->prepareForWrite();
+
+												// Sort
+												std::sort(internals->mValues, internals->mValues + internals->mCount);
+												internals->mReference++;
+
+												return internals;
+											}
+						void			reserve(CArray::ItemCount capacity)
+											{
+												// Check if need to grow
+												if (capacity > mCapacity) {
+													// Grow
+													mValues = (T*) ::realloc(mValues, capacity * sizeof(T));
+													mCapacity = capacity;
+												}
+											}
+
+				T*					mValues;
+				CArray::ItemCount	mCount;
+				CArray::ItemCount	mCapacity;
+				UInt32				mReference;
+		};
+
+	// IteratorInfo
+	private:
+		class IteratorInfo : public CIterator::Info {
+			// Methods
+			public:
+									// Lifecycle methods
+									IteratorInfo(const Internals& internals, CArray::ItemIndex currentIndex = 0) :
+										CIterator::Info(),
+												mInternals(internals), mInitialReference(internals.mReference),
+												mCurrentIndex(currentIndex)
+										{}
+
+									// CIterator::Info methods
+				CIterator::Info*	copy()
+										{ return new IteratorInfo(mInternals, mCurrentIndex); }
+
+			// Properties
+			const	Internals&			mInternals;
+					UInt32				mInitialReference;
+					CArray::ItemIndex	mCurrentIndex;
+		};
+
+	// Methods
+	public:
+											// Lifecycle methods
+											TNumericArray(CArray::ItemCount initialCapacity = 0) :
+												CEquatable(), mInternals(new Internals(initialCapacity))
+												{}
+											TNumericArray(T value, CArray::ItemCount count = 1) :
+												CEquatable(), mInternals(new Internals(count))
+												{
+													// Loop requested times
+													for (CArray::ItemIndex i = 0; i < count; i++)
+														// Store
+														mInternals->mValues[i] = value;
+													mInternals->mCount = count;
+												}
+											TNumericArray(const T* values, CArray::ItemCount count) :
+												CEquatable(), mInternals(new Internals(count))
+												{ mInternals = mInternals->add(values, count); }
+											TNumericArray(const CArray& array, MappingProc mappingProc) :
+												CEquatable(), mInternals(new Internals(array.getCount()))
+												{
+													// Iterate all items
+													CArray::ItemCount	count = array.getCount();
+													for (CArray::ItemIndex i = 0; i < count; i++)
+														// Store mapped item
+														mInternals->mValues[i] = mappingProc(array.getItemAt(i));
+													mInternals->mCount = count;
+												}
+											TNumericArray(const TNumericArray<T>& array) :
+												CEquatable(), mInternals(array.mInternals->addReference())
+												{}
+											~TNumericArray()
+												{ mInternals->removeReference(); }
+
+											// CEquatable methods
+				bool						operator==(const CEquatable& other) const
+												{ return equals((const TNumericArray<T>&) other); }
+
+											// Instance methods
+				CArray::ItemCount			getCount() const
+												{ return mInternals->mCount; }
+				bool						isEmpty() const
+												{ return mInternals->mCount == 0; }
+
+				TNumericArray<T>&			add(T value)
+												{ mInternals = mInternals->add(&value, 1); return *this; }
+				TNumericArray<T>&			addFrom(const TNumericArray<T>& array)
+												{
+													// Check if adding to self
+													if (array.mInternals == mInternals) {
+														// Copy first as our buffer may move
+														TNumericArray<T>	other(array.getBuffer(), array.getCount());
+														mInternals =
+																mInternals->add(other.getBuffer(), other.getCount());
+													} else
+														// Add
+														mInternals =
+																mInternals->add(array.getBuffer(), array.getCount());
+
+													return *this;
+												}
+
+				bool						contains(T value) const
+												{ return getIndexOf(value).hasValue(); }
+
+				T							getAt(CArray::ItemIndex index) const
+												{
+													// Check index
+													AssertFailIf(index >= mInternals->mCount);
+
+													return mInternals->mValues[index];
+												}
+				T							getFirst() const
+												{ return getAt(0); }
+				T							getLast() const
+												{ return getAt(mInternals->mCount - 1); }
+				OV<CArray::ItemIndex>		getIndexOf(T value) const
+												{
+													// Iterate all
+													for (CArray::ItemIndex i = 0; i < mInternals->mCount; i++) {
+														// Check if same
+														if (mInternals->mValues[i] == value)
+															// Match
+															return OV<CArray::ItemIndex>(i);
+													}
+
+													return OV<CArray::ItemIndex>();
+												}
+		const	T*							getBuffer() const
+												{ return mInternals->mValues; }
+
+				TNumericArray<T>&			insertAtIndex(T value, CArray::ItemIndex index)
+												{
+													// Check index
+													AssertFailIf(index > mInternals->mCount);
+
+													// Insert
+													mInternals = mInternals->insertAtIndex(value, index);
+
+													return *this;
+												}
+
+				TNumericArray<T>&			removeAtIndex(CArray::ItemIndex index)
+												{
+													// Check index
+													AssertFailIf(index >= mInternals->mCount);
+
+													// Remove
+													mInternals = mInternals->removeAtIndex(index);
+
+													return *this;
+												}
+				TNumericArray<T>&			removeAll()
+												{ mInternals = mInternals->removeAll(); return *this; }
+
+				bool						equals(const TNumericArray<T>& other) const
+												{
+													// Compare
+													return (other.mInternals == mInternals) ||
+															((other.mInternals->mCount == mInternals->mCount) &&
+																	(::memcmp(other.mInternals->mValues,
+																			mInternals->mValues,
+																			mInternals->mCount * sizeof(T)) == 0));
+												}
+
+				TIteratorS<T>				getIterator() const
+												{
+													// Setup
+													IteratorInfo*	iteratorInfo = new IteratorInfo(*mInternals);
+
+													return TIteratorS<T>(
+															(mInternals->mCount > 0) ? mInternals->mValues : nil,
+															iteratorAdvance, *iteratorInfo);
+												}
+
+		const	T*							begin() const
+												{ return mInternals->mValues; }
+		const	T*							end() const
+												{ return mInternals->mValues + mInternals->mCount; }
+
+				TNumericArray<T>&			sort()
+												{ mInternals = mInternals->sort(); return *this; }
+				TNumericArray<T>			sorted() const
+												{ TNumericArray<T> array(*this); array.sort(); return array; }
+
+				T							operator[] (CArray::ItemIndex index) const
+												{ return getAt(index); }
+				TNumericArray<T>&			operator=(const TNumericArray<T>& other)
+												{
+													// Check if assignment to self
+													if (this == &other)
+														return *this;
+
+													// Update reference
+													mInternals->removeReference();
+													mInternals = other.mInternals->addReference();
+
+													return *this;
+												}
+				TNumericArray<T>&			operator+=(T value)
+												{ return add(value); }
+				TNumericArray<T>&			operator+=(const TNumericArray<T>& other)
+												{ return addFrom(other); }
+
+	private:
+											// Class methods
+		static	void*						iteratorAdvance(CIterator::Info& iteratorInfo)
+												{
+													// Setup
+													IteratorInfo&		numericArrayIteratorInfo =
+																					(IteratorInfo&) iteratorInfo;
+													const	Internals&	internals = numericArrayIteratorInfo.mInternals;
+
+													// Internals check
+													AssertFailIf(numericArrayIteratorInfo.mInitialReference !=
+															internals.mReference);
+
+													return (++numericArrayIteratorInfo.mCurrentIndex <
+																	internals.mCount) ?
+															(void*)
+																	&internals.mValues[
+																			numericArrayIteratorInfo.mCurrentIndex] :
+															nil;
+												}
+
+	// Properties
+	private:
+		Internals*	mInternals;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - TVArray
+//	TVArray stores items by value in a single contiguous buffer that grows geometrically.  There is no per-item
+//		allocation and items are moved (not copied) when the buffer grows.  Copying a TVArray copies all the items, so
+//		pass by reference and use move where possible.  Iterate using begin()/end() which do not allocate.
+
+template <typename T> class TVArray {
+	// Types
+	public:
+		typedef	ECompareResult	(*CompareProc)(const T& item1, const T& item2, void* userData);
+
 	// Methods
 	public:
-													// Lifecycle methods
-													TNumericArray(ItemCount initialCapacity = 0) :
-														CArray(initialCapacity, (CArray::CopyProc) copy, dispose)
-														{}
-													TNumericArray(T value, ItemCount count = 1) :
-														CArray(count, (CArray::CopyProc) copy, dispose)
-														{
-															// Loop requested times
-															for (ItemIndex i = 0; i < count; i++)
-																// Add
-																CArray::add(new SNumberWrapper<T>(value));
-														}
-													TNumericArray(const CArray& array, MappingProc mappingProc) :
-														CArray(0, (CArray::CopyProc) copy, dispose)
-														{
-															ItemCount	count = array.getCount();
-															for (ItemIndex i = 0; i < count; i++)
-																CArray::add(mappingProc(array.getItemAt(i)));
-														}
-													TNumericArray(const TNumericArray<T>& array) : CArray(array) {}
-
-													// CArray methods
-				TNumericArray<T>&					add(T value)
-														{ CArray::add(new SNumberWrapper<T>(value)); return *this; }
-				TNumericArray<T>&					addFrom(const TNumericArray<T>& array)
-														{
-															// Iterate all
-															ItemCount	count = array.getCount();
-															for (ItemIndex i = 0; i < count; i++)
-																// Add
-																CArray::add(CArray::copy(array.getItemAt(i)));
-
-															return *this;
-														}
-
-				T									getAt(ItemIndex index) const
-														{ return ((SNumberWrapper<T>*) getItemAt(index))->mValue; }
-
-				TIteratorM<SNumberWrapper<T>, T>	getIterator() const
-														{
-															TIteratorS<ItemRef> iterator = CArray::getIterator();
-
-															return TIteratorM<SNumberWrapper<T>, T>(
-																	(TIteratorM<SNumberWrapper<T>, T>*) &iterator,
-																	getValueForRawValue);
-														}
-
-													// Instance methods
-				T									operator[] (ItemIndex index) const
-														{ return ((SNumberWrapper<T>*) getItemAt(index))->mValue; }
-				TNumericArray<T>&					operator+=(T value)
-														{ CArray::add(new SNumberWrapper<T>(value)); return *this; }
-
-													// Class methods
-		static	T									getValue(ItemRef itemRef)
-														{ return ((SNumberWrapper<T>*) itemRef)->mValue; }
+											// Lifecycle methods
+											TVArray(CArray::ItemCount initialCapacity = 0) :
+												mItems(nil), mCount(0), mCapacity(0)
+												{ reserve(initialCapacity); }
+											TVArray(const TVArray<T>& other) :
+												mItems(nil), mCount(0), mCapacity(0)
+												{ addFrom(other); }
+											TVArray(TVArray<T>&& other) :
+												mItems(other.mItems), mCount(other.mCount), mCapacity(other.mCapacity)
+												{ other.mItems = nil; other.mCount = 0; other.mCapacity = 0; }
+											TVArray(const TArray<T>& array) :
+												mItems(nil), mCount(0), mCapacity(0)
+												{ addFrom(array); }
+											~TVArray()
+												{ removeAll(); ::free(mItems); }
+
+											// Instance methods
+				CArray::ItemCount			getCount() const
+												{ return mCount; }
+				bool						isEmpty() const
+												{ return mCount == 0; }
+				CArray::ItemCount			getCapacity() const
+												{ return mCapacity; }
+
+				TVArray<T>&					reserve(CArray::ItemCount capacity)
+												{
+													// Check if need to grow
+													if (capacity > mCapacity)
+														// Grow
+														relocate((T*) ::malloc(capacity * sizeof(T)), capacity);
+
+													return *this;
+												}
+
+				TVArray<T>&					add(const T& item)
+												{ return emplace(item); }
+				TVArray<T>&					add(T&& item)
+												{ return emplace(std::move(item)); }
+				template <typename... A>
+				TVArray<T>&					emplace(A&&... arguments)
+												{
+													// Check if need to grow
+													if (mCount == mCapacity) {
+														// Construct into the new buffer before moving the existing
+														//	items as the arguments may reference one of them
+														CArray::ItemCount	capacity = std::max<CArray::ItemCount>(
+																							mCapacity * 2, 10);
+														T*					items =
+																					(T*) ::malloc(
+																							capacity * sizeof(T));
+														new (items + mCount) T(std::forward<A>(arguments)...);
+														relocate(items, capacity);
+													} else
+														// Construct in place
+														new (mItems + mCount) T(std::forward<A>(arguments)...);
+													mCount++;
+
+													return *this;
+												}
+				TVArray<T>&					addFrom(const TVArray<T>& other)
+												{
+													// Check if adding to self
+													if (&other == this) {
+														// Copy first as our buffer may move
+														TVArray<T>	otherCopy(other);
+
+														return addFrom(otherCopy);
+													}
+
+													// Copy items
+													reserve(mCount + other.mCount);
+													for (CArray::ItemIndex i = 0; i < other.mCount; i++, mCount++)
+														// Copy
+														new (mItems + mCount) T(other.mItems[i]);
+
+													return *this;
+												}
+				TVArray<T>&					addFrom(const TArray<T>& array)
+												{
+													// Copy items
+													CArray::ItemCount	count = array.getCount();
+													reserve(mCount + count);
+													for (CArray::ItemIndex i = 0; i < count; i++, mCount++)
+														// Copy
+														new (mItems + mCount) T(array.getAt(i));
+
+													return *this;
+												}
+
+				bool						contains(const T& item) const
+												{ return getIndexOf(item).hasValue(); }
+
+				T&							getAt(CArray::ItemIndex index)
+												{ AssertFailIf(index >= mCount); return mItems[index]; }
+		const	T&							getAt(CArray::ItemIndex index) const
+												{ AssertFailIf(index >= mCount); return mItems[index]; }
+				T&							getFirst()
+												{ return getAt(0); }
+		const	T&							getFirst() const
+												{ return getAt(0); }
+				T&							getLast()
+												{ return getAt(mCount - 1); }
+		const	T&							getLast() const
+												{ return getAt(mCount - 1); }
+				OV<CArray::ItemIndex>		getIndexOf(const T& item) const
+												{
+													// Iterate all
+													for (CArray::ItemIndex i = 0; i < mCount; i++) {
+														// Check if same
+														if (mItems[i] == item)
+															// Match
+															return OV<CArray::ItemIndex>(i);
+													}
+
+													return OV<CArray::ItemIndex>();
+												}
+
+				TVArray<T>&					insertAtIndex(const T& item, CArray::ItemIndex index)
+												{
+													// Check index
+													AssertFailIf(index > mCount);
+
+													// Add to the end and rotate into place
+													emplace(item);
+													for (CArray::ItemIndex i = mCount - 1; i > index; i--)
+														// Swap
+														std::swap(mItems[i], mItems[i - 1]);
 
+													return *this;
+												}
+
+				TVArray<T>&					removeAtIndex(CArray::ItemIndex index)
+												{
+													// Check index
+													AssertFailIf(index >= mCount);
+
+													// Shift following items down
+													for (CArray::ItemIndex i = index; (i + 1) < mCount; i++)
+														// Move
+														mItems[i] = std::move(mItems[i + 1]);
+
+													// Destroy the last one
+													mItems[--mCount].~T();
+
+													return *this;
+												}
+				TVArray<T>&					removeAll()
+												{
+													// Destroy all items
+													for (CArray::ItemIndex i = 0; i < mCount; i++)
+														// Destroy
+														mItems[i].~T();
+													mCount = 0;
+
+													return *this;
+												}
+
+				TVArray<T>&					sort(CompareProc compareProc, void* userData = nil)
+												{ std::sort(mItems, mItems + mCount, SSortInfo(compareProc, userData));
+														return *this; }
+
+				T*							begin()
+												{ return mItems; }
+		const	T*							begin() const
+												{ return mItems; }
+				T*							end()
+												{ return mItems + mCount; }
+		const	T*							end() const
+												{ return mItems + mCount; }
+
+				T&							operator[] (CArray::ItemIndex index)
+												{ return getAt(index); }
+		const	T&							operator[] (CArray::ItemIndex index) const
+												{ return getAt(index); }
+				TVArray<T>&					operator=(const TVArray<T>& other)
+												{
+													// Check if assignment to self
+													if (this == &other)
+														return *this;
+
+													// Replace items
+													removeAll();
+
+													return addFrom(other);
+												}
+				TVArray<T>&					operator=(TVArray<T>&& other)
+												{
+													// Check if assignment to self
+													if (this == &other)
+														return *this;
+
+													// Take other's buffer
+													removeAll();
+													::free(mItems);
+
+													mItems = other.mItems;
+													mCount = other.mCount;
+													mCapacity = other.mCapacity;
+
+													other.mItems = nil;
+													other.mCount = 0;
+													other.mCapacity = 0;
+
+													return *this;
+												}
+				TVArray<T>&					operator+=(const T& item)
+												{ return emplace(item); }
+				TVArray<T>&					operator+=(T&& item)
+												{ return emplace(std::move(item)); }
+				TVArray<T>&					operator+=(const TVArray<T>& other)
+												{ return addFrom(other); }
+
+											operator TArray<T>() const
+												{
+													// Copy items
+													TNArray<T>	array;
+													for (CArray::ItemIndex i = 0; i < mCount; i++)
+														// Add
+														array += mItems[i];
+
+													return array;
+												}
+
+	private:
+											// Instance methods
+				void						relocate(T* items, CArray::ItemCount capacity)
+												{
+													// Move items to new buffer
+													for (CArray::ItemIndex i = 0; i < mCount; i++) {
+														// Move
+														new (items + i) T(std::move(mItems[i]));
+														mItems[i].~T();
+													}
+
+													// Update
+													::free(mItems);
+													mItems = items;
+													mCapacity = capacity;
+												}
+
+	// Types
+	private:
+		struct SSortInfo {
+					// Lifecycle methods
+					SSortInfo(CompareProc compareProc, void* userData) :
+						mCompareProc(compareProc), mUserData(userData)
+						{}
+
+					// Instance methods
+			bool	operator()(const T& item1, const T& item2) const
+						{ return mCompareProc(item1, item2, mUserData) == kCompareResultBefore; }
+
+			// Properties
+			CompareProc	mCompareProc;
+			void*		mUserData;
+		};
+
+	// Properties
 	private:
-													// Class methods
-		static	SNumberWrapper<T>*					copy(ItemRef itemRef)
-														{ return new SNumberWrapper<T>(
-																*((SNumberWrapper<T>*) itemRef)); }
-		static	void								dispose(ItemRef itemRef)
-														{
-															SNumberWrapper<T>*	numberWrapper =
-																						(SNumberWrapper<T>*) itemRef;
-															Delete(numberWrapper);
-														}
-		static	T									getValueForRawValue(SNumberWrapper<T>** rawValue)
-														{ return (*rawValue)->mValue; }
+		T*					mItems;
+		CArray::ItemCount	mCount;
+		CArray::ItemCount	mCapacity;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -575,6 +1219,9 @@ template <typename T> class TIArray : public CArray {
 				TIArray<T>&		sort(ECompareResult (proc)(const T& item1, const T& item2, void* userData),
 										void* userData = nil)
 									{ CArray::sort((CompareProc) proc, userData); return *this; }
+				template <typename C>
+				TIArray<T>&		sort(C compare)
+									{ CArray::sort(TCompareSortProcs<T, C>(compare)); return *this; }
 
 								// Instance methods
 				T&				operator[] (ItemIndex index) const
@@ -0,0 +1,375 @@
+//----------------------------------------------------------------------------------------------------------------------
+//	CBase64.cpp			©2021 Stevo Brock	All rights reserved.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "CBase64.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	#include <immintrin.h>
+	#define BASE64_SSSE3		1
+	#define BASE64_SSSE3_TARGET	__attribute__((target("ssse3")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	#include <intrin.h>
+	#define BASE64_SSSE3		1
+	#define BASE64_SSSE3_TARGET
+#endif
+
+/*
+	The SSSE3 kernels follow Wojciech Muła and Daniel Lemire, "Faster Base64 Encoding and Decoding Using AVX2
+		Instructions" (https://arxiv.org/abs/1704.00605), using their 128-bit variants.
+	Encoding reshuffles 12 input bytes into 16 6-bit indices and maps them to characters with a single pshufb of
+		per-range offsets.
+	Decoding classifies 16 characters by their high and low nibbles to find the offset for each, and validates them
+		at the same time.  Any block containing something outside the standard alphabet (whitespace, '=', URL safe
+		characters) is handed to the scalar decoder, which then resumes the vector path at the next group boundary.
+ */
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: Local data
+
+static	const	UInt8	kDecodeInvalid = 0xFF;
+static	const	UInt64	kPrettyPrintLineCharCount = 72;
+
+static	const	char*	sEncodeTable = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+struct SDecodeTable {
+			// Lifecycle methods
+			SDecodeTable()
+				{
+					// Fill in.  Accepts both the standard ("+/") and URL safe ("-_") alphabets.
+					::memset(mValues, kDecodeInvalid, sizeof(mValues));
+					for (UInt8 i = 0; i < 64; i++)
+						// Set value
+						mValues[(UInt8) sEncodeTable[i]] = i;
+					mValues['-'] = 62;
+					mValues['_'] = 63;
+				}
+
+	// Properties
+	UInt8	mValues[256];
+};
+
+const	UInt64	CBase64::kPrettyPrintLineByteCount = kPrettyPrintLineCharCount / 4 * 3;
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - Local proc declarations
+
+static	const	UInt8*	sGetDecodeTable();
+static			bool	sHaveSSSE3();
+static			UInt64	sEncode(const UInt8* bytes, UInt64 byteCount, char* chars);
+static			UInt64	sDecode(const char* chars, UInt64 charCount, UInt8* bytes, bool isFinal,
+								UInt64& usedCharCount);
+
+#if BASE64_SSSE3
+static			UInt64	sEncodeSSSE3(const UInt8* bytes, UInt64 byteCount, char* chars) BASE64_SSSE3_TARGET;
+static			UInt64	sDecodeSSSE3(const char* chars, UInt64 charCount, UInt8* bytes) BASE64_SSSE3_TARGET;
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CBase64
+
+// MARK: Class methods
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 CBase64::getEncodedCharCount(UInt64 byteCount, bool prettyPrint)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	UInt64	charCount = (byteCount + 2) / 3 * 4;	// 3 byte blocks to 4 characters
+
+	return prettyPrint ? charCount + (charCount + kPrettyPrintLineCharCount - 1) / kPrettyPrintLineCharCount :
+			charCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 CBase64::encode(const void* bytes, UInt64 byteCount, char* chars, bool prettyPrint)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check pretty print
+	if (!prettyPrint)
+		// Encode all
+		return sEncode((const UInt8*) bytes, byteCount, chars);
+
+	// Encode by line
+	const	UInt8*	bytePtr = (const UInt8*) bytes;
+			char*	charPtr = chars;
+	while (byteCount > 0) {
+		// Encode line
+		UInt64	lineByteCount = std::min<UInt64>(byteCount, kPrettyPrintLineByteCount);
+		charPtr += sEncode(bytePtr, lineByteCount, charPtr);
+		*charPtr++ = '\n';
+
+		// Update
+		bytePtr += lineByteCount;
+		byteCount -= lineByteCount;
+	}
+
+	return charPtr - chars;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 CBase64::decode(const char* chars, UInt64 charCount, void* bytes)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Decode
+	UInt64	usedCharCount;
+
+	return sDecode(chars, charCount, (UInt8*) bytes, true, usedCharCount);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 CBase64::decode(const char* chars, UInt64 charCount, void* bytes, UInt64& usedCharCount)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return sDecode(chars, charCount, (UInt8*) bytes, false, usedCharCount);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - Local proc definitions
+
+//----------------------------------------------------------------------------------------------------------------------
+const UInt8* sGetDecodeTable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	static	SDecodeTable	sDecodeTable;
+
+	return sDecodeTable.mValues;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool sHaveSSSE3()
+//----------------------------------------------------------------------------------------------------------------------
+{
+#if BASE64_SSSE3
+	#if defined(_MSC_VER)
+		// Query CPUID leaf 1, ECX bit 9
+		static	bool	sHaveSSSE3 = []() { int info[4]; __cpuid(info, 1); return (info[2] & (1 << 9)) != 0; }();
+	#else
+		static	bool	sHaveSSSE3 = __builtin_cpu_supports("ssse3");
+	#endif
+
+	return sHaveSSSE3;
+#else
+	return false;
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 sEncode(const UInt8* bytes, UInt64 byteCount, char* chars)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	const	UInt8*	bytePtr = bytes;
+	const	UInt8*	endBytePtr = bytes + byteCount;
+			char*	charPtr = chars;
+
+#if BASE64_SSSE3
+	// Check for vector support
+	if (sHaveSSSE3()) {
+		// Encode all but the tail
+		UInt64	vectorByteCount = sEncodeSSSE3(bytePtr, byteCount, charPtr);
+		bytePtr += vectorByteCount;
+		charPtr += vectorByteCount / 3 * 4;
+	}
+#endif
+
+	// Encode 3 bytes at a time
+	while ((endBytePtr - bytePtr) >= 3) {
+		// Convert the next 3 bytes to 4 characters
+		UInt32	value = (bytePtr[0] << 16) | (bytePtr[1] << 8) | bytePtr[2];
+		*charPtr++ = sEncodeTable[value >> 18];
+		*charPtr++ = sEncodeTable[(value >> 12) & 0x3F];
+		*charPtr++ = sEncodeTable[(value >> 6) & 0x3F];
+		*charPtr++ = sEncodeTable[value & 0x3F];
+
+		// Update
+		bytePtr += 3;
+	}
+
+	// Check for last 1 or 2 bytes
+	if ((endBytePtr - bytePtr) == 1) {
+		// Convert last byte
+		*charPtr++ = sEncodeTable[bytePtr[0] >> 2];
+		*charPtr++ = sEncodeTable[(bytePtr[0] & 0x03) << 4];
+		*charPtr++ = '=';
+		*charPtr++ = '=';
+	} else if ((endBytePtr - bytePtr) == 2) {
+		// Convert last 2 bytes
+		*charPtr++ = sEncodeTable[bytePtr[0] >> 2];
+		*charPtr++ = sEncodeTable[((bytePtr[0] & 0x03) << 4) | (bytePtr[1] >> 4)];
+		*charPtr++ = sEncodeTable[(bytePtr[1] & 0x0F) << 2];
+		*charPtr++ = '=';
+	}
+
+	return charPtr - chars;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 sDecode(const char* chars, UInt64 charCount, UInt8* bytes, bool isFinal, UInt64& usedCharCount)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	const	UInt8*	table = sGetDecodeTable();
+	const	char*	charPtr = chars;
+	const	char*	endCharPtr = chars + charCount;
+	const	char*	groupEndCharPtr = chars;
+	const	char*	scalarUntilCharPtr = chars;
+			UInt8*	bytePtr = bytes;
+			UInt32	value = 0;
+			UInt32	valueCharCount = 0;
+#if BASE64_SSSE3
+			bool	haveSSSE3 = sHaveSSSE3();
+#endif
+
+	// Decode
+	while (charPtr < endCharPtr) {
+#if BASE64_SSSE3
+		// Try vector blocks when on a group boundary
+		if (haveSSSE3 && (valueCharCount == 0) && (charPtr >= scalarUntilCharPtr) && ((endCharPtr - charPtr) >= 16)) {
+			// Decode 16 characters to 12 bytes at a time
+			UInt64	vectorCharCount = sDecodeSSSE3(charPtr, endCharPtr - charPtr, bytePtr);
+			charPtr += vectorCharCount;
+			bytePtr += vectorCharCount / 4 * 3;
+			groupEndCharPtr = charPtr;
+
+			// Stopped at a block with something outside the standard alphabet, so handle it with scalar code
+			scalarUntilCharPtr = charPtr + 16;
+			if (vectorCharCount > 0)
+				continue;
+		}
+#endif
+
+		// Check character
+		UInt8	charValue = table[(UInt8) *charPtr];
+		if (charValue == kDecodeInvalid) {
+			// Check for padding
+			if (*charPtr == '=') {
+				// Done
+				isFinal = true;
+				break;
+			}
+
+			// Skip
+			charPtr++;
+			continue;
+		}
+
+		// Accumulate
+		value = (value << 6) | charValue;
+		charPtr++;
+		if (++valueCharCount == 4) {
+			// Output 3 bytes
+			*bytePtr++ = (UInt8) (value >> 16);
+			*bytePtr++ = (UInt8) (value >> 8);
+			*bytePtr++ = (UInt8) value;
+
+			// Update
+			value = 0;
+			valueCharCount = 0;
+			groupEndCharPtr = charPtr;
+		}
+	}
+
+	// Check if final
+	if (isFinal) {
+		// Output remaining bytes
+		if (valueCharCount == 2)
+			// 1 byte
+			*bytePtr++ = (UInt8) (value >> 4);
+		else if (valueCharCount == 3) {
+			// 2 bytes
+			*bytePtr++ = (UInt8) (value >> 10);
+			*bytePtr++ = (UInt8) (value >> 2);
+		}
+		usedCharCount = charCount;
+	} else
+		// Leave the partial group for the next call
+		usedCharCount = groupEndCharPtr - chars;
+
+	return bytePtr - bytes;
+}
+
+#if BASE64_SSSE3
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 sEncodeSSSE3(const UInt8* bytes, UInt64 byteCount, char* chars)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	const	__m128i	shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+	const	__m128i	shiftTable =
+							_mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+									'0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+	// Each step reads 16 bytes but only consumes 12
+	UInt64	usedByteCount = 0;
+	for (; (byteCount - usedByteCount) >= 16; usedByteCount += 12, bytes += 12, chars += 16) {
+		// Spread 12 bytes into 16 6-bit indices
+		__m128i	input = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) bytes), shuffle);
+		__m128i	high = _mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+		__m128i	low = _mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+		__m128i	indexes = _mm_or_si128(high, low);
+
+		// Map to characters by adding the offset for the range each index falls in
+		__m128i	ranges = _mm_subs_epu8(indexes, _mm_set1_epi8(51));
+		__m128i	isLetter = _mm_cmpgt_epi8(_mm_set1_epi8(26), indexes);
+		ranges = _mm_or_si128(ranges, _mm_and_si128(isLetter, _mm_set1_epi8(13)));
+		_mm_storeu_si128((__m128i*) chars, _mm_add_epi8(_mm_shuffle_epi8(shiftTable, ranges), indexes));
+	}
+
+	return usedByteCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 sDecodeSSSE3(const char* chars, UInt64 charCount, UInt8* bytes)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	const	__m128i	shiftTable = _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const	__m128i	maskTable =
+							_mm_setr_epi8((char) 0xA8, (char) 0xF8, (char) 0xF8, (char) 0xF8, (char) 0xF8,
+									(char) 0xF8, (char) 0xF8, (char) 0xF8, (char) 0xF8, (char) 0xF8, (char) 0xF0, 0x54,
+									0x50, 0x50, 0x50, 0x54);
+	const	__m128i	bitTable =
+							_mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char) 0x80, 0, 0, 0, 0, 0, 0, 0,
+									0);
+	const	__m128i	packShuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+	// Iterate blocks
+	UInt64	usedCharCount = 0;
+	for (; (charCount - usedCharCount) >= 16; usedCharCount += 16, chars += 16, bytes += 12) {
+		// Classify
+		__m128i	input = _mm_loadu_si128((const __m128i*) chars);
+		__m128i	highNibbles = _mm_and_si128(_mm_srli_epi32(input, 4), _mm_set1_epi8(0x0F));
+		__m128i	lowNibbles = _mm_and_si128(input, _mm_set1_epi8(0x0F));
+		__m128i	invalid =
+						_mm_cmpeq_epi8(
+								_mm_and_si128(_mm_shuffle_epi8(maskTable, lowNibbles),
+										_mm_shuffle_epi8(bitTable, highNibbles)),
+								_mm_setzero_si128());
+		if (_mm_movemask_epi8(invalid) != 0)
+			// Not all in the alphabet
+			break;
+
+		// Convert to 6-bit values ('/' shares a high nibble with '+' but needs a different offset)
+		__m128i	isSlash = _mm_cmpeq_epi8(input, _mm_set1_epi8('/'));
+		__m128i	shift =
+						_mm_or_si128(_mm_andnot_si128(isSlash, _mm_shuffle_epi8(shiftTable, highNibbles)),
+								_mm_and_si128(isSlash, _mm_set1_epi8(16)));
+		__m128i	values = _mm_add_epi8(input, shift);
+
+		// Pack 4 6-bit values into 3 bytes
+		__m128i	packed = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+		packed = _mm_shuffle_epi8(_mm_madd_epi16(packed, _mm_set1_epi32(0x00011000)), packShuffle);
+
+		// Store 12 bytes
+		_mm_storel_epi64((__m128i*) bytes, packed);
+		UInt32	last = (UInt32) _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+		::memcpy(bytes + 8, &last, sizeof(UInt32));
+	}
+
+	return usedCharCount;
+}
+#endif
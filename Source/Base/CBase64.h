@@ -0,0 +1,34 @@
+//----------------------------------------------------------------------------------------------------------------------
+//	CBase64.h			©2021 Stevo Brock	All rights reserved.
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "PlatformDefinitions.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: CBase64
+//	Base64 conversion on raw buffers.  Encoding and decoding use SSSE3 kernels when the processor supports them
+//		(checked at runtime) and fall back to scalar code otherwise.
+//	Pretty printed output has a newline after every 72 characters and after the final partial line.
+//	Decoding accepts the standard and URL safe alphabets, ignores characters outside the alphabet (such as
+//		whitespace) and stops at the first '='.  The variant taking usedCharCount is for decoding in chunks: it only
+//		decodes complete 4 character groups (unless '=' is found) and reports how far it got, so the remainder can be
+//		passed in again at the front of the next chunk.
+
+class CBase64 {
+	// Methods
+	public:
+						// Class methods
+		static	UInt64	getEncodedCharCount(UInt64 byteCount, bool prettyPrint = false);
+		static	UInt64	encode(const void* bytes, UInt64 byteCount, char* chars, bool prettyPrint = false);
+
+		static	UInt64	getDecodedByteCountMax(UInt64 charCount)
+							{ return (charCount + 3) / 4 * 3; }
+		static	UInt64	decode(const char* chars, UInt64 charCount, void* bytes);
+		static	UInt64	decode(const char* chars, UInt64 charCount, void* bytes, UInt64& usedCharCount);
+
+	// Properties
+	public:
+		static	const	UInt64	kPrettyPrintLineByteCount;
+};
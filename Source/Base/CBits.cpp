@@ -4,58 +4,386 @@
 
 #include "CBits.h"
 
-#include "TReferenceTracking.h"
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define BITS_SSE2	1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#include <arm_neon.h>
+	#define BITS_NEON	1
+#endif
 
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: Local data
+
+static	const	UInt32	kWordsPerRankBlock = 8;
+
+//----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
-// MARK: CBitsInternals
+// MARK: - Local proc declarations
+
+static	UInt32	sPopCount(UInt64 word);
+static	UInt32	sCountTrailingZeros(UInt64 word);
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - Combine operations
+
+struct SBitsAnd {
+#if defined(BITS_SSE2)
+	static	__m128i		combine(__m128i a, __m128i b)
+							{ return _mm_and_si128(a, b); }
+#elif defined(BITS_NEON)
+	static	uint64x2_t	combine(uint64x2_t a, uint64x2_t b)
+							{ return vandq_u64(a, b); }
+#endif
+	static	UInt64		combine(UInt64 a, UInt64 b)
+							{ return a & b; }
+};
+
+struct SBitsOr {
+#if defined(BITS_SSE2)
+	static	__m128i		combine(__m128i a, __m128i b)
+							{ return _mm_or_si128(a, b); }
+#elif defined(BITS_NEON)
+	static	uint64x2_t	combine(uint64x2_t a, uint64x2_t b)
+							{ return vorrq_u64(a, b); }
+#endif
+	static	UInt64		combine(UInt64 a, UInt64 b)
+							{ return a | b; }
+};
+
+struct SBitsXor {
+#if defined(BITS_SSE2)
+	static	__m128i		combine(__m128i a, __m128i b)
+							{ return _mm_xor_si128(a, b); }
+#elif defined(BITS_NEON)
+	static	uint64x2_t	combine(uint64x2_t a, uint64x2_t b)
+							{ return veorq_u64(a, b); }
+#endif
+	static	UInt64		combine(UInt64 a, UInt64 b)
+							{ return a ^ b; }
+};
+
+struct SBitsAndNot {
+#if defined(BITS_SSE2)
+	static	__m128i		combine(__m128i a, __m128i b)
+							{ return _mm_andnot_si128(b, a); }
+#elif defined(BITS_NEON)
+	static	uint64x2_t	combine(uint64x2_t a, uint64x2_t b)
+							{ return vbicq_u64(a, b); }
+#endif
+	static	UInt64		combine(UInt64 a, UInt64 b)
+							{ return a & ~b; }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename O> static void sCombine(UInt64* words, const UInt64* otherWords, UInt32 wordCount)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	UInt32	index = 0;
+
+#if defined(BITS_SSE2)
+	// 2 words at a time
+	for (; (index + 2) <= wordCount; index += 2)
+		// Combine
+		_mm_storeu_si128((__m128i*) (words + index),
+				O::combine(_mm_loadu_si128((const __m128i*) (words + index)),
+						_mm_loadu_si128((const __m128i*) (otherWords + index))));
+#elif defined(BITS_NEON)
+	// 2 words at a time
+	for (; (index + 2) <= wordCount; index += 2)
+		// Combine
+		vst1q_u64(words + index, O::combine(vld1q_u64(words + index), vld1q_u64(otherWords + index)));
+#endif
+
+	// Remaining words
+	for (; index < wordCount; index++)
+		// Combine
+		words[index] = O::combine(words[index], otherWords[index]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CBitsInternals
 
 class CBitsInternals : public TCopyOnWriteReferenceCountable<CBitsInternals> {
 	public:
-				CBitsInternals(UInt32 count) :
-					TCopyOnWriteReferenceCountable(), mUsed(count)
-					{
-						// Setup
-						UInt32	bytes = (count + 7) / 8;
-						mAvailable = bytes * 8;
-						mStorage = (UInt8*) ::calloc(bytes, 1);
-					}
-				CBitsInternals(const CBitsInternals& other) :
-					TCopyOnWriteReferenceCountable(), mAvailable(other.mAvailable), mUsed(other.mUsed)
-					{
-						// Copy storage
-						mStorage = (UInt8*) ::malloc(mAvailable / 8);
-						::memcpy(mStorage, other.mStorage, mAvailable / 8);
-					}
-				~CBitsInternals()
-					{
-						free(mStorage);
-					}
-
-		void	set(UInt32 index, bool value)
-					{
-						// Update storage if necessary
-						if (index >= mAvailable) {
-							// Resize
-							UInt32	bytes = (index + 8) / 8;
-							mAvailable = bytes * 8;
-							mStorage = (UInt8*) ::realloc(mStorage, bytes);
-						}
-
-						// Setup
-						UInt32	byteIndex = index / 8;
-						UInt32	bitIndex = index % 8;
-
-						if (value)
-							// Set
-							mStorage[byteIndex] |= 1 << bitIndex;
-						else
-							// Clear
-							mStorage[byteIndex] &= ~(1 << bitIndex);
-					}
-
-		UInt8*	mStorage;
-		UInt32	mAvailable;
-		UInt32	mUsed;
+					CBitsInternals(UInt32 count) :
+						TCopyOnWriteReferenceCountable(),
+								mWordCount(std::max<UInt32>((UInt32) (((UInt64) count + 63) / 64), 1)), mCount(count),
+								mRankCounts(nil)
+						{
+							// Setup
+							mWords = (UInt64*) ::calloc(mWordCount, sizeof(UInt64));
+						}
+					CBitsInternals(const CBitsInternals& other) :
+						TCopyOnWriteReferenceCountable(), mWordCount(other.mWordCount), mCount(other.mCount),
+								mRankCounts(nil)
+						{
+							// Copy storage
+							mWords = (UInt64*) ::malloc(mWordCount * sizeof(UInt64));
+							::memcpy(mWords, other.mWords, mWordCount * sizeof(UInt64));
+						}
+					~CBitsInternals()
+						{
+							// Cleanup
+							::free(mWords);
+							::free(mRankCounts);
+						}
+
+		void		setCount(UInt32 count)
+						{
+							// Check if need more words
+							UInt32	wordCount = (UInt32) (((UInt64) count + 63) / 64);
+							if (wordCount > mWordCount) {
+								// Grow
+								UInt32	newWordCount = std::max<UInt32>(wordCount, mWordCount * 2);
+								mWords = (UInt64*) ::realloc(mWords, newWordCount * sizeof(UInt64));
+								::memset(mWords + mWordCount, 0, (newWordCount - mWordCount) * sizeof(UInt64));
+								mWordCount = newWordCount;
+							}
+
+							// Update count
+							mCount = std::max<UInt32>(mCount, count);
+						}
+		void		set(UInt32 index, bool value)
+						{
+							// Update storage if necessary
+							if (index >= mCount)
+								// Extend
+								setCount(index + 1);
+
+							// Update
+							if (value)
+								// Set
+								mWords[index / 64] |= 1ULL << (index % 64);
+							else
+								// Clear
+								mWords[index / 64] &= ~(1ULL << (index % 64));
+							discardRankIndex();
+						}
+		void		setRange(UInt32 startIndex, UInt32 count, bool value)
+						{
+							// Check count
+							if (count == 0)
+								// Nothing to do
+								return;
+
+							// Update storage if necessary
+							if ((startIndex + count) > mCount)
+								// Extend
+								setCount(startIndex + count);
+
+							// Setup
+							UInt32	startWordIndex = startIndex / 64;
+							UInt32	endWordIndex = (startIndex + count - 1) / 64;
+							UInt64	startMask = ~0ULL << (startIndex % 64);
+							UInt64	endMask = ~0ULL >> (63 - ((startIndex + count - 1) % 64));
+
+							// Check if all in a single word
+							if (startWordIndex == endWordIndex)
+								// Update word
+								updateWord(startWordIndex, startMask & endMask, value);
+							else {
+								// Update first word, whole words, then last word
+								updateWord(startWordIndex, startMask, value);
+								::memset(mWords + startWordIndex + 1, value ? 0xFF : 0x00,
+										(endWordIndex - startWordIndex - 1) * sizeof(UInt64));
+								updateWord(endWordIndex, endMask, value);
+							}
+							discardRankIndex();
+						}
+		void		updateWord(UInt32 wordIndex, UInt64 mask, bool value)
+						{
+							// Update
+							if (value)
+								// Set
+								mWords[wordIndex] |= mask;
+							else
+								// Clear
+								mWords[wordIndex] &= ~mask;
+						}
+
+		UInt32		getSetCount() const
+						{
+							// Count all words
+							UInt32	count = 0;
+							for (UInt32 i = 0; i < mWordCount; i++)
+								// Count this word
+								count += sPopCount(mWords[i]);
+
+							return count;
+						}
+		OV<UInt32>	getNext(UInt32 startIndex, bool value) const
+						{
+							// Check start index
+							if (startIndex >= mCount)
+								// Past the end
+								return OV<UInt32>();
+
+							// Setup
+							UInt64	flipMask = value ? 0 : ~0ULL;
+							UInt32	wordIndex = startIndex / 64;
+							UInt32	endWordIndex = (mCount + 63) / 64;
+
+							// Scan words, flipping them when looking for a clear bit
+							UInt64	word = (mWords[wordIndex] ^ flipMask) & (~0ULL << (startIndex % 64));
+							while (word == 0) {
+								// Next word
+								if (++wordIndex == endWordIndex)
+									// Not found
+									return OV<UInt32>();
+								word = mWords[wordIndex] ^ flipMask;
+							}
+
+							// Found.  When looking for a clear bit, the padding past the end will look clear.
+							UInt32	index = wordIndex * 64 + sCountTrailingZeros(word);
+
+							return (index < mCount) ? OV<UInt32>(index) : OV<UInt32>();
+						}
+
+		void		combineAnd(const CBitsInternals& other)
+						{
+							// Combine common words and clear the rest
+							UInt32	wordCount = std::min<UInt32>(mWordCount, other.mWordCount);
+							sCombine<SBitsAnd>(mWords, other.mWords, wordCount);
+							::memset(mWords + wordCount, 0, (mWordCount - wordCount) * sizeof(UInt64));
+							discardRankIndex();
+						}
+		void		combineAndNot(const CBitsInternals& other)
+						{
+							// Combine common words
+							sCombine<SBitsAndNot>(mWords, other.mWords, std::min<UInt32>(mWordCount, other.mWordCount));
+							discardRankIndex();
+						}
+		void		combineOr(const CBitsInternals& other)
+						{
+							// Combine
+							setCount(other.mCount);
+							sCombine<SBitsOr>(mWords, other.mWords, std::min<UInt32>(mWordCount, other.mWordCount));
+							discardRankIndex();
+						}
+		void		combineXor(const CBitsInternals& other)
+						{
+							// Combine
+							setCount(other.mCount);
+							sCombine<SBitsXor>(mWords, other.mWords, std::min<UInt32>(mWordCount, other.mWordCount));
+							discardRankIndex();
+						}
+
+		void		buildRankIndex()
+						{
+							// Setup
+							mRankCounts = (UInt32*) ::realloc(mRankCounts, getRankBlockCount() * sizeof(UInt32));
+
+							// Store the number of set bits before each block.  There is always a block starting at
+							//	mWordCount so getRank() can be called with mCount.
+							UInt32	count = 0;
+							for (UInt32 i = 0; i <= mWordCount; i++) {
+								// Check for block start
+								if ((i % kWordsPerRankBlock) == 0)
+									// Store
+									mRankCounts[i / kWordsPerRankBlock] = count;
+
+								// Count this word
+								if (i < mWordCount)
+									count += sPopCount(mWords[i]);
+							}
+						}
+		void		discardRankIndex()
+						{
+							// Check if have index
+							if (mRankCounts != nil) {
+								// Discard
+								::free(mRankCounts);
+								mRankCounts = nil;
+							}
+						}
+		UInt32		getRankBlockCount() const
+						{ return mWordCount / kWordsPerRankBlock + 1; }
+		UInt32		getRank(UInt32 index) const
+						{
+							// Setup
+							index = std::min<UInt32>(index, mCount);
+							UInt32	wordIndex = index / 64;
+							UInt32	count = 0;
+							UInt32	i = 0;
+
+							// Check if have index
+							if (mRankCounts != nil) {
+								// Start from the block containing this index
+								count = mRankCounts[wordIndex / kWordsPerRankBlock];
+								i = wordIndex / kWordsPerRankBlock * kWordsPerRankBlock;
+							}
+
+							// Count whole words
+							for (; i < wordIndex; i++)
+								// Count this word
+								count += sPopCount(mWords[i]);
+
+							// Count the bits before the index in its word
+							if ((index % 64) != 0)
+								// Count partial word
+								count += sPopCount(mWords[wordIndex] & ((1ULL << (index % 64)) - 1));
+
+							return count;
+						}
+		OV<UInt32>	getSelect(UInt32 rank) const
+						{
+							// Setup
+							UInt32	wordIndex = 0;
+
+							// Check if have index
+							if (mRankCounts != nil) {
+								// Find the last block starting with at most rank set bits before it
+								UInt32	low = 0;
+								UInt32	high = getRankBlockCount();
+								while ((high - low) > 1) {
+									// Check middle
+									UInt32	middle = (low + high) / 2;
+									if (mRankCounts[middle] <= rank)
+										// Look higher
+										low = middle;
+									else
+										// Look lower
+										high = middle;
+								}
+
+								// Start from that block
+								wordIndex = low * kWordsPerRankBlock;
+								rank -= mRankCounts[low];
+							}
+
+							// Scan words
+							for (; wordIndex < mWordCount; wordIndex++) {
+								// Check if in this word
+								UInt64	word = mWords[wordIndex];
+								UInt32	count = sPopCount(word);
+								if (rank < count) {
+									// Drop the lower set bits
+									for (; rank > 0; rank--)
+										// Drop lowest set bit
+										word &= word - 1;
+
+									return OV<UInt32>(wordIndex * 64 + sCountTrailingZeros(word));
+								}
+
+								// Next word
+								rank -= count;
+							}
+
+							return OV<UInt32>();
+						}
+
+		UInt64*		mWords;
+		UInt32		mWordCount;
+		UInt32		mCount;
+		UInt32*		mRankCounts;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -91,22 +419,186 @@ CBits::~CBits()
 UInt32 CBits::getCount() const
 //----------------------------------------------------------------------------------------------------------------------
 {
-	return mInternals->mUsed;
+	return mInternals->mCount;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 bool CBits::get(UInt32 index) const
 //----------------------------------------------------------------------------------------------------------------------
 {
-	UInt32	byteIndex = index / 8;
-	UInt32	bitIndex = index % 8;
-
-	return mInternals->mStorage[byteIndex] & (1 << bitIndex);
+	return (index < mInternals->mCount) && ((mInternals->mWords[index / 64] & (1ULL << (index % 64))) != 0);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void CBits::set(UInt32 index, bool value)
 //----------------------------------------------------------------------------------------------------------------------
 {
+	// Prepare for write
+	mInternals = mInternals->prepareForWrite();
+
+	// Set
 	mInternals->set(index, value);
 }
+
+//----------------------------------------------------------------------------------------------------------------------
+void CBits::setRange(UInt32 startIndex, UInt32 count, bool value)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Prepare for write
+	mInternals = mInternals->prepareForWrite();
+
+	// Set
+	mInternals->setRange(startIndex, count, value);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt32 CBits::getSetCount() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mInternals->getSetCount();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+OV<UInt32> CBits::getNextSet(UInt32 startIndex) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mInternals->getNext(startIndex, true);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+OV<UInt32> CBits::getNextClear(UInt32 startIndex) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mInternals->getNext(startIndex, false);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CBits::buildRankIndex()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Prepare for write
+	mInternals = mInternals->prepareForWrite();
+
+	// Build
+	mInternals->buildRankIndex();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt32 CBits::getRank(UInt32 index) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mInternals->getRank(index);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+OV<UInt32> CBits::getSelect(UInt32 rank) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mInternals->getSelect(rank);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CBits& CBits::andNot(const CBits& other)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Prepare for write
+	mInternals = mInternals->prepareForWrite();
+
+	// Combine
+	mInternals->combineAndNot(*other.mInternals);
+
+	return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CBits& CBits::operator=(const CBits& other)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if assignment to self
+	if (this == &other)
+		return *this;
+
+	// Remove reference to ourselves
+	mInternals->removeReference();
+
+	// Add reference to other
+	mInternals = other.mInternals->addReference();
+
+	return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CBits& CBits::operator&=(const CBits& other)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Prepare for write
+	mInternals = mInternals->prepareForWrite();
+
+	// Combine
+	mInternals->combineAnd(*other.mInternals);
+
+	return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CBits& CBits::operator|=(const CBits& other)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Prepare for write
+	mInternals = mInternals->prepareForWrite();
+
+	// Combine
+	mInternals->combineOr(*other.mInternals);
+
+	return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CBits& CBits::operator^=(const CBits& other)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Prepare for write
+	mInternals = mInternals->prepareForWrite();
+
+	// Combine
+	mInternals->combineXor(*other.mInternals);
+
+	return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - Local proc definitions
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt32 sPopCount(UInt64 word)
+//----------------------------------------------------------------------------------------------------------------------
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return (UInt32) __builtin_popcountll(word);
+#else
+	// Count bits in parallel
+	word = word - ((word >> 1) & 0x5555555555555555ULL);
+	word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+
+	return (UInt32) ((((word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL) * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt32 sCountTrailingZeros(UInt64 word)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// word must not be 0
+#if defined(__GNUC__) || defined(__clang__)
+	return (UInt32) __builtin_ctzll(word);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+	unsigned	long	index;
+	_BitScanForward64(&index, word);
+
+	return (UInt32) index;
+#else
+	// Count the bits below the lowest set bit
+	return sPopCount((word & (0 - word)) - 1);
+#endif
+}
@@ -4,26 +4,52 @@
 
 #pragma once
 
-#include "PlatformDefinitions.h"
+#include "TWrappers.h"
 
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: CBits
+//	Bits are stored in 64-bit words and searches, counts and bulk operations work a word (or a vector of words) at a
+//		time.  Setting a bit past the end extends the count.
+//	buildRankIndex() adds a cumulative count every 512 bits so getRank() only has to count at most 8 more words.  The
+//		index is discarded by any change and getRank() falls back to counting from the start.
 
 class CBitsInternals;
 class CBits {
 	// Methods
 	public:
-				// Lifecycle methods
-				CBits(UInt32 count = 8);
-				CBits(const CBits& other);
-				~CBits();
-
-				// Instance methods
-		UInt32	getCount() const;
-		bool	get(UInt32 index) const;
-		void	set(UInt32 index, bool value = true);
-		void	clear(UInt32 index)
-					{ set(index, false); }
+					// Lifecycle methods
+					CBits(UInt32 count = 8);
+					CBits(const CBits& other);
+					~CBits();
+
+					// Instance methods
+		UInt32		getCount() const;
+		bool		get(UInt32 index) const;
+		void		set(UInt32 index, bool value = true);
+		void		clear(UInt32 index)
+						{ set(index, false); }
+		void		setRange(UInt32 startIndex, UInt32 count, bool value = true);
+		void		clearRange(UInt32 startIndex, UInt32 count)
+						{ setRange(startIndex, count, false); }
+
+		UInt32		getSetCount() const;
+		OV<UInt32>	getFirstSet() const
+						{ return getNextSet(0); }
+		OV<UInt32>	getFirstClear() const
+						{ return getNextClear(0); }
+		OV<UInt32>	getNextSet(UInt32 startIndex) const;
+		OV<UInt32>	getNextClear(UInt32 startIndex) const;
+
+		void		buildRankIndex();
+		UInt32		getRank(UInt32 index) const;
+		OV<UInt32>	getSelect(UInt32 rank) const;
+
+		CBits&		andNot(const CBits& other);
+
+		CBits&		operator=(const CBits& other);
+		CBits&		operator&=(const CBits& other);
+		CBits&		operator|=(const CBits& other);
+		CBits&		operator^=(const CBits& other);
 
 	// Properties
 	private:
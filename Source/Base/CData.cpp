@@ -4,12 +4,15 @@
 
 #include "CData.h"
 
+#include "CBase64.h"
 #include "CppToolboxAssert.h"
 #include "TBuffer.h"
 
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: Local data
 
+static	const	CData::Size	kMinimumGrowCapacity = 64;
+
 CData	CData::mEmpty;
 CData	CData::mZeroByte("", 1, false);
 
@@ -17,11 +20,12 @@ CData	CData::mZeroByte("", 1, false);
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - CDataInternals
 
-class CDataInternals : public TCopyOnWriteReferenceCountable<CDataInternals> {
+class CDataInternals : public TAtomicCopyOnWriteReferenceCountable<CDataInternals> {
 	public:
 						CDataInternals(CData::Size initialSize, const void* initialBuffer = nil,
 								bool copySourceData = true) :
-							TCopyOnWriteReferenceCountable(), mFreeOnDelete(copySourceData), mBufferSize(initialSize)
+							TAtomicCopyOnWriteReferenceCountable(), mFreeOnDelete(copySourceData),
+									mBufferSize(initialSize), mBufferCapacity(initialSize), mParentInternals(nil)
 							{
 								// Check for initial buffer
 								if (initialBuffer != nil) {
@@ -44,21 +48,48 @@ class CDataInternals : public TCopyOnWriteReferenceCountable<CDataInternals> {
 									mBuffer = nil;
 							}
 						CDataInternals(const CDataInternals& other) :
-							TCopyOnWriteReferenceCountable(), mFreeOnDelete(true),
+							TAtomicCopyOnWriteReferenceCountable(), mFreeOnDelete(true),
 									mBuffer((other.mBufferSize > 0) ? ::malloc(other.mBufferSize) : nil),
-									mBufferSize(other.mBufferSize)
+									mBufferSize(other.mBufferSize), mBufferCapacity(other.mBufferSize),
+									mParentInternals(nil)
 							{
 								// Do we have any data
 								if (mBufferSize > 0)
 									// Copy data
 									::memcpy(mBuffer, other.mBuffer, mBufferSize);
 							}
+						CDataInternals(CDataInternals& parentInternals, CData::ByteIndex startByte,
+								CData::Size size) :
+							TAtomicCopyOnWriteReferenceCountable(), mFreeOnDelete(false),
+									mBuffer((UInt8*) parentInternals.mBuffer + startByte), mBufferSize(size),
+									mBufferCapacity(size),
+									mParentInternals(
+											(parentInternals.mParentInternals != nil) ?
+													parentInternals.mParentInternals->addReference() :
+													parentInternals.addReference())
+							{}
 						~CDataInternals()
 							{
 								// Cleanup
 								if (mFreeOnDelete)
 									// Free!
 									::free(mBuffer);
+								if (mParentInternals != nil)
+									// Release parent
+									mParentInternals->removeReference();
+							}
+
+		CDataInternals*	prepareForModify()
+							{
+								// Prepare for write
+								CDataInternals*	dataInternals = prepareForWrite();
+
+								// Views share their parent's bytes so must move to their own buffer first
+								if (dataInternals->mParentInternals != nil)
+									// Move
+									dataInternals->setCapacity(dataInternals->mBufferSize);
+
+								return dataInternals;
 							}
 
 		CDataInternals*	setSize(CData::Size size)
@@ -66,16 +97,98 @@ class CDataInternals : public TCopyOnWriteReferenceCountable<CDataInternals> {
 								// Prepare for write
 								CDataInternals*	dataInternals = prepareForWrite();
 
+								// Check if need to grow
+								if (size > dataInternals->mBufferCapacity) {
+									// Grow geometrically so a run of appends only copies the existing bytes a
+									//	logarithmic number of times
+									CData::Size	capacity =
+														dataInternals->mBufferCapacity +
+																dataInternals->mBufferCapacity / 2;
+									dataInternals->setCapacity(
+											std::max<CData::Size>(std::max<CData::Size>(capacity, size),
+													kMinimumGrowCapacity));
+								} else if (dataInternals->mParentInternals != nil)
+									// Views share their parent's bytes so must move to their own buffer first
+									dataInternals->setCapacity(size);
+
 								// Update size
 								dataInternals->mBufferSize = size;
-								dataInternals->mBuffer = ::realloc(dataInternals->mBuffer, dataInternals->mBufferSize);
 
 								return dataInternals;
 							}
+		CDataInternals*	reserve(CData::Size capacity)
+							{
+								// Check if need to grow
+								if (capacity <= mBufferCapacity)
+									// Have enough already
+									return this;
+
+								// Prepare for write
+								CDataInternals*	dataInternals = prepareForWrite();
+
+								// Check if need to grow (copy may have trimmed capacity)
+								if (capacity > dataInternals->mBufferCapacity)
+									// Grow
+									dataInternals->setCapacity(capacity);
+
+								return dataInternals;
+							}
+		CDataInternals*	shrinkToFit()
+							{
+								// Check if anything to do
+								if (!mFreeOnDelete || (mBufferCapacity == mBufferSize))
+									// Nothing to do
+									return this;
+
+								// Prepare for write
+								CDataInternals*	dataInternals = prepareForWrite();
+
+								// Check if still need to shrink (copy will already be exact)
+								if (dataInternals->mBufferCapacity > dataInternals->mBufferSize)
+									// Shrink
+									dataInternals->setCapacity(dataInternals->mBufferSize);
+
+								return dataInternals;
+							}
+		void			setCapacity(CData::Size capacity)
+							{
+								// Check if we own the buffer
+								if (mFreeOnDelete) {
+									// Resize
+									if (capacity > 0)
+										// Reallocate
+										mBuffer = ::realloc(mBuffer, capacity);
+									else {
+										// Free
+										::free(mBuffer);
+										mBuffer = nil;
+									}
+								} else {
+									// Move to our own buffer
+									void*	buffer = (capacity > 0) ? ::malloc(capacity) : nil;
+									if (mBufferSize > 0)
+										// Copy
+										::memcpy(buffer, mBuffer, std::min<CData::Size>(mBufferSize, capacity));
+									mBuffer = buffer;
+									mFreeOnDelete = true;
+
+									// Check for parent
+									if (mParentInternals != nil) {
+										// No longer a view
+										mParentInternals->removeReference();
+										mParentInternals = nil;
+									}
+								}
+
+								// Update
+								mBufferCapacity = capacity;
+							}
 
-		bool		mFreeOnDelete;
-		void*		mBuffer;
-		CData::Size	mBufferSize;
+		bool			mFreeOnDelete;
+		void*			mBuffer;
+		CData::Size		mBufferSize;
+		CData::Size		mBufferCapacity;
+		CDataInternals*	mParentInternals;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -112,21 +225,9 @@ CData::CData(const void* buffer, Size bufferSize, bool copySourceData)
 CData::CData(const CString& base64String)
 //----------------------------------------------------------------------------------------------------------------------
 {
-	// From https://stackoverflow.com/questions/180947/base64-decode-snippet-in-c/13935718
-	static	const	UInt8	sMap[256] =
-									{
-										0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-										0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-										0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  62, 63, 62, 62, 63,
-										52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 0,  0,  0,  0,  0,  0,
-										0,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14,
-										15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 0,  0,  0,  0,  63,
-										0,  26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
-										41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51,
-									};
-
 	// Setup
-	CString::Length	stringLength = base64String.getLength();
+	CString::C	cString = base64String.getCString(CString::kEncodingUTF8);
+	Size		stringLength = ::strlen(*cString);
 	if (stringLength == 0) {
 		// No string
 		mInternals = CData::mEmpty.mInternals->addReference();
@@ -134,38 +235,9 @@ CData::CData(const CString& base64String)
 		return;
 	}
 
-			CString::C		cString = base64String.getCString();
-	const	char*			stringPtr = *cString;
-			bool			pad1 = ((stringLength % 4) != 0) || (stringPtr[stringLength - 1] == '=');
-			bool			pad2 = pad1 && (((stringLength % 4) > 2) || (stringPtr[stringLength - 2] != '='));
-			CString::Length	last = (stringLength - (pad1 ? 1 : 0)) / 4 << 2;
-
-	// Setup internals
-	Size	dataSize = last / 4 * 3 + (pad1 ? 1 : 0) + (pad2 ? 1 : 0);
-	mInternals = new CDataInternals(dataSize);
-
-	// Convert
-	UInt8*	dataPtr = (UInt8*) mInternals->mBuffer;
-	for (UInt32 i = 0; i < last; i += 4) {
-		// Convert these 4 characters to 3 bytes
-		UInt32	bytes =
-						(sMap[stringPtr[i]] << 18) | (sMap[stringPtr[i + 1]] << 12) | (sMap[stringPtr[i + 2]] << 6) |
-								sMap[stringPtr[i + 3]];
-		*dataPtr++ = bytes >> 16;
-		*dataPtr++ = bytes >> 8 & 0xFF;
-		*dataPtr++ = bytes & 0xFF;
-	}
-
-	if (pad1) {
-		// Have extra bytes
-		UInt32	bytes = (sMap[stringPtr[last]] << 18) | (sMap[stringPtr[last + 1]] << 12);
-		*dataPtr++ = bytes >> 16;
-		if (pad2) {
-			// One more byte
-			bytes |= sMap[stringPtr[last + 2]] << 6;
-			*dataPtr++ = bytes >> 8 & 0xFF;
-		}
-	}
+	// Decode
+	mInternals = new CDataInternals(CBase64::getDecodedByteCountMax(stringLength));
+	mInternals->mBufferSize = CBase64::decode(*cString, stringLength, mInternals->mBuffer);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -184,6 +256,14 @@ CData::CData(UInt8 value)
 	mInternals = new CDataInternals(sizeof(UInt8), &value);
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+CData::CData(CDataInternals* internals)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	mInternals = internals;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 CData::~CData()
 //----------------------------------------------------------------------------------------------------------------------
@@ -217,6 +297,29 @@ void CData::increaseSizeBy(Size size)
 	mInternals = mInternals->setSize(mInternals->mBufferSize + size);
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+CData::Size CData::getCapacity() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mInternals->mBufferCapacity;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CData::reserve(Size capacity)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Reserve
+	mInternals = mInternals->reserve(capacity);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CData::shrinkToFit()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Shrink
+	mInternals = mInternals->shrinkToFit();
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 const void* CData::getBytePtr() const
 //----------------------------------------------------------------------------------------------------------------------
@@ -229,7 +332,7 @@ void* CData::getMutableBytePtr()
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Prepare for write
-	mInternals = mInternals->prepareForWrite();
+	mInternals = mInternals->prepareForModify();
 
 	return mInternals->mBuffer;
 }
@@ -254,6 +357,26 @@ void CData::copyBytes(void* destinationBuffer, ByteIndex startByte, OV<Size> cou
 	::memcpy(destinationBuffer, (UInt8*) mInternals->mBuffer + startByte, byteCount);
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+CData CData::getSubData(ByteIndex startByte, OV<Size> count) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	Size	byteCount = count.hasValue() ? count.getValue() : getSize() - startByte;
+
+	// Parameter check
+	AssertFailIf((startByte + byteCount) > getSize());
+	if ((startByte + byteCount) > getSize())
+		return CData::mEmpty;
+
+	// Check for all the data
+	if ((startByte == 0) && (byteCount == getSize()))
+		// Same
+		return *this;
+
+	return CData(new CDataInternals(*mInternals, startByte, byteCount));
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 void CData::appendBytes(const void* buffer, Size bufferSize)
 //----------------------------------------------------------------------------------------------------------------------
@@ -292,7 +415,7 @@ void CData::replaceBytes(ByteIndex startByte, Size byteCount, const void* buffer
 	Size	resultSize = mInternals->mBufferSize - byteCount + bufferSize;
 	if (resultSize == mInternals->mBufferSize) {
 		// Overall size is staying the same
-		mInternals = mInternals->prepareForWrite();
+		mInternals = mInternals->prepareForModify();
 		::memcpy((UInt8*) mInternals->mBuffer + startByte, buffer, bufferSize);
 	} else if (resultSize > mInternals->mBufferSize) {
 		// Overall size is increasing
@@ -308,6 +431,7 @@ void CData::replaceBytes(ByteIndex startByte, Size byteCount, const void* buffer
 		// [0...startByte] stays the same
 		// [startByte...startByte+byteCount] becomes [startByte...startByte+bufferSize]
 		// [startByte+byteCount...end] stays the same
+		mInternals = mInternals->prepareForModify();
 		::memmove((UInt8*) mInternals->mBuffer + startByte + bufferSize,
 				(UInt8*) mInternals->mBuffer + startByte + byteCount, resultSize - startByte - bufferSize);
 		::memcpy((UInt8*) mInternals->mBuffer + startByte, buffer, bufferSize);
@@ -319,67 +443,16 @@ void CData::replaceBytes(ByteIndex startByte, Size byteCount, const void* buffer
 CString CData::getBase64String(bool prettyPrint) const
 //----------------------------------------------------------------------------------------------------------------------
 {
-	// From http://web.mit.edu/freebsd/head/contrib/wpa/src/utils/base64.c
-	static	const	char*	sTable = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
 	// Setup
-	Size			dataLength = mInternals->mBufferSize;
-	CString::Length	stringLength = (CString::Length) (dataLength + 2) / 3 * 4;	// 3 byte blocks to 4 characters
-	if (prettyPrint)
-		// Add for newlines
-		stringLength += (stringLength + 71) / 72; // line feeds
-	if (stringLength < dataLength)
+	CString::Length	stringLength =
+							(CString::Length) CBase64::getEncodedCharCount(mInternals->mBufferSize, prettyPrint);
+	if (stringLength < mInternals->mBufferSize)
 		// Integer overflow
 		return CString::mEmpty;
 
 	// Convert
-	const	UInt8*			bytePtr = (UInt8*) mInternals->mBuffer;
-	const	UInt8*			endBytePtr = bytePtr + mInternals->mBufferSize;
-
-			TBuffer<char>	stringBuffer(stringLength);
-			char*			stringPtr = *stringBuffer;
-
-			CString::Length	currentLineLength = 0;
-	while ((endBytePtr - bytePtr) >= 3) {
-		// Convert the next 3 bytes to 4 characters
-		*stringPtr++ = sTable[bytePtr[0] >> 2];
-		*stringPtr++ = sTable[((bytePtr[0] & 0x03) << 4) | (bytePtr[1] >> 4)];
-		*stringPtr++ = sTable[((bytePtr[1] & 0x0f) << 2) | (bytePtr[2] >> 6)];
-		*stringPtr++ = sTable[bytePtr[2] & 0x3f];
-
-		// Update
-		bytePtr += 3;
-		currentLineLength += 4;
-		if (prettyPrint && (currentLineLength >= 72)) {
-			// Add newline
-			*stringPtr++ = '\n';
-			currentLineLength = 0;
-		}
-	}
-
-	if ((endBytePtr - bytePtr) > 0) {
-		// Convert last 1 or 2 bytes
-		*stringPtr++ = sTable[bytePtr[0] >> 2];
-		if (endBytePtr - bytePtr == 1) {
-			// Convert last 1 byte
-			*stringPtr++ = sTable[(bytePtr[0] & 0x03) << 4];
-			*stringPtr++ = '=';
-			*stringPtr++ = '=';
-		} else {
-			// Convert last 2 bytes
-			*stringPtr++ = sTable[((bytePtr[0] & 0x03) << 4) |
-			(bytePtr[1] >> 4)];
-			*stringPtr++ = sTable[(bytePtr[1] & 0x0f) << 2];
-			*stringPtr++ = '=';
-		}
-
-		// Update
-		currentLineLength += 4;
-	}
-
-	if (prettyPrint && (currentLineLength > 0))
-		// Add newline
-		*stringPtr++ = '\n';
+	TBuffer<char>	stringBuffer(stringLength);
+	CBase64::encode(mInternals->mBuffer, mInternals->mBufferSize, *stringBuffer, prettyPrint);
 
 	return CString(*stringBuffer, stringLength, CString::kEncodingUTF8);
 }
@@ -422,3 +495,61 @@ CData CData::operator+(const CData& other) const
 
 	return data;
 }
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CDataBuilder
+
+// MARK: Lifecycle methods
+
+//----------------------------------------------------------------------------------------------------------------------
+CDataBuilder::CDataBuilder(CData::Size initialCapacity)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	mData.reserve(initialCapacity);
+}
+
+// MARK: Instance methods
+
+//----------------------------------------------------------------------------------------------------------------------
+void* CDataBuilder::getWritableBytePtr(CData::Size byteCount)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	CData::Size	size = mData.getSize();
+
+	// Make sure we have our own buffer first since a copy made while shared only has room for the current size
+	mData.getMutableBytePtr();
+
+	// Make sure there is room
+	if ((size + byteCount) > mData.getCapacity())
+		// Grow geometrically
+		mData.reserve(std::max<CData::Size>(size + byteCount, mData.getCapacity() * 2));
+
+	return (UInt8*) mData.getMutableBytePtr() + size;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CDataBuilder::commitBytes(CData::Size byteCount)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Parameter check
+	AssertFailIf((mData.getSize() + byteCount) > mData.getCapacity());
+
+	// Update size (within capacity, so no copy)
+	mData.increaseSizeBy(byteCount);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CDataBuilder::append(const CString& string, CString::Encoding encoding)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	CString::Length	byteCount = string.getLength(encoding);
+	if (byteCount == 0)
+		return;
+
+	// Convert directly into our storage
+	commitBytes(string.get((char*) getWritableBytePtr(byteCount), byteCount, false, encoding));
+}
@@ -33,15 +33,22 @@ class CData {
 				void	increaseSizeBy(Size size);
 				bool	isEmpty() const
 							{ return getSize() == 0; }
+				Size	getCapacity() const;
+				void	reserve(Size capacity);
+				void	shrinkToFit();
 
 		const	void*	getBytePtr() const;
 				void*	getMutableBytePtr();
 				void	copyBytes(void* destinationBuffer, ByteIndex startByte = 0, OV<Size> count = OV<Size>()) const;
+				CData	getSubData(ByteIndex startByte, OV<Size> count = OV<Size>()) const;
 				void	appendBytes(const void* buffer, Size bufferSize);
 				void	replaceBytes(ByteIndex startByte, Size byteCount, const void* buffer, Size bufferSize);
 
 				CString	getBase64String(bool prettyPrint = false) const;
 
+				void	hashInto(CHasher& hasher) const
+							{ hasher.add(getBytePtr(), getSize()); }
+
 				CData&	operator=(const CData& other);
 				bool	operator==(const CData& other) const;
 				bool	operator!=(const CData& other) const
@@ -50,6 +57,10 @@ class CData {
 				CData&	operator+=(const CData& other)
 							{ appendBytes(other.getBytePtr(), other.getSize()); return *this; }
 
+	private:
+						// Lifecycle methods
+						CData(CDataInternals* internals);
+
 	// Properties
 	public:
 		static	CData			mEmpty;
@@ -58,3 +69,34 @@ class CData {
 	private:
 				CDataInternals*	mInternals;
 };
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CDataBuilder
+//	Accumulates bytes for serializers.  Callers can ask for a writable region at the end, fill it in place, and then
+//		commit however many bytes were actually written, avoiding intermediate buffers.
+
+class CDataBuilder {
+	// Methods
+	public:
+								// Lifecycle methods
+								CDataBuilder(CData::Size initialCapacity = 0);
+
+								// Instance methods
+				CData::Size		getSize() const
+									{ return mData.getSize(); }
+
+				void*			getWritableBytePtr(CData::Size byteCount);
+				void			commitBytes(CData::Size byteCount);
+
+				void			appendBytes(const void* buffer, CData::Size bufferSize)
+									{ mData.appendBytes(buffer, bufferSize); }
+				void			append(const CString& string, CString::Encoding encoding = CString::kEncodingUTF8);
+
+		const	CData&			getData() const
+									{ return mData; }
+
+	// Properties
+	private:
+		CData	mData;
+};
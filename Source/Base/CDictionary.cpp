@@ -10,13 +10,13 @@
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: TDictionaryInternals
 
-template <typename T> class TDictionaryInternals : public TCopyOnWriteReferenceCountable<T> {
+template <typename T> class TDictionaryInternals : public TAtomicCopyOnWriteReferenceCountable<T> {
 	// Methods
 	public:
 												// Lifecycle methods
-												TDictionaryInternals() : TCopyOnWriteReferenceCountable<T>() {}
+												TDictionaryInternals() : TAtomicCopyOnWriteReferenceCountable<T>() {}
 												TDictionaryInternals(const TDictionaryInternals& other) :
-													TCopyOnWriteReferenceCountable<T>()
+													TAtomicCopyOnWriteReferenceCountable<T>()
 													{}
 		virtual									~TDictionaryInternals() {}
 
@@ -29,8 +29,11 @@ template <typename T> class TDictionaryInternals : public TCopyOnWriteReferenceC
 		virtual	CDictionaryInternals*			removeAll() = 0;
 
 		virtual	TIteratorS<CDictionary::Item>	getIterator() const = 0;
+		virtual	const	CDictionary::ItemInfo*	getItemInfos(UInt32& itemInfosCount) const = 0;
 
 		virtual	SValue::OpaqueEqualsProc		getOpaqueEqualsProc() const = 0;
+
+		virtual	void							noteShared() {}
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -39,63 +42,41 @@ template <typename T> class TDictionaryInternals : public TCopyOnWriteReferenceC
 
 class CDictionaryInternals : public TDictionaryInternals<CDictionaryInternals> {};
 
-//----------------------------------------------------------------------------------------------------------------------
-//----------------------------------------------------------------------------------------------------------------------
-// MARK: - SDictionaryItemInfo
-
-struct SDictionaryItemInfo {
-			// Lifecycle methods
-			SDictionaryItemInfo(UInt32 keyHashValue, const CString& key, const SValue& value) :
-				mKeyHashValue(keyHashValue), mItem(key, value), mNextItemInfo(nil)
-				{}
-			SDictionaryItemInfo(const SDictionaryItemInfo& itemInfo, SValue::OpaqueCopyProc opaqueCopyProc) :
-				mKeyHashValue(itemInfo.mKeyHashValue), mItem(itemInfo.mItem, opaqueCopyProc), mNextItemInfo(nil)
-				{}
-
-			// Instance methods
-	bool	doesMatch(UInt32 hashValue, const CString& key)
-				{ return (hashValue == mKeyHashValue) && (key == mItem.mKey); }
-	void	disposeValue(SValue::OpaqueDisposeProc opaqueDisposeProc)
-				{ mItem.mValue.dispose(opaqueDisposeProc); }
-
-	// Properties
-	UInt32					mKeyHashValue;
-	CDictionary::Item		mItem;
-	SDictionaryItemInfo*	mNextItemInfo;
-};
-
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - CStandardDictionaryInternals
 
+/*
+	Storage is an open-addressing table using Robin Hood insertion and backward-shift deletion.  Each slot caches the
+		key hash value so probing and rehashing never need to touch the item itself.  The slot count is always a power
+		of 2 and grows by 2x whenever the load would exceed 7/8.  No slots are allocated until the first item is set.
+	When built into an arena, items and slots are allocated from the arena and outgrown slots are simply abandoned.
+		Copies made on write are always on the heap.  Once the storage has been shared with another CDictionary, the
+		next write also copies to the heap (even if that other CDictionary is gone by then) as the arena is not
+		thread safe and the copy may be on another thread.
+*/
+
 class CStandardDictionaryInternals : public TDictionaryInternals<CStandardDictionaryInternals> {
 	// IteratorInfo
 	class IteratorInfo : public CIterator::Info {
 		// Methods
 		public:
 								// Lifecycle methods
-								IteratorInfo(const CStandardDictionaryInternals& internals, UInt32 initialReference) :
-									CIterator::Info(),
-											mInternals(internals), mInitialReference(initialReference),
-											mCurrentIndex(0), mCurrentItemInfo(nil)
-									{}
 								IteratorInfo(const CStandardDictionaryInternals& internals, UInt32 initialReference,
-										UInt32 currentIndex, SDictionaryItemInfo* curretItemInfo) :
+										UInt32 currentIndex = 0) :
 									CIterator::Info(),
 											mInternals(internals), mInitialReference(initialReference),
-											mCurrentIndex(currentIndex), mCurrentItemInfo(curretItemInfo)
+											mCurrentIndex(currentIndex)
 									{}
 
 								// CIterator::Info methods
 			CIterator::Info*	copy()
-									{ return new IteratorInfo(mInternals, mInitialReference, mCurrentIndex,
-											mCurrentItemInfo); }
+									{ return new IteratorInfo(mInternals, mInitialReference, mCurrentIndex); }
 
 		// Properties
 		const	CStandardDictionaryInternals&	mInternals;
 				UInt32							mInitialReference;
 				UInt32							mCurrentIndex;
-				SDictionaryItemInfo*			mCurrentItemInfo;
 	};
 
 
@@ -104,6 +85,7 @@ class CStandardDictionaryInternals : public TDictionaryInternals<CStandardDictio
 												CStandardDictionaryInternals(SValue::OpaqueCopyProc opaqueCopyProc,
 														SValue::OpaqueDisposeProc opaqueDisposeProc,
 														SValue::OpaqueEqualsProc opaqueEqualsProc);
+												CStandardDictionaryInternals(CArena& arena);
 												CStandardDictionaryInternals(const CStandardDictionaryInternals& other);
 												~CStandardDictionaryInternals();
 
@@ -119,12 +101,47 @@ class CStandardDictionaryInternals : public TDictionaryInternals<CStandardDictio
 				CDictionaryInternals*			removeAll();
 
 				TIteratorS<CDictionary::Item>	getIterator() const;
+		const	CDictionary::ItemInfo*			getItemInfos(UInt32& itemInfosCount) const;
 
 				SValue::OpaqueEqualsProc		getOpaqueEqualsProc() const;
 
+				void							noteShared()
+													{ mIsShared.store(true, std::memory_order_relaxed); }
+
 												// Private methods
+				CStandardDictionaryInternals*	prepareForWrite()
+													{
+														// Check if in arena and have been shared
+														if ((mArena != nil) &&
+																mIsShared.load(std::memory_order_relaxed)) {
+															// Stop using the arena
+															CStandardDictionaryInternals*	internals =
+																	new CStandardDictionaryInternals(*this);
+															removeReference();
+
+															return internals;
+														} else
+															// Copy on write as usual
+															return TDictionaryInternals::prepareForWrite();
+													}
+				CDictionary::Item*				newItem(const CString& key, const SValue& value)
+													{
+														return (mArena != nil) ?
+																new (mArena->allocate(sizeof(CDictionary::Item)))
+																		CDictionary::Item(key, value) :
+																new CDictionary::Item(key, value);
+													}
+				UInt32							getHomeIndex(UInt32 hashValue) const
+													{ return (hashValue * 2654435769U) >> mItemInfosShift; }
+				UInt32							getProbeDistance(UInt32 index) const
+													{ return (index - getHomeIndex(mItemInfos[index].mKeyHashValue)) &
+															(mItemInfosCount - 1); }
+				UInt32							getIndex(UInt32 hashValue, const CString& key) const;
+				void							insert(CDictionary::ItemInfo itemInfo);
+				void							dispose(CDictionary::ItemInfo& itemInfo);
+				void							removeAt(UInt32 index);
 				void							removeAllInternal();
-				void							remove(SDictionaryItemInfo* itemInfo, bool removeAll);
+				void							resize(UInt32 itemInfosCount);
 
 												// Class methods
 		static	void*							iteratorAdvance(IteratorInfo& iteratorInfo);
@@ -134,9 +151,12 @@ class CStandardDictionaryInternals : public TDictionaryInternals<CStandardDictio
 		SValue::OpaqueEqualsProc	mOpaqueEqualsProc;
 
 		CDictionary::KeyCount		mCount;
-		SDictionaryItemInfo**		mItemInfos;
+		CDictionary::ItemInfo*		mItemInfos;
 		UInt32						mItemInfosCount;
+		UInt32						mItemInfosShift;
 		UInt32						mReference;
+		CArena*						mArena;
+		std::atomic<bool>			mIsShared;
 };
 
 // MARK: Lifecycle methods
@@ -146,11 +166,20 @@ CStandardDictionaryInternals::CStandardDictionaryInternals(SValue::OpaqueCopyPro
 		SValue::OpaqueDisposeProc opaqueDisposeProc, SValue::OpaqueEqualsProc opaqueEqualsProc) :
 	TDictionaryInternals(),
 			mOpaqueCopyProc(opaqueCopyProc), mOpaqueDisposeProc(opaqueDisposeProc), mOpaqueEqualsProc(opaqueEqualsProc),
-			mCount(0), mItemInfosCount(16), mReference(0)
+			mCount(0), mItemInfos(nil), mItemInfosCount(0), mItemInfosShift(32), mReference(0), mArena(nil),
+			mIsShared(false)
+//----------------------------------------------------------------------------------------------------------------------
+{
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CStandardDictionaryInternals::CStandardDictionaryInternals(CArena& arena) :
+	TDictionaryInternals(),
+			mOpaqueCopyProc(nil), mOpaqueDisposeProc(nil), mOpaqueEqualsProc(nil),
+			mCount(0), mItemInfos(nil), mItemInfosCount(0), mItemInfosShift(32), mReference(0),
+			mArena(new (arena.allocate(sizeof(CArena))) CArena(arena)), mIsShared(false)
 //----------------------------------------------------------------------------------------------------------------------
 {
-	// Setup
-	mItemInfos = (SDictionaryItemInfo**) ::calloc(mItemInfosCount, sizeof(SDictionaryItemInfo*));
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -158,32 +187,22 @@ CStandardDictionaryInternals::CStandardDictionaryInternals(const CStandardDictio
 	TDictionaryInternals(other),
 			mOpaqueCopyProc(other.mOpaqueCopyProc), mOpaqueDisposeProc(other.mOpaqueDisposeProc),
 			mOpaqueEqualsProc(other.mOpaqueEqualsProc),
-			mCount(other.mCount), mItemInfosCount(other.mItemInfosCount), mReference(0)
-//----------------------------------------------------------------------------------------------------------------------
-{
-	// Setup
-	mItemInfos = (SDictionaryItemInfo**) ::calloc(mItemInfosCount, sizeof(SDictionaryItemInfo*));
-
-	// Copy item infos
-	for (UInt32 i = 0; i < mItemInfosCount; i++) {
-		// Setup for this linked list
-		SDictionaryItemInfo*	itemInfo = other.mItemInfos[i];
-		SDictionaryItemInfo*	dictionaryInternalsItemInfo = nil;
-
-		while (itemInfo != nil) {
-			// Check for first in the linked list
-			if (dictionaryInternalsItemInfo == nil) {
-				// First in this linked list
-				mItemInfos[i] = new SDictionaryItemInfo(*itemInfo, mOpaqueCopyProc);
-				dictionaryInternalsItemInfo = mItemInfos[i];
-			} else {
-				// Next one in this linked list
-				dictionaryInternalsItemInfo->mNextItemInfo = new SDictionaryItemInfo(*itemInfo, mOpaqueCopyProc);
-				dictionaryInternalsItemInfo = dictionaryInternalsItemInfo->mNextItemInfo;
-			}
-
-			// Next
-			itemInfo = itemInfo->mNextItemInfo;
+			mCount(other.mCount), mItemInfos(nil), mItemInfosCount(other.mItemInfosCount),
+			mItemInfosShift(other.mItemInfosShift), mReference(0), mArena(nil), mIsShared(false)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if have item infos
+	if (mItemInfosCount > 0) {
+		// Copy layout as-is so no rehashing is necessary
+		mItemInfos = (CDictionary::ItemInfo*) ::malloc(mItemInfosCount * sizeof(CDictionary::ItemInfo));
+		::memcpy(mItemInfos, other.mItemInfos, mItemInfosCount * sizeof(CDictionary::ItemInfo));
+
+		// Copy items
+		for (UInt32 i = 0; i < mItemInfosCount; i++) {
+			// Check if have item
+			if (!mItemInfos[i].isEmpty())
+				// Copy item
+				mItemInfos[i].mItem = new CDictionary::Item(*other.mItemInfos[i].mItem, mOpaqueCopyProc);
 		}
 	}
 }
@@ -195,8 +214,13 @@ CStandardDictionaryInternals::~CStandardDictionaryInternals()
 	// Remove all
 	removeAllInternal();
 
-	// Cleanup
-	::free(mItemInfos);
+	// Check if have arena
+	if (mArena != nil)
+		// Release last as it lives in its own storage
+		mArena->~CArena();
+	else
+		// Cleanup
+		::free(mItemInfos);
 }
 
 // MARK: TDictionaryInternals methods
@@ -212,17 +236,15 @@ CDictionary::KeyCount CStandardDictionaryInternals::getKeyCount()
 OR<SValue> CStandardDictionaryInternals::getValue(const CString& key)
 //----------------------------------------------------------------------------------------------------------------------
 {
-	// Setup
-	UInt32	hashValue = CHasher::getValueForHashable(key);
-	UInt32	index = hashValue & (mItemInfosCount - 1);
+	// Check if empty
+	if (mCount == 0)
+		// Nothing to find
+		return OR<SValue>();
 
 	// Find item info that matches
-	SDictionaryItemInfo*	itemInfo = mItemInfos[index];
-	while ((itemInfo != nil) && !itemInfo->doesMatch(hashValue, key))
-		// Advance to next item info
-		itemInfo = itemInfo->mNextItemInfo;
+	UInt32	index = getIndex(CHasher::getValueForHashable(key), key);
 
-	return (itemInfo != nil) ? OR<SValue>(itemInfo->mItem.mValue) : OR<SValue>();
+	return (index < mItemInfosCount) ? OR<SValue>(mItemInfos[index].mItem->mValue) : OR<SValue>();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -234,34 +256,27 @@ CDictionaryInternals* CStandardDictionaryInternals::set(const CString& key, cons
 
 	// Setup
 	UInt32	hashValue = CHasher::getValueForHashable(key);
-	UInt32	index = hashValue & (dictionaryInternals->mItemInfosCount - 1);
 
 	// Find
-	SDictionaryItemInfo*	previousItemInfo = nil;
-	SDictionaryItemInfo*	currentItemInfo = dictionaryInternals->mItemInfos[index];
-	while ((currentItemInfo != nil) && !currentItemInfo->doesMatch(hashValue, key)) {
-		// Next in linked list
-		previousItemInfo = currentItemInfo;
-		currentItemInfo = currentItemInfo->mNextItemInfo;
-	}
+	UInt32	index = dictionaryInternals->getIndex(hashValue, key);
+	if (index < dictionaryInternals->mItemInfosCount) {
+		// Did find a match
+		CDictionary::ItemInfo&	itemInfo = dictionaryInternals->mItemInfos[index];
+		itemInfo.mItem->mValue.dispose(mOpaqueDisposeProc);
+		itemInfo.mItem->mValue = value;
+	} else {
+		// Did not find.  Check if need to grow.
+		if (((dictionaryInternals->mCount + 1) * 8) > (dictionaryInternals->mItemInfosCount * 7))
+			// Grow
+			dictionaryInternals->resize(std::max<UInt32>(dictionaryInternals->mItemInfosCount * 2, 8));
 
-	// Check results
-	if (currentItemInfo == nil) {
-		// Did not find
-		if (previousItemInfo == nil)
-			// First one
-			dictionaryInternals->mItemInfos[index] = new SDictionaryItemInfo(hashValue, key, value);
-		else
-			// Add to the end
-			previousItemInfo->mNextItemInfo = new SDictionaryItemInfo(hashValue, key, value);
+		// Insert
+		CDictionary::ItemInfo	itemInfo = {hashValue, dictionaryInternals->newItem(key, value)};
+		dictionaryInternals->insert(itemInfo);
 
 		// Update info
 		dictionaryInternals->mCount++;
 		dictionaryInternals->mReference++;
-	} else {
-		// Did find a match
-		currentItemInfo->disposeValue(mOpaqueDisposeProc);
-		currentItemInfo->mItem.mValue = value;
 	}
 
 	return (CDictionaryInternals*) dictionaryInternals;
@@ -271,34 +286,19 @@ CDictionaryInternals* CStandardDictionaryInternals::set(const CString& key, cons
 CDictionaryInternals* CStandardDictionaryInternals::remove(const CString& key)
 //----------------------------------------------------------------------------------------------------------------------
 {
+	// Check if empty
+	if (mCount == 0)
+		// Nothing to remove
+		return (CDictionaryInternals*) this;
+
 	// Prepare for write
 	CStandardDictionaryInternals*	dictionaryInternals = (CStandardDictionaryInternals*) prepareForWrite();
 
-	// Setup
-	UInt32	hashValue = CHasher::getValueForHashable(key);
-	UInt32	index = hashValue & (dictionaryInternals->mItemInfosCount - 1);
-
 	// Find
-	SDictionaryItemInfo*	previousItemInfo = nil;
-	SDictionaryItemInfo*	currentItemInfo = dictionaryInternals->mItemInfos[index];
-	while ((currentItemInfo != nil) && !currentItemInfo->doesMatch(hashValue, key)) {
-		// Next in linked list
-		previousItemInfo = currentItemInfo;
-		currentItemInfo = currentItemInfo->mNextItemInfo;
-	}
-
-	// Check results
-	if (currentItemInfo != nil) {
+	UInt32	index = dictionaryInternals->getIndex(CHasher::getValueForHashable(key), key);
+	if (index < dictionaryInternals->mItemInfosCount) {
 		// Did find a match
-		if (previousItemInfo == nil)
-			// First item info
-			dictionaryInternals->mItemInfos[index] = currentItemInfo->mNextItemInfo;
-		else
-			// Not the first item info
-			previousItemInfo->mNextItemInfo = currentItemInfo->mNextItemInfo;
-
-		// Cleanup
-		remove(currentItemInfo, false);
+		dictionaryInternals->removeAt(index);
 
 		// Update info
 		dictionaryInternals->mCount--;
@@ -353,18 +353,27 @@ TIteratorS<CDictionary::Item> CStandardDictionaryInternals::getIterator() const
 	IteratorInfo*	iteratorInfo = new IteratorInfo(*this, mReference);
 
 	// Find first item info
-	while ((mItemInfos[iteratorInfo->mCurrentIndex] == nil) && (++iteratorInfo->mCurrentIndex < mItemInfosCount)) ;
+	while ((iteratorInfo->mCurrentIndex < mItemInfosCount) && mItemInfos[iteratorInfo->mCurrentIndex].isEmpty())
+		// Next
+		iteratorInfo->mCurrentIndex++;
 
-	CDictionary::Item*	firstItem = nil;
-	if (iteratorInfo->mCurrentIndex < mItemInfosCount) {
-		// Have first item info
-		iteratorInfo->mCurrentItemInfo = mItemInfos[iteratorInfo->mCurrentIndex];
-		firstItem = &mItemInfos[iteratorInfo->mCurrentIndex]->mItem;
-	}
+	CDictionary::Item*	firstItem =
+								(iteratorInfo->mCurrentIndex < mItemInfosCount) ?
+										mItemInfos[iteratorInfo->mCurrentIndex].mItem : nil;
 
 	return TIteratorS<CDictionary::Item>(firstItem, (CIterator::AdvanceProc) iteratorAdvance, *iteratorInfo);
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+const CDictionary::ItemInfo* CStandardDictionaryInternals::getItemInfos(UInt32& itemInfosCount) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	itemInfosCount = mItemInfosCount;
+
+	return mItemInfos;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 SValue::OpaqueEqualsProc CStandardDictionaryInternals::getOpaqueEqualsProc() const
 //----------------------------------------------------------------------------------------------------------------------
@@ -374,6 +383,99 @@ SValue::OpaqueEqualsProc CStandardDictionaryInternals::getOpaqueEqualsProc() con
 
 // MARK: Private methods
 
+//----------------------------------------------------------------------------------------------------------------------
+UInt32 CStandardDictionaryInternals::getIndex(UInt32 hashValue, const CString& key) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if have item infos
+	if (mItemInfosCount == 0)
+		// Nope
+		return 0;
+
+	// Probe from the home index.  Robin Hood ordering means we can stop as soon as we pass an item info that is closer
+	//	to its home index than we are to ours.
+	UInt32	mask = mItemInfosCount - 1;
+	UInt32	index = getHomeIndex(hashValue);
+	for (UInt32 distance = 0; !mItemInfos[index].isEmpty() && (distance <= getProbeDistance(index));
+			distance++, index = (index + 1) & mask) {
+		// Check this item info
+		if (mItemInfos[index].doesMatch(hashValue, key))
+			// Found
+			return index;
+	}
+
+	return mItemInfosCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CStandardDictionaryInternals::insert(CDictionary::ItemInfo itemInfo)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	UInt32	mask = mItemInfosCount - 1;
+	UInt32	index = getHomeIndex(itemInfo.mKeyHashValue);
+
+	// Probe
+	for (UInt32 distance = 0;; distance++, index = (index + 1) & mask) {
+		// Check if empty
+		if (mItemInfos[index].isEmpty()) {
+			// Store here
+			mItemInfos[index] = itemInfo;
+
+			return;
+		}
+
+		// Check if the existing item info is closer to its home index than we are to ours
+		UInt32	existingDistance = getProbeDistance(index);
+		if (existingDistance < distance) {
+			// Take this slot and continue on with the displaced item info
+			CDictionary::ItemInfo	displacedItemInfo = mItemInfos[index];
+			mItemInfos[index] = itemInfo;
+			itemInfo = displacedItemInfo;
+			distance = existingDistance;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CStandardDictionaryInternals::dispose(CDictionary::ItemInfo& itemInfo)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Dispose value
+	itemInfo.mItem->mValue.dispose(mOpaqueDisposeProc);
+
+	// Check if in arena
+	if (mArena != nil) {
+		// Storage is owned by the arena
+		itemInfo.mItem->~Item();
+		itemInfo.mItem = nil;
+	} else
+		// Delete
+		Delete(itemInfo.mItem);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CStandardDictionaryInternals::removeAt(UInt32 index)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Dispose
+	dispose(mItemInfos[index]);
+
+	// Shift following item infos back until we find an empty one or one that is already at its home index
+	UInt32	mask = mItemInfosCount - 1;
+	UInt32	nextIndex = (index + 1) & mask;
+	while (!mItemInfos[nextIndex].isEmpty() && (getProbeDistance(nextIndex) > 0)) {
+		// Shift back
+		mItemInfos[index] = mItemInfos[nextIndex];
+		index = nextIndex;
+		nextIndex = (nextIndex + 1) & mask;
+	}
+
+	// Clear
+	mItemInfos[index].mKeyHashValue = 0;
+	mItemInfos[index].mItem = nil;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 void CStandardDictionaryInternals::removeAllInternal()
 //----------------------------------------------------------------------------------------------------------------------
@@ -381,29 +483,51 @@ void CStandardDictionaryInternals::removeAllInternal()
 	// Iterate all item infos
 	for (UInt32 i = 0; i < mItemInfosCount; i++) {
 		// Check if have an item info
-		if (mItemInfos[i] != nil) {
-			// Remove this chain
-			remove(mItemInfos[i], true);
+		if (!mItemInfos[i].isEmpty()) {
+			// Dispose
+			dispose(mItemInfos[i]);
 
 			// Clear
-			mItemInfos[i] = nil;
+			mItemInfos[i].mKeyHashValue = 0;
+			mItemInfos[i].mItem = nil;
 		}
 	}
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void CStandardDictionaryInternals::remove(SDictionaryItemInfo* itemInfo, bool removeAll)
+void CStandardDictionaryInternals::resize(UInt32 itemInfosCount)
 //----------------------------------------------------------------------------------------------------------------------
 {
-	// Check for next item info
-	if (removeAll && (itemInfo->mNextItemInfo != nil))
-		// Remove the next item info
-		remove(itemInfo->mNextItemInfo, true);
-
-	// Dispose
-	itemInfo->disposeValue(mOpaqueDisposeProc);
+	// Setup
+	CDictionary::ItemInfo*	previousItemInfos = mItemInfos;
+	UInt32					previousItemInfosCount = mItemInfosCount;
+
+	// Update storage
+	if (mArena != nil) {
+		// Allocate from arena
+		mItemInfos = (CDictionary::ItemInfo*) mArena->allocate(itemInfosCount * sizeof(CDictionary::ItemInfo));
+		::memset(mItemInfos, 0, itemInfosCount * sizeof(CDictionary::ItemInfo));
+	} else
+		// Allocate
+		mItemInfos = (CDictionary::ItemInfo*) ::calloc(itemInfosCount, sizeof(CDictionary::ItemInfo));
+	mItemInfosCount = itemInfosCount;
+	mItemInfosShift = 32;
+	for (UInt32 count = itemInfosCount; count > 1; count >>= 1)
+		// Next
+		mItemInfosShift--;
+
+	// Reinsert using the cached key hash values
+	for (UInt32 i = 0; i < previousItemInfosCount; i++) {
+		// Check if have an item info
+		if (!previousItemInfos[i].isEmpty())
+			// Reinsert
+			insert(previousItemInfos[i]);
+	}
 
-	Delete(itemInfo);
+	// Check if have arena
+	if (mArena == nil)
+		// Cleanup
+		::free(previousItemInfos);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -413,25 +537,717 @@ void* CStandardDictionaryInternals::iteratorAdvance(IteratorInfo& iteratorInfo)
 	// Internals check
 	AssertFailIf(iteratorInfo.mInitialReference != iteratorInfo.mInternals.mReference);
 
-	// Check for additional item info in linked list
-	if (iteratorInfo.mCurrentItemInfo->mNextItemInfo != nil) {
-		// Have next item info
-		iteratorInfo.mCurrentItemInfo = iteratorInfo.mCurrentItemInfo->mNextItemInfo;
+	// Setup
+	const	CStandardDictionaryInternals&	internals = iteratorInfo.mInternals;
+
+	// Find next item info
+	while ((++iteratorInfo.mCurrentIndex < internals.mItemInfosCount) &&
+			internals.mItemInfos[iteratorInfo.mCurrentIndex].isEmpty()) ;
+
+	return (iteratorInfo.mCurrentIndex < internals.mItemInfosCount) ?
+			(void*) internals.mItemInfos[iteratorInfo.mCurrentIndex].mItem : nil;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - SPersistentDictionaryItem
+
+struct SPersistentDictionaryItem {
+	// Lifecycle methods
+	SPersistentDictionaryItem(UInt32 keyHashValue, const CString& key, const SValue& value) :
+		mReferenceCount(1), mKeyHashValue(keyHashValue), mItem(key, value)
+		{}
+
+	// Properties
+	std::atomic<UInt32>	mReferenceCount;
+	UInt32				mKeyHashValue;
+	CDictionary::Item	mItem;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - SPersistentDictionaryNode
+
+struct SPersistentDictionaryNode;
+struct SPersistentDictionarySlot {
+	// Properties
+	SPersistentDictionaryItem*	mItem;	// nil when this slot refers to a child node
+	SPersistentDictionaryNode*	mNode;
+};
+
+struct alignas(void*) SPersistentDictionaryNode {
+										// Lifecycle methods
+										SPersistentDictionaryNode(UInt32 bitmap, UInt32 slotCount) :
+											mReferenceCount(1), mBitmap(bitmap), mSlotCount(slotCount)
+											{}
+
+										// Instance methods
+			SPersistentDictionarySlot*	getSlots()
+											{ return (SPersistentDictionarySlot*) (this + 1); }
+			UInt32						getSlotIndex(UInt32 bit) const
+											{
+												// Count the bits below this one
+												UInt32	bits = mBitmap & (bit - 1);
+												bits = bits - ((bits >> 1) & 0x55555555);
+												bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+
+												return (((bits + (bits >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+											}
+
+										// Class methods
+	static	SPersistentDictionaryNode*	create(UInt32 bitmap, UInt32 slotCount)
+											{
+												return new (::malloc(sizeof(SPersistentDictionaryNode) +
+																slotCount * sizeof(SPersistentDictionarySlot)))
+														SPersistentDictionaryNode(bitmap, slotCount);
+											}
+	static	void						free(SPersistentDictionaryNode* node)
+											{ node->~SPersistentDictionaryNode(); ::free(node); }
+	static	UInt32						getBit(UInt32 hashValue, UInt32 shift)
+											{ return 1 << ((hashValue >> shift) & 0x1F); }
+
+	// Properties
+	std::atomic<UInt32>	mReferenceCount;
+	UInt32				mBitmap;
+	UInt32				mSlotCount;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CPersistentDictionaryInternals
+
+/*
+	Storage is a hash array mapped trie.  Each node consumes 5 bits of the key hash value and stores a bitmap of which
+		of its 32 possible slots are in use followed by only the slots that are in use.  A slot is either an item or a
+		child node.  Keys whose hash values are identical end up together in a collision node below the last level,
+		which is searched linearly.
+	Nodes and items are reference counted and shared between copies, so a copy made on write only retains the root
+		node.  A write then copies just the nodes along the path to the key being changed (and only those that are
+		still shared); everything else continues to be shared with the other copies.  Items are never copied, so the
+		opaque copy proc is never needed.
+*/
+
+class CPersistentDictionaryInternals : public TDictionaryInternals<CPersistentDictionaryInternals> {
+	// IteratorInfo
+	class IteratorInfo : public CIterator::Info {
+		// Methods
+		public:
+								// Lifecycle methods
+								IteratorInfo(const CPersistentDictionaryInternals& internals,
+										UInt32 initialReference) :
+									CIterator::Info(),
+											mInternals(internals), mInitialReference(initialReference), mDepth(0)
+									{}
+
+								// CIterator::Info methods
+			CIterator::Info*	copy()
+									{
+										// Setup
+										IteratorInfo*	iteratorInfo = new IteratorInfo(mInternals, mInitialReference);
+										iteratorInfo->mDepth = mDepth;
+										::memcpy(iteratorInfo->mNodes, mNodes, sizeof(mNodes));
+										::memcpy(iteratorInfo->mSlotIndexes, mSlotIndexes, sizeof(mSlotIndexes));
+
+										return iteratorInfo;
+									}
+
+								// Instance methods
+			CDictionary::Item*	getNextItem()
+									{
+										// Walk the nodes depth first
+										while (mDepth > 0) {
+											// Check if have more slots in this node
+											SPersistentDictionaryNode*	node = mNodes[mDepth - 1];
+											UInt32&						slotIndex = mSlotIndexes[mDepth - 1];
+											if (slotIndex == node->mSlotCount) {
+												// Back up
+												mDepth--;
+												continue;
+											}
+
+											// Check slot
+											SPersistentDictionarySlot&	slot = node->getSlots()[slotIndex++];
+											if (slot.mItem != nil)
+												// Found item
+												return &slot.mItem->mItem;
+
+											// Descend
+											mNodes[mDepth] = slot.mNode;
+											mSlotIndexes[mDepth] = 0;
+											mDepth++;
+										}
+
+										return nil;
+									}
+
+		// Properties
+		const	CPersistentDictionaryInternals&	mInternals;
+				UInt32							mInitialReference;
+				UInt32							mDepth;
+				SPersistentDictionaryNode*		mNodes[8];
+				UInt32							mSlotIndexes[8];
+	};
+
+	public:
+												// Lifecycle methods
+												CPersistentDictionaryInternals(
+														SValue::OpaqueDisposeProc opaqueDisposeProc,
+														SValue::OpaqueEqualsProc opaqueEqualsProc);
+												CPersistentDictionaryInternals(
+														const CPersistentDictionaryInternals& other);
+												~CPersistentDictionaryInternals();
+
+												// TDictionaryInternals methods
+				CDictionary::KeyCount			getKeyCount();
+				OR<SValue>						getValue(const CString& key);
+				CDictionaryInternals*			set(const CString& key, const SValue& value);
+				CDictionaryInternals*			remove(const CString& key);
+				CDictionaryInternals*			remove(const TSet<CString>& keys);
+				CDictionaryInternals*			removeAll();
+
+				TIteratorS<CDictionary::Item>	getIterator() const;
+		const	CDictionary::ItemInfo*			getItemInfos(UInt32& itemInfosCount) const;
+
+				SValue::OpaqueEqualsProc		getOpaqueEqualsProc() const;
+
+												// Private methods
+				SPersistentDictionaryItem*		find(UInt32 hashValue, const CString& key) const;
+				bool							set(SPersistentDictionaryNode*& node, UInt32 shift,
+														UInt32 hashValue, const CString& key, const SValue& value);
+				void							remove(SPersistentDictionaryNode*& node, UInt32 shift,
+														UInt32 hashValue, const CString& key);
+				SPersistentDictionaryNode*		getEditableNode(SPersistentDictionaryNode* node);
+				void							replaceValue(SPersistentDictionaryItem*& item, const SValue& value);
+				void							release(SPersistentDictionaryNode* node);
+				void							release(SPersistentDictionaryItem* item);
+
+												// Class methods
+		static	SPersistentDictionaryNode*		newNode(SPersistentDictionaryItem* item1,
+														SPersistentDictionaryItem* item2, UInt32 shift);
+		static	SPersistentDictionaryNode*		insertSlot(SPersistentDictionaryNode* node, UInt32 slotIndex,
+														UInt32 bit, SPersistentDictionaryItem* item);
+		static	SPersistentDictionaryNode*		removeSlot(SPersistentDictionaryNode* node, UInt32 slotIndex,
+														UInt32 bit);
+		static	void*							iteratorAdvance(IteratorInfo& iteratorInfo);
+
+		SValue::OpaqueDisposeProc	mOpaqueDisposeProc;
+		SValue::OpaqueEqualsProc	mOpaqueEqualsProc;
+
+		CDictionary::KeyCount		mCount;
+		SPersistentDictionaryNode*	mRootNode;
+		UInt32						mReference;
+};
+
+// MARK: Lifecycle methods
+
+//----------------------------------------------------------------------------------------------------------------------
+CPersistentDictionaryInternals::CPersistentDictionaryInternals(SValue::OpaqueDisposeProc opaqueDisposeProc,
+		SValue::OpaqueEqualsProc opaqueEqualsProc) :
+	TDictionaryInternals(),
+			mOpaqueDisposeProc(opaqueDisposeProc), mOpaqueEqualsProc(opaqueEqualsProc), mCount(0), mRootNode(nil),
+			mReference(0)
+//----------------------------------------------------------------------------------------------------------------------
+{
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CPersistentDictionaryInternals::CPersistentDictionaryInternals(const CPersistentDictionaryInternals& other) :
+	TDictionaryInternals(other),
+			mOpaqueDisposeProc(other.mOpaqueDisposeProc), mOpaqueEqualsProc(other.mOpaqueEqualsProc),
+			mCount(other.mCount), mRootNode(other.mRootNode), mReference(0)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Share root node
+	if (mRootNode != nil)
+		// Add reference
+		mRootNode->mReferenceCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CPersistentDictionaryInternals::~CPersistentDictionaryInternals()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if have root node
+	if (mRootNode != nil)
+		// Release
+		release(mRootNode);
+}
+
+// MARK: TDictionaryInternals methods
+
+//----------------------------------------------------------------------------------------------------------------------
+CDictionary::KeyCount CPersistentDictionaryInternals::getKeyCount()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mCount;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+OR<SValue> CPersistentDictionaryInternals::getValue(const CString& key)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Find item
+	SPersistentDictionaryItem*	item = find(CHasher::getValueForHashable(key), key);
+
+	return (item != nil) ? OR<SValue>(item->mItem.mValue) : OR<SValue>();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CDictionaryInternals* CPersistentDictionaryInternals::set(const CString& key, const SValue& value)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Prepare for write
+	CPersistentDictionaryInternals*	dictionaryInternals = (CPersistentDictionaryInternals*) prepareForWrite();
+
+	// Set
+	if (dictionaryInternals->set(dictionaryInternals->mRootNode, 0, CHasher::getValueForHashable(key), key, value)) {
+		// Added
+		dictionaryInternals->mCount++;
+		dictionaryInternals->mReference++;
+	}
+
+	return (CDictionaryInternals*) dictionaryInternals;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CDictionaryInternals* CPersistentDictionaryInternals::remove(const CString& key)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if have key.  This is done before preparing for write so nothing gets copied when there is nothing to
+	//	remove.
+	UInt32	hashValue = CHasher::getValueForHashable(key);
+	if (find(hashValue, key) == nil)
+		// Nothing to remove
+		return (CDictionaryInternals*) this;
+
+	// Prepare for write
+	CPersistentDictionaryInternals*	dictionaryInternals = (CPersistentDictionaryInternals*) prepareForWrite();
+
+	// Remove
+	dictionaryInternals->remove(dictionaryInternals->mRootNode, 0, hashValue, key);
+
+	// Update info
+	dictionaryInternals->mCount--;
+	dictionaryInternals->mReference++;
+
+	return (CDictionaryInternals*) dictionaryInternals;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CDictionaryInternals* CPersistentDictionaryInternals::remove(const TSet<CString>& keys)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	CDictionaryInternals*	dictionaryInternals = (CDictionaryInternals*) this;
+
+	// Iterate keys
+	for (TIteratorS<CString> iterator = keys.getIterator(); iterator.hasValue(); iterator.advance())
+		// Remove this key
+		dictionaryInternals = dictionaryInternals->remove(*iterator);
+
+	return dictionaryInternals;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CDictionaryInternals* CPersistentDictionaryInternals::removeAll()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if empty
+	if (mCount == 0)
+		// Nothing to remove
+		return (CDictionaryInternals*) this;
+
+	// Prepare for write
+	CPersistentDictionaryInternals*	dictionaryInternals = (CPersistentDictionaryInternals*) prepareForWrite();
+
+	// Remove all
+	dictionaryInternals->release(dictionaryInternals->mRootNode);
+
+	// Update info
+	dictionaryInternals->mRootNode = nil;
+	dictionaryInternals->mCount = 0;
+	dictionaryInternals->mReference++;
+
+	return (CDictionaryInternals*) dictionaryInternals;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+TIteratorS<CDictionary::Item> CPersistentDictionaryInternals::getIterator() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	IteratorInfo*	iteratorInfo = new IteratorInfo(*this, mReference);
+	if (mRootNode != nil) {
+		// Start at the root node
+		iteratorInfo->mNodes[0] = mRootNode;
+		iteratorInfo->mSlotIndexes[0] = 0;
+		iteratorInfo->mDepth = 1;
+	}
+
+	return TIteratorS<CDictionary::Item>(iteratorInfo->getNextItem(), (CIterator::AdvanceProc) iteratorAdvance,
+			*iteratorInfo);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const CDictionary::ItemInfo* CPersistentDictionaryInternals::getItemInfos(UInt32& itemInfosCount) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Items are spread across nodes
+	itemInfosCount = 0;
+
+	return nil;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+SValue::OpaqueEqualsProc CPersistentDictionaryInternals::getOpaqueEqualsProc() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mOpaqueEqualsProc;
+}
+
+// MARK: Private methods
+
+//----------------------------------------------------------------------------------------------------------------------
+SPersistentDictionaryItem* CPersistentDictionaryInternals::find(UInt32 hashValue, const CString& key) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Walk down from the root node
+	SPersistentDictionaryNode*	node = mRootNode;
+	for (UInt32 shift = 0; node != nil; shift += 5) {
+		// Check if past the end of the hash value
+		if (shift >= 32) {
+			// Collision node
+			for (UInt32 i = 0; i < node->mSlotCount; i++) {
+				// Check this item
+				if (node->getSlots()[i].mItem->mItem.mKey == key)
+					// Found
+					return node->getSlots()[i].mItem;
+			}
+
+			return nil;
+		}
+
+		// Check bitmap
+		UInt32	bit = SPersistentDictionaryNode::getBit(hashValue, shift);
+		if ((node->mBitmap & bit) == 0)
+			// Not found
+			return nil;
+
+		// Check slot
+		SPersistentDictionarySlot&	slot = node->getSlots()[node->getSlotIndex(bit)];
+		if (slot.mItem != nil)
+			// Item
+			return ((slot.mItem->mKeyHashValue == hashValue) && (slot.mItem->mItem.mKey == key)) ? slot.mItem : nil;
+
+		// Descend
+		node = slot.mNode;
+	}
+
+	return nil;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool CPersistentDictionaryInternals::set(SPersistentDictionaryNode*& node, UInt32 shift, UInt32 hashValue,
+		const CString& key, const SValue& value)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if have node
+	if (node == nil) {
+		// Start with just this item
+		node = SPersistentDictionaryNode::create(SPersistentDictionaryNode::getBit(hashValue, shift), 1);
+		node->getSlots()[0].mItem = new SPersistentDictionaryItem(hashValue, key, value);
+		node->getSlots()[0].mNode = nil;
+
+		return true;
+	}
+
+	// Get editable node
+	node = getEditableNode(node);
+
+	// Check if past the end of the hash value
+	if (shift >= 32) {
+		// Collision node
+		for (UInt32 i = 0; i < node->mSlotCount; i++) {
+			// Check this item
+			SPersistentDictionaryItem*&	item = node->getSlots()[i].mItem;
+			if (item->mItem.mKey == key) {
+				// Found
+				replaceValue(item, value);
+
+				return false;
+			}
+		}
+
+		// Add
+		node =
+				insertSlot(node, node->mSlotCount, 0,
+						new SPersistentDictionaryItem(hashValue, key, value));
+
+		return true;
+	}
+
+	// Check bitmap
+	UInt32	bit = SPersistentDictionaryNode::getBit(hashValue, shift);
+	UInt32	slotIndex = node->getSlotIndex(bit);
+	if ((node->mBitmap & bit) == 0) {
+		// Add
+		node = insertSlot(node, slotIndex, bit, new SPersistentDictionaryItem(hashValue, key, value));
+
+		return true;
+	}
+
+	// Check slot
+	SPersistentDictionarySlot&	slot = node->getSlots()[slotIndex];
+	if (slot.mNode != nil)
+		// Descend
+		return set(slot.mNode, shift + 5, hashValue, key, value);
+	else if ((slot.mItem->mKeyHashValue == hashValue) && (slot.mItem->mItem.mKey == key)) {
+		// Found
+		replaceValue(slot.mItem, value);
+
+		return false;
+	} else {
+		// Push the existing item down into a new node along with this one
+		slot.mNode = newNode(slot.mItem, new SPersistentDictionaryItem(hashValue, key, value), shift + 5);
+		slot.mItem = nil;
+
+		return true;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CPersistentDictionaryInternals::remove(SPersistentDictionaryNode*& node, UInt32 shift, UInt32 hashValue,
+		const CString& key)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Get editable node
+	node = getEditableNode(node);
+
+	// Check if past the end of the hash value
+	if (shift >= 32) {
+		// Collision node
+		for (UInt32 i = 0; i < node->mSlotCount; i++) {
+			// Check this item
+			SPersistentDictionaryItem*	item = node->getSlots()[i].mItem;
+			if (item->mItem.mKey == key) {
+				// Found
+				release(item);
+				node = removeSlot(node, i, 0);
+
+				return;
+			}
+		}
+
+		return;
+	}
+
+	// Setup
+	UInt32						bit = SPersistentDictionaryNode::getBit(hashValue, shift);
+	UInt32						slotIndex = node->getSlotIndex(bit);
+	SPersistentDictionarySlot&	slot = node->getSlots()[slotIndex];
+
+	// Check slot
+	if (slot.mNode != nil) {
+		// Descend
+		remove(slot.mNode, shift + 5, hashValue, key);
+
+		// Check if the child node is down to a single item
+		SPersistentDictionaryNode*	childNode = slot.mNode;
+		if ((childNode->mSlotCount == 1) && (childNode->getSlots()[0].mItem != nil)) {
+			// Pull the item up into this node
+			slot.mItem = childNode->getSlots()[0].mItem;
+			slot.mNode = nil;
+			SPersistentDictionaryNode::free(childNode);
+		}
+	} else {
+		// Remove item
+		release(slot.mItem);
+		node = removeSlot(node, slotIndex, bit);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CPersistentDictionaryInternals::replaceValue(SPersistentDictionaryItem*& item, const SValue& value)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if item is shared
+	if (item->mReferenceCount.load(std::memory_order_acquire) == 1) {
+		// Only referenced by us
+		item->mItem.mValue.dispose(mOpaqueDisposeProc);
+		item->mItem.mValue = value;
 	} else {
-		// End of item info linked list
-		while ((++iteratorInfo.mCurrentIndex < iteratorInfo.mInternals.mItemInfosCount) &&
-				(iteratorInfo.mInternals.mItemInfos [iteratorInfo.mCurrentIndex] == nil)) ;
-
-		// Check if found another item info
-		if (iteratorInfo.mCurrentIndex < iteratorInfo.mInternals.mItemInfosCount)
-			// Found another item info
-			iteratorInfo.mCurrentItemInfo = iteratorInfo.mInternals.mItemInfos[iteratorInfo.mCurrentIndex];
+		// Shared with another copy
+		SPersistentDictionaryItem*	previousItem = item;
+		item = new SPersistentDictionaryItem(previousItem->mKeyHashValue, previousItem->mItem.mKey, value);
+		release(previousItem);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+SPersistentDictionaryNode* CPersistentDictionaryInternals::getEditableNode(SPersistentDictionaryNode* node)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if node is shared
+	if (node->mReferenceCount.load(std::memory_order_acquire) == 1)
+		// Only referenced by us
+		return node;
+
+	// Copy node, sharing its items and child nodes
+	SPersistentDictionaryNode*	editableNode = SPersistentDictionaryNode::create(node->mBitmap, node->mSlotCount);
+	::memcpy(editableNode->getSlots(), node->getSlots(), node->mSlotCount * sizeof(SPersistentDictionarySlot));
+	for (UInt32 i = 0; i < node->mSlotCount; i++) {
+		// Add reference
+		SPersistentDictionarySlot&	slot = node->getSlots()[i];
+		if (slot.mItem != nil)
+			// Item
+			slot.mItem->mReferenceCount.fetch_add(1, std::memory_order_relaxed);
 		else
-			// No more item infos
-			iteratorInfo.mCurrentItemInfo = nil;
+			// Node
+			slot.mNode->mReferenceCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Release our reference to the shared node
+	release(node);
+
+	return editableNode;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CPersistentDictionaryInternals::release(SPersistentDictionaryNode* node)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if we are the last one
+	if (node->mReferenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		// Release slots
+		for (UInt32 i = 0; i < node->mSlotCount; i++) {
+			// Check slot
+			SPersistentDictionarySlot&	slot = node->getSlots()[i];
+			if (slot.mItem != nil)
+				// Item
+				release(slot.mItem);
+			else
+				// Node
+				release(slot.mNode);
+		}
+
+		// Cleanup
+		SPersistentDictionaryNode::free(node);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CPersistentDictionaryInternals::release(SPersistentDictionaryItem* item)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if we are the last one
+	if (item->mReferenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		// Dispose value
+		item->mItem.mValue.dispose(mOpaqueDisposeProc);
+
+		// Cleanup
+		Delete(item);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+SPersistentDictionaryNode* CPersistentDictionaryInternals::newNode(SPersistentDictionaryItem* item1,
+		SPersistentDictionaryItem* item2, UInt32 shift)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if past the end of the hash value
+	if (shift >= 32) {
+		// Collision node
+		SPersistentDictionaryNode*	node = SPersistentDictionaryNode::create(0, 2);
+		node->getSlots()[0].mItem = item1;
+		node->getSlots()[0].mNode = nil;
+		node->getSlots()[1].mItem = item2;
+		node->getSlots()[1].mNode = nil;
+
+		return node;
 	}
 
-	return (iteratorInfo.mCurrentItemInfo != nil) ? (void*) &iteratorInfo.mCurrentItemInfo->mItem : nil;
+	// Setup
+	UInt32	bit1 = SPersistentDictionaryNode::getBit(item1->mKeyHashValue, shift);
+	UInt32	bit2 = SPersistentDictionaryNode::getBit(item2->mKeyHashValue, shift);
+
+	// Check bits
+	if (bit1 == bit2) {
+		// Same slot at this level as well
+		SPersistentDictionaryNode*	node = SPersistentDictionaryNode::create(bit1, 1);
+		node->getSlots()[0].mItem = nil;
+		node->getSlots()[0].mNode = newNode(item1, item2, shift + 5);
+
+		return node;
+	} else {
+		// Different slots
+		SPersistentDictionaryNode*	node = SPersistentDictionaryNode::create(bit1 | bit2, 2);
+		node->getSlots()[(bit1 < bit2) ? 0 : 1].mItem = item1;
+		node->getSlots()[(bit1 < bit2) ? 1 : 0].mItem = item2;
+		node->getSlots()[0].mNode = nil;
+		node->getSlots()[1].mNode = nil;
+
+		return node;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+SPersistentDictionaryNode* CPersistentDictionaryInternals::insertSlot(SPersistentDictionaryNode* node, UInt32 slotIndex,
+		UInt32 bit, SPersistentDictionaryItem* item)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	SPersistentDictionaryNode*	updatedNode =
+										SPersistentDictionaryNode::create(node->mBitmap | bit, node->mSlotCount + 1);
+
+	// Move slots over
+	::memcpy(updatedNode->getSlots(), node->getSlots(), slotIndex * sizeof(SPersistentDictionarySlot));
+	updatedNode->getSlots()[slotIndex].mItem = item;
+	updatedNode->getSlots()[slotIndex].mNode = nil;
+	::memcpy(updatedNode->getSlots() + slotIndex + 1, node->getSlots() + slotIndex,
+			(node->mSlotCount - slotIndex) * sizeof(SPersistentDictionarySlot));
+
+	// Cleanup
+	SPersistentDictionaryNode::free(node);
+
+	return updatedNode;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+SPersistentDictionaryNode* CPersistentDictionaryInternals::removeSlot(SPersistentDictionaryNode* node, UInt32 slotIndex,
+		UInt32 bit)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if this is the last slot
+	if (node->mSlotCount == 1) {
+		// Node is now empty
+		SPersistentDictionaryNode::free(node);
+
+		return nil;
+	}
+
+	// Setup
+	SPersistentDictionaryNode*	updatedNode =
+										SPersistentDictionaryNode::create(node->mBitmap & ~bit, node->mSlotCount - 1);
+
+	// Move slots over
+	::memcpy(updatedNode->getSlots(), node->getSlots(), slotIndex * sizeof(SPersistentDictionarySlot));
+	::memcpy(updatedNode->getSlots() + slotIndex, node->getSlots() + slotIndex + 1,
+			(node->mSlotCount - slotIndex - 1) * sizeof(SPersistentDictionarySlot));
+
+	// Cleanup
+	SPersistentDictionaryNode::free(node);
+
+	return updatedNode;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void* CPersistentDictionaryInternals::iteratorAdvance(IteratorInfo& iteratorInfo)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Internals check
+	AssertFailIf(iteratorInfo.mInitialReference != iteratorInfo.mInternals.mReference);
+
+	return iteratorInfo.getNextItem();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -508,6 +1324,9 @@ class CProcsDictionaryInternals : public TDictionaryInternals<CProcsDictionaryIn
 																*iteratorInfo);
 													}
 
+		const	CDictionary::ItemInfo*			getItemInfos(UInt32& itemInfosCount) const
+													{ itemInfosCount = 0; return nil; }
+
 				SValue::OpaqueEqualsProc		getOpaqueEqualsProc() const
 													{ return nil; }
 
@@ -561,6 +1380,36 @@ CDictionary::CDictionary(SValue::OpaqueCopyProc opaqueCopyProc, SValue::OpaqueDi
 					opaqueEqualsProc);
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+CDictionary::CDictionary(Storage storage, SValue::OpaqueCopyProc opaqueCopyProc,
+		SValue::OpaqueDisposeProc opaqueDisposeProc, SValue::OpaqueEqualsProc opaqueEqualsProc) : CEquatable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check storage
+	switch (storage) {
+		case kStorageStandard:
+			// Standard
+			mInternals =
+					(CDictionaryInternals*) new CStandardDictionaryInternals(opaqueCopyProc, opaqueDisposeProc,
+							opaqueEqualsProc);
+			break;
+
+		case kStoragePersistent:
+			// Persistent (items are shared between copies so the opaque copy proc is not needed)
+			mInternals =
+					(CDictionaryInternals*) new CPersistentDictionaryInternals(opaqueDisposeProc, opaqueEqualsProc);
+			break;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CDictionary::CDictionary(CArena& arena) : CEquatable()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	mInternals = (CDictionaryInternals*) new CStandardDictionaryInternals(arena);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 CDictionary::CDictionary(const Procs& procs) : CEquatable()
 //----------------------------------------------------------------------------------------------------------------------
@@ -575,6 +1424,7 @@ CDictionary::CDictionary(const CDictionary& other) : CEquatable()
 {
 	// Setup
 	mInternals = (CDictionaryInternals*) other.mInternals->addReference();
+	mInternals->noteShared();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -999,6 +1849,30 @@ TIteratorS<CDictionary::Item> CDictionary::getIterator() const
 	return mInternals->getIterator();
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+CDictionary::Iterator CDictionary::begin() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if have item infos
+			UInt32		itemInfosCount;
+	const	ItemInfo*	itemInfos = mInternals->getItemInfos(itemInfosCount);
+
+	return (itemInfos != nil) ?
+			Iterator(itemInfos, itemInfos + itemInfosCount) : Iterator(new TIteratorS<Item>(mInternals->getIterator()));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CDictionary::Iterator CDictionary::end() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if have item infos
+			UInt32		itemInfosCount;
+	const	ItemInfo*	itemInfos = mInternals->getItemInfos(itemInfosCount);
+
+	return (itemInfos != nil) ?
+			Iterator(itemInfos + itemInfosCount, itemInfos + itemInfosCount) : Iterator(nil, nil);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 const OR<SValue> CDictionary::operator[](const CString& key) const
 //----------------------------------------------------------------------------------------------------------------------
@@ -1019,6 +1893,7 @@ CDictionary& CDictionary::operator=(const CDictionary& other)
 
 	// Add reference to other
 	mInternals = other.mInternals->addReference();
+	mInternals->noteShared();
 
 	return *this;
 }
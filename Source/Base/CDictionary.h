@@ -12,6 +12,14 @@
 
 class CDictionaryInternals;
 class CDictionary : public CEquatable {
+	// Enums
+	public:
+		enum Storage {
+			kStorageStandard,	// Hash table.  A copy on write copies every item.
+			kStoragePersistent,	// Hash array mapped trie.  A copy on write copies only the nodes along the path being
+								//	changed and shares everything else, so snapshots are cheap to take and modify.
+		};
+
 	// Types
 	public:
 		typedef	UInt32	KeyCount;
@@ -28,7 +36,7 @@ class CDictionary : public CEquatable {
 				mKey(key), mValue(value, opaqueCopyProc)
 				{}
 			Item(const Item& other, SValue::OpaqueCopyProc opaqueCopyProc) :
-				mKey(other.mKey), mValue(other.mValue, opaqueCopyProc)
+				mKey(other.mKey), mValue(other.mValue.copy(opaqueCopyProc))
 				{}
 
 			// Properties
@@ -36,6 +44,18 @@ class CDictionary : public CEquatable {
 			SValue	mValue;
 		};
 
+		struct ItemInfo {
+					// Instance methods
+			bool	isEmpty() const
+						{ return mItem == nil; }
+			bool	doesMatch(UInt32 hashValue, const CString& key) const
+						{ return (hashValue == mKeyHashValue) && (mItem != nil) && (key == mItem->mKey); }
+
+			// Properties
+			UInt32	mKeyHashValue;
+			Item*	mItem;
+		};
+
 		struct Procs {
 			// Procs
 			typedef	KeyCount	(*GetKeyCountProc)(void* userData);
@@ -84,12 +104,78 @@ class CDictionary : public CEquatable {
 				void*				mUserData;
 		};
 
+	// Iterator
+	public:
+		// With standard storage, walks the item infos directly and does not allocate.  Other storage goes through the
+		//	regular iterator.  The dictionary must not be modified while iterating.
+		class Iterator {
+			// Methods
+			public:
+							// Lifecycle methods
+							Iterator(const ItemInfo* itemInfo, const ItemInfo* endItemInfo) :
+								mItemInfo(itemInfo), mEndItemInfo(endItemInfo), mIterator(nil)
+								{ skipEmpty(); }
+							Iterator(TIteratorS<Item>* iterator) :
+								mItemInfo(nil), mEndItemInfo(nil), mIterator(iterator)
+								{}
+							Iterator(const Iterator& other) :
+								mItemInfo(other.mItemInfo), mEndItemInfo(other.mEndItemInfo),
+										mIterator((other.mIterator != nil) ?
+												new TIteratorS<Item>(other.mIterator) : nil)
+								{}
+							~Iterator()
+								{ Delete(mIterator); }
+
+							// Instance methods
+				Item&		operator*() const
+								{ return (mIterator != nil) ? **mIterator : *mItemInfo->mItem; }
+				Item*		operator->() const
+								{ return &**this; }
+				Iterator&	operator++()
+								{
+									// Check mode
+									if (mIterator != nil)
+										// Iterator
+										mIterator->advance();
+									else {
+										// Item infos
+										mItemInfo++;
+										skipEmpty();
+									}
+
+									return *this;
+								}
+				bool		operator!=(const Iterator& other) const
+								{ return (mIterator != nil) ? mIterator->hasValue() : (mItemInfo != other.mItemInfo); }
+				bool		operator==(const Iterator& other) const
+								{ return !(*this != other); }
+
+			private:
+							// Instance methods
+				Iterator&	operator=(const Iterator& other);
+
+							// Private methods
+				void		skipEmpty()
+								{ while ((mItemInfo != mEndItemInfo) && mItemInfo->isEmpty()) mItemInfo++; }
+
+			// Properties
+			private:
+				const	ItemInfo*			mItemInfo;
+				const	ItemInfo*			mEndItemInfo;
+						TIteratorS<Item>*	mIterator;
+		};
+
 	// Methods
 	public:
 												// Lifecycle methods
 												CDictionary(SValue::OpaqueCopyProc opaqueCopyProc = nil,
 														SValue::OpaqueDisposeProc opaqueDisposeProc = nil,
 														SValue::OpaqueEqualsProc opaqueEqualsProc = nil);
+												CDictionary(Storage storage,
+														SValue::OpaqueCopyProc opaqueCopyProc = nil,
+														SValue::OpaqueDisposeProc opaqueDisposeProc = nil,
+														SValue::OpaqueEqualsProc opaqueEqualsProc = nil);
+												CDictionary(CArena& arena);
 												CDictionary(const Procs& procs);
 												CDictionary(const CDictionary& other);
 		virtual									~CDictionary();
@@ -192,6 +278,8 @@ class CDictionary : public CEquatable {
 														const;
 
 						TIteratorS<Item>		getIterator() const;
+						Iterator				begin() const;
+						Iterator				end() const;
 
 				const	OR<SValue>				operator[](const CString& key) const;
 						CDictionary&			operator=(const CDictionary& other);
@@ -363,3 +451,402 @@ template <typename K, typename T> class TKeyConvertibleDictionary : public CDict
 		static	void	dispose(SValue::Opaque opaque)
 							{ T* t = (T*) opaque; Delete(t); }
 };
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - TNumericKeyDictionary
+//	TNumericKeyDictionary maps numeric keys (UInt32, UInt64, OSType, etc) to values.  Keys are stored inline in an
+//		open-addressing table and hashed directly, so there is no CString conversion on set or lookup.  Values are
+//		allocated individually so references to them stay valid as the table grows.
+
+template <typename K, typename T> class TNumericKeyDictionary {
+	// ItemInfo
+	private:
+		struct ItemInfo {
+			// Instance methods
+			bool	isEmpty() const
+						{ return mHashValue == 0; }
+
+			// Properties
+			K		mKey;
+			UInt32	mHashValue;
+			T*		mValue;
+		};
+
+	// Internals
+	private:
+		class Internals : public TAtomicCopyOnWriteReferenceCountable<Internals> {
+			public:
+										Internals() :
+											TAtomicCopyOnWriteReferenceCountable<Internals>(),
+													mCount(0), mItemInfos(nil), mItemInfosCount(0), mItemInfosShift(32)
+											{}
+										Internals(const Internals& other) :
+											TAtomicCopyOnWriteReferenceCountable<Internals>(),
+													mCount(other.mCount), mItemInfos(nil),
+													mItemInfosCount(other.mItemInfosCount),
+													mItemInfosShift(other.mItemInfosShift)
+											{
+												// Check if have item infos
+												if (mItemInfosCount > 0) {
+													// Copy layout as-is
+													mItemInfos =
+															(ItemInfo*) ::malloc(mItemInfosCount * sizeof(ItemInfo));
+													::memcpy(mItemInfos, other.mItemInfos,
+															mItemInfosCount * sizeof(ItemInfo));
+
+													// Copy values
+													for (UInt32 i = 0; i < mItemInfosCount; i++) {
+														// Check if have value
+														if (!mItemInfos[i].isEmpty())
+															// Copy
+															mItemInfos[i].mValue = new T(*other.mItemInfos[i].mValue);
+													}
+												}
+											}
+										~Internals()
+											{
+												// Remove all
+												removeAllInternal();
+
+												// Cleanup
+												::free(mItemInfos);
+											}
+
+						OR<T>			get(K key) const
+											{
+												// Find
+												UInt32	index = getIndex(getHashValue(key), key);
+
+												return (index < mItemInfosCount) ?
+														OR<T>(*mItemInfos[index].mValue) : OR<T>();
+											}
+						Internals*		set(K key, const T& value)
+											{
+												// Prepare for write
+												Internals*	internals = this->prepareForWrite();
+
+												// Find
+												UInt32	hashValue = getHashValue(key);
+												UInt32	index = internals->getIndex(hashValue, key);
+												if (index < internals->mItemInfosCount) {
+													// Replace value
+													Delete(internals->mItemInfos[index].mValue);
+													internals->mItemInfos[index].mValue = new T(value);
+												} else {
+													// Check if need to grow
+													if (((internals->mCount + 1) * 8) >
+															(internals->mItemInfosCount * 7))
+														// Grow
+														internals->resize(
+																std::max<UInt32>(internals->mItemInfosCount * 2, 8));
+
+													// Insert
+													ItemInfo	itemInfo = {key, hashValue, new T(value)};
+													internals->insertItemInfo(itemInfo);
+													internals->mCount++;
+												}
+
+												return internals;
+											}
+						Internals*		remove(K key)
+											{
+												// Check if have key
+												UInt32	hashValue = getHashValue(key);
+												if (getIndex(hashValue, key) == mItemInfosCount)
+													// Nothing to remove
+													return this;
+
+												// Prepare for write
+												Internals*	internals = this->prepareForWrite();
+
+												// Remove
+												internals->removeAt(internals->getIndex(hashValue, key));
+
+												return internals;
+											}
+						Internals*		removeAll()
+											{
+												// Check if empty
+												if (mCount == 0)
+													// Nothing to remove
+													return this;
+
+												// Prepare for write
+												Internals*	internals = this->prepareForWrite();
+
+												// Remove all
+												internals->removeAllInternal();
+
+												return internals;
+											}
+
+										// Private methods
+						UInt32			getHomeIndex(UInt32 hashValue) const
+											{ return (hashValue * 2654435769U) >> mItemInfosShift; }
+						UInt32			getProbeDistance(UInt32 index) const
+											{ return (index - getHomeIndex(mItemInfos[index].mHashValue)) &
+													(mItemInfosCount - 1); }
+						UInt32			getIndex(UInt32 hashValue, K key) const
+											{
+												// Check if have item infos
+												if (mItemInfosCount == 0)
+													// Nope
+													return 0;
+
+												// Probe from the home index until we pass an item info that is
+												//	closer to its home index than we are to ours
+												UInt32	mask = mItemInfosCount - 1;
+												UInt32	index = getHomeIndex(hashValue);
+												for (UInt32 distance = 0;
+														!mItemInfos[index].isEmpty() &&
+																(distance <= getProbeDistance(index));
+														distance++, index = (index + 1) & mask) {
+													// Check this item info
+													if (mItemInfos[index].mKey == key)
+														// Found
+														return index;
+												}
+
+												return mItemInfosCount;
+											}
+						void			insertItemInfo(ItemInfo itemInfo)
+											{
+												// Setup
+												UInt32	mask = mItemInfosCount - 1;
+												UInt32	index = getHomeIndex(itemInfo.mHashValue);
+
+												// Probe
+												for (UInt32 distance = 0;; distance++, index = (index + 1) & mask) {
+													// Check if empty
+													if (mItemInfos[index].isEmpty()) {
+														// Store here
+														mItemInfos[index] = itemInfo;
+
+														return;
+													}
+
+													// Check if the existing item info is closer to its home index
+													//	than we are to ours
+													UInt32	existingDistance = getProbeDistance(index);
+													if (existingDistance < distance) {
+														// Take this slot and continue on with the displaced item info
+														ItemInfo	displacedItemInfo = mItemInfos[index];
+														mItemInfos[index] = itemInfo;
+														itemInfo = displacedItemInfo;
+														distance = existingDistance;
+													}
+												}
+											}
+						void			removeAt(UInt32 index)
+											{
+												// Dispose
+												Delete(mItemInfos[index].mValue);
+
+												// Shift following item infos back until we find an empty one or
+												//	one that is already at its home index
+												UInt32	mask = mItemInfosCount - 1;
+												UInt32	nextIndex = (index + 1) & mask;
+												while (!mItemInfos[nextIndex].isEmpty() &&
+														(getProbeDistance(nextIndex) > 0)) {
+													// Shift back
+													mItemInfos[index] = mItemInfos[nextIndex];
+													index = nextIndex;
+													nextIndex = (nextIndex + 1) & mask;
+												}
+
+												// Clear
+												mItemInfos[index].mHashValue = 0;
+
+												// Update info
+												mCount--;
+											}
+						void			removeAllInternal()
+											{
+												// Iterate all item infos
+												for (UInt32 i = 0; i < mItemInfosCount; i++) {
+													// Check if have an item info
+													if (!mItemInfos[i].isEmpty()) {
+														// Dispose
+														Delete(mItemInfos[i].mValue);
+														mItemInfos[i].mHashValue = 0;
+													}
+												}
+
+												// Update info
+												mCount = 0;
+											}
+						void			resize(UInt32 itemInfosCount)
+											{
+												// Setup
+												ItemInfo*	previousItemInfos = mItemInfos;
+												UInt32		previousItemInfosCount = mItemInfosCount;
+
+												// Update storage
+												mItemInfos = (ItemInfo*) ::calloc(itemInfosCount, sizeof(ItemInfo));
+												mItemInfosCount = itemInfosCount;
+												mItemInfosShift = 32;
+												for (UInt32 count = itemInfosCount; count > 1; count >>= 1)
+													// Next
+													mItemInfosShift--;
+
+												// Reinsert using the cached hash values
+												for (UInt32 i = 0; i < previousItemInfosCount; i++) {
+													// Check if have an item info
+													if (!previousItemInfos[i].isEmpty())
+														// Reinsert
+														insertItemInfo(previousItemInfos[i]);
+												}
+
+												// Cleanup
+												::free(previousItemInfos);
+											}
+
+										// Class methods
+				static	UInt32			getHashValue(K key)
+											{
+												// Mix all the bits (64-bit finalizer from MurmurHash3).  0 is
+												//	reserved to mark an empty item info.
+												UInt64	bits = (UInt64) key;
+												bits ^= bits >> 33;
+												bits *= 0xFF51AFD7ED558CCDULL;
+												bits ^= bits >> 33;
+
+												return (UInt32) bits | 1;
+											}
+
+				CDictionary::KeyCount	mCount;
+				ItemInfo*				mItemInfos;
+				UInt32					mItemInfosCount;
+				UInt32					mItemInfosShift;
+		};
+
+	// Iterator
+	public:
+		// Walks the item infos directly and does not allocate.  The dictionary must not be modified while iterating.
+		class Iterator {
+			// Methods
+			public:
+							// Lifecycle methods
+							Iterator(const ItemInfo* itemInfo, const ItemInfo* endItemInfo) :
+								mItemInfo(itemInfo), mEndItemInfo(endItemInfo)
+								{ skipEmpty(); }
+
+							// Instance methods
+				K			getKey() const
+								{ return mItemInfo->mKey; }
+
+				T&			operator*() const
+								{ return *mItemInfo->mValue; }
+				T*			operator->() const
+								{ return mItemInfo->mValue; }
+				Iterator&	operator++()
+								{ mItemInfo++; skipEmpty(); return *this; }
+				bool		operator==(const Iterator& other) const
+								{ return mItemInfo == other.mItemInfo; }
+				bool		operator!=(const Iterator& other) const
+								{ return mItemInfo != other.mItemInfo; }
+
+			private:
+							// Private methods
+				void		skipEmpty()
+								{ while ((mItemInfo != mEndItemInfo) && mItemInfo->isEmpty()) mItemInfo++; }
+
+			// Properties
+			private:
+				const	ItemInfo*	mItemInfo;
+				const	ItemInfo*	mEndItemInfo;
+		};
+
+	// Methods
+	public:
+									// Lifecycle methods
+									TNumericKeyDictionary() : mInternals(new Internals()) {}
+									TNumericKeyDictionary(const TNumericKeyDictionary<K, T>& other) :
+										mInternals(other.mInternals->addReference())
+										{}
+									~TNumericKeyDictionary()
+										{ mInternals->removeReference(); }
+
+									// Instance methods
+		CDictionary::KeyCount		getKeyCount() const
+										{ return mInternals->mCount; }
+		bool						isEmpty() const
+										{ return mInternals->mCount == 0; }
+		TNumericSet<K>				getKeys() const
+										{
+											// Setup
+											TNumericSet<K>	keys;
+
+											// Iterate all
+											for (Iterator iterator = begin(); iterator != end(); ++iterator)
+												// Add key
+												keys.add(iterator.getKey());
+
+											return keys;
+										}
+
+		bool						contains(K key) const
+										{ return mInternals->get(key).hasReference(); }
+
+		OR<T>						get(K key) const
+										{ return mInternals->get(key); }
+		void						set(K key, const T& value)
+										{ mInternals = mInternals->set(key, value); }
+
+		void						remove(K key)
+										{ mInternals = mInternals->remove(key); }
+		void						removeAll()
+										{ mInternals = mInternals->removeAll(); }
+
+		bool						equals(const TNumericKeyDictionary<K, T>& other) const
+										{
+											// Check if same internals
+											if (other.mInternals == mInternals)
+												// Same
+												return true;
+
+											// Check count
+											if (other.mInternals->mCount != mInternals->mCount)
+												// Counts differ
+												return false;
+
+											// Iterate all
+											for (Iterator iterator = begin(); iterator != end(); ++iterator) {
+												// Get other value
+												OR<T>	value = other.mInternals->get(iterator.getKey());
+												if (!value.hasReference() || !(*value == *iterator))
+													// Value not found or value is not the same
+													return false;
+											}
+
+											return true;
+										}
+
+		Iterator					begin() const
+										{ return Iterator(mInternals->mItemInfos,
+												mInternals->mItemInfos + mInternals->mItemInfosCount); }
+		Iterator					end() const
+										{ return Iterator(mInternals->mItemInfos + mInternals->mItemInfosCount,
+												mInternals->mItemInfos + mInternals->mItemInfosCount); }
+
+		OR<T>						operator[](K key) const
+										{ return get(key); }
+		bool						operator==(const TNumericKeyDictionary<K, T>& other) const
+										{ return equals(other); }
+		TNumericKeyDictionary<K, T>&	operator=(const TNumericKeyDictionary<K, T>& other)
+										{
+											// Check if assignment to self
+											if (this == &other)
+												return *this;
+
+											// Update reference
+											mInternals->removeReference();
+											mInternals = other.mInternals->addReference();
+
+											return *this;
+										}
+
+	// Properties
+	private:
+		Internals*	mInternals;
+};
@@ -4,67 +4,379 @@
 
 #include "CHashing.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define HASHING_SSE2	1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#include <arm_neon.h>
+	#define HASHING_NEON	1
+#endif
+
+/*
+	Hashing is based on wyhash (https://github.com/wangyi-fudan/wyhash, public domain).  Each add() folds its bytes
+		into the 64-bit state using the state as the seed.  Short inputs take 1 or 2 reads, medium inputs are consumed
+		16 bytes per step, and inputs up to kLongInputByteCount 48 bytes per step across 3 independent lanes so the
+		multiplies overlap.
+	Longer inputs (file contents, large CData) use an XXH3-style accumulator: 8 64-bit lanes each take a 32 x 32 bit
+		multiply of the data mixed with a secret per 64 byte stripe, and are scrambled every kStripesPerBlock stripes.
+		This maps directly onto SSE2 and NEON, with a scalar path that produces the same values elsewhere.
+ */
+
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: Local data
 
-// Based on https://stackoverflow.com/questions/8317508/hash-function-for-a-string
-const	UInt32	kA = 54059; /* a prime */
-const	UInt32	kB = 76963; /* another prime */
-//const	UInt32	kC = 86969; /* yet another prime */
-const	UInt32	kInitialValue = 37; /* also prime */
+static	const	UInt64	kSecret0 = 0x2d358dccaa6c78a5ULL;
+static	const	UInt64	kSecret1 = 0x8bb84b93962eacc9ULL;
+static	const	UInt64	kSecret2 = 0x4b33a62ed433d4a3ULL;
+static	const	UInt64	kSecret3 = 0x4d5a2da51de1aa47ULL;
+
+static	const	UInt64	kLongInputByteCount = 512;
+static	const	UInt64	kStripeByteCount = 64;
+static	const	UInt64	kStripesPerBlock = 16;
+static	const	UInt32	kScramblePrime = 0x9E3779B1;
+
+static	const	UInt64	sStripeSecrets[] = {
+							0x28350394fec49c59ULL, 0x9c5118947de5991bULL, 0x6da148e246e891fdULL, 0x33c67e9b00ff1885ULL,
+							0xbc8d5567bb133a23ULL, 0x8cd45dfd8895c7b9ULL, 0x957864f9bfaebd4dULL, 0xa6d4d7ae1a383d2fULL,
+						};
+static	const	UInt64	sScrambleSecrets[] = {
+							0x75198da9a0db8ffdULL, 0xe92b0f2033b07371ULL, 0x019996ef2387c673ULL, 0xdec2f7b812148f15ULL,
+							0x3de49326ef6d1575ULL, 0x1490628500e7873bULL, 0x268f36d8d2d5cdd1ULL, 0xb5b0f03a01f7e871ULL,
+						};
 
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
-// MARK: - CHasherInternals
+// MARK: - Local proc declarations
 
-class CHasherInternals {
-	public:
-				CHasherInternals() : mValue(kInitialValue) {}
-				~CHasherInternals() {}
+static	void	sMultiply(UInt64& a, UInt64& b);
+static	UInt64	sMix(UInt64 a, UInt64 b);
+static	UInt64	sRead8(const UInt8* bytes);
+static	UInt64	sRead4(const UInt8* bytes);
+static	UInt64	sRead3(const UInt8* bytes, UInt64 byteCount);
+static	UInt64	sHash(const UInt8* bytes, UInt64 byteCount, UInt64 seed);
+static	void	sAccumulate(UInt64 accumulators[8], const UInt8* bytes, UInt64 stripeCount);
+static	void	sScramble(UInt64 accumulators[8]);
+static	UInt64	sHashLong(const UInt8* bytes, UInt64 byteCount, UInt64 seed);
 
-		void	add(const char* string)
-					{
-						// Iterate all characters
-						for (; *string != 0; string++)
-							// Update value
-							mValue = (mValue * kA) ^ ((UInt32) string[0] * kB);
-					}
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CHashable
+
+// MARK: Instance methods
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt32 CHashable::getHashValue() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Hash
+	CHasher	hasher;
+	hashInto(hasher);
 
-		UInt32	mValue;
-};
+	return hasher.getValue();
+}
 
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - CHasher
 
-// MARK: Lifecycle methods
+// MARK: Instance methods
 
 //----------------------------------------------------------------------------------------------------------------------
-CHasher::CHasher()
+void CHasher::add(const char* string)
 //----------------------------------------------------------------------------------------------------------------------
 {
-	mInternals = new CHasherInternals();
+	mValue = sHash((const UInt8*) string, ::strlen(string), mValue);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CHasher::~CHasher()
+void CHasher::add(const void* bytes, UInt64 byteCount)
 //----------------------------------------------------------------------------------------------------------------------
 {
-	Delete(mInternals);
+	mValue = sHash((const UInt8*) bytes, byteCount, mValue);
 }
 
-// MARK: Instance methods
+//----------------------------------------------------------------------------------------------------------------------
+UInt32 CHasher::getValue() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return (UInt32) (mValue ^ (mValue >> 32));
+}
 
 //----------------------------------------------------------------------------------------------------------------------
-void CHasher::add(const char* string)
+UInt64 CHasher::getValue64() const
 //----------------------------------------------------------------------------------------------------------------------
 {
-	mInternals->add(string);
+	return mValue;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-UInt32 CHasher::getValue() const
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - Local proc definitions
+
+//----------------------------------------------------------------------------------------------------------------------
+void sMultiply(UInt64& a, UInt64& b)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Full 64 x 64 -> 128 bit multiply, low half into a and high half into b
+#if defined(__SIZEOF_INT128__)
+	__uint128_t	result = (__uint128_t) a * b;
+	a = (UInt64) result;
+	b = (UInt64) (result >> 64);
+#else
+	UInt64	aHigh = a >> 32, aLow = (UInt32) a;
+	UInt64	bHigh = b >> 32, bLow = (UInt32) b;
+	UInt64	highHigh = aHigh * bHigh, highLow = aHigh * bLow, lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+	UInt64	low = lowLow + (highLow << 32);
+	UInt64	carry = (low < lowLow) ? 1 : 0;
+	UInt64	result = low + (lowHigh << 32);
+	carry += (result < low) ? 1 : 0;
+	a = result;
+	b = highHigh + (highLow >> 32) + (lowHigh >> 32) + carry;
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 sMix(UInt64 a, UInt64 b)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	sMultiply(a, b);
+
+	return a ^ b;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 sRead8(const UInt8* bytes)
 //----------------------------------------------------------------------------------------------------------------------
 {
-	return mInternals->mValue;	 // or return mValue % kC
+	UInt64	value;
+	::memcpy(&value, bytes, sizeof(UInt64));
+
+	return value;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 sRead4(const UInt8* bytes)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	UInt32	value;
+	::memcpy(&value, bytes, sizeof(UInt32));
+
+	return value;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 sRead3(const UInt8* bytes, UInt64 byteCount)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Read first, middle, and last (which may overlap for 1 and 2 byte inputs)
+	return ((UInt64) bytes[0] << 16) | ((UInt64) bytes[byteCount >> 1] << 8) | bytes[byteCount - 1];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 sHash(const UInt8* bytes, UInt64 byteCount, UInt64 seed)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check for long input
+	if (byteCount >= kLongInputByteCount)
+		return sHashLong(bytes, byteCount, seed);
+
+	// Setup
+	UInt64	a, b;
+	seed ^= sMix(seed ^ kSecret0, kSecret1);
+
+	// Check size
+	if (byteCount <= 16) {
+		// Short
+		if (byteCount >= 4) {
+			// 4 - 16 bytes
+			UInt64	offset = (byteCount >> 3) << 2;
+			a = (sRead4(bytes) << 32) | sRead4(bytes + offset);
+			b = (sRead4(bytes + byteCount - 4) << 32) | sRead4(bytes + byteCount - 4 - offset);
+		} else if (byteCount > 0) {
+			// 1 - 3 bytes
+			a = sRead3(bytes, byteCount);
+			b = 0;
+		} else {
+			// Empty
+			a = 0;
+			b = 0;
+		}
+	} else {
+		// Long
+		const	UInt8*	p = bytes;
+				UInt64	remaining = byteCount;
+		if (remaining > 48) {
+			// 48 bytes per step in 3 independent lanes
+			UInt64	seed1 = seed, seed2 = seed;
+			do {
+				// Mix
+				seed = sMix(sRead8(p) ^ kSecret1, sRead8(p + 8) ^ seed);
+				seed1 = sMix(sRead8(p + 16) ^ kSecret2, sRead8(p + 24) ^ seed1);
+				seed2 = sMix(sRead8(p + 32) ^ kSecret3, sRead8(p + 40) ^ seed2);
+				p += 48;
+				remaining -= 48;
+			} while (remaining > 48);
+			seed ^= seed1 ^ seed2;
+		}
+
+		// 16 bytes per step
+		while (remaining > 16) {
+			// Mix
+			seed = sMix(sRead8(p) ^ kSecret1, sRead8(p + 8) ^ seed);
+			p += 16;
+			remaining -= 16;
+		}
+
+		// Last 16 bytes (may overlap what was already mixed)
+		a = sRead8(p + remaining - 16);
+		b = sRead8(p + remaining - 8);
+	}
+
+	// Finalize
+	a ^= kSecret1;
+	b ^= seed;
+	sMultiply(a, b);
+
+	return sMix(a ^ kSecret0 ^ byteCount, b ^ kSecret1);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void sAccumulate(UInt64 accumulators[8], const UInt8* bytes, UInt64 stripeCount)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// For each lane i: accumulators[i ^ 1] += data[i], accumulators[i] += lo32(data[i] ^ secret[i]) * hi32(...)
+	//	Lanes are independent, so each vector runs down all the stripes while its accumulator stays in a register.
+#if HASHING_SSE2
+	// Iterate vectors
+	for (UInt32 i = 0; i < 4; i++) {
+		// Setup
+		__m128i			vector = _mm_loadu_si128((const __m128i*) accumulators + i);
+		__m128i			secret = _mm_loadu_si128((const __m128i*) sStripeSecrets + i);
+		const	UInt8*	stripe = bytes + i * 16;
+
+		// Iterate stripes
+		for (UInt64 j = 0; j < stripeCount; j++, stripe += kStripeByteCount) {
+			// Mix
+			__m128i	data = _mm_loadu_si128((const __m128i*) stripe);
+			__m128i	dataKey = _mm_xor_si128(data, secret);
+			__m128i	product = _mm_mul_epu32(dataKey, _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1)));
+			__m128i	swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+			vector = _mm_add_epi64(vector, _mm_add_epi64(product, swapped));
+		}
+
+		// Store
+		_mm_storeu_si128((__m128i*) accumulators + i, vector);
+	}
+#elif HASHING_NEON
+	// Iterate vectors
+	for (UInt32 i = 0; i < 4; i++) {
+		// Setup
+		uint64x2_t		vector = vld1q_u64(accumulators + i * 2);
+		uint64x2_t		secret = vld1q_u64(sStripeSecrets + i * 2);
+		const	UInt8*	stripe = bytes + i * 16;
+
+		// Iterate stripes
+		for (UInt64 j = 0; j < stripeCount; j++, stripe += kStripeByteCount) {
+			// Mix
+			uint64x2_t	data = vreinterpretq_u64_u8(vld1q_u8(stripe));
+			uint64x2_t	dataKey = veorq_u64(data, secret);
+			uint64x2_t	product = vmull_u32(vmovn_u64(dataKey), vshrn_n_u64(dataKey, 32));
+			uint64x2_t	swapped = vextq_u64(data, data, 1);
+			vector = vaddq_u64(vector, vaddq_u64(product, swapped));
+		}
+
+		// Store
+		vst1q_u64(accumulators + i * 2, vector);
+	}
+#else
+	// Iterate stripes
+	for (; stripeCount > 0; stripeCount--, bytes += kStripeByteCount) {
+		// Iterate lanes
+		for (UInt32 i = 0; i < 8; i++) {
+			// Mix
+			UInt64	data = sRead8(bytes + i * 8);
+			UInt64	dataKey = data ^ sStripeSecrets[i];
+			accumulators[i ^ 1] += data;
+			accumulators[i] += (dataKey & 0xFFFFFFFF) * (dataKey >> 32);
+		}
+	}
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void sScramble(UInt64 accumulators[8])
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// For each lane: accumulator = ((accumulator ^ (accumulator >> 47)) ^ secret) * kScramblePrime
+#if HASHING_SSE2
+	// Setup
+	__m128i	prime = _mm_set1_epi32((int) kScramblePrime);
+
+	// Iterate vectors
+	for (UInt32 i = 0; i < 4; i++) {
+		// Scramble
+		__m128i	vector = _mm_loadu_si128((const __m128i*) accumulators + i);
+		vector = _mm_xor_si128(vector, _mm_srli_epi64(vector, 47));
+		vector = _mm_xor_si128(vector, _mm_loadu_si128((const __m128i*) sScrambleSecrets + i));
+
+		__m128i	productLow = _mm_mul_epu32(vector, prime);
+		__m128i	productHigh = _mm_mul_epu32(_mm_srli_epi64(vector, 32), prime);
+		_mm_storeu_si128((__m128i*) accumulators + i, _mm_add_epi64(productLow, _mm_slli_epi64(productHigh, 32)));
+	}
+#elif HASHING_NEON
+	// Setup
+	uint32x2_t	prime = vdup_n_u32(kScramblePrime);
+
+	// Iterate vectors
+	for (UInt32 i = 0; i < 4; i++) {
+		// Scramble
+		uint64x2_t	vector = vld1q_u64(accumulators + i * 2);
+		vector = veorq_u64(vector, vshrq_n_u64(vector, 47));
+		vector = veorq_u64(vector, vld1q_u64(sScrambleSecrets + i * 2));
+
+		uint64x2_t	productLow = vmull_u32(vmovn_u64(vector), prime);
+		uint64x2_t	productHigh = vmull_u32(vshrn_n_u64(vector, 32), prime);
+		vst1q_u64(accumulators + i * 2, vaddq_u64(productLow, vshlq_n_u64(productHigh, 32)));
+	}
+#else
+	// Iterate lanes
+	for (UInt32 i = 0; i < 8; i++) {
+		// Scramble
+		UInt64	accumulator = accumulators[i];
+		accumulator ^= accumulator >> 47;
+		accumulator ^= sScrambleSecrets[i];
+		accumulators[i] = accumulator * kScramblePrime;
+	}
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt64 sHashLong(const UInt8* bytes, UInt64 byteCount, UInt64 seed)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	UInt64	accumulators[8];
+	for (UInt32 i = 0; i < 8; i++)
+		accumulators[i] = sScrambleSecrets[i] ^ seed;
+
+	// Process full blocks
+	UInt64	stripeCount = byteCount / kStripeByteCount;
+	for (; stripeCount >= kStripesPerBlock;
+			stripeCount -= kStripesPerBlock, bytes += kStripesPerBlock * kStripeByteCount) {
+		// Accumulate and scramble
+		sAccumulate(accumulators, bytes, kStripesPerBlock);
+		sScramble(accumulators);
+	}
+
+	// Process remaining full stripes
+	sAccumulate(accumulators, bytes, stripeCount);
+	bytes += stripeCount * kStripeByteCount;
+
+	// Merge lanes
+	UInt64	value = seed ^ (byteCount * kSecret0);
+	for (UInt32 i = 0; i < 8; i += 2)
+		value = sMix(accumulators[i] ^ sStripeSecrets[i], accumulators[i + 1] ^ value);
+
+	// Finish with the remaining bytes (under a stripe, so this takes the short path)
+	return sHash(bytes, byteCount % kStripeByteCount, value);
 }
@@ -18,6 +18,9 @@ class CHashable : public CEquatable {
 						CHashable() : CEquatable() {}
 						~CHashable() {}
 
+						// Instance methods
+		virtual	UInt32	getHashValue() const;
+
 						// Subclass methods
 		virtual	void	hashInto(CHasher& hasher) const = 0;
 };
@@ -25,24 +28,25 @@ class CHashable : public CEquatable {
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - CHasher
 
-class CHasherInternals;
 class CHasher {
 	// Methods
 	public:
 						// Lifecycle methods
-						CHasher();
-						~CHasher();
+						CHasher() : mValue(0) {}
+						~CHasher() {}
 
 						// Instance methods
 				void	add(const char* string);
+				void	add(const void* bytes, UInt64 byteCount);
 
 				UInt32	getValue() const;
+				UInt64	getValue64() const;
 
 						// Class methods
 		static	UInt32	getValueForHashable(const CHashable& hashable)
-							{ CHasher hasher; hashable.hashInto(hasher); return hasher.getValue(); }
+							{ return hashable.getHashValue(); }
 
 	// Properties
 	private:
-		CHasherInternals*	mInternals;
+		UInt64	mValue;
 };
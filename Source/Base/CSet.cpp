@@ -8,117 +8,79 @@
 #include "TReferenceTracking.h"
 
 //----------------------------------------------------------------------------------------------------------------------
-// MARK: SSetItemInfo
-
-struct SSetItemInfo {
-			// Lifecycle methods
-			SSetItemInfo(UInt32 hashValue, const CHashable& hashable) :
-				mHashValue(hashValue), mHashable(hashable), mNextItemInfo(nil)
-				{}
-			SSetItemInfo(const SSetItemInfo& other) :
-				mHashValue(other.mHashValue), mHashable(other.mHashable), mNextItemInfo(nil)
-				{}
-
-			// Instance methods
-	bool	doesMatch(UInt32 hashValue, const CHashable& hashable)
-				{ return (hashValue == mHashValue) && (hashable == mHashable); }
-
-	// Properties
-			UInt32			mHashValue;
-	const	CHashable&		mHashable;
-			SSetItemInfo*	mNextItemInfo;
-};
-
-//----------------------------------------------------------------------------------------------------------------------
-//----------------------------------------------------------------------------------------------------------------------
-// MARK: - CSetIteratorInfo
+// MARK: CSetIteratorInfo
 
 struct CSetIteratorInfo : public CIterator::Info {
 	// Methods
 	public:
 						// Lifecycle methods
-						CSetIteratorInfo(const CSetInternals& internals, UInt32 initialReference) :
+						CSetIteratorInfo(const CSetInternals& internals, UInt32 initialReference,
+								UInt32 currentIndex = 0) :
 							CIterator::Info(),
-									mInternals(internals), mInitialReference(initialReference), mCurrentIndex(0),
-									mCurrentItemInfo(nil)
+									mInternals(internals), mInitialReference(initialReference),
+									mCurrentIndex(currentIndex)
 							{}
 
 						// CIterator::Info methods
 	CIterator::Info*	copy()
-							{
-								// Make copy
-								CSetIteratorInfo*	iteratorInfo = new CSetIteratorInfo(mInternals, mInitialReference);
-								iteratorInfo->mCurrentIndex = mCurrentIndex;
-								iteratorInfo->mCurrentItemInfo = mCurrentItemInfo;
-
-								return iteratorInfo;
-							}
+							{ return new CSetIteratorInfo(mInternals, mInitialReference, mCurrentIndex); }
 
 	// Properties
 	const	CSetInternals&	mInternals;
 			UInt32			mInitialReference;
 			UInt32			mCurrentIndex;
-			SSetItemInfo*	mCurrentItemInfo;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - CSetInternals
 
+/*
+	Storage is an open-addressing table using Robin Hood insertion and backward-shift deletion, the same as
+		CDictionary.  Item infos cache the hash value so bulk operations can probe another set without rehashing.
+*/
+
 class CSetInternals : public TCopyOnWriteReferenceCountable<CSetInternals> {
 	public:
-										CSetInternals(bool ownsItems) :
+										CSetInternals(CSet::CopyProc copyProc) :
 											TCopyOnWriteReferenceCountable(),
-													mOwnsItems(ownsItems), mCount(0), mReference(0), mItemInfosCount(16)
-											{
-												mItemInfos =
-														(SSetItemInfo**)
-																::calloc(mItemInfosCount, sizeof(SSetItemInfo*));
-											}
+													mCopyProc(copyProc), mCount(0), mReference(0), mItemInfos(nil),
+													mItemInfosCount(0), mItemInfosShift(32)
+											{}
 										CSetInternals(const CSetInternals& other) :
 											TCopyOnWriteReferenceCountable(),
-													mOwnsItems(other.mOwnsItems), mCount(other.mCount), mReference(0),
-													mItemInfosCount(other.mItemInfosCount)
+													mCopyProc(other.mCopyProc), mCount(other.mCount), mReference(0),
+													mItemInfos(nil), mItemInfosCount(other.mItemInfosCount),
+													mItemInfosShift(other.mItemInfosShift)
 											{
-												// Ensure we do not own items
-												AssertFailIf(mOwnsItems && (mCount > 0));
-
-												// Finish setup
-												mItemInfos =
-														(SSetItemInfo**)
-																::calloc(mItemInfosCount, sizeof(SSetItemInfo*));
-
-												for (UInt32 i = 0; i < mItemInfosCount; i++) {
-													// Setup for this linked list
-													SSetItemInfo*	itemInfo = other.mItemInfos[i];
-													SSetItemInfo*	setInternalsItemInfo = nil;
-
-													while (itemInfo != nil) {
-														// Check for first in the linked list
-														if (setInternalsItemInfo == nil) {
-															// First in this linked list
-															mItemInfos[i] = new SSetItemInfo(*itemInfo);
-															setInternalsItemInfo = mItemInfos[i];
-														} else {
-															// Next one in this linked list
-															setInternalsItemInfo->mNextItemInfo =
-																	new SSetItemInfo(*itemInfo);
-															setInternalsItemInfo =
-																	setInternalsItemInfo->mNextItemInfo;
+												// Check if have item infos
+												if (mItemInfosCount > 0) {
+													// Copy layout as-is so no rehashing is necessary
+													mItemInfos =
+															(CSet::ItemInfo*)
+																	::malloc(mItemInfosCount * sizeof(CSet::ItemInfo));
+													::memcpy(mItemInfos, other.mItemInfos,
+															mItemInfosCount * sizeof(CSet::ItemInfo));
+
+													// Check if owns items
+													if (mCopyProc != nil) {
+														// Copy items
+														for (UInt32 i = 0; i < mItemInfosCount; i++) {
+															// Check if have item
+															if (!mItemInfos[i].isEmpty())
+																// Copy
+																mItemInfos[i].mHashable =
+																		mCopyProc(*other.mItemInfos[i].mHashable);
 														}
 													}
 												}
 											}
 										~CSetInternals()
 											{
-												// Iterate all item infos
-												for (UInt32 i = 0; i < mItemInfosCount; i++) {
-													// Check if have an item info
-													if (mItemInfos[i] != nil)
-														// Remove this chain
-														remove(mItemInfos[i], mOwnsItems);
-												}
+												// Remove all
+												removeAllInternal();
 
+												// Cleanup
 												::free(mItemInfos);
 											}
 
@@ -129,119 +91,152 @@ class CSetInternals : public TCopyOnWriteReferenceCountable<CSetInternals> {
 
 												// Setup
 												UInt32	hashValue = CHasher::getValueForHashable(hashable);
-												UInt32	index = hashValue & (setInternals->mItemInfosCount - 1);
 
-												// Find
-												SSetItemInfo*	previousItemInfo = nil;
-												SSetItemInfo*	currentItemInfo = setInternals->mItemInfos[index];
-												while ((currentItemInfo != nil) &&
-														!currentItemInfo->doesMatch(hashValue, hashable)) {
-													// Next in linked list
-													previousItemInfo = currentItemInfo;
-													currentItemInfo = currentItemInfo->mNextItemInfo;
-												}
-
-												// Check results
-												if (currentItemInfo == nil) {
-													// Did not find
-													if (previousItemInfo == nil)
-														// First one
-														setInternals->mItemInfos[index] =
-																new SSetItemInfo(hashValue, hashable);
-													else
-														// Add to the end
-														previousItemInfo->mNextItemInfo =
-																new SSetItemInfo(hashValue, hashable);
-
-													// Update info
-													setInternals->mCount++;
-													setInternals->mReference++;
-												} else if (setInternals->mOwnsItems) {
+												// Check if already have
+												if (setInternals->getIndex(hashValue, hashable) <
+														setInternals->mItemInfosCount) {
 													// Did not add
-													const	CHashable*	tempHashable = &hashable;
-													Delete(tempHashable);
-												}
+													if (setInternals->mCopyProc != nil) {
+														// Dispose
+														const	CHashable*	tempHashable = &hashable;
+														Delete(tempHashable);
+													}
+												} else
+													// Add
+													setInternals->add(hashValue, &hashable);
 
 												return setInternals;
 											}
-				bool					contains(const CHashable& hashable)
+				CSetInternals*			addFrom(const CSetInternals& other)
 											{
-												// Setup
-												UInt32	hashValue = CHasher::getValueForHashable(hashable);
-												UInt32	index = hashValue & (mItemInfosCount - 1);
+												// Check if anything to do
+												if ((this == &other) || (other.mCount == 0))
+													// Nothing to do
+													return this;
 
-												// Find item info that matches
-												SSetItemInfo*	itemInfo = mItemInfos[index];
-												while ((itemInfo != nil) && !itemInfo->doesMatch(hashValue, hashable))
-													// Advance to next item info
-													itemInfo = itemInfo->mNextItemInfo;
+												// Prepare for write
+												CSetInternals*	setInternals = prepareForWrite();
+
+												// Make room for the worst case up front so we grow at most once
+												setInternals->reserve(setInternals->mCount + other.mCount);
+
+												// Iterate other item infos
+												for (UInt32 i = 0; i < other.mItemInfosCount; i++) {
+													// Setup
+													const	CSet::ItemInfo&	itemInfo = other.mItemInfos[i];
+
+													// Check if need to add
+													if (!itemInfo.isEmpty() &&
+															(setInternals->getIndex(itemInfo.mHashValue,
+																	*itemInfo.mHashable) ==
+																	setInternals->mItemInfosCount))
+														// Add
+														setInternals->add(itemInfo.mHashValue,
+																(setInternals->mCopyProc != nil) ?
+																		setInternals->mCopyProc(*itemInfo.mHashable) :
+																		itemInfo.mHashable);
+												}
+
+												return setInternals;
+											}
+				bool					contains(const CHashable& hashable) const
+											{ return (mCount > 0) &&
+													(getIndex(CHasher::getValueForHashable(hashable), hashable) <
+															mItemInfosCount); }
+				bool					intersects(const CSetInternals& other) const
+											{
+												// Iterate the smaller and probe the larger
+												bool					isSmaller = mCount <= other.mCount;
+												const	CSetInternals&	smaller = isSmaller ? *this : other;
+												const	CSetInternals&	larger = isSmaller ? other : *this;
+												if (smaller.mCount == 0)
+													// Nothing to intersect
+													return false;
+
+												for (UInt32 i = 0; i < smaller.mItemInfosCount; i++) {
+													// Setup
+													const	CSet::ItemInfo&	itemInfo = smaller.mItemInfos[i];
+
+													// Check if larger has this item
+													if (!itemInfo.isEmpty() &&
+															(larger.getIndex(itemInfo.mHashValue, *itemInfo.mHashable) <
+																	larger.mItemInfosCount))
+														// Yes
+														return true;
+												}
 
-												return itemInfo != nil;
+												return false;
 											}
+				CSetInternals*			intersect(const CSetInternals& other)
+											{ return ((this == &other) || (mCount == 0)) ? this : retain(other, true); }
 				CSetInternals*			remove(const CHashable& hashable)
 											{
+												// Check if empty
+												if (mCount == 0)
+													// Nothing to remove
+													return this;
+
 												// Prepare for write
 												CSetInternals*	setInternals = prepareForWrite();
 
-												// Setup
-												UInt32	hashValue = CHasher::getValueForHashable(hashable);
-												UInt32	index = hashValue & (setInternals->mItemInfosCount - 1);
-
 												// Find
-												SSetItemInfo*	previousItemInfo = nil;
-												SSetItemInfo*	currentItemInfo = setInternals->mItemInfos[index];
-												while ((currentItemInfo != nil) &&
-														!currentItemInfo->doesMatch(hashValue, hashable)) {
-													// Next in linked list
-													previousItemInfo = currentItemInfo;
-													currentItemInfo = currentItemInfo->mNextItemInfo;
-												}
-
-												// Check if found
-												if (currentItemInfo != nil) {
+												UInt32	index =
+																setInternals->getIndex(
+																		CHasher::getValueForHashable(hashable),
+																		hashable);
+												if (index < setInternals->mItemInfosCount)
 													// Remove
-													if (previousItemInfo == nil)
-														// First in linked list
-														setInternals->mItemInfos[index] =
-																currentItemInfo->mNextItemInfo;
-													else
-														// Some other item info in linked list
-														previousItemInfo->mNextItemInfo =
-																currentItemInfo->mNextItemInfo;
-
-													// Check if owns item
-													if (setInternals->mOwnsItems) {
-														// Dispose
-														const	CHashable*	tempHashable = &currentItemInfo->mHashable;
-														Delete(tempHashable);
-													}
+													setInternals->removeAt(index);
+
+												return setInternals;
+											}
+				CSetInternals*			removeFrom(const CSetInternals& other)
+											{
+												// Check situation
+												if ((mCount == 0) || (other.mCount == 0))
+													// Nothing to remove
+													return this;
+												else if (this == &other)
+													// Remove everything
+													return removeAll();
+												else if (other.mCount > mCount)
+													// Faster to filter ourselves against the other
+													return retain(other, false);
 
-													// Cleanup this one
-													Delete(currentItemInfo);
+												// Prepare for write
+												CSetInternals*	setInternals = prepareForWrite();
 
-													// Update info
-													setInternals->mCount--;
-													setInternals->mReference++;
+												// Iterate other item infos
+												for (UInt32 i = 0; i < other.mItemInfosCount; i++) {
+													// Setup
+													const	CSet::ItemInfo&	itemInfo = other.mItemInfos[i];
+													if (itemInfo.isEmpty())
+														// Skip
+														continue;
+
+													// Find
+													UInt32	index =
+																	setInternals->getIndex(itemInfo.mHashValue,
+																			*itemInfo.mHashable);
+													if (index < setInternals->mItemInfosCount)
+														// Remove
+														setInternals->removeAt(index);
 												}
 
 												return setInternals;
 											}
 				CSetInternals*			removeAll()
 											{
+												// Check if empty
+												if (mCount == 0)
+													// Nothing to remove
+													return this;
+
 												// Prepare for write
 												CSetInternals*	setInternals = prepareForWrite();
 
-												// Iterate all item infos
-												for (UInt32 i = 0; i < setInternals->mItemInfosCount; i++) {
-													// Check if have an item info
-													if (setInternals->mItemInfos[i] != nil) {
-														// Remove this chain
-														remove(setInternals->mItemInfos[i], mOwnsItems);
-
-														// Clear
-														setInternals->mItemInfos[i] = nil;
-													}
-												}
+												// Remove all
+												setInternals->removeAllInternal();
 
 												// Update info
 												setInternals->mCount = 0;
@@ -249,91 +244,259 @@ class CSetInternals : public TCopyOnWriteReferenceCountable<CSetInternals> {
 
 												return setInternals;
 											}
-				void					remove(SSetItemInfo* itemInfo, bool ownsItems)
+
+				TIteratorS<CHashable>	getIterator() const
+											{
+												// Setup
+												CSetIteratorInfo*	iteratorInfo =
+																			new CSetIteratorInfo(*this, mReference);
+
+												// Find first item info
+												while ((iteratorInfo->mCurrentIndex < mItemInfosCount) &&
+														mItemInfos[iteratorInfo->mCurrentIndex].isEmpty())
+													// Next
+													iteratorInfo->mCurrentIndex++;
+
+												CHashable*	firstValue =
+																	(iteratorInfo->mCurrentIndex < mItemInfosCount) ?
+																			(CHashable*)
+																					mItemInfos[iteratorInfo->
+																							mCurrentIndex].mHashable :
+																			nil;
+
+												return TIteratorS<CHashable>(firstValue, iteratorAdvance,
+														*iteratorInfo);
+											}
+
+										// Private methods
+				UInt32					getHomeIndex(UInt32 hashValue) const
+											{ return (hashValue * 2654435769U) >> mItemInfosShift; }
+				UInt32					getProbeDistance(UInt32 index) const
+											{ return (index - getHomeIndex(mItemInfos[index].mHashValue)) &
+													(mItemInfosCount - 1); }
+				UInt32					getIndex(UInt32 hashValue, const CHashable& hashable) const
+											{
+												// Check if have item infos
+												if (mItemInfosCount == 0)
+													// Nope
+													return 0;
+
+												// Probe from the home index until we pass an item info that is
+												//	closer to its home index than we are to ours
+												UInt32	mask = mItemInfosCount - 1;
+												UInt32	index = getHomeIndex(hashValue);
+												for (UInt32 distance = 0;
+														!mItemInfos[index].isEmpty() &&
+																(distance <= getProbeDistance(index));
+														distance++, index = (index + 1) & mask) {
+													// Check this item info
+													if (mItemInfos[index].doesMatch(hashValue, hashable))
+														// Found
+														return index;
+												}
+
+												return mItemInfosCount;
+											}
+				void					add(UInt32 hashValue, const CHashable* hashable)
+											{
+												// Check if need to grow
+												if (((mCount + 1) * 8) > (mItemInfosCount * 7))
+													// Grow
+													resize(std::max<UInt32>(mItemInfosCount * 2, 8));
+
+												// Insert
+												CSet::ItemInfo	itemInfo = {hashValue, hashable};
+												insertItemInfo(itemInfo);
+
+												// Update info
+												mCount++;
+												mReference++;
+											}
+				void					insertItemInfo(CSet::ItemInfo itemInfo)
 											{
-												// Check for next item info
-												if (itemInfo->mNextItemInfo != nil)
-													// Remove the next item info
-													remove(itemInfo->mNextItemInfo, ownsItems);
+												// Setup
+												UInt32	mask = mItemInfosCount - 1;
+												UInt32	index = getHomeIndex(itemInfo.mHashValue);
+
+												// Probe
+												for (UInt32 distance = 0;; distance++, index = (index + 1) & mask) {
+													// Check if empty
+													if (mItemInfos[index].isEmpty()) {
+														// Store here
+														mItemInfos[index] = itemInfo;
 
-												// Check if owns item
-												if (ownsItems) {
+														return;
+													}
+
+													// Check if the existing item info is closer to its home index
+													//	than we are to ours
+													UInt32	existingDistance = getProbeDistance(index);
+													if (existingDistance < distance) {
+														// Take this slot and continue on with the displaced item info
+														CSet::ItemInfo	displacedItemInfo = mItemInfos[index];
+														mItemInfos[index] = itemInfo;
+														itemInfo = displacedItemInfo;
+														distance = existingDistance;
+													}
+												}
+											}
+				void					removeAt(UInt32 index)
+											{
+												// Check if owns items
+												if (mCopyProc != nil) {
 													// Dispose
-													const	CHashable*	hashable = &itemInfo->mHashable;
+													const	CHashable*	hashable = mItemInfos[index].mHashable;
 													Delete(hashable);
 												}
 
-												// Cleanup this one
-												Delete(itemInfo);
+												// Shift following item infos back until we find an empty one or
+												//	one that is already at its home index
+												UInt32	mask = mItemInfosCount - 1;
+												UInt32	nextIndex = (index + 1) & mask;
+												while (!mItemInfos[nextIndex].isEmpty() &&
+														(getProbeDistance(nextIndex) > 0)) {
+													// Shift back
+													mItemInfos[index] = mItemInfos[nextIndex];
+													index = nextIndex;
+													nextIndex = (nextIndex + 1) & mask;
+												}
+
+												// Clear
+												mItemInfos[index].mHashValue = 0;
+												mItemInfos[index].mHashable = nil;
+
+												// Update info
+												mCount--;
+												mReference++;
 											}
+				void					removeAllInternal()
+											{
+												// Iterate all item infos
+												for (UInt32 i = 0; i < mItemInfosCount; i++) {
+													// Check if have an item info
+													if (!mItemInfos[i].isEmpty()) {
+														// Check if owns items
+														if (mCopyProc != nil) {
+															// Dispose
+															const	CHashable*	hashable = mItemInfos[i].mHashable;
+															Delete(hashable);
+														}
 
-				TIteratorS<CHashable>	getIterator() const
+														// Clear
+														mItemInfos[i].mHashValue = 0;
+														mItemInfos[i].mHashable = nil;
+													}
+												}
+											}
+				CSetInternals*			retain(const CSetInternals& other, bool retainIfContained)
 											{
+												// Prepare for write
+												CSetInternals*	setInternals = prepareForWrite();
+
 												// Setup
-												CSetIteratorInfo*	iteratorInfo =
-																			new CSetIteratorInfo(*this, mReference);
+												CSet::ItemInfo*	previousItemInfos = setInternals->mItemInfos;
+												UInt32			previousItemInfosCount = setInternals->mItemInfosCount;
 
-												// Find first item info
-												while ((mItemInfos[iteratorInfo->mCurrentIndex] == nil) &&
-														(++iteratorInfo->mCurrentIndex < mItemInfosCount)) ;
-
-												CHashable*	firstValue = nil;
-												if (iteratorInfo->mCurrentIndex < mItemInfosCount) {
-													// Have first item info
-													iteratorInfo->mCurrentItemInfo =
-															mItemInfos[iteratorInfo->mCurrentIndex];
-													firstValue =
-															(CHashable*)
-																	&mItemInfos[iteratorInfo->mCurrentIndex]->mHashable;
+												// Rebuild with only the item infos that we are retaining
+												setInternals->mItemInfos =
+														(CSet::ItemInfo*)
+																::calloc(previousItemInfosCount, sizeof(CSet::ItemInfo));
+												setInternals->mCount = 0;
+												setInternals->mReference++;
+												for (UInt32 i = 0; i < previousItemInfosCount; i++) {
+													// Setup
+													const	CSet::ItemInfo&	itemInfo = previousItemInfos[i];
+													if (itemInfo.isEmpty())
+														// Skip
+														continue;
+
+													// Check if retaining
+													bool	isContained =
+																	(other.mCount > 0) &&
+																			(other.getIndex(itemInfo.mHashValue,
+																					*itemInfo.mHashable) <
+																					other.mItemInfosCount);
+													if (isContained == retainIfContained) {
+														// Retain
+														setInternals->insertItemInfo(itemInfo);
+														setInternals->mCount++;
+													} else if (setInternals->mCopyProc != nil) {
+														// Dispose
+														const	CHashable*	hashable = itemInfo.mHashable;
+														Delete(hashable);
+													}
+												}
+
+												// Cleanup
+												::free(previousItemInfos);
+
+												return setInternals;
+											}
+				void					reserve(UInt32 count)
+											{
+												// Check if need to grow
+												UInt32	itemInfosCount = std::max<UInt32>(mItemInfosCount, 8);
+												while ((count * 8) > (itemInfosCount * 7))
+													// Double
+													itemInfosCount *= 2;
+												if (itemInfosCount > mItemInfosCount)
+													// Grow
+													resize(itemInfosCount);
+											}
+				void					resize(UInt32 itemInfosCount)
+											{
+												// Setup
+												CSet::ItemInfo*	previousItemInfos = mItemInfos;
+												UInt32			previousItemInfosCount = mItemInfosCount;
+
+												// Update storage
+												mItemInfos =
+														(CSet::ItemInfo*) ::calloc(itemInfosCount, sizeof(CSet::ItemInfo));
+												mItemInfosCount = itemInfosCount;
+												mItemInfosShift = 32;
+												for (UInt32 count = itemInfosCount; count > 1; count >>= 1)
+													// Next
+													mItemInfosShift--;
+
+												// Reinsert using the cached hash values
+												for (UInt32 i = 0; i < previousItemInfosCount; i++) {
+													// Check if have an item info
+													if (!previousItemInfos[i].isEmpty())
+														// Reinsert
+														insertItemInfo(previousItemInfos[i]);
 												}
 
-												return TIteratorS<CHashable>(firstValue, iteratorAdvance, *iteratorInfo);
+												// Cleanup
+												::free(previousItemInfos);
 											}
 
 		static	void*					iteratorAdvance(CIterator::Info& iteratorInfo)
 											{
 												// Setup
-												CSetIteratorInfo&	setIteratorInfo = (CSetIteratorInfo&) iteratorInfo;
+												CSetIteratorInfo&		setIteratorInfo =
+																				(CSetIteratorInfo&) iteratorInfo;
+												const	CSetInternals&	internals = setIteratorInfo.mInternals;
 
 												// Internals check
-												AssertFailIf(setIteratorInfo.mInitialReference !=
-														setIteratorInfo.mInternals.mReference);
-
-												// Check for additional item info in linked list
-												if (setIteratorInfo.mCurrentItemInfo->mNextItemInfo != nil) {
-													// Have next item info
-													setIteratorInfo.mCurrentItemInfo =
-															setIteratorInfo.mCurrentItemInfo->mNextItemInfo;
-												} else {
-													// End of item info linked list
-													while ((++setIteratorInfo.mCurrentIndex <
-																	setIteratorInfo.mInternals.mItemInfosCount) &&
-															(setIteratorInfo.mInternals.mItemInfos
-																	[setIteratorInfo.mCurrentIndex] ==
-																	nil)) ;
-
-													// Check if found another item info
-													if (setIteratorInfo.mCurrentIndex <
-															setIteratorInfo.mInternals.mItemInfosCount)
-														// Found another item info
-														setIteratorInfo.mCurrentItemInfo =
-																setIteratorInfo.mInternals
-																		.mItemInfos[setIteratorInfo.mCurrentIndex];
-													else
-														// No more item infos
-														setIteratorInfo.mCurrentItemInfo = nil;
-												}
+												AssertFailIf(setIteratorInfo.mInitialReference != internals.mReference);
 
-												return (setIteratorInfo.mCurrentItemInfo != nil) ?
-														(void*) &setIteratorInfo.mCurrentItemInfo->mHashable : nil;
+												// Find next item info
+												while ((++setIteratorInfo.mCurrentIndex < internals.mItemInfosCount) &&
+														internals.mItemInfos[setIteratorInfo.mCurrentIndex].isEmpty()) ;
+
+												return (setIteratorInfo.mCurrentIndex < internals.mItemInfosCount) ?
+														(void*) internals.mItemInfos[setIteratorInfo.mCurrentIndex]
+																.mHashable :
+														nil;
 											}
 
-		bool			mOwnsItems;
+		CSet::CopyProc	mCopyProc;
 		CSet::ItemCount	mCount;
 		UInt32			mReference;
 
-		SSetItemInfo**	mItemInfos;
+		CSet::ItemInfo*	mItemInfos;
 		UInt32			mItemInfosCount;
+		UInt32			mItemInfosShift;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -343,11 +506,11 @@ class CSetInternals : public TCopyOnWriteReferenceCountable<CSetInternals> {
 // MARK: Lifecycle methods
 
 //----------------------------------------------------------------------------------------------------------------------
-CSet::CSet(bool ownsItems)
+CSet::CSet(CopyProc copyProc)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Setup
-	mInternals = new CSetInternals(ownsItems);
+	mInternals = new CSetInternals(copyProc);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -385,6 +548,13 @@ bool CSet::contains(const CHashable& hashable) const
 	return mInternals->contains(hashable);
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+bool CSet::intersects(const CSet& other) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mInternals->intersects(*other.mInternals);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 CSet::ItemCount CSet::getCount() const
 //----------------------------------------------------------------------------------------------------------------------
@@ -392,6 +562,26 @@ CSet::ItemCount CSet::getCount() const
 	return mInternals->mCount;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+CSet& CSet::addFrom(const CSet& other)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Add all
+	mInternals = mInternals->addFrom(*other.mInternals);
+
+	return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CSet& CSet::intersect(const CSet& other)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Intersect
+	mInternals = mInternals->intersect(*other.mInternals);
+
+	return *this;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 CSet& CSet::remove(const CHashable& hashable)
 //----------------------------------------------------------------------------------------------------------------------
@@ -402,6 +592,16 @@ CSet& CSet::remove(const CHashable& hashable)
 	return *this;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+CSet& CSet::removeFrom(const CSet& other)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Remove all
+	mInternals = mInternals->removeFrom(*other.mInternals);
+
+	return *this;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 CSet& CSet::removeAll()
 //----------------------------------------------------------------------------------------------------------------------
@@ -419,6 +619,16 @@ TIteratorS<CHashable> CSet::getIterator() const
 	return mInternals->getIterator();
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+const CSet::ItemInfo* CSet::getItemInfos(UInt32& itemInfosCount) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	itemInfosCount = mInternals->mItemInfosCount;
+
+	return mInternals->mItemInfos;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 CSet& CSet::apply(ApplyProc applyProc, void* userData)
 //----------------------------------------------------------------------------------------------------------------------
@@ -6,6 +6,7 @@
 
 #include "CArray.h"
 #include "CHashing.h"
+#include "TReferenceTracking.h"
 
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: CSet
@@ -18,7 +19,56 @@ class CSet {
 
 	// Procs
 	public:
-		typedef	void	(*ApplyProc)(CHashable& hashable, void* userData);
+		typedef	void		(*ApplyProc)(CHashable& hashable, void* userData);
+		typedef	CHashable*	(*CopyProc)(const CHashable& hashable);
+
+	// Structs
+	public:
+		struct ItemInfo {
+					// Instance methods
+			bool	isEmpty() const
+						{ return mHashable == nil; }
+			bool	doesMatch(UInt32 hashValue, const CHashable& hashable) const
+						{ return (hashValue == mHashValue) && (mHashable != nil) && (hashable == *mHashable); }
+
+			// Properties
+					UInt32		mHashValue;
+			const	CHashable*	mHashable;
+		};
+
+	// Iterator
+	public:
+		// Walks the item infos directly and does not allocate.  The set must not be modified while iterating.
+		template <typename T> class TIterator {
+			// Methods
+			public:
+							// Lifecycle methods
+							TIterator(const ItemInfo* itemInfo, const ItemInfo* endItemInfo) :
+								mItemInfo(itemInfo), mEndItemInfo(endItemInfo)
+								{ skipEmpty(); }
+
+							// Instance methods
+				T&			operator*() const
+								{ return *((T*) mItemInfo->mHashable); }
+				T*			operator->() const
+								{ return (T*) mItemInfo->mHashable; }
+				TIterator&	operator++()
+								{ mItemInfo++; skipEmpty(); return *this; }
+				bool		operator==(const TIterator& other) const
+								{ return mItemInfo == other.mItemInfo; }
+				bool		operator!=(const TIterator& other) const
+								{ return mItemInfo != other.mItemInfo; }
+
+			private:
+							// Private methods
+				void		skipEmpty()
+								{ while ((mItemInfo != mEndItemInfo) && mItemInfo->isEmpty()) mItemInfo++; }
+
+			// Properties
+			private:
+				const	ItemInfo*	mItemInfo;
+				const	ItemInfo*	mEndItemInfo;
+		};
 
 	// Methods
 	public:
@@ -31,19 +81,24 @@ class CSet {
 											{ return getCount() == 0; }
 
 				bool					contains(const CHashable& hashable) const;
+				bool					intersects(const CSet& other) const;
 
 	protected:
 										// Lifecycle methods
-										CSet(bool ownsItems = false);
+										CSet(CopyProc copyProc = nil);
 										CSet(const CSet& other);
 
 										// Instance methods
 				CSet&					add(const CHashable* hashable);
+				CSet&					addFrom(const CSet& other);
+				CSet&					intersect(const CSet& other);
 
 				CSet&					remove(const CHashable& hashable);
+				CSet&					removeFrom(const CSet& other);
 				CSet&					removeAll();
 
 				TIteratorS<CHashable>	getIterator() const;
+		const	ItemInfo*				getItemInfos(UInt32& itemInfosCount) const;
 				CSet&					apply(ApplyProc applyProc, void* userData = nil);
 
 				CSet&					operator=(const CSet& other);
@@ -64,12 +119,12 @@ template <typename T> class TSet : public CSet {
 	// Methods
 	public:
 						// Lifecycle methods
-						TSet() : CSet(true) {}
+						TSet() : CSet(copy) {}
 						TSet(const T& item) :
-							CSet(true)
+							CSet(copy)
 							{ CSet::add(new T(item)); }
 						TSet(const TArray<T>& array) :
-							CSet(true)
+							CSet(copy)
 							{
 								// Iterate all
 								for (TIteratorD<T> iterator = array.getIterator(); iterator.hasValue();
@@ -78,7 +133,7 @@ template <typename T> class TSet : public CSet {
 									CSet::add(new T(*iterator));
 							}
 						TSet(const CArray& array, T (mappingProc)(CArray::ItemRef item)) :
-							CSet(true)
+							CSet(copy)
 							{
 								// Iterate all items
 								ItemCount	count = array.getCount();
@@ -88,7 +143,7 @@ template <typename T> class TSet : public CSet {
 							}
 						TSet(const TSet<T>& other) : CSet(other) {}
 						TSet(const TSet<T>& other, IsIncludedProc isIncludedProc, void* userData) :
-							CSet(true)
+							CSet(copy)
 							{
 								// Iterate all items
 								for (TIteratorS<T> iterator = other.getIterator(); iterator.hasValue();
@@ -116,28 +171,9 @@ template <typename T> class TSet : public CSet {
 								return *this;
 							}
 		TSet<T>&		addFrom(const TSet<T>& other)
-							{
-								// Iterate all
-								for (TIteratorS<T> iterator = other.getIterator(); iterator.hasValue();
-										iterator.advance())
-									// Add
-									CSet::add(new T(*iterator));
-
-								return *this;
-							}
-		bool			intersects(const TSet<T>& other) const
-							{
-								// Iterate values
-								for (TIteratorS<T> iterator = other.getIterator(); iterator.hasValue();
-										iterator.advance()) {
-									// Check if have value
-									if (contains(*iterator))
-										// Has value
-										return true;
-								}
-
-								return false;
-							}
+							{ CSet::addFrom(other); return *this; }
+		TSet<T>&		intersect(const TSet<T>& other)
+							{ CSet::intersect(other); return *this; }
 
 		TSet<T>&		remove(const T item)
 							{ CSet::remove(item); return *this; }
@@ -152,15 +188,7 @@ template <typename T> class TSet : public CSet {
 								return *this;
 							}
 		TSet<T>&		removeFrom(const TSet<T>& other)
-							{
-								// Iterate all
-								for (TIteratorS<T> iterator = other.getIterator(); iterator.hasValue();
-										iterator.advance())
-									// Add
-									CSet::remove(T(*iterator));
-
-								return *this;
-							}
+							{ CSet::removeFrom(other); return *this; }
 		TSet<T>&		removeAll()
 							{ CSet::removeAll(); return *this; }
 
@@ -170,6 +198,22 @@ template <typename T> class TSet : public CSet {
 		TIteratorS<T>	getIterator() const
 							{ TIteratorS<CHashable> iterator = CSet::getIterator();
 									return TIteratorS<T>((TIteratorS<T>*) &iterator); }
+		TIterator<T>	begin() const
+							{
+								// Setup
+										UInt32		itemInfosCount;
+								const	ItemInfo*	itemInfos = getItemInfos(itemInfosCount);
+
+								return TIterator<T>(itemInfos, itemInfos + itemInfosCount);
+							}
+		TIterator<T>	end() const
+							{
+								// Setup
+										UInt32		itemInfosCount;
+								const	ItemInfo*	itemInfos = getItemInfos(itemInfosCount);
+
+								return TIterator<T>(itemInfos + itemInfosCount, itemInfos + itemInfosCount);
+							}
 
 		TSet<T>&		operator=(const TSet<T>& other)
 							{ CSet::operator=(other); return *this; }
@@ -181,4 +225,509 @@ template <typename T> class TSet : public CSet {
 							{ return remove(item); }
 		TSet<T>&		operator-=(const TSet<T>& other)
 							{ return removeFrom(other); }
+
+	private:
+						// Class methods
+		static	CHashable*	copy(const CHashable& hashable)
+								{ return new T((const T&) hashable); }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - TNumericSet
+//	TNumericSet stores numeric values (UInt32, UInt64, OSType, etc) inline in an open-addressing table.  There is no
+//		per-item allocation or CHashable boxing, and the bulk operations run in linear time.
+
+template <typename T> class TNumericSet {
+	// ItemInfo
+	private:
+		struct ItemInfo {
+			// Instance methods
+			bool	isEmpty() const
+						{ return mHashValue == 0; }
+
+			// Properties
+			T		mValue;
+			UInt32	mHashValue;
+		};
+
+	// Internals
+	private:
+		class Internals : public TCopyOnWriteReferenceCountable<Internals> {
+			public:
+										Internals() :
+											TCopyOnWriteReferenceCountable<Internals>(),
+													mCount(0), mReference(0), mItemInfos(nil), mItemInfosCount(0),
+													mItemInfosShift(32)
+											{}
+										Internals(const Internals& other) :
+											TCopyOnWriteReferenceCountable<Internals>(),
+													mCount(other.mCount), mReference(0), mItemInfos(nil),
+													mItemInfosCount(other.mItemInfosCount),
+													mItemInfosShift(other.mItemInfosShift)
+											{
+												// Check if have item infos
+												if (mItemInfosCount > 0) {
+													// Copy layout as-is
+													mItemInfos =
+															(ItemInfo*) ::malloc(mItemInfosCount * sizeof(ItemInfo));
+													::memcpy(mItemInfos, other.mItemInfos,
+															mItemInfosCount * sizeof(ItemInfo));
+												}
+											}
+										~Internals()
+											{ ::free(mItemInfos); }
+
+						Internals*		add(T value)
+											{
+												// Prepare for write
+												Internals*	internals = this->prepareForWrite();
+
+												// Check if already have
+												UInt32	hashValue = getHashValue(value);
+												if (internals->getIndex(hashValue, value) == internals->mItemInfosCount)
+													// Add
+													internals->add(hashValue, value);
+
+												return internals;
+											}
+						Internals*		addFrom(const Internals& other)
+											{
+												// Check if anything to do
+												if ((this == &other) || (other.mCount == 0))
+													// Nothing to do
+													return this;
+
+												// Prepare for write
+												Internals*	internals = this->prepareForWrite();
+
+												// Make room for the worst case up front so we grow at most once
+												internals->reserve(internals->mCount + other.mCount);
+
+												// Iterate other item infos
+												for (UInt32 i = 0; i < other.mItemInfosCount; i++) {
+													// Setup
+													const	ItemInfo&	itemInfo = other.mItemInfos[i];
+
+													// Check if need to add
+													if (!itemInfo.isEmpty() &&
+															(internals->getIndex(itemInfo.mHashValue,
+																	itemInfo.mValue) == internals->mItemInfosCount))
+														// Add
+														internals->add(itemInfo.mHashValue, itemInfo.mValue);
+												}
+
+												return internals;
+											}
+						bool			contains(T value) const
+											{ return (mCount > 0) &&
+													(getIndex(getHashValue(value), value) < mItemInfosCount); }
+						bool			intersects(const Internals& other) const
+											{
+												// Iterate the smaller and probe the larger
+												const	Internals&	smaller = (mCount <= other.mCount) ? *this : other;
+												const	Internals&	larger = (mCount <= other.mCount) ? other : *this;
+												for (UInt32 i = 0;
+														(smaller.mCount > 0) && (i < smaller.mItemInfosCount); i++) {
+													// Setup
+													const	ItemInfo&	itemInfo = smaller.mItemInfos[i];
+
+													// Check if larger has this item
+													if (!itemInfo.isEmpty() &&
+															(larger.getIndex(itemInfo.mHashValue, itemInfo.mValue) <
+																	larger.mItemInfosCount))
+														// Yes
+														return true;
+												}
+
+												return false;
+											}
+						Internals*		intersect(const Internals& other)
+											{ return ((this == &other) || (mCount == 0)) ? this : retain(other, true); }
+						Internals*		remove(T value)
+											{
+												// Check if empty
+												if (mCount == 0)
+													// Nothing to remove
+													return this;
+
+												// Prepare for write
+												Internals*	internals = this->prepareForWrite();
+
+												// Find
+												UInt32	index = internals->getIndex(getHashValue(value), value);
+												if (index < internals->mItemInfosCount)
+													// Remove
+													internals->removeAt(index);
+
+												return internals;
+											}
+						Internals*		removeFrom(const Internals& other)
+											{
+												// Check situation
+												if ((mCount == 0) || (other.mCount == 0))
+													// Nothing to remove
+													return this;
+												else if (this == &other)
+													// Remove everything
+													return removeAll();
+												else if (other.mCount > mCount)
+													// Faster to filter ourselves against the other
+													return retain(other, false);
+
+												// Prepare for write
+												Internals*	internals = this->prepareForWrite();
+
+												// Iterate other item infos
+												for (UInt32 i = 0; i < other.mItemInfosCount; i++) {
+													// Setup
+													const	ItemInfo&	itemInfo = other.mItemInfos[i];
+													if (itemInfo.isEmpty())
+														// Skip
+														continue;
+
+													// Find
+													UInt32	index =
+																	internals->getIndex(itemInfo.mHashValue,
+																			itemInfo.mValue);
+													if (index < internals->mItemInfosCount)
+														// Remove
+														internals->removeAt(index);
+												}
+
+												return internals;
+											}
+						Internals*		removeAll()
+											{
+												// Check if empty
+												if (mCount == 0)
+													// Nothing to remove
+													return this;
+
+												// Prepare for write
+												Internals*	internals = this->prepareForWrite();
+
+												// Remove all
+												::memset(internals->mItemInfos, 0,
+														internals->mItemInfosCount * sizeof(ItemInfo));
+												internals->mCount = 0;
+												internals->mReference++;
+
+												return internals;
+											}
+
+										// Private methods
+						UInt32			getHomeIndex(UInt32 hashValue) const
+											{ return (hashValue * 2654435769U) >> mItemInfosShift; }
+						UInt32			getProbeDistance(UInt32 index) const
+											{ return (index - getHomeIndex(mItemInfos[index].mHashValue)) &
+													(mItemInfosCount - 1); }
+						UInt32			getIndex(UInt32 hashValue, T value) const
+											{
+												// Check if have item infos
+												if (mItemInfosCount == 0)
+													// Nope
+													return 0;
+
+												// Probe from the home index until we pass an item info that is
+												//	closer to its home index than we are to ours
+												UInt32	mask = mItemInfosCount - 1;
+												UInt32	index = getHomeIndex(hashValue);
+												for (UInt32 distance = 0;
+														!mItemInfos[index].isEmpty() &&
+																(distance <= getProbeDistance(index));
+														distance++, index = (index + 1) & mask) {
+													// Check this item info
+													if (mItemInfos[index].mValue == value)
+														// Found
+														return index;
+												}
+
+												return mItemInfosCount;
+											}
+						void			add(UInt32 hashValue, T value)
+											{
+												// Check if need to grow
+												if (((mCount + 1) * 8) > (mItemInfosCount * 7))
+													// Grow
+													resize(std::max<UInt32>(mItemInfosCount * 2, 8));
+
+												// Insert
+												ItemInfo	itemInfo = {value, hashValue};
+												insertItemInfo(itemInfo);
+
+												// Update info
+												mCount++;
+												mReference++;
+											}
+						void			insertItemInfo(ItemInfo itemInfo)
+											{
+												// Setup
+												UInt32	mask = mItemInfosCount - 1;
+												UInt32	index = getHomeIndex(itemInfo.mHashValue);
+
+												// Probe
+												for (UInt32 distance = 0;; distance++, index = (index + 1) & mask) {
+													// Check if empty
+													if (mItemInfos[index].isEmpty()) {
+														// Store here
+														mItemInfos[index] = itemInfo;
+
+														return;
+													}
+
+													// Check if the existing item info is closer to its home index
+													//	than we are to ours
+													UInt32	existingDistance = getProbeDistance(index);
+													if (existingDistance < distance) {
+														// Take this slot and continue on with the displaced item info
+														ItemInfo	displacedItemInfo = mItemInfos[index];
+														mItemInfos[index] = itemInfo;
+														itemInfo = displacedItemInfo;
+														distance = existingDistance;
+													}
+												}
+											}
+						void			removeAt(UInt32 index)
+											{
+												// Shift following item infos back until we find an empty one or
+												//	one that is already at its home index
+												UInt32	mask = mItemInfosCount - 1;
+												UInt32	nextIndex = (index + 1) & mask;
+												while (!mItemInfos[nextIndex].isEmpty() &&
+														(getProbeDistance(nextIndex) > 0)) {
+													// Shift back
+													mItemInfos[index] = mItemInfos[nextIndex];
+													index = nextIndex;
+													nextIndex = (nextIndex + 1) & mask;
+												}
+
+												// Clear
+												mItemInfos[index].mHashValue = 0;
+
+												// Update info
+												mCount--;
+												mReference++;
+											}
+						Internals*		retain(const Internals& other, bool retainIfContained)
+											{
+												// Prepare for write
+												Internals*	internals = this->prepareForWrite();
+
+												// Setup
+												ItemInfo*	previousItemInfos = internals->mItemInfos;
+												UInt32		previousItemInfosCount = internals->mItemInfosCount;
+
+												// Rebuild with only the item infos that we are retaining
+												internals->mItemInfos =
+														(ItemInfo*) ::calloc(previousItemInfosCount, sizeof(ItemInfo));
+												internals->mCount = 0;
+												internals->mReference++;
+												for (UInt32 i = 0; i < previousItemInfosCount; i++) {
+													// Setup
+													const	ItemInfo&	itemInfo = previousItemInfos[i];
+
+													// Check if retaining
+													if (!itemInfo.isEmpty() &&
+															(other.contains(itemInfo.mValue) == retainIfContained)) {
+														// Retain
+														internals->insertItemInfo(itemInfo);
+														internals->mCount++;
+													}
+												}
+
+												// Cleanup
+												::free(previousItemInfos);
+
+												return internals;
+											}
+						void			reserve(UInt32 count)
+											{
+												// Check if need to grow
+												UInt32	itemInfosCount = std::max<UInt32>(mItemInfosCount, 8);
+												while ((count * 8) > (itemInfosCount * 7))
+													// Double
+													itemInfosCount *= 2;
+												if (itemInfosCount > mItemInfosCount)
+													// Grow
+													resize(itemInfosCount);
+											}
+						void			resize(UInt32 itemInfosCount)
+											{
+												// Setup
+												ItemInfo*	previousItemInfos = mItemInfos;
+												UInt32		previousItemInfosCount = mItemInfosCount;
+
+												// Update storage
+												mItemInfos = (ItemInfo*) ::calloc(itemInfosCount, sizeof(ItemInfo));
+												mItemInfosCount = itemInfosCount;
+												mItemInfosShift = 32;
+												for (UInt32 count = itemInfosCount; count > 1; count >>= 1)
+													// Next
+													mItemInfosShift--;
+
+												// Reinsert using the cached hash values
+												for (UInt32 i = 0; i < previousItemInfosCount; i++) {
+													// Check if have an item info
+													if (!previousItemInfos[i].isEmpty())
+														// Reinsert
+														insertItemInfo(previousItemInfos[i]);
+												}
+
+												// Cleanup
+												::free(previousItemInfos);
+											}
+
+										// Class methods
+				static	UInt32			getHashValue(T value)
+											{
+												// Mix all the bits (64-bit finalizer from MurmurHash3).  0 is
+												//	reserved to mark an empty item info.
+												UInt64	bits = (UInt64) value;
+												bits ^= bits >> 33;
+												bits *= 0xFF51AFD7ED558CCDULL;
+												bits ^= bits >> 33;
+
+												return (UInt32) bits | 1;
+											}
+
+				CSet::ItemCount	mCount;
+				UInt32			mReference;
+
+				ItemInfo*		mItemInfos;
+				UInt32			mItemInfosCount;
+				UInt32			mItemInfosShift;
+		};
+
+	// IteratorInfo
+	private:
+		class IteratorInfo : public CIterator::Info {
+			// Methods
+			public:
+									// Lifecycle methods
+									IteratorInfo(const Internals& internals, UInt32 currentIndex = 0) :
+										CIterator::Info(),
+												mInternals(internals), mInitialReference(internals.mReference),
+												mCurrentIndex(currentIndex)
+										{}
+
+									// CIterator::Info methods
+				CIterator::Info*	copy()
+										{ return new IteratorInfo(mInternals, mCurrentIndex); }
+
+			// Properties
+			const	Internals&	mInternals;
+					UInt32		mInitialReference;
+					UInt32		mCurrentIndex;
+		};
+
+	// Methods
+	public:
+							// Lifecycle methods
+							TNumericSet() : mInternals(new Internals()) {}
+							TNumericSet(T value) : mInternals(new Internals()) { mInternals = mInternals->add(value); }
+							TNumericSet(const TNumericArray<T>& array) :
+								mInternals(new Internals())
+								{ addFrom(array); }
+							TNumericSet(const TNumericSet<T>& other) : mInternals(other.mInternals->addReference()) {}
+							~TNumericSet()
+								{ mInternals->removeReference(); }
+
+							// Instance methods
+		CSet::ItemCount		getCount() const
+								{ return mInternals->mCount; }
+		bool				isEmpty() const
+								{ return mInternals->mCount == 0; }
+
+		bool				contains(T value) const
+								{ return mInternals->contains(value); }
+		bool				intersects(const TNumericSet<T>& other) const
+								{ return mInternals->intersects(*other.mInternals); }
+
+		TNumericSet<T>&		add(T value)
+								{ mInternals = mInternals->add(value); return *this; }
+		TNumericSet<T>&		addFrom(const TNumericArray<T>& array)
+								{
+									// Iterate all
+									CArray::ItemCount	count = array.getCount();
+									for (CArray::ItemIndex i = 0; i < count; i++)
+										// Add
+										mInternals = mInternals->add(array.getAt(i));
+
+									return *this;
+								}
+		TNumericSet<T>&		addFrom(const TNumericSet<T>& other)
+								{ mInternals = mInternals->addFrom(*other.mInternals); return *this; }
+		TNumericSet<T>&		intersect(const TNumericSet<T>& other)
+								{ mInternals = mInternals->intersect(*other.mInternals); return *this; }
+
+		TNumericSet<T>&		remove(T value)
+								{ mInternals = mInternals->remove(value); return *this; }
+		TNumericSet<T>&		removeFrom(const TNumericSet<T>& other)
+								{ mInternals = mInternals->removeFrom(*other.mInternals); return *this; }
+		TNumericSet<T>&		removeAll()
+								{ mInternals = mInternals->removeAll(); return *this; }
+
+		TIteratorS<T>		getIterator() const
+								{
+									// Setup
+									IteratorInfo*	iteratorInfo = new IteratorInfo(*mInternals);
+
+									// Find first item info
+									while ((iteratorInfo->mCurrentIndex < mInternals->mItemInfosCount) &&
+											mInternals->mItemInfos[iteratorInfo->mCurrentIndex].isEmpty())
+										// Next
+										iteratorInfo->mCurrentIndex++;
+
+									T*	firstValue =
+												(iteratorInfo->mCurrentIndex < mInternals->mItemInfosCount) ?
+														&mInternals->mItemInfos[iteratorInfo->mCurrentIndex].mValue :
+														nil;
+
+									return TIteratorS<T>(firstValue, iteratorAdvance, *iteratorInfo);
+								}
+
+		TNumericSet<T>&		operator=(const TNumericSet<T>& other)
+								{
+									// Check if assignment to self
+									if (this == &other)
+										return *this;
+
+									// Update reference
+									mInternals->removeReference();
+									mInternals = other.mInternals->addReference();
+
+									return *this;
+								}
+		TNumericSet<T>&		operator+=(T value)
+								{ return add(value); }
+		TNumericSet<T>&		operator+=(const TNumericSet<T>& other)
+								{ return addFrom(other); }
+		TNumericSet<T>&		operator-=(T value)
+								{ return remove(value); }
+		TNumericSet<T>&		operator-=(const TNumericSet<T>& other)
+								{ return removeFrom(other); }
+
+	private:
+							// Class methods
+		static	void*		iteratorAdvance(CIterator::Info& iteratorInfo)
+								{
+									// Setup
+									IteratorInfo&		numericSetIteratorInfo = (IteratorInfo&) iteratorInfo;
+									const	Internals&	internals = numericSetIteratorInfo.mInternals;
+
+									// Internals check
+									AssertFailIf(numericSetIteratorInfo.mInitialReference != internals.mReference);
+
+									// Find next item info
+									while ((++numericSetIteratorInfo.mCurrentIndex < internals.mItemInfosCount) &&
+											internals.mItemInfos[numericSetIteratorInfo.mCurrentIndex].isEmpty()) ;
+
+									return (numericSetIteratorInfo.mCurrentIndex < internals.mItemInfosCount) ?
+											(void*) &internals.mItemInfos[numericSetIteratorInfo.mCurrentIndex].mValue :
+											nil;
+								}
+
+	// Properties
+	private:
+		Internals*	mInternals;
 };
@@ -4,6 +4,8 @@
 
 #include "CString.h"
 
+#include "ConcurrencyPrimitives.h"
+
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: Local data
 
@@ -15,6 +17,92 @@ const	UInt64	kDisplayAsKiBThreshhold = 4097;
 const	UInt64	kDisplayAsMiBThreshHold = 1000 * 1024;
 const	UInt64	kDisplayAsGiBThreshHold = 1024 * 1024 * 1024;
 
+static	const	UInt32	kInternTableInitialCapacity = 256;
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CStringInternTable
+
+/*
+	Open-addressed table of interned strings, keyed by their hash values.  Interned strings are never removed.
+ */
+
+class CStringInternTable {
+	// Structs
+	public:
+		struct Entry {
+			UInt32			mHashValue;
+			const	CString*	mString;
+		};
+
+	// Methods
+	public:
+							// Lifecycle methods
+							CStringInternTable() :
+								mEntries((Entry*) ::calloc(kInternTableInitialCapacity, sizeof(Entry))),
+										mCapacity(kInternTableInitialCapacity), mCount(0)
+								{}
+
+							// Instance methods
+		const	CString*	get(UInt32 hashValue, const CString& string) const
+								{
+									// Probe
+									for (UInt32 index = hashValue & (mCapacity - 1); mEntries[index].mString != nil;
+											index = (index + 1) & (mCapacity - 1)) {
+										// Check this entry
+										if ((mEntries[index].mHashValue == hashValue) &&
+												(*mEntries[index].mString == string))
+											// Found
+											return mEntries[index].mString;
+									}
+
+									return nil;
+								}
+				void		add(UInt32 hashValue, const CString* string)
+								{
+									// Check if need to grow (keep load at or under 50%)
+									if ((mCount + 1) * 2 > mCapacity) {
+										// Grow
+										Entry*	entries = mEntries;
+										UInt32	capacity = mCapacity;
+
+										mEntries = (Entry*) ::calloc(mCapacity * 2, sizeof(Entry));
+										mCapacity *= 2;
+										for (UInt32 i = 0; i < capacity; i++) {
+											// Check if have entry
+											if (entries[i].mString != nil)
+												// Reinsert
+												store(entries[i]);
+										}
+										::free(entries);
+									}
+
+									// Add
+									Entry	entry = {hashValue, string};
+									store(entry);
+									mCount++;
+								}
+
+	private:
+				void		store(const Entry& entry)
+								{
+									// Find empty slot
+									UInt32	index = entry.mHashValue & (mCapacity - 1);
+									while (mEntries[index].mString != nil)
+										index = (index + 1) & (mCapacity - 1);
+									mEntries[index] = entry;
+								}
+
+	// Properties
+	public:
+		CLock	mLock;
+
+	private:
+		Entry*	mEntries;
+		UInt32	mCapacity;
+		UInt32	mCount;
+};
+
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - CString
@@ -44,7 +132,7 @@ CString	CString::mNewlineLinefeed(OSSTR("\n\r"));
 // MARK: Lifecycle methods
 
 //----------------------------------------------------------------------------------------------------------------------
-CString::CString(UInt64 value, SpecialFormattingOptions options) : CHashable()
+CString::CString(UInt64 value, SpecialFormattingOptions options) : CHashable(), mHashValue(0)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Init
@@ -234,6 +322,21 @@ CString::CString(UInt64 value, SpecialFormattingOptions options) : CHashable()
 
 // MARK: Instance methods
 
+//----------------------------------------------------------------------------------------------------------------------
+UInt32 CString::getHashValue() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if need to compute (racing readers compute the same value, so relaxed access is enough)
+	UInt32	hashValue = mHashValue.load(std::memory_order_relaxed);
+	if (hashValue == 0) {
+		// Compute and cache
+		hashValue = CHashable::getHashValue();
+		((CString*) this)->mHashValue.store(hashValue, std::memory_order_relaxed);
+	}
+
+	return hashValue;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 SInt8 CString::getSInt8(UInt8 base) const
 //----------------------------------------------------------------------------------------------------------------------
@@ -421,3 +524,29 @@ CString CString::make(const char* format, ...)
 
 	return string;
 }
+
+//----------------------------------------------------------------------------------------------------------------------
+const CString& CString::intern(const CString& string)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	static	CStringInternTable*	sInternTable = new CStringInternTable();
+
+	UInt32	hashValue = string.getHashValue();
+
+	// Check if already interned
+	sInternTable->mLock.lock();
+	const	CString*	internedString = sInternTable->get(hashValue, string);
+	if (internedString == nil) {
+		// Intern
+		CString*	newString = new CString(string);
+#if TARGET_OS_LINUX
+		newString->makeInterned();
+#endif
+		sInternTable->add(hashValue, newString);
+		internedString = newString;
+	}
+	sInternTable->mLock.unlock();
+
+	return *internedString;
+}
@@ -7,6 +7,8 @@
 #include "CArray.h"
 #include "CHashing.h"
 
+#include <atomic>
+
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: Native strings
 
@@ -14,6 +16,10 @@
 	#define OSStringType	CFStringRef
 	#define OSStringVar(s)	CFStringRef s
 	#define	OSSTR(s)		CFSTR(s)
+#elif TARGET_OS_LINUX
+	#define OSStringType	const char*
+	#define OSStringVar(s)	const char s[]
+	#define OSSTR(s)		s
 #elif TARGET_OS_WINDOWS
 	#define OSStringType	const TCHAR*
 	#define OSStringVar(s)	const TCHAR s[]
@@ -202,7 +208,9 @@ class CString : public CHashable {
 										// Lifecycle methods
 										CString();
 										CString(const CString& other, OV<Length> length = OV<Length>());
+#if !TARGET_OS_LINUX
 										CString(OSStringVar(initialString), OV<Length> length = OV<Length>());
+#endif
 										CString(const char* chars, Length charsCount = ~0,
 												Encoding encoding = kEncodingTextDefault);
 										CString(const UTF16Char* chars, Length charsCount,
@@ -242,8 +250,14 @@ class CString : public CHashable {
 											{ return equals((const CString&) other); }
 
 										// CHashable methods
+#if TARGET_OS_LINUX
+						void			hashInto(CHasher& hasher) const
+											{ hasher.add(getChars(), mByteCount); }
+#else
 						void			hashInto(CHasher& hasher) const
 											{ getCString().hashInto(hasher); }
+#endif
+						UInt32			getHashValue() const;
 
 										// Instance methods
 						OSStringType	getOSString() const;
@@ -336,12 +350,26 @@ class CString : public CHashable {
 
 		static			CString			make(const char* format, ...);
 		static			CString			make(const char* format, va_list args);
+		static	const	CString&		intern(const CString& string);
 		static			bool			isCharacterInSet(UTF32Char utf32Char, CharacterSet characterSet);
 
 	protected:
 										// Internal methods
 						void			init();
 
+#if TARGET_OS_LINUX
+	private:
+										// Internal methods
+				const	char*			getChars() const
+											{ return (mHeapChars != nil) ? mHeapChars : mInlineChars; }
+						void			set(const char* chars, Length byteCount, Length length);
+						void			set(const CString& other);
+						void			append(const char* chars, Length byteCount, Length length);
+						Length			getByteIndex(CharIndex charIndex) const;
+						CharIndex		getCharIndex(Length byteIndex) const;
+						void			makeInterned();
+#endif
+
 	// Properties
 	public:
 		static			CString		mEmpty;
@@ -358,8 +386,19 @@ class CString : public CHashable {
 		static			CString		mPlatformDefaultNewline;
 		
 	private:
+						std::atomic<UInt32>			mHashValue;		// 0 until computed (may be cached by any reader)
 #if TARGET_OS_IOS || TARGET_OS_MACOS || TARGET_OS_TVOS || TARGET_OS_WATCHOS
 						CFStringRef					mStringRef;
+#elif TARGET_OS_LINUX
+		// UTF-8 storage (OS strings are UTF-8 and go through the char constructor).  Strings of up to 22 bytes are
+		//	stored inline, longer ones on the heap.  Length is in UTF-16 units to match the other platforms, and equals
+		//	the byte count when the string is all ASCII.  Heap chars with no capacity are interned storage that is
+		//	never freed and is shared by all copies.
+						char*						mHeapChars;
+						Length						mHeapCapacity;
+						Length						mByteCount;
+						Length						mLength;
+						char						mInlineChars[23];
 #elif TARGET_OS_WINDOWS
 						std::basic_string<TCHAR>	mString;
 #endif
@@ -111,6 +111,15 @@ CUUID::~CUUID()
 	mInternals->removeReference();
 }
 
+// MARK: CHashable methods
+
+//----------------------------------------------------------------------------------------------------------------------
+void CUUID::hashInto(CHasher& hasher) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	hasher.add(&mInternals->mUUIDBytes, sizeof(Bytes));
+}
+
 // MARK: Instance methods
 
 //----------------------------------------------------------------------------------------------------------------------
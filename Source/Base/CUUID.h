@@ -41,8 +41,7 @@ class CUUID : public CHashable {
 							{ return equals((const CUUID&) other); }
 
 						// CHashable methods
-				void	hashInto(CHasher& hasher) const
-							{ getBase64String().hashInto(hasher); }
+				void	hashInto(CHasher& hasher) const;
 
 						// Instance methods
 				CData	getData() const;
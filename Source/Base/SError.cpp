@@ -11,3 +11,4 @@
 
 SError	SError::mUnimplemented(CString(OSSTR("SError")), 1, CString(OSSTR("Unimplemented")));
 SError	SError::mEndOfData(CString(OSSTR("SError")), 2, CString(OSSTR("End of Data")));
+SError	SError::mCancelled(CString(OSSTR("SError")), 3, CString(OSSTR("Cancelled")));
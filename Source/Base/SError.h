@@ -35,6 +35,7 @@ struct SError {
 	public:
 		static	SError	mUnimplemented;
 		static	SError	mEndOfData;
+		static	SError	mCancelled;
 
 	private:
 				CString	mDomain;
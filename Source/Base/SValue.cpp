@@ -7,7 +7,25 @@
 #include "CDictionary.h"
 
 //----------------------------------------------------------------------------------------------------------------------
-// MARK: SValue
+// MARK: Local procs
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T> static void sDispose(T*& t, bool isInArena)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if in arena
+	if (isInArena) {
+		// Storage is owned by the arena
+		t->~T();
+		t = nil;
+	} else
+		// Delete
+		Delete(t);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - SValue
 
 // MARK: Properties
 
@@ -16,123 +34,144 @@ SValue	SValue::mEmpty;
 // MARK: Lifecycle methods
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue() : mType(kEmpty), mValue(false)
+SValue::SValue() : mType(kEmpty), mPayloadIsInArena(false), mValue(false)
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(bool value) : mType(kBool), mValue(value)
+SValue::SValue(bool value) : mType(kBool), mPayloadIsInArena(false), mValue(value)
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(const TArray<CDictionary>& value) : mType(kArrayOfDictionaries), mValue(new TArray<CDictionary>(value))
+SValue::SValue(const TArray<CDictionary>& value) :
+	mType(kArrayOfDictionaries), mPayloadIsInArena(false), mValue(new TArray<CDictionary>(value))
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(const TArray<CString>& value) : mType(kArrayOfStrings), mValue(new TArray<CString>(value))
+SValue::SValue(const TArray<CString>& value) :
+	mType(kArrayOfStrings), mPayloadIsInArena(false), mValue(new TArray<CString>(value))
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(const CData& value) : mType(kData), mValue(new CData(value))
+SValue::SValue(const CData& value) : mType(kData), mPayloadIsInArena(false), mValue(new CData(value))
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(const CDictionary& value) : mType(kDictionary), mValue(new CDictionary(value))
+SValue::SValue(const CDictionary& value) :
+	mType(kDictionary), mPayloadIsInArena(false), mValue(new CDictionary(value))
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(const CString& value) : mType(kString), mValue(new CString(value))
+SValue::SValue(const CString& value) : mType(kString), mPayloadIsInArena(false), mValue(new CString(value))
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(Float32 value) : mType(kFloat32), mValue(value)
+SValue::SValue(Float32 value) : mType(kFloat32), mPayloadIsInArena(false), mValue(value)
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(Float64 value) : mType(kFloat64), mValue(value)
+SValue::SValue(Float64 value) : mType(kFloat64), mPayloadIsInArena(false), mValue(value)
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(SInt8 value) : mType(kSInt8), mValue(value)
+SValue::SValue(SInt8 value) : mType(kSInt8), mPayloadIsInArena(false), mValue(value)
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(SInt16 value) : mType(kSInt16), mValue(value)
+SValue::SValue(SInt16 value) : mType(kSInt16), mPayloadIsInArena(false), mValue(value)
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(SInt32 value) : mType(kSInt32), mValue(value)
+SValue::SValue(SInt32 value) : mType(kSInt32), mPayloadIsInArena(false), mValue(value)
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(SInt64 value) : mType(kSInt64), mValue(value)
+SValue::SValue(SInt64 value) : mType(kSInt64), mPayloadIsInArena(false), mValue(value)
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(UInt8 value) : mType(kUInt8), mValue(value)
+SValue::SValue(UInt8 value) : mType(kUInt8), mPayloadIsInArena(false), mValue(value)
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(UInt16 value) : mType(kUInt16), mValue(value)
+SValue::SValue(UInt16 value) : mType(kUInt16), mPayloadIsInArena(false), mValue(value)
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(UInt32 value) : mType(kUInt32), mValue(value)
+SValue::SValue(UInt32 value) : mType(kUInt32), mPayloadIsInArena(false), mValue(value)
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(UInt64 value) : mType(kUInt64), mValue(value)
+SValue::SValue(UInt64 value) : mType(kUInt64), mPayloadIsInArena(false), mValue(value)
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(Opaque value) : mType(kOpaque), mValue(value)
+SValue::SValue(Opaque value) : mType(kOpaque), mPayloadIsInArena(false), mValue(value)
 //----------------------------------------------------------------------------------------------------------------------
 {}
 
 //----------------------------------------------------------------------------------------------------------------------
-SValue::SValue(const SValue& other, OpaqueCopyProc opaqueCopyProc) : mType(other.mType), mValue(other.mValue)
+SValue::SValue(const SValue& other, OpaqueCopyProc opaqueCopyProc) :
+	mType(other.mType), mPayloadIsInArena(other.mPayloadIsInArena), mValue(other.mValue)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Check for ItemCopyProc
-	if (opaqueCopyProc != nil) {
+	if (opaqueCopyProc != nil)
 		// Copy value
-		if (mType == kArrayOfDictionaries)
-			// Array of dictionaries
-			mValue.mArrayOfDictionaries = new TNArray<CDictionary>(*mValue.mArrayOfDictionaries);
-		else if (mType == kArrayOfStrings)
-			// Array of strings
-			mValue.mArrayOfStrings = new TNArray<CString>(*mValue.mArrayOfStrings);
-		else if (mType == kData)
-			// Data
-			mValue.mData = new CData(*mValue.mData);
-		else if (mType == kDictionary)
-			// Dictionary
-			mValue.mDictionary = new CDictionary(*mValue.mDictionary);
-		else if (mType == kString)
-			// String
-			mValue.mString = new CString(*mValue.mString);
-		else if ((mType == kOpaque) && (opaqueCopyProc != nil))
-			// Opaque and have copy proc
-			mValue.mOpaque = opaqueCopyProc(mValue.mOpaque);
-	}
+		copyPayload(opaqueCopyProc);
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+SValue::SValue(const TArray<CDictionary>& value, CArena& arena) :
+	mType(kArrayOfDictionaries), mPayloadIsInArena(true),
+			mValue(new (arena.allocate(sizeof(TArray<CDictionary>))) TArray<CDictionary>(value))
+//----------------------------------------------------------------------------------------------------------------------
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+SValue::SValue(const TArray<CString>& value, CArena& arena) :
+	mType(kArrayOfStrings), mPayloadIsInArena(true),
+			mValue(new (arena.allocate(sizeof(TArray<CString>))) TArray<CString>(value))
+//----------------------------------------------------------------------------------------------------------------------
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+SValue::SValue(const CData& value, CArena& arena) :
+	mType(kData), mPayloadIsInArena(true),
+			mValue(new (arena.allocate(sizeof(CData))) CData(value))
+//----------------------------------------------------------------------------------------------------------------------
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+SValue::SValue(const CDictionary& value, CArena& arena) :
+	mType(kDictionary), mPayloadIsInArena(true),
+			mValue(new (arena.allocate(sizeof(CDictionary))) CDictionary(value))
+//----------------------------------------------------------------------------------------------------------------------
+{}
+
+//----------------------------------------------------------------------------------------------------------------------
+SValue::SValue(const CString& value, CArena& arena) :
+	mType(kString), mPayloadIsInArena(true),
+			mValue(new (arena.allocate(sizeof(CString))) CString(value))
+//----------------------------------------------------------------------------------------------------------------------
+{}
+
 // MARK: Instance methods
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -533,6 +572,17 @@ bool SValue::equals(const SValue& other, OpaqueEqualsProc opaqueEqualsProc) cons
 	}
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+SValue SValue::copy(OpaqueCopyProc opaqueCopyProc) const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	SValue	value(*this);
+	value.copyPayload(opaqueCopyProc);
+
+	return value;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 void SValue::dispose(OpaqueDisposeProc opaqueDisposeProc)
 //----------------------------------------------------------------------------------------------------------------------
@@ -540,25 +590,53 @@ void SValue::dispose(OpaqueDisposeProc opaqueDisposeProc)
 	// Check value type
 	if (mType == kArrayOfDictionaries) {
 		// Array of dictionaries
-		Delete(mValue.mArrayOfDictionaries);
+		sDispose(mValue.mArrayOfDictionaries, mPayloadIsInArena);
 	} else if (mType == kArrayOfStrings) {
 		// Array of strings
-		Delete(mValue.mArrayOfStrings);
+		sDispose(mValue.mArrayOfStrings, mPayloadIsInArena);
 	} else if (mType == kData) {
 		// Data
-		Delete(mValue.mData);
+		sDispose(mValue.mData, mPayloadIsInArena);
 	} else if (mType == kDictionary) {
 		// Dictionary
-		Delete(mValue.mDictionary);
+		sDispose(mValue.mDictionary, mPayloadIsInArena);
 	} else if (mType == kString) {
 		// String
-		Delete(mValue.mString);
+		sDispose(mValue.mString, mPayloadIsInArena);
 	} else if ((mType == kOpaque) && (opaqueDisposeProc != nil)) {
 		// Item Ref and have item dispose proc
 		opaqueDisposeProc(mValue.mOpaque);
 	}
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+void SValue::copyPayload(OpaqueCopyProc opaqueCopyProc)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Copy value
+	if (mType == kArrayOfDictionaries)
+		// Array of dictionaries
+		mValue.mArrayOfDictionaries = new TNArray<CDictionary>(*mValue.mArrayOfDictionaries);
+	else if (mType == kArrayOfStrings)
+		// Array of strings
+		mValue.mArrayOfStrings = new TNArray<CString>(*mValue.mArrayOfStrings);
+	else if (mType == kData)
+		// Data
+		mValue.mData = new CData(*mValue.mData);
+	else if (mType == kDictionary)
+		// Dictionary
+		mValue.mDictionary = new CDictionary(*mValue.mDictionary);
+	else if (mType == kString)
+		// String
+		mValue.mString = new CString(*mValue.mString);
+	else if ((mType == kOpaque) && (opaqueCopyProc != nil))
+		// Opaque and have copy proc
+		mValue.mOpaque = opaqueCopyProc(mValue.mOpaque);
+
+	// Copy is on the heap
+	mPayloadIsInArena = false;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 const CDictionary& SValue::getEmptyDictionary()
 //----------------------------------------------------------------------------------------------------------------------
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "CArena.h"
 #include "CData.h"
 #include "SError.h"
 
@@ -68,6 +69,13 @@ struct SValue {
 												SValue(Opaque value);
 												SValue(const SValue& other, OpaqueCopyProc opaqueCopyProc = nil);
 
+												// Payload is placed in arena (and destroyed in place by dispose())
+												SValue(const TArray<CDictionary>& value, CArena& arena);
+												SValue(const TArray<CString>& value, CArena& arena);
+												SValue(const CData& value, CArena& arena);
+												SValue(const CDictionary& value, CArena& arena);
+												SValue(const CString& value, CArena& arena);
+
 												// Instance methods
 						Type					getType() const { return mType; }
 
@@ -95,12 +103,16 @@ struct SValue {
 
 						bool					equals(const SValue& other, OpaqueEqualsProc opaqueEqualsProc) const;
 
+						SValue					copy(OpaqueCopyProc opaqueCopyProc = nil) const;
 						void					dispose(OpaqueDisposeProc opaqueDisposeProc);
 
 	private:
 												// Lifecycle methods
 												SValue();
 
+												// Instance methods
+						void					copyPayload(OpaqueCopyProc opaqueCopyProc);
+
 												// Class methods
 		static	const	CDictionary&			getEmptyDictionary();
 
@@ -110,6 +122,7 @@ struct SValue {
 		
 	private:
 				Type	mType;
+				bool	mPayloadIsInArena;
 				union ValueValue {
 					// Lifecycle methods
 					ValueValue(TArray<CDictionary>* value) : mArrayOfDictionaries(value) {}
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: SReferenceCountable
 
@@ -57,13 +59,48 @@ template <typename T> class TReferenceCountable {
 		UInt32	mReferenceCount;
 };
 
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - TAtomicReferenceCountable
+//	Same as TReferenceCountable, but the reference count may be changed from multiple threads at once, so a single
+//		instance can be shared between threads (for instance by work items) without copying.
+
+template <typename T> class TAtomicReferenceCountable {
+	public:
+						// Lifecycle methods
+						TAtomicReferenceCountable() : mReferenceCount(1) {}
+		virtual			~TAtomicReferenceCountable() {}
+
+						// Instance methods
+				T*		addReference()
+							{ mReferenceCount.fetch_add(1, std::memory_order_relaxed); return (T*) this; }
+				void	removeReference()
+							{
+								// Check if we are the last one.  When we hold the only reference, nobody else can be
+								//	adding one, so the read-modify-write can be skipped.
+								if ((mReferenceCount.load(std::memory_order_acquire) == 1) ||
+										(mReferenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1)) {
+									// We going away
+									T*	THIS = (T*) this;
+									Delete(THIS);
+								}
+							}
+
+	protected:
+						// Subclass methods
+				UInt32	getReferenceCount() const
+							{ return mReferenceCount.load(std::memory_order_acquire); }
+
+	private:
+		std::atomic<UInt32>	mReferenceCount;
+};
+
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - TCopyOnWriteReferenceCountable
 
-template <typename T> class TCopyOnWriteReferenceCountable : public TReferenceCountable<T> {
+template <typename T, typename R = TReferenceCountable<T> > class TCopyOnWriteReferenceCountable : public R {
 	public:
 			// Lifecycle methods
-			TCopyOnWriteReferenceCountable() : TReferenceCountable<T>() {}
+			TCopyOnWriteReferenceCountable() : R() {}
 
 			// Instance methods
 		T*	prepareForWrite()
@@ -71,13 +108,26 @@ template <typename T> class TCopyOnWriteReferenceCountable : public TReferenceCo
 					// Check reference count.  If there is more than 1 reference, we implement a
 					//	"copy on write".  So we will clone ourselves so we have a personal buffer that
 					//	can be changed while leaving the exiting buffer as-is for the other references.
-					if (TReferenceCountable<T>::getReferenceCount() > 1) {
+					//	The copy is made before our reference is removed as another thread may be removing
+					//	the other reference at the same time.
+					if (R::getReferenceCount() > 1) {
 						// Multiple references
-						TReferenceCountable<T>::removeReference();
+						T*	t = new T((T&) *this);
+						R::removeReference();
 
-						return new T((T&) *this);
+						return t;
 					} else
 						// Only a single reference
 						return (T*) this;
 				}
 };
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - TAtomicCopyOnWriteReferenceCountable
+
+template <typename T> class TAtomicCopyOnWriteReferenceCountable :
+		public TCopyOnWriteReferenceCountable<T, TAtomicReferenceCountable<T> > {
+	public:
+		// Lifecycle methods
+		TAtomicCopyOnWriteReferenceCountable() : TCopyOnWriteReferenceCountable<T, TAtomicReferenceCountable<T> >() {}
+};
@@ -95,12 +95,12 @@ ECompareResult CColorGroup::compareDisplayIndexes(const CColorGroup& colorGroup1
 class CColorSetInternals : public TReferenceCountable<CColorSetInternals> {
 	public:
 		CColorSetInternals(const CString& name, OV<OSType> id = OV<OSType>()) :
-			TReferenceCountable(), mName(name), mID(id), mColorsMap((SValue::OpaqueEqualsProc) CColor::areEqual)
+			TReferenceCountable(), mName(name), mID(id)
 			{}
 
-	CString										mName;
-	OV<OSType>									mID;
-	TKeyConvertibleDictionary<UInt64, CColor>	mColorsMap;
+	CString									mName;
+	OV<OSType>								mID;
+	TNumericKeyDictionary<UInt64, CColor>	mColorsMap;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -217,17 +217,17 @@ CDictionary CColorSet::getInfo() const
 	info.set(CString(OSSTR("name")), mInternals->mName);
 
 	TNArray<CDictionary>	colorSetColorInfos;
-	for (TIteratorS<CDictionary::Item> iterator = mInternals->mColorsMap.getIterator(); iterator.hasValue();
-			iterator.advance()) {
+	for (TNumericKeyDictionary<UInt64, CColor>::Iterator iterator = mInternals->mColorsMap.begin();
+			iterator != mInternals->mColorsMap.end(); ++iterator) {
 		// Get info
-		UInt64	key = iterator.getValue().mKey.getUInt64();
+		UInt64	key = iterator.getKey();
 		OSType	colorGroupID = (OSType) (key >> 32);
 		OSType	colorID = (OSType) (key & 0xFFFFFFFF);
 
 		CDictionary	colorSetColorInfo;
 		colorSetColorInfo.set(CString(OSSTR("groupID")), colorGroupID);
 		colorSetColorInfo.set(CString(OSSTR("colorID")), colorID);
-		colorSetColorInfo.set(CString(OSSTR("color")), ((CColor*) iterator.getValue().mValue.getOpaque())->getInfo());
+		colorSetColorInfo.set(CString(OSSTR("color")), iterator->getInfo());
 
 		// Add to array
 		colorSetColorInfos += colorSetColorInfo;
@@ -309,7 +309,7 @@ class CColorRegistryInternals {
 		CNotificationCenter&							mNotificationCenter;
 		OI<CColorSet>									mCurrentColorSet;
 		OI<CPreferences::Pref>							mPref;
-		TKeyConvertibleDictionary<OSType, CColorGroup>	mColorGroupMap;
+		TNumericKeyDictionary<OSType, CColorGroup>		mColorGroupMap;
 		TNArray<CColorSet>								mColorSets;
 		TNArray<CColorSet>								mColorSetPresets;
 };
@@ -384,10 +384,9 @@ TArray<CColorGroup> CColorRegistry::getColorGroups() const
 {
 	// Get color groups
 	TNArray<CColorGroup>	colorGroups;
-	for (TIteratorS<CDictionary::Item> iterator = mInternals->mColorGroupMap.getIterator();
-			iterator.hasValue(); iterator.advance())
+	for (const CColorGroup& colorGroup : mInternals->mColorGroupMap)
 		// Insert value
-		colorGroups += *((CColorGroup*) iterator.getValue().mValue.getOpaque());
+		colorGroups += colorGroup;
 
 	// Sort by display index
 	colorGroups.sort(CColorGroup::compareDisplayIndexes);
@@ -460,9 +459,9 @@ void CColorRegistry::setAsCurrent(const CColorSet& colorSet)
 	TArray<CColorGroup>	colorGroups = getColorGroups();
 	for (CArray::ItemIndex i = 0; i < colorGroups.getCount(); i++) {
 		// Get info
-		CColorGroup&			colorGroup = colorGroups[i];
-		OSType					colorGroupID = colorGroup.getID();
-		TNumericArray<OSType>	colorIDs = colorGroup.getColorIDs();
+				CColorGroup&			colorGroup = colorGroups[i];
+				OSType					colorGroupID = colorGroup.getID();
+		const	TNumericArray<OSType>&	colorIDs = colorGroup.getColorIDs();
 
 		// Setup
 		info.set(mGroupIDKey, colorGroupID);
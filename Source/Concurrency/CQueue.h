@@ -5,13 +5,18 @@
 #pragma once
 
 #include "CEquatable.h"
+#include "ConcurrencyPrimitives.h"
 #include "TBuffer.h"
 #include "TWrappers.h"
 
+#include <atomic>
+
 /*
 	Terminology:
 		SR - Single Reader
 		SW - Single Writer
+		MR - Multiple Readers
+		MW - Multiple Writers
 		BIP - Bip Buffer
 */
 
@@ -286,3 +291,399 @@ class CSRSWMessageQueues {
 	private:
 		CSRSWMessageQueuesInternals*	mInternals;
 };
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CQueueWaiters
+
+// Parks threads waiting on one of the lock-free queues below.  A thread registers before checking the queue one last
+//	time and a waker only touches the semaphore when it can claim a registration, so neither side makes a system call
+//	unless a thread actually needs to sleep.  A thread that is woken without finding anything simply waits again.
+
+class CQueueWaiters {
+	// Methods
+	public:
+				// Lifecycle methods
+				CQueueWaiters() : mWaiterCount(0) {}
+
+				// Instance methods
+		void	prepareToWait()
+					{
+						// Register, then make sure the final check sees anything published before a waker looked for
+						//	registrations
+						mWaiterCount++;
+						std::atomic_thread_fence(std::memory_order_seq_cst);
+					}
+		void	cancelWait()
+					{
+						// Unregister
+						UInt32	waiterCount = mWaiterCount.load();
+						while (waiterCount > 0) {
+							// Try to unregister
+							if (mWaiterCount.compare_exchange_weak(waiterCount, waiterCount - 1))
+								// Done
+								return;
+						}
+
+						// A waker already claimed our registration so consume its signal
+						mSemaphore.waitFor();
+					}
+		void	wait()
+					{ mSemaphore.waitFor(); }
+		void	wake(UInt32 count = 1)
+					{
+						// Make sure any thread that registers from here on sees what was just published
+						std::atomic_thread_fence(std::memory_order_seq_cst);
+
+						// Claim registrations and wake
+						UInt32	waiterCount = mWaiterCount.load(std::memory_order_relaxed);
+						while ((count > 0) && (waiterCount > 0)) {
+							// Try to claim
+							if (mWaiterCount.compare_exchange_weak(waiterCount, waiterCount - 1)) {
+								// Wake
+								mSemaphore.signal();
+								count--;
+								waiterCount--;
+							}
+						}
+					}
+
+	// Properties
+	private:
+		std::atomic<UInt32>	mWaiterCount;
+		CSemaphore			mSemaphore;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - TMRMWQueue
+
+// A bounded, lock-free ring for any number of readers and writers (after Dmitry Vyukov's bounded MPMC queue).  Each
+//	cell carries a sequence number that tells a writer when the cell is free for its lap and a reader when the item
+//	for its lap has been written, so readers and writers only contend on their own position.  Batch reads and writes
+//	claim several cells with a single compare-and-swap.  The capacity is rounded up to a power of 2 and T must be
+//	default constructible and copyable (small values such as pointers work best).
+
+template <typename T> class TMRMWQueue {
+	// Structs
+	private:
+		struct Cell {
+			// Properties
+			std::atomic<UInt32>	mSequence;
+			T					mItem;
+		};
+
+	// Methods
+	public:
+				// Lifecycle methods
+				TMRMWQueue(UInt32 capacity) : mCapacity(1), mReadPosition(0), mWritePosition(0)
+					{
+						// Setup
+						while (mCapacity < capacity)
+							// Next power of 2
+							mCapacity *= 2;
+						mCells = new Cell[mCapacity];
+						for (UInt32 i = 0; i < mCapacity; i++)
+							// Free for the first lap
+							mCells[i].mSequence.store(i, std::memory_order_relaxed);
+					}
+				~TMRMWQueue()
+					{ DeleteArray(mCells); }
+
+				// Instance methods
+		UInt32	getCapacity() const
+					{ return mCapacity; }
+
+		bool	write(const T& item)
+					{
+						// Claim the next cell
+						UInt32	position = mWritePosition.load(std::memory_order_relaxed);
+						Cell*	cell;
+						while (true) {
+							// Check cell
+							cell = &mCells[position & (mCapacity - 1)];
+							SInt32	difference = (SInt32) (cell->mSequence.load(std::memory_order_acquire) - position);
+							if (difference == 0) {
+								// Free, try to claim
+								if (mWritePosition.compare_exchange_weak(position, position + 1,
+										std::memory_order_relaxed))
+									// Claimed
+									break;
+							} else if (difference < 0)
+								// Full
+								return false;
+							else
+								// Another writer got here first
+								position = mWritePosition.load(std::memory_order_relaxed);
+						}
+
+						// Write
+						cell->mItem = item;
+						cell->mSequence.store(position + 1, std::memory_order_release);
+						mReadWaiters.wake();
+
+						return true;
+					}
+		UInt32	write(const T* items, UInt32 count)
+					{
+						// Claim the run of free cells at the write position, up to count.  Only a writer that
+						//	claims a free cell can change it, so the run stays free if the claim succeeds.
+						UInt32	position = mWritePosition.load(std::memory_order_relaxed);
+						UInt32	claimCount;
+						do {
+							// Count free cells
+							claimCount = getRunCount(position, 0, count);
+							if (claimCount == 0)
+								// Full
+								return 0;
+						} while (!mWritePosition.compare_exchange_weak(position, position + claimCount,
+								std::memory_order_relaxed));
+
+						// Write
+						for (UInt32 i = 0; i < claimCount; i++) {
+							// Write
+							Cell&	cell = mCells[(position + i) & (mCapacity - 1)];
+							cell.mItem = items[i];
+							cell.mSequence.store(position + i + 1, std::memory_order_release);
+						}
+						mReadWaiters.wake(claimCount);
+
+						return claimCount;
+					}
+		void	waitForWrite(const T& item)
+					{
+						// Write, parking while full
+						while (!write(item)) {
+							// Register and check again
+							mWriteWaiters.prepareToWait();
+							if (write(item)) {
+								// Written
+								mWriteWaiters.cancelWait();
+
+								return;
+							}
+
+							// Park
+							mWriteWaiters.wait();
+						}
+					}
+
+		OV<T>	read()
+					{
+						// Claim the next cell
+						UInt32	position = mReadPosition.load(std::memory_order_relaxed);
+						Cell*	cell;
+						while (true) {
+							// Check cell
+							cell = &mCells[position & (mCapacity - 1)];
+							SInt32	difference =
+											(SInt32) (cell->mSequence.load(std::memory_order_acquire) -
+													(position + 1));
+							if (difference == 0) {
+								// Written, try to claim
+								if (mReadPosition.compare_exchange_weak(position, position + 1,
+										std::memory_order_relaxed))
+									// Claimed
+									break;
+							} else if (difference < 0)
+								// Empty
+								return OV<T>();
+							else
+								// Another reader got here first
+								position = mReadPosition.load(std::memory_order_relaxed);
+						}
+
+						// Read
+						T	item = cell->mItem;
+						cell->mSequence.store(position + mCapacity, std::memory_order_release);
+						mWriteWaiters.wake();
+
+						return OV<T>(item);
+					}
+		UInt32	read(T* items, UInt32 count)
+					{
+						// Claim the run of written cells at the read position, up to count.  Only a reader that
+						//	claims a written cell can change it, so the run stays written if the claim succeeds.
+						UInt32	position = mReadPosition.load(std::memory_order_relaxed);
+						UInt32	claimCount;
+						do {
+							// Count written cells
+							claimCount = getRunCount(position, 1, count);
+							if (claimCount == 0)
+								// Empty
+								return 0;
+						} while (!mReadPosition.compare_exchange_weak(position, position + claimCount,
+								std::memory_order_relaxed));
+
+						// Read
+						for (UInt32 i = 0; i < claimCount; i++) {
+							// Read
+							Cell&	cell = mCells[(position + i) & (mCapacity - 1)];
+							items[i] = cell.mItem;
+							cell.mSequence.store(position + i + mCapacity, std::memory_order_release);
+						}
+						mWriteWaiters.wake(claimCount);
+
+						return claimCount;
+					}
+		T		waitForRead()
+					{
+						// Read, parking while empty
+						while (true) {
+							// Try to read
+							OV<T>	item = read();
+							if (item.hasValue())
+								// Have item
+								return *item;
+
+							// Register and check again
+							mReadWaiters.prepareToWait();
+							item = read();
+							if (item.hasValue()) {
+								// Have item
+								mReadWaiters.cancelWait();
+
+								return *item;
+							}
+
+							// Park
+							mReadWaiters.wait();
+						}
+					}
+
+	private:
+				// Instance methods
+		UInt32	getRunCount(UInt32 position, UInt32 sequenceOffset, UInt32 maxCount) const
+					{
+						// Count cells from position whose sequence matches their position plus the offset (0 for
+						//	free, 1 for written)
+						UInt32	count = 0;
+						while ((count < maxCount) &&
+								(mCells[(position + count) & (mCapacity - 1)].mSequence.load(
+										std::memory_order_acquire) == position + count + sequenceOffset))
+							// Next
+							count++;
+
+						return count;
+					}
+
+	// Properties
+	private:
+						Cell*				mCells;
+						UInt32				mCapacity;
+		alignas(64)		std::atomic<UInt32>	mReadPosition;
+		alignas(64)		std::atomic<UInt32>	mWritePosition;
+						CQueueWaiters		mReadWaiters;
+						CQueueWaiters		mWriteWaiters;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - TSRMWQueue
+
+// An unbounded, lock-free linked queue for any number of writers and a single reader (after Dmitry Vyukov's
+//	MPSC node queue), intended for passing messages into a single consumer.  A write is one allocation and one
+//	atomic exchange and never waits on other writers.  The reader always keeps the last node read so it never
+//	contends with writers on an empty queue.  T must be default constructible and copyable.
+
+template <typename T> class TSRMWQueue {
+	// Structs
+	private:
+		struct Node {
+			// Lifecycle methods
+			Node() : mNextNode(nil) {}
+			Node(const T& item) : mNextNode(nil), mItem(item) {}
+
+			// Properties
+			std::atomic<Node*>	mNextNode;
+			T					mItem;
+		};
+
+	// Methods
+	public:
+				// Lifecycle methods
+				TSRMWQueue() : mReadNode(new Node()), mWriteNode(mReadNode) {}
+				~TSRMWQueue()
+					{
+						// Cleanup
+						while (mReadNode != nil) {
+							// Delete this one
+							Node*	node = mReadNode;
+							mReadNode = node->mNextNode.load(std::memory_order_relaxed);
+							Delete(node);
+						}
+					}
+
+				// Instance methods
+		void	write(const T& item)
+					{
+						// Link at end.  The reader sees the end of the queue at the previous node until it has been
+						//	linked, which is fine as we wake it after.
+						Node*	node = new Node(item);
+						Node*	previousNode = mWriteNode.exchange(node, std::memory_order_acq_rel);
+						previousNode->mNextNode.store(node, std::memory_order_release);
+						mReadWaiters.wake();
+					}
+
+				// Reader only
+		OV<T>	read()
+					{
+						// Check if have next node
+						Node*	nextNode = mReadNode->mNextNode.load(std::memory_order_acquire);
+						if (nextNode == nil)
+							// Empty
+							return OV<T>();
+
+						// Move on
+						T	item = nextNode->mItem;
+						nextNode->mItem = T();
+						Delete(mReadNode);
+						mReadNode = nextNode;
+
+						return OV<T>(item);
+					}
+		UInt32	read(T* items, UInt32 count)
+					{
+						// Read up to count
+						UInt32	readCount = 0;
+						while (readCount < count) {
+							// Read next
+							OV<T>	item = read();
+							if (!item.hasValue())
+								// Empty
+								break;
+
+							// Store
+							items[readCount++] = *item;
+						}
+
+						return readCount;
+					}
+		T		waitForRead()
+					{
+						// Read, parking while empty
+						while (true) {
+							// Try to read
+							OV<T>	item = read();
+							if (item.hasValue())
+								// Have item
+								return *item;
+
+							// Register and check again
+							mReadWaiters.prepareToWait();
+							item = read();
+							if (item.hasValue()) {
+								// Have item
+								mReadWaiters.cancelWait();
+
+								return *item;
+							}
+
+							// Park
+							mReadWaiters.wait();
+						}
+					}
+
+	// Properties
+	private:
+						Node*				mReadNode;
+		alignas(64)		std::atomic<Node*>	mWriteNode;
+						CQueueWaiters		mReadWaiters;
+};
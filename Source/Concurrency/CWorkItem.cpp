@@ -6,14 +6,21 @@
 
 #include "PlatformDefinitions.h"
 
+#include <atomic>
+
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: CWorkItemInternals
 
 class CWorkItemInternals {
 	public:
-		CWorkItemInternals() : mState(CWorkItem::kStateWaiting) {}
+		CWorkItemInternals() :
+			mState(CWorkItem::kStateWaiting), mIsCancelRequested(false), mWasStoppedEarly(false), mQueueInfo(nil)
+			{}
  
-		CWorkItem::State	mState;
+		std::atomic<CWorkItem::State>	mState;
+		std::atomic<bool>				mIsCancelRequested;
+		bool							mWasStoppedEarly;
+		void*							mQueueInfo;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -45,6 +52,21 @@ CWorkItem::State CWorkItem::getState() const
 	return mInternals->mState;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+bool CWorkItem::isCancelRequested() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mInternals->mIsCancelRequested;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CWorkItem::noteStoppedEarly()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Update
+	mInternals->mWasStoppedEarly = true;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 void CWorkItem::transitionTo(State state)
 //----------------------------------------------------------------------------------------------------------------------
@@ -53,9 +75,39 @@ void CWorkItem::transitionTo(State state)
 	mInternals->mState = state;
 
 	// Check state
-	switch (mInternals->mState) {
+	switch (state) {
 		case kStateCompleted:	completed();	break;
 		case kStateCancelled:	cancelled();	break;
 		default:								break;
 	}
 }
+
+//----------------------------------------------------------------------------------------------------------------------
+void CWorkItem::requestCancel()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Update
+	mInternals->mIsCancelRequested = true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool CWorkItem::wasStoppedEarly() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mInternals->mWasStoppedEarly;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void* CWorkItem::getQueueInfo() const
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return mInternals->mQueueInfo;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CWorkItem::setQueueInfo(void* queueInfo)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Store
+	mInternals->mQueueInfo = queueInfo;
+}
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "PlatformDefinitions.h"
+
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: CWorkItem
 
@@ -41,6 +43,9 @@ class CWorkItem {
 				bool	isCancelled() const
 							{ return getState() == kStateCancelled; }
 
+				bool	isCancelRequested() const;	// Active Work Items may poll this to stop early
+				void	noteStoppedEarly();			// Active Work Items call this when stopping early
+
 						// Subclass methods
 		virtual	void	perform() = 0;
 
@@ -49,6 +54,10 @@ class CWorkItem {
 
 						// Internal-use only methods
 				void	transitionTo(State state);
+				void	requestCancel();
+				bool	wasStoppedEarly() const;
+				void*	getQueueInfo() const;
+				void	setQueueInfo(void* queueInfo);
 
 	// Properties
 	private:
@@ -66,14 +75,26 @@ class CProcWorkItem : public CWorkItem {
 	// Methods
 	public:
 				// Lifecycle methods
-				CProcWorkItem(Proc proc, void* userData) : CWorkItem(), mProc(proc), mUserData(userData) {}
+				CProcWorkItem(Proc proc, void* userData, Proc cancelledProc = nil) :
+					CWorkItem(), mProc(proc), mUserData(userData), mCancelledProc(cancelledProc), mWasPerformed(false)
+					{}
 
 				// CWorkItem methods
 		void	perform()
-					{ mProc(*this, mUserData); }
+					{ mWasPerformed = true; mProc(*this, mUserData); }
+
+		void	cancelled() const
+					{
+						// Check if cancelled before the proc was called
+						if (!mWasPerformed && (mCancelledProc != nil))
+							// Call cancelled proc so userData can be cleaned up
+							mCancelledProc(*((CProcWorkItem*) this), mUserData);
+					}
 
 	// Properties
 	private:
 		Proc	mProc;
 		void*	mUserData;
+		Proc	mCancelledProc;
+		bool	mWasPerformed;
 };
@@ -4,60 +4,89 @@
 
 #include "CWorkItemQueue.h"
 
-#include "CArray.h"
 #include "CCoreServices.h"
+#include "CDictionary.h"
 #include "ConcurrencyPrimitives.h"
 #include "CThread.h"
-#include "TLockingArray.h"
+#include "CppToolboxAssert.h"
+
+#include <atomic>
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+#endif
 
 /*
-	TODOs:
-		-Implement cancel(workItem)
-		-Remove cancelled work items immediately
+	Scheduling:
+		Each worker thread owns a deque per priority.  Work items added from a worker go on that worker's deque and
+			work items added from any other thread go on a shared injection deque.  A worker takes work highest
+			priority first, from its own deque, then the injection deque, then by stealing from other workers.
+			Workers take from the front (oldest first) and steal from the back so owners and thieves rarely meet.
+		A work item only needs bookkeeping in the queue hierarchy when some queue it goes through has a maximum
+			concurrent work items limit below the number of workers (otherwise the limit can never be reached) or is
+			paused.  These work items wait in per priority lists in their queue and are admitted onto the injection
+			deque when every queue up to the main queue has headroom.  Admitting walks only queues that have waiting
+			work items, taking the highest priority and then the earliest created.  The admitted count of each queue
+			is released when the work item completes.
+		Workers are started on demand up to the maximum.  A worker that runs out of work spins briefly (on multi-core
+			machines) watching for new work and then parks on its semaphore.  A worker that stays parked for the idle
+			timeout exits unless that would take the pool below the minimum.  Its slot (with its now empty deques) stays
+			in place for thieves and is reused by the next worker started.
+
+	Cancellation:
+		Cancelling a work item that is waiting for admission unlinks it from its queue right away.  A work item that is
+			already on a deque cannot be unlinked cheaply, so it is marked and skipped when it is taken.  Cancelling
+			all the work items in a queue bumps the queue's cancel count and unlinks everything waiting in the queue
+			and its children.  Every work item notes the total of the cancel counts up to the main queue when it is
+			added, and one taken after that total has changed is skipped.
 */
 
 //----------------------------------------------------------------------------------------------------------------------
-// MARK: SWorkItemInfo
+// MARK: Local data
+
+static	const	UInt32	kPriorityCount = CWorkItem::kPriorityBackground + 1;
+static	const	UInt32	kDequeInitialCapacity = 64;
+static	const	UInt32	kIdleSpinCount = 1000;
+
+static	const	UInt32					kParallelChunksPerThreadCount = 4;
+
+const	UniversalTimeInterval	CWorkItemQueue::kHelpingWaitTimeInterval = 0.001;
+
+static	CWorkItemQueue::PoolInfo	sMainPoolInfo;
+
+class CWorkItemScheduler;
+static	CWorkItemScheduler*	sWorkItemScheduler = nil;
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - SWorkItemInfo
+
+class CWorkItemQueueInternals;
+struct SWorkItemInfo {
+	// Procs
+	typedef	SWorkItemInfo*	(*CompletedProc)(void* userData);	// Returns a continuation to perform next (if any)
 
-struct SWorkItemInfo : public CEquatable {
 			// Lifecycle methods
 			SWorkItemInfo(CWorkItemQueueInternals& owningWorkItemQueueInternals, CWorkItem& workItem,
-					CWorkItem::Priority priority) :
+					CWorkItem::Priority priority, CompletedProc completedProc = nil,
+					void* completedProcUserData = nil) :
 				mOwningWorkItemQueueInternals(owningWorkItemQueueInternals), mWorkItem(workItem), mPriority(priority),
-						mIndex(SWorkItemInfo::mNextIndex++)
+						mIndex(SWorkItemInfo::mNextIndex++), mIsAdmitted(false), mCancelAllCountDeep(0),
+						mCompletedProc(completedProc), mCompletedProcUserData(completedProcUserData),
+						mPreviousWorkItemInfo(nil), mNextWorkItemInfo(nil)
 				{}
 			SWorkItemInfo(CWorkItemQueueInternals& owningWorkItemQueueInternals, CProcWorkItem::Proc proc,
-					void* userData, CWorkItem::Priority priority) :
+					void* userData, CWorkItem::Priority priority, CProcWorkItem::Proc cancelledProc) :
 				mOwningWorkItemQueueInternals(owningWorkItemQueueInternals),
-						mProcWorkItem(new CProcWorkItem(proc, userData)), mPriority(priority),
-						mIndex(SWorkItemInfo::mNextIndex++)
+						mProcWorkItem(new CProcWorkItem(proc, userData, cancelledProc)), mPriority(priority),
+						mIndex(SWorkItemInfo::mNextIndex++), mIsAdmitted(false), mCancelAllCountDeep(0),
+						mCompletedProc(nil), mCompletedProcUserData(nil), mPreviousWorkItemInfo(nil),
+						mNextWorkItemInfo(nil)
 				{}
 
-			// CEquatable methods
-	bool	operator==(const CEquatable& other) const
-				{ return this == &other; }
-
-			// Instance methods
-	void	transitionTo(CWorkItem::State state)
-				{
-					// Check what we have
-					if (mWorkItem.hasReference())
-						// Work item
-						mWorkItem->transitionTo(state);
-					else
-						// Proc work item
-						mProcWorkItem->transitionTo(state);
-				}
-	void	perform()
-				{
-					// Check what we have
-					if (mWorkItem.hasReference())
-						// Work item
-						mWorkItem->perform();
-					else
-						// Proc work item
-						mProcWorkItem->perform();
-				}
+				// Instance methods
+	CWorkItem&	getWorkItem() const
+					{ return mWorkItem.hasReference() ? *mWorkItem : *mProcWorkItem; }
 
 	// Properties
 			CWorkItemQueueInternals&	mOwningWorkItemQueueInternals;
@@ -65,74 +94,201 @@ struct SWorkItemInfo : public CEquatable {
 			OI<CProcWorkItem>			mProcWorkItem;
 			CWorkItem::Priority			mPriority;
 			UInt32						mIndex;
+			bool						mIsAdmitted;
+			UInt32						mCancelAllCountDeep;
+			CompletedProc				mCompletedProc;
+			void*						mCompletedProcUserData;
 
-	static	UInt32						mNextIndex;
+			SWorkItemInfo*				mPreviousWorkItemInfo;
+			SWorkItemInfo*				mNextWorkItemInfo;
+
+	static	std::atomic<UInt32>			mNextIndex;
 };
 
-UInt32	SWorkItemInfo::mNextIndex = 0;
+std::atomic<UInt32>	SWorkItemInfo::mNextIndex(0);
 
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
-// MARK: - SWorkItemThreadInfo
-
-struct SWorkItemThreadInfo {
-	// Lifecycle methods
-	SWorkItemThreadInfo(SWorkItemInfo& initialWorkItemInfo, CThread::ThreadProc threadProc, const CString& name) :
-		mThread(threadProc, this, name, CThread::kOptionsNone), mWorkItemInfo(&initialWorkItemInfo)
-		{
-			// Start
-			mThread.start();
-		}
+// MARK: - SWorkItemInfoList
+
+struct SWorkItemInfoList {
+					// Lifecycle methods
+					SWorkItemInfoList() : mFirstWorkItemInfo(nil), mLastWorkItemInfo(nil) {}
+
+					// Instance methods
+	void			add(SWorkItemInfo& workItemInfo)
+						{
+							// Link at end
+							workItemInfo.mPreviousWorkItemInfo = mLastWorkItemInfo;
+							workItemInfo.mNextWorkItemInfo = nil;
+							if (mLastWorkItemInfo != nil)
+								// Have last
+								mLastWorkItemInfo->mNextWorkItemInfo = &workItemInfo;
+							else
+								// Empty
+								mFirstWorkItemInfo = &workItemInfo;
+							mLastWorkItemInfo = &workItemInfo;
+						}
+	void			remove(SWorkItemInfo& workItemInfo)
+						{
+							// Unlink
+							if (workItemInfo.mPreviousWorkItemInfo != nil)
+								// Have previous
+								workItemInfo.mPreviousWorkItemInfo->mNextWorkItemInfo = workItemInfo.mNextWorkItemInfo;
+							else
+								// Was first
+								mFirstWorkItemInfo = workItemInfo.mNextWorkItemInfo;
+							if (workItemInfo.mNextWorkItemInfo != nil)
+								// Have next
+								workItemInfo.mNextWorkItemInfo->mPreviousWorkItemInfo =
+										workItemInfo.mPreviousWorkItemInfo;
+							else
+								// Was last
+								mLastWorkItemInfo = workItemInfo.mPreviousWorkItemInfo;
+							workItemInfo.mPreviousWorkItemInfo = nil;
+							workItemInfo.mNextWorkItemInfo = nil;
+						}
 
 	// Properties
-	CSemaphore		mSemaphore;
-	CThread			mThread;
-	SWorkItemInfo*	mWorkItemInfo;
+	SWorkItemInfo*	mFirstWorkItemInfo;
+	SWorkItemInfo*	mLastWorkItemInfo;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
-// MARK: - SWorkItemQueueReference
+// MARK: - CWorkItemDeque
 
-struct SWorkItemQueueReference {
-								// Lifecycle methods
-								SWorkItemQueueReference(CWorkItemQueueInternals& workItemQueueInternals) :
-									mWorkItemQueueInternals(workItemQueueInternals)
-									{}
+class CWorkItemDeque {
+	public:
+						CWorkItemDeque() :
+							mWorkItemInfos((SWorkItemInfo**) ::malloc(kDequeInitialCapacity * sizeof(SWorkItemInfo*))),
+									mCapacity(kDequeInitialCapacity), mStartIndex(0), mCount(0)
+							{}
+						~CWorkItemDeque()
+							{ ::free(mWorkItemInfos); }
+
+		bool			isEmpty() const
+							{ return mCount.load(std::memory_order_relaxed) == 0; }
+
+		void			addLast(SWorkItemInfo& workItemInfo)
+							{
+								// Setup
+								mLock.lock();
+
+								// Check if need to grow
+								UInt32	count = mCount.load(std::memory_order_relaxed);
+								if (count == mCapacity) {
+									// Grow, unwrapping into the new storage
+									SWorkItemInfo**	workItemInfos =
+															(SWorkItemInfo**)
+																	::malloc(mCapacity * 2 * sizeof(SWorkItemInfo*));
+									for (UInt32 i = 0; i < count; i++)
+										// Copy
+										workItemInfos[i] = mWorkItemInfos[(mStartIndex + i) & (mCapacity - 1)];
+									::free(mWorkItemInfos);
+									mWorkItemInfos = workItemInfos;
+									mCapacity *= 2;
+									mStartIndex = 0;
+								}
+
+								// Add
+								mWorkItemInfos[(mStartIndex + count) & (mCapacity - 1)] = &workItemInfo;
+								mCount.store(count + 1, std::memory_order_relaxed);
+								mLock.unlock();
+							}
+		SWorkItemInfo*	removeFirst()
+							{
+								// Check if empty
+								if (isEmpty())
+									// Empty
+									return nil;
+
+								// Remove first
+								mLock.lock();
+								SWorkItemInfo*	workItemInfo = nil;
+								UInt32			count = mCount.load(std::memory_order_relaxed);
+								if (count > 0) {
+									// Remove
+									workItemInfo = mWorkItemInfos[mStartIndex];
+									mStartIndex = (mStartIndex + 1) & (mCapacity - 1);
+									mCount.store(count - 1, std::memory_order_relaxed);
+								}
+								mLock.unlock();
+
+								return workItemInfo;
+							}
+		SWorkItemInfo*	removeLast()
+							{
+								// Check if empty
+								if (isEmpty())
+									// Empty
+									return nil;
+
+								// Remove last
+								mLock.lock();
+								SWorkItemInfo*	workItemInfo = nil;
+								UInt32			count = mCount.load(std::memory_order_relaxed);
+								if (count > 0) {
+									// Remove
+									workItemInfo = mWorkItemInfos[(mStartIndex + count - 1) & (mCapacity - 1)];
+									mCount.store(count - 1, std::memory_order_relaxed);
+								}
+								mLock.unlock();
+
+								return workItemInfo;
+							}
 
-								// Instance methods
-			UInt32				getActiveWorkItemInfosCountDeep();
-			OR<SWorkItemInfo>	getNextWorkItemInfo();
+	private:
+		SWorkItemInfo**		mWorkItemInfos;
+		UInt32				mCapacity;
+		UInt32				mStartIndex;
+		std::atomic<UInt32>	mCount;
+		CLock				mLock;
+};
 
-								// Class methods
-	static	void				getActiveWorkItemInfosCountDeep(SWorkItemQueueReference& workItemQueueReference,
-										void* userData)
-									{
-										// Setup
-										UInt32&	count = *((UInt32*) userData);
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - SWorkItemWorker
 
-										// Update count
-										count += workItemQueueReference.getActiveWorkItemInfosCountDeep();
-									}
-	static	void				getNextWorkItemInfo(SWorkItemQueueReference& workItemQueueReference, void* userData)
-									{
-										// Setup
-										OR<SWorkItemInfo>&	workItemInfo = *((OR<SWorkItemInfo>*) userData);
-
-										// Update work item info
-										OR<SWorkItemInfo>	childWorkItemInfo =
-																	workItemQueueReference.getNextWorkItemInfo();
-										if (childWorkItemInfo.hasReference() &&
-												(!workItemInfo.hasReference() ||
-														(childWorkItemInfo->mIndex < workItemInfo->mIndex)))
-											// Start with this child work item info
-											workItemInfo = childWorkItemInfo;
-									}
+struct SWorkItemWorker {
+	// Lifecycle methods
+	SWorkItemWorker(CWorkItemScheduler& workItemScheduler, UInt32 index, CThread::ThreadProc threadProc) :
+		mWorkItemScheduler(workItemScheduler), mIndex(index), mThreadProc(threadProc), mThread(nil)
+		{
+			// Start
+			start();
+		}
+
+	// Instance methods
+	void	start()
+				{
+					// Check if have previous thread
+					if (mThread != nil) {
+						// The previous thread has returned from the thread proc but may not have quite finished
+						while (mThread->getIsRunning())
+							// Wait
+							CThread::sleepFor(0.0001);
+						Delete(mThread);
+					}
+
+					// Start thread
+					mThread =
+							new CThread(mThreadProc, this, CString(OSSTR("CWorkItemQueue #")) + CString(mIndex + 1),
+									CThread::kOptionsNone);
+					mThread->start();
+				}
 
 	// Properties
-	CWorkItemQueueInternals&	mWorkItemQueueInternals;
+	CWorkItemScheduler&	mWorkItemScheduler;
+	UInt32				mIndex;
+	CThread::ThreadProc	mThreadProc;
+	CWorkItemDeque		mDeques[kPriorityCount];
+	CSemaphore			mSemaphore;
+	CThread*			mThread;
 };
 
+static	thread_local	SWorkItemWorker*	sCurrentWorkItemWorker = nil;
+
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - CWorkItemQueueInternals
@@ -142,253 +298,1072 @@ class CWorkItemQueueInternals {
 									CWorkItemQueueInternals(UInt32 maximumConcurrentWorkItems,
 											OR<CWorkItemQueueInternals> targetWorkItemQueueInternals =
 													OR<CWorkItemQueueInternals>()) :
-										mIsPaused(false), mTargetWorkItemQueueInternals(targetWorkItemQueueInternals),
-												mMaximumConcurrentWorkItems(maximumConcurrentWorkItems)
+										mTargetWorkItemQueueInternals(targetWorkItemQueueInternals),
+												mMaximumConcurrentWorkItems(maximumConcurrentWorkItems),
+												mIsPaused(false), mCancelAllCount(0),
+												mAdmittedWorkItemInfosCountDeep(0),
+												mFirstChildWorkItemQueueInternals(nil),
+												mNextSiblingWorkItemQueueInternals(nil)
 										{
-											// Check if have target
-											if (mTargetWorkItemQueueInternals.hasReference()) {
-												// Add as child
-												mWorkItemQueueReference = new SWorkItemQueueReference(*this);
-												mTargetWorkItemQueueInternals->mChildWorkItemQueueReferences +=
-														mWorkItemQueueReference;
-											} else
-												// No target
-												mWorkItemQueueReference = nil;
+											// Setup
+											for (UInt32 i = 0; i < kPriorityCount; i++)
+												// Reset
+												mWaitingWorkItemInfosCountsDeep[i] = 0;
 										}
-									~CWorkItemQueueInternals()
+
+		CWorkItemQueueInternals*	getTargetWorkItemQueueInternals() const
 										{
-											// Check if have target
-											if (mTargetWorkItemQueueInternals.hasReference()) {
-												// Remove as child
-												mTargetWorkItemQueueInternals->mChildWorkItemQueueReferences -=
-														*mWorkItemQueueReference;
+											return mTargetWorkItemQueueInternals.hasReference() ?
+													&*mTargetWorkItemQueueInternals : nil;
+										}
+		bool						isPausedDeep() const
+										{
+											// Check up to the main work item queue
+											for (const CWorkItemQueueInternals* workItemQueueInternals = this;
+													workItemQueueInternals != nil;
+													workItemQueueInternals =
+															workItemQueueInternals->getTargetWorkItemQueueInternals()) {
+												// Check if paused
+												if (workItemQueueInternals->mIsPaused)
+													// Paused
+													return true;
 											}
+
+											return false;
 										}
+		bool						isLimitedDeep(UInt32 workerCount) const
+										{
+											// Check up to the main work item queue
+											for (const CWorkItemQueueInternals* workItemQueueInternals = this;
+													workItemQueueInternals != nil;
+													workItemQueueInternals =
+															workItemQueueInternals->getTargetWorkItemQueueInternals()) {
+												// Check if limited
+												if (workItemQueueInternals->mMaximumConcurrentWorkItems < workerCount)
+													// Limited
+													return true;
+											}
 
-				void				add(CWorkItem& workItem, CWorkItem::Priority priority)
+											return false;
+										}
+		UInt32						getCancelAllCountDeep() const
 										{
-											// Add
-											mWorkItemInfosLock.lock();
-											mIdleWorkItemInfos += new SWorkItemInfo(*this, workItem, priority);
-											mWorkItemInfosLock.unlock();
+											// Total up to the main work item queue
+											UInt32	cancelAllCountDeep = 0;
+											for (const CWorkItemQueueInternals* workItemQueueInternals = this;
+													workItemQueueInternals != nil;
+													workItemQueueInternals =
+															workItemQueueInternals->getTargetWorkItemQueueInternals())
+												// Add
+												cancelAllCountDeep += workItemQueueInternals->mCancelAllCount;
+
+											return cancelAllCountDeep;
 										}
-				CWorkItem&			add(CProcWorkItem::Proc proc, void* userData, CWorkItem::Priority priority)
+
+									// Must be called with the admission lock held
+		SWorkItemInfo*				getNextWaitingWorkItemInfo(CWorkItem::Priority priority) const
 										{
-											// Add
-											mWorkItemInfosLock.lock();
-											mIdleWorkItemInfos += new SWorkItemInfo(*this, proc, userData, priority);
-											CWorkItem&	workItem = *mIdleWorkItemInfos.getLast().mProcWorkItem;
-											mWorkItemInfosLock.unlock();
+											// Check if can admit anything at this priority
+											if (mIsPaused ||
+													(mAdmittedWorkItemInfosCountDeep >= mMaximumConcurrentWorkItems) ||
+													(mWaitingWorkItemInfosCountsDeep[priority] == 0))
+												// No
+												return nil;
+
+											// Start with our own first waiting work item info
+											SWorkItemInfo*	workItemInfo =
+																	mWaitingWorkItemInfos[priority].mFirstWorkItemInfo;
+
+											// Check child work item queues for an earlier one
+											for (CWorkItemQueueInternals* childWorkItemQueueInternals =
+															mFirstChildWorkItemQueueInternals;
+													childWorkItemQueueInternals != nil;
+													childWorkItemQueueInternals =
+															childWorkItemQueueInternals->
+																	mNextSiblingWorkItemQueueInternals) {
+												// Check this child
+												SWorkItemInfo*	childWorkItemInfo =
+																		childWorkItemQueueInternals->
+																				getNextWaitingWorkItemInfo(priority);
+												if ((childWorkItemInfo != nil) &&
+														((workItemInfo == nil) ||
+																(childWorkItemInfo->mIndex < workItemInfo->mIndex)))
+													// Use this child work item info
+													workItemInfo = childWorkItemInfo;
+											}
 
-											return workItem;
+											return workItemInfo;
 										}
 
-				void				pause()
-										{ mIsPaused = true; }
-				void				resume()
-										{ mIsPaused = false; }
+		OR<CWorkItemQueueInternals>	mTargetWorkItemQueueInternals;
+		UInt32						mMaximumConcurrentWorkItems;
+		std::atomic<bool>			mIsPaused;
+		std::atomic<UInt32>			mCancelAllCount;
+
+									// Protected by the admission lock
+		SWorkItemInfoList			mWaitingWorkItemInfos[kPriorityCount];
+		UInt32						mWaitingWorkItemInfosCountsDeep[kPriorityCount];
+		UInt32						mAdmittedWorkItemInfosCountDeep;
+		CWorkItemQueueInternals*	mFirstChildWorkItemQueueInternals;
+		CWorkItemQueueInternals*	mNextSiblingWorkItemQueueInternals;
+};
 
-		static	void				processWorkItems()
-										{
-											// Check if can do another workItem
-											mWorkItemThreadInfosLock.lock();
-
-											// Get next work item info
-											OR<SWorkItemInfo>	workItemInfo =
-																		mMainWorkItemQueueInternals->
-																				getNextWorkItemInfo();
-											while (
-													(mActiveWorkItemThreadInfos.getCount() <
-															mMainWorkItemQueueInternals->mMaximumConcurrentWorkItems) &&
-													workItemInfo.hasReference()) {
-												// Move from idle to active
-												workItemInfo->mOwningWorkItemQueueInternals.mWorkItemInfosLock.lock();
-												workItemInfo->mOwningWorkItemQueueInternals.mIdleWorkItemInfos.move(
-														*workItemInfo,
-														workItemInfo->mOwningWorkItemQueueInternals
-																.mActiveWorkItemInfos);
-												workItemInfo->transitionTo(CWorkItem::kStateActive);
-												workItemInfo->mOwningWorkItemQueueInternals.mWorkItemInfosLock.unlock();
-
-												// Find thread
-												if (mIdleWorkItemThreadInfos.getCount() > 0) {
-													// Resume an idle thread
-													SWorkItemThreadInfo&	workItemThreadInfo =
-																					mIdleWorkItemThreadInfos.getFirst();
-													workItemThreadInfo.mWorkItemInfo = &*workItemInfo;
-													workItemThreadInfo.mSemaphore.signal();
-
-													mIdleWorkItemThreadInfos.move(workItemThreadInfo,
-															mActiveWorkItemThreadInfos);
-												} else {
-													// Create new active thread
-													UInt32	threadNumber = mActiveWorkItemThreadInfos.getCount() + 1;
-													CString	threadName =
-																	CString(OSSTR("CWorkItemQueue #")) +
-																			CString(threadNumber);
-													mActiveWorkItemThreadInfos +=
-															new SWorkItemThreadInfo(*workItemInfo, threadProc,
-																	threadName);
-												}
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CWorkItemScheduler
 
-												// Get next work item info
-												workItemInfo = mMainWorkItemQueueInternals->getNextWorkItemInfo();
-											}
-											mWorkItemThreadInfosLock.unlock();
-										}
+class CWorkItemScheduler {
+	public:
+						CWorkItemScheduler(CWorkItemQueueInternals& mainWorkItemQueueInternals,
+								UInt32 minimumWorkerCount, UInt32 maximumWorkerCount,
+								UniversalTimeInterval idleTimeoutInterval, UInt32 processorCoresCount, bool prewarm) :
+							mMainWorkItemQueueInternals(mainWorkItemQueueInternals),
+									mWorkers(
+											(SWorkItemWorker**) ::calloc(maximumWorkerCount,
+													sizeof(SWorkItemWorker*))),
+									mWorkerCount(0), mMinimumWorkerCount(minimumWorkerCount),
+									mMaximumWorkerCount(maximumWorkerCount), mRunningWorkerCount(0),
+									mIdleWorkers(
+											(SWorkItemWorker**) ::calloc(maximumWorkerCount,
+													sizeof(SWorkItemWorker*))),
+									mIdleWorkerCount(0),
+									mExitedWorkers(
+											(SWorkItemWorker**) ::calloc(maximumWorkerCount,
+													sizeof(SWorkItemWorker*))),
+									mExitedWorkerCount(0), mIdleTimeoutInterval(idleTimeoutInterval),
+									mIdleSpinCount((processorCoresCount > 1) ? kIdleSpinCount : 0), mReadyCount(0)
+							{
+								// Check if pre-warming
+								if (prewarm) {
+									// Start minimum workers
+									mWorkersLock.lock();
+									while (mRunningWorkerCount < mMinimumWorkerCount)
+										// Start worker
+										startWorker();
+									mWorkersLock.unlock();
+								}
+							}
+
+		void			addChild(CWorkItemQueueInternals& workItemQueueInternals)
+							{
+								// Link as first child of target
+								mAdmissionLock.lock();
+								workItemQueueInternals.mNextSiblingWorkItemQueueInternals =
+										workItemQueueInternals.mTargetWorkItemQueueInternals->
+												mFirstChildWorkItemQueueInternals;
+								workItemQueueInternals.mTargetWorkItemQueueInternals->
+										mFirstChildWorkItemQueueInternals = &workItemQueueInternals;
+								mAdmissionLock.unlock();
+							}
+		void			removeChild(CWorkItemQueueInternals& workItemQueueInternals)
+							{
+								// Wait for admitted work items to be released since a worker releases admission after
+								//	the work item has already been reported as completed
+								mAdmissionLock.lock();
+								while (workItemQueueInternals.mAdmittedWorkItemInfosCountDeep > 0) {
+									// Let the worker finish
+									mAdmissionLock.unlock();
+									CThread::sleepFor(0.0001);
+									mAdmissionLock.lock();
+								}
+
+								// Unlink from target
+								CWorkItemQueueInternals**	workItemQueueInternalsPtr =
+																	&workItemQueueInternals
+																			.mTargetWorkItemQueueInternals->
+																			mFirstChildWorkItemQueueInternals;
+								while (*workItemQueueInternalsPtr != &workItemQueueInternals)
+									// Next
+									workItemQueueInternalsPtr =
+											&(*workItemQueueInternalsPtr)->mNextSiblingWorkItemQueueInternals;
+								*workItemQueueInternalsPtr = workItemQueueInternals.mNextSiblingWorkItemQueueInternals;
+								mAdmissionLock.unlock();
+							}
+
+		UInt32			getMaximumWorkerCount() const
+							{ return mMaximumWorkerCount; }
+		bool			needsAdmission(const SWorkItemInfo& workItemInfo) const
+							{
+								return workItemInfo.mOwningWorkItemQueueInternals.isPausedDeep() ||
+										workItemInfo.mOwningWorkItemQueueInternals.isLimitedDeep(
+												mMaximumWorkerCount);
+							}
+		void			add(SWorkItemInfo& workItemInfo)
+							{
+								// Note cancel all count
+								workItemInfo.mCancelAllCountDeep =
+										workItemInfo.mOwningWorkItemQueueInternals.getCancelAllCountDeep();
+
+								// Check if need to go through admission
+								if (needsAdmission(workItemInfo)) {
+									// Wait for admission
+									mAdmissionLock.lock();
+									addWaiting(workItemInfo);
+									admitAll();
+									mAdmissionLock.unlock();
+								} else
+									// Ready now
+									addReady(workItemInfo);
+							}
+		void			resume()
+							{
+								// Admit anything that was waiting on the pause
+								mAdmissionLock.lock();
+								admitAll();
+								mAdmissionLock.unlock();
+							}
+		void			cancel(CWorkItem& workItem)
+							{
+								// Check if waiting
+								mAdmissionLock.lock();
+								SWorkItemInfo*	workItemInfo = (SWorkItemInfo*) workItem.getQueueInfo();
+								if (workItemInfo != nil)
+									// Remove
+									removeWaiting(*workItemInfo);
+								mAdmissionLock.unlock();
+
+								// Check if removed
+								if (workItemInfo != nil)
+									// Cancelled
+									cancelled(workItemInfo);
+							}
+		void			cancelAll(CWorkItemQueueInternals& workItemQueueInternals)
+							{
+								// Skip work items already on a deque when they are taken
+								mAdmissionLock.lock();
+								workItemQueueInternals.mCancelAllCount++;
+
+								// Remove waiting work items
+								SWorkItemInfoList	workItemInfoList;
+								removeAllWaiting(workItemQueueInternals, workItemInfoList);
+								mAdmissionLock.unlock();
+
+								// Cancelled
+								while (workItemInfoList.mFirstWorkItemInfo != nil) {
+									// Cancelled
+									SWorkItemInfo*	workItemInfo = workItemInfoList.mFirstWorkItemInfo;
+									workItemInfoList.remove(*workItemInfo);
+									cancelled(workItemInfo);
+								}
+							}
+		bool			performNext()
+							{
+								// Get next work item info.  Workers look at their own deque first.
+								SWorkItemInfo*	workItemInfo =
+														getNextReady(
+																((sCurrentWorkItemWorker != nil) &&
+																		(&sCurrentWorkItemWorker->mWorkItemScheduler ==
+																				this)) ?
+																	OR<SWorkItemWorker>(*sCurrentWorkItemWorker) :
+																	OR<SWorkItemWorker>());
+								if (workItemInfo == nil)
+									// Nothing ready
+									return false;
+
+								// Perform
+								performReady(*workItemInfo);
+
+								return true;
+							}
 
-				UInt32				getActiveWorkItemInfosCountDeep()
-										{
-											// Setup
-											UInt32	count = 0;
+	private:
+						// Instance methods
+		void			addReady(SWorkItemInfo& workItemInfo)
+							{
+								// Add to the current worker's deque if called from a worker or the injection deque
+								//	otherwise
+								if ((sCurrentWorkItemWorker != nil) &&
+										(&sCurrentWorkItemWorker->mWorkItemScheduler == this))
+									// Current worker
+									sCurrentWorkItemWorker->mDeques[workItemInfo.mPriority].addLast(workItemInfo);
+								else
+									// Injection
+									mInjectionDeques[workItemInfo.mPriority].addLast(workItemInfo);
+								mReadyCount++;
+
+								// Wake or start a worker
+								mWorkersLock.lock();
+								if (mIdleWorkerCount > 0)
+									// Wake idle worker
+									mIdleWorkers[--mIdleWorkerCount]->mSemaphore.signal();
+								else if (mRunningWorkerCount < mMaximumWorkerCount)
+									// Start worker
+									startWorker();
+								mWorkersLock.unlock();
+							}
+						// Must be called with the workers lock held
+		void			startWorker()
+							{
+								// Check if have an exited worker
+								if (mExitedWorkerCount > 0)
+									// Restart in its slot
+									mExitedWorkers[--mExitedWorkerCount]->start();
+								else {
+									// Start a new worker.  The count is published after the worker is stored so
+									//	thieves only see workers that exist.
+									mWorkers[mWorkerCount] = new SWorkItemWorker(*this, mWorkerCount, threadProc);
+									mWorkerCount++;
+								}
+								mRunningWorkerCount++;
+							}
+		bool			waitForWork(SWorkItemWorker& workItemWorker)
+							{
+								// Spin briefly in case more work is about to arrive
+								for (UInt32 i = 0; (i < mIdleSpinCount) && (mReadyCount.load() == 0); i++)
+									// Relax
+									relax();
+								if (mReadyCount.load() > 0)
+									// More work arrived
+									return true;
+
+								// Go idle.  Recheck after registering as idle since a work item added before we
+								//	registered would not have woken anyone.
+								mWorkersLock.lock();
+								if (mReadyCount > 0) {
+									// More work arrived
+									mWorkersLock.unlock();
+
+									return true;
+								}
+								mIdleWorkers[mIdleWorkerCount++] = &workItemWorker;
+								mWorkersLock.unlock();
+
+								// Park
+								while (!workItemWorker.mSemaphore.timedWaitFor(mIdleTimeoutInterval)) {
+									// Timed out
+									mWorkersLock.lock();
+									UInt32	index = 0;
+									while ((index < mIdleWorkerCount) && (mIdleWorkers[index] != &workItemWorker))
+										// Next
+										index++;
+									if (index == mIdleWorkerCount) {
+										// Woken just as we timed out, so consume the signal
+										mWorkersLock.unlock();
+										workItemWorker.mSemaphore.waitFor();
+
+										return true;
+									}
+									if (mRunningWorkerCount > mMinimumWorkerCount) {
+										// Exit
+										mIdleWorkers[index] = mIdleWorkers[--mIdleWorkerCount];
+										mExitedWorkers[mExitedWorkerCount++] = &workItemWorker;
+										mRunningWorkerCount--;
+										mWorkersLock.unlock();
+
+										return false;
+									}
+									mWorkersLock.unlock();
+								}
+
+								return true;
+							}
+		SWorkItemInfo*	getNextReady(const OR<SWorkItemWorker>& workItemWorker)
+							{
+								// Check each priority
+								for (UInt32 priority = 0; priority < kPriorityCount; priority++) {
+									// Check our deque
+									SWorkItemInfo*	workItemInfo =
+															workItemWorker.hasReference() ?
+																	workItemWorker->mDeques[priority].removeFirst() :
+																	nil;
+									if (workItemInfo != nil)
+										// Found
+										return workItemInfo;
+
+									// Check the injection deque
+									workItemInfo = mInjectionDeques[priority].removeFirst();
+									if (workItemInfo != nil)
+										// Found
+										return workItemInfo;
+
+									// Steal, starting after ourselves so thieves spread out
+									UInt32	workerCount = mWorkerCount;
+									UInt32	startIndex = workItemWorker.hasReference() ? workItemWorker->mIndex + 1 : 0;
+									for (UInt32 i = 0; i < workerCount; i++) {
+										// Check if ourselves
+										SWorkItemWorker*	otherWorkItemWorker =
+																	mWorkers[(startIndex + i) % workerCount];
+										if (workItemWorker.hasReference() && (otherWorkItemWorker == &*workItemWorker))
+											// Skip
+											continue;
+
+										// Try to steal from this worker
+										workItemInfo = otherWorkItemWorker->mDeques[priority].removeLast();
+										if (workItemInfo != nil)
+											// Found
+											return workItemInfo;
+									}
+								}
+
+								return nil;
+							}
+		void			performReady(SWorkItemInfo& workItemInfo)
+							{
+								// No longer ready
+								mReadyCount--;
+
+								// Check if paused since it was made ready
+								if (!isCancelled(workItemInfo) &&
+										workItemInfo.mOwningWorkItemQueueInternals.isPausedDeep()) {
+									// Back to waiting
+									mAdmissionLock.lock();
+									if (workItemInfo.mIsAdmitted)
+										// Release
+										releaseAdmission(workItemInfo);
+									addWaiting(workItemInfo);
+									admitAll();
+									mAdmissionLock.unlock();
+
+									return;
+								}
+
+								// Perform, following any continuations
+								SWorkItemInfo*	nextWorkItemInfo = &workItemInfo;
+								while (nextWorkItemInfo != nil)
+									// Perform
+									nextWorkItemInfo = perform(nextWorkItemInfo);
+							}
+		SWorkItemInfo*	perform(SWorkItemInfo* workItemInfo)
+							{
+								// Check if cancelled before it started
+								CWorkItem&	workItem = workItemInfo->getWorkItem();
+								if (!isCancelled(*workItemInfo)) {
+									// Perform
+									workItem.transitionTo(CWorkItem::kStateActive);
+									workItem.perform();
+
+									// Note completed (or cancelled if it stopped early after being asked to stop)
+									workItem.transitionTo(
+											(workItem.isCancelRequested() && workItem.wasStoppedEarly()) ?
+													CWorkItem::kStateCancelled : CWorkItem::kStateCompleted);
+								} else
+									// Cancelled
+									workItem.transitionTo(CWorkItem::kStateCancelled);
+
+								// Check if admitted
+								if (workItemInfo->mIsAdmitted) {
+									// Release and admit more
+									mAdmissionLock.lock();
+									releaseAdmission(*workItemInfo);
+									admitAll();
+									mAdmissionLock.unlock();
+								}
+
+								// Check for continuation
+								SWorkItemInfo*	nextWorkItemInfo =
+														(workItemInfo->mCompletedProc != nil) ?
+																workItemInfo->mCompletedProc(
+																		workItemInfo->mCompletedProcUserData) :
+																nil;
+
+								// Cleanup
+								Delete(workItemInfo);
+
+								return nextWorkItemInfo;
+							}
+		void			cancelled(SWorkItemInfo* workItemInfo)
+							{
+								// Note cancelled
+								workItemInfo->getWorkItem().transitionTo(CWorkItem::kStateCancelled);
+
+								// Check for continuation
+								SWorkItemInfo*	nextWorkItemInfo =
+														(workItemInfo->mCompletedProc != nil) ?
+																workItemInfo->mCompletedProc(
+																		workItemInfo->mCompletedProcUserData) :
+																nil;
+								if (nextWorkItemInfo != nil)
+									// Add
+									add(*nextWorkItemInfo);
+
+								// Cleanup
+								Delete(workItemInfo);
+							}
+		bool			isCancelled(const SWorkItemInfo& workItemInfo) const
+							{
+								return workItemInfo.getWorkItem().isCancelRequested() ||
+										(workItemInfo.mOwningWorkItemQueueInternals.getCancelAllCountDeep() !=
+												workItemInfo.mCancelAllCountDeep);
+							}
+
+						// Must be called with the admission lock held
+		void			addWaiting(SWorkItemInfo& workItemInfo)
+							{
+								// Add to owning work item queue
+								workItemInfo.mOwningWorkItemQueueInternals.mWaitingWorkItemInfos[
+										workItemInfo.mPriority].add(workItemInfo);
+								workItemInfo.getWorkItem().setQueueInfo(&workItemInfo);
+
+								// Update counts up to the main work item queue
+								for (CWorkItemQueueInternals* workItemQueueInternals =
+												&workItemInfo.mOwningWorkItemQueueInternals;
+										workItemQueueInternals != nil;
+										workItemQueueInternals =
+												workItemQueueInternals->getTargetWorkItemQueueInternals())
+									// Update count
+									workItemQueueInternals->mWaitingWorkItemInfosCountsDeep[workItemInfo.mPriority]++;
+							}
+		void			removeWaiting(SWorkItemInfo& workItemInfo)
+							{
+								// Remove from owning work item queue
+								workItemInfo.mOwningWorkItemQueueInternals.mWaitingWorkItemInfos[
+										workItemInfo.mPriority].remove(workItemInfo);
+								workItemInfo.getWorkItem().setQueueInfo(nil);
+
+								// Update counts up to the main work item queue
+								for (CWorkItemQueueInternals* workItemQueueInternals =
+												&workItemInfo.mOwningWorkItemQueueInternals;
+										workItemQueueInternals != nil;
+										workItemQueueInternals =
+												workItemQueueInternals->getTargetWorkItemQueueInternals())
+									// Update count
+									workItemQueueInternals->mWaitingWorkItemInfosCountsDeep[workItemInfo.mPriority]--;
+							}
+		void			removeAllWaiting(CWorkItemQueueInternals& workItemQueueInternals,
+								SWorkItemInfoList& workItemInfoList)
+							{
+								// Remove our own
+								for (UInt32 priority = 0; priority < kPriorityCount; priority++) {
+									// Remove all at this priority
+									while (workItemQueueInternals.mWaitingWorkItemInfos[priority].mFirstWorkItemInfo !=
+											nil) {
+										// Move to list
+										SWorkItemInfo*	workItemInfo =
+																workItemQueueInternals.mWaitingWorkItemInfos[priority]
+																		.mFirstWorkItemInfo;
+										removeWaiting(*workItemInfo);
+										workItemInfoList.add(*workItemInfo);
+									}
+								}
+
+								// Remove from child work item queues
+								for (CWorkItemQueueInternals* childWorkItemQueueInternals =
+												workItemQueueInternals.mFirstChildWorkItemQueueInternals;
+										childWorkItemQueueInternals != nil;
+										childWorkItemQueueInternals =
+												childWorkItemQueueInternals->mNextSiblingWorkItemQueueInternals)
+									// Remove from this child
+									removeAllWaiting(*childWorkItemQueueInternals, workItemInfoList);
+							}
+		void			admitAll()
+							{
+								// Admit until nothing more can be
+								while (true) {
+									// Find the highest priority, earliest created work item info that can be admitted
+									SWorkItemInfo*	workItemInfo = nil;
+									for (UInt32 priority = 0; (workItemInfo == nil) && (priority < kPriorityCount);
+											priority++)
+										// Check this priority
+										workItemInfo =
+												mMainWorkItemQueueInternals.getNextWaitingWorkItemInfo(
+														(CWorkItem::Priority) priority);
+									if (workItemInfo == nil)
+										// Done
+										return;
+
+									// Remove from waiting
+									removeWaiting(*workItemInfo);
+
+									// Update counts up to the main work item queue
+									for (CWorkItemQueueInternals* workItemQueueInternals =
+													&workItemInfo->mOwningWorkItemQueueInternals;
+											workItemQueueInternals != nil;
+											workItemQueueInternals =
+													workItemQueueInternals->getTargetWorkItemQueueInternals())
+										// Update count
+										workItemQueueInternals->mAdmittedWorkItemInfosCountDeep++;
+
+									// Ready
+									workItemInfo->mIsAdmitted = true;
+									addReady(*workItemInfo);
+								}
+							}
+		void			releaseAdmission(SWorkItemInfo& workItemInfo)
+							{
+								// Update counts up to the main work item queue
+								for (CWorkItemQueueInternals* workItemQueueInternals =
+												&workItemInfo.mOwningWorkItemQueueInternals;
+										workItemQueueInternals != nil;
+										workItemQueueInternals =
+												workItemQueueInternals->getTargetWorkItemQueueInternals())
+									// Update count
+									workItemQueueInternals->mAdmittedWorkItemInfosCountDeep--;
+								workItemInfo.mIsAdmitted = false;
+							}
+
+						// Class methods
+		static	void	relax()
+							{
+#if defined(__SSE2__) || defined(_M_X64)
+								// Let the other hyperthread run
+								_mm_pause();
+#endif
+							}
+		static	void	threadProc(CThread& thread, void* userData)
+							{
+								// Setup
+								SWorkItemWorker&	workItemWorker = *((SWorkItemWorker*) userData);
+								CWorkItemScheduler&	workItemScheduler = workItemWorker.mWorkItemScheduler;
+								sCurrentWorkItemWorker = &workItemWorker;
+
+								// Run until idle too long
+								while (true) {
+									// Get next work item info
+									SWorkItemInfo*	workItemInfo =
+															workItemScheduler.getNextReady(
+																	OR<SWorkItemWorker>(workItemWorker));
+									if (workItemInfo == nil) {
+										// Wait for more work
+										if (workItemScheduler.waitForWork(workItemWorker))
+											// Try again
+											continue;
+										else
+											// Idle too long
+											break;
+									}
 
-											// Add our active work items
-											mWorkItemInfosLock.lock();
-											count += mActiveWorkItemInfos.getCount();
-											mWorkItemInfosLock.unlock();
+									// Perform
+									workItemScheduler.performReady(*workItemInfo);
+								}
+							}
 
-											// Add active work items from all child work item queues
-											mChildWorkItemQueueReferences.apply(
-													SWorkItemQueueReference::getActiveWorkItemInfosCountDeep, &count);
+	// Properties
+	private:
+		CWorkItemQueueInternals&	mMainWorkItemQueueInternals;
+
+		CLock						mAdmissionLock;
+
+		CWorkItemDeque				mInjectionDeques[kPriorityCount];
+
+		SWorkItemWorker**			mWorkers;
+		std::atomic<UInt32>			mWorkerCount;
+		UInt32						mMinimumWorkerCount;
+		UInt32						mMaximumWorkerCount;
+		UInt32						mRunningWorkerCount;
+		SWorkItemWorker**			mIdleWorkers;
+		UInt32						mIdleWorkerCount;
+		SWorkItemWorker**			mExitedWorkers;
+		UInt32						mExitedWorkerCount;
+		UniversalTimeInterval		mIdleTimeoutInterval;
+		UInt32						mIdleSpinCount;
+		std::atomic<UInt32>			mReadyCount;
+		CLock						mWorkersLock;
+};
 
-											return count;
-										}
-				OR<SWorkItemInfo>	getNextWorkItemInfo()
-										{
-											// Check if paused
-											if (mIsPaused)
-												// Paused
-												return OR<SWorkItemInfo>();
-
-											// Check if have headroom
-											if (getActiveWorkItemInfosCountDeep() >= mMaximumConcurrentWorkItems)
-												// No more headroom
-												return OR<SWorkItemInfo>();
-
-											// Get our next work item info
-											mWorkItemInfosLock.lock();
-											mIdleWorkItemInfos.sort(workItemInfoCompareProc);
-											OR<SWorkItemInfo>	workItemInfo =
-																		!mIdleWorkItemInfos.isEmpty() ?
-																				OR<SWorkItemInfo>(mIdleWorkItemInfos[0]) :
-																				OR<SWorkItemInfo>();
-											mWorkItemInfosLock.unlock();
-
-											// Check any child work item queues
-											mChildWorkItemQueueReferences.apply(
-													SWorkItemQueueReference::getNextWorkItemInfo, &workItemInfo);
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - SWorkItemGraphNode
+
+class CWorkItemGraphInternals;
+struct SWorkItemGraphNode {
+	// Edge
+	struct Edge {
+		// Lifecycle methods
+		Edge(SWorkItemGraphNode& successorWorkItemGraphNode) :
+			mSuccessorWorkItemGraphNode(successorWorkItemGraphNode), mNextEdge(nil)
+			{}
+
+		// Properties
+		SWorkItemGraphNode&	mSuccessorWorkItemGraphNode;
+		Edge*				mNextEdge;
+	};
 
-											return workItemInfo;
+			// Lifecycle methods
+			SWorkItemGraphNode(CWorkItemGraphInternals& workItemGraphInternals, CWorkItem& workItem,
+					const OI<CProcWorkItem>& procWorkItem, CWorkItem::Priority priority) :
+				mWorkItemGraphInternals(workItemGraphInternals), mWorkItem(workItem), mProcWorkItem(procWorkItem),
+						mPriority(priority), mPendingPredecessorsCount(0), mIsCompleted(false), mIsCancelled(false),
+						mFirstEdge(nil), mLastEdge(nil)
+				{}
+			~SWorkItemGraphNode()
+				{ removeAllEdges(); }
+
+			// Instance methods
+	void	addSuccessor(SWorkItemGraphNode& successorWorkItemGraphNode)
+				{
+					// Append so successors are started in the order they were added
+					Edge*	edge = new Edge(successorWorkItemGraphNode);
+					if (mLastEdge != nil)
+						// Have last
+						mLastEdge->mNextEdge = edge;
+					else
+						// First
+						mFirstEdge = edge;
+					mLastEdge = edge;
+
+					successorWorkItemGraphNode.mPendingPredecessorsCount++;
+				}
+	void	removeAllEdges()
+				{
+					// Delete all
+					while (mFirstEdge != nil) {
+						// Delete this one
+						Edge*	edge = mFirstEdge;
+						mFirstEdge = edge->mNextEdge;
+						Delete(edge);
+					}
+					mLastEdge = nil;
+				}
+
+	// Properties
+	CWorkItemGraphInternals&	mWorkItemGraphInternals;
+	CWorkItem&					mWorkItem;
+	OI<CProcWorkItem>			mProcWorkItem;
+	CWorkItem::Priority			mPriority;
+	UInt32						mPendingPredecessorsCount;
+	bool						mIsCompleted;
+	bool						mIsCancelled;
+	Edge*						mFirstEdge;
+	Edge*						mLastEdge;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CWorkItemGraphInternals
+
+class CWorkItemGraphInternals {
+	public:
+								CWorkItemGraphInternals(CWorkItemQueueInternals& workItemQueueInternals) :
+									mWorkItemQueueInternals(workItemQueueInternals), mIncompleteCount(0),
+											mWaiterCount(0)
+									{}
+								~CWorkItemGraphInternals()
+									{
+										// Cleanup
+										for (TNumericKeyDictionary<UInt64, SWorkItemGraphNode*>::Iterator iterator =
+														mWorkItemGraphNodes.begin();
+												iterator != mWorkItemGraphNodes.end(); ++iterator)
+											// Delete
+											Delete(*iterator);
+									}
+
+		void					add(CWorkItem& workItem, const OI<CProcWorkItem>& procWorkItem,
+										const TArray<R<CWorkItem> >& predecessorWorkItems,
+										CWorkItem::Priority priority)
+									{
+										// Setup
+										SWorkItemGraphNode*	workItemGraphNode =
+																	new SWorkItemGraphNode(*this, workItem,
+																			procWorkItem, priority);
+
+										// Add
+										mLock.lock();
+										AssertFailIf(mWorkItemGraphNodes.contains(getKey(workItem)));
+										mWorkItemGraphNodes.set(getKey(workItem), workItemGraphNode);
+										mIncompleteCount++;
+
+										// Link to predecessors that have not yet completed
+										for (CArray::ItemIndex i = 0; i < predecessorWorkItems.getCount(); i++) {
+											// Get predecessor
+											OR<SWorkItemGraphNode*>	predecessorWorkItemGraphNode =
+																			mWorkItemGraphNodes.get(
+																					getKey(*predecessorWorkItems[i]));
+											AssertFailIf(!predecessorWorkItemGraphNode.hasReference());
+
+											// Check state
+											if ((*predecessorWorkItemGraphNode)->mIsCancelled)
+												// Will never be performed
+												workItemGraphNode->mIsCancelled = true;
+											else if (!(*predecessorWorkItemGraphNode)->mIsCompleted)
+												// Add edge
+												(*predecessorWorkItemGraphNode)->addSuccessor(*workItemGraphNode);
 										}
 
-	private:
-		static	ECompareResult		workItemInfoCompareProc(const SWorkItemInfo& workItemInfo1,
-											const SWorkItemInfo& workItemInfo2, void* userData)
-										{
-											// Sort in this order:
-											//	Priority
-											//	Index
-											if (workItemInfo1.mPriority < workItemInfo2.mPriority)
-												// Work item 1 has a higher priority
-												return kCompareResultBefore;
-											else if (workItemInfo2.mPriority < workItemInfo1.mPriority)
-												// Work item 2 has a higher priority
-												return kCompareResultAfter;
-											else if (workItemInfo1.mIndex < workItemInfo2.mIndex)
-												// Work item 1 has an earlier index
-												return kCompareResultBefore;
-											else
-												// Work item 1 has a later index
-												return kCompareResultAfter;
+										// Check if cancelled
+										if (workItemGraphNode->mIsCancelled) {
+											// Cancel
+											mLock.unlock();
+											workItem.transitionTo(CWorkItem::kStateCancelled);
+
+											mLock.lock();
+											noteCompleted(*workItemGraphNode);
+										} else if (workItemGraphNode->mPendingPredecessorsCount == 0)
+											// Add to work item queue
+											sWorkItemScheduler->add(*createWorkItemInfo(*workItemGraphNode));
+										mLock.unlock();
+									}
+		void					waitFor(const OR<CWorkItem>& workItem)
+									{
+										// Setup
+										SWorkItemGraphNode*	workItemGraphNode = nil;
+										if (workItem.hasReference()) {
+											// Get node
+											mLock.lock();
+											OR<SWorkItemGraphNode*>	workItemGraphNodeReference =
+																			mWorkItemGraphNodes.get(getKey(*workItem));
+											AssertFailIf(!workItemGraphNodeReference.hasReference());
+											workItemGraphNode = *workItemGraphNodeReference;
+											mLock.unlock();
 										}
-		static	void				threadProc(CThread& thread, void* userData)
-										{
-											// Setup
-											SWorkItemThreadInfo&	workItemThreadInfo =
-																			*((SWorkItemThreadInfo*) userData);
 
-											// Run forever
-											while (true) {
-												// Setup
-												SWorkItemInfo&				workItemInfo =
-																					*workItemThreadInfo.mWorkItemInfo;
-												CWorkItemQueueInternals&	workItemQueueInternals =
-																					workItemInfo
-																							.mOwningWorkItemQueueInternals;
+										// Help until done
+										while (true) {
+											// Check if done
+											mLock.lock();
+											if (isDone(workItemGraphNode)) {
+												// Done
+												mLock.unlock();
+												break;
+											}
+											mLock.unlock();
+
+											// Perform a ready work item if there is one
+											if (sWorkItemScheduler->performNext())
+												// Check again
+												continue;
+
+											// Wait for a work item in this graph to complete.  The timeout lets us
+											//	help again with work items that became ready in the meantime.
+											mLock.lock();
+											if (isDone(workItemGraphNode)) {
+												// Done
+												mLock.unlock();
+												break;
+											}
+											mWaiterCount++;
+											mLock.unlock();
 
-												// Perform
-												workItemInfo.perform();
+											mSemaphore.timedWaitFor(CWorkItemQueue::kHelpingWaitTimeInterval);
 
-												// Note completed
-												workItemInfo.transitionTo(CWorkItem::kStateCompleted);
-												workItemThreadInfo.mWorkItemInfo = nil;
-
-												// Remove work item info from active
-												workItemQueueInternals.mWorkItemInfosLock.lock();
-												workItemQueueInternals.mActiveWorkItemInfos -= workItemInfo;
-												workItemQueueInternals.mWorkItemInfosLock.unlock();
-
-												// Move this thread to idle
-												mWorkItemThreadInfosLock.lock();
-												mActiveWorkItemThreadInfos.move(workItemThreadInfo,
-														mIdleWorkItemThreadInfos);
-												mWorkItemThreadInfosLock.unlock();
-
-												// Process work items
-												processWorkItems();
-
-												// Check if waiting on workItem info
-												if (workItemThreadInfo.mWorkItemInfo == nil)
-													// Wait
-													workItemThreadInfo.mSemaphore.waitFor();
+											mLock.lock();
+											mWaiterCount--;
+											mLock.unlock();
+										}
+									}
+
+								// Must be called with the lock held
+		bool					isDone(SWorkItemGraphNode* workItemGraphNode) const
+									{
+										return (workItemGraphNode != nil) ?
+												workItemGraphNode->mIsCompleted : (mIncompleteCount == 0);
+									}
+		SWorkItemInfo*			createWorkItemInfo(SWorkItemGraphNode& workItemGraphNode)
+									{
+										return new SWorkItemInfo(mWorkItemQueueInternals,
+												workItemGraphNode.mWorkItem, workItemGraphNode.mPriority, completed,
+												&workItemGraphNode);
+									}
+		void					noteCompleted(SWorkItemGraphNode& workItemGraphNode)
+									{
+										// Update
+										workItemGraphNode.mIsCompleted = true;
+										mIncompleteCount--;
+										for (UInt32 i = 0; i < mWaiterCount; i++)
+											// Wake waiter
+											mSemaphore.signal();
+									}
+		void					noteCancelled(SWorkItemGraphNode& workItemGraphNode,
+										TNArray<R<SWorkItemGraphNode> >& cancelledWorkItemGraphNodes)
+									{
+										// Everything that depends on a cancelled work item is cancelled too.  Walk the
+										//	successors breadth first as chains can be long.
+										workItemGraphNode.mIsCancelled = true;
+										cancelledWorkItemGraphNodes += R<SWorkItemGraphNode>(workItemGraphNode);
+										for (CArray::ItemIndex i = 0; i < cancelledWorkItemGraphNodes.getCount();
+												i++) {
+											// Iterate successors
+											SWorkItemGraphNode&	cancelledWorkItemGraphNode =
+																		*cancelledWorkItemGraphNodes[i];
+											for (SWorkItemGraphNode::Edge* edge =
+															cancelledWorkItemGraphNode.mFirstEdge;
+													edge != nil; edge = edge->mNextEdge) {
+												// Check if already cancelled
+												SWorkItemGraphNode&	successorWorkItemGraphNode =
+																			edge->mSuccessorWorkItemGraphNode;
+												if (!successorWorkItemGraphNode.mIsCancelled) {
+													// Cancel
+													successorWorkItemGraphNode.mIsCancelled = true;
+													cancelledWorkItemGraphNodes +=
+															R<SWorkItemGraphNode>(successorWorkItemGraphNode);
+												}
 											}
+											cancelledWorkItemGraphNode.removeAllEdges();
 										}
+									}
 
-	public:
-		static	OR<CWorkItemQueueInternals>				mMainWorkItemQueueInternals;
+								// Class methods
+		static	UInt64			getKey(const CWorkItem& workItem)
+									{ return (UInt64) (uintptr_t) &workItem; }
+		static	SWorkItemInfo*	completed(void* userData)
+									{
+										// Setup
+										SWorkItemGraphNode&			workItemGraphNode =
+																			*((SWorkItemGraphNode*) userData);
+										CWorkItemGraphInternals&	internals =
+																			workItemGraphNode.mWorkItemGraphInternals;
+										SWorkItemInfo*				continuationWorkItemInfo = nil;
+
+										// Check if cancelled
+										if (workItemGraphNode.mWorkItem.isCancelled()) {
+											// Cancel successors (without holding the lock while they are notified)
+											TNArray<R<SWorkItemGraphNode> >	cancelledWorkItemGraphNodes;
+											internals.mLock.lock();
+											internals.noteCancelled(workItemGraphNode, cancelledWorkItemGraphNodes);
+											internals.mLock.unlock();
+
+											for (CArray::ItemIndex i = 1; i < cancelledWorkItemGraphNodes.getCount();
+													i++)
+												// Note cancelled
+												cancelledWorkItemGraphNodes[i]->mWorkItem.transitionTo(
+														CWorkItem::kStateCancelled);
+
+											// Done
+											internals.mLock.lock();
+											for (CArray::ItemIndex i = 0; i < cancelledWorkItemGraphNodes.getCount();
+													i++)
+												// Note completed
+												internals.noteCompleted(*cancelledWorkItemGraphNodes[i]);
+											internals.mLock.unlock();
 
-	private:
-				bool									mIsPaused;
+											return nil;
+										}
 
-				OR<CWorkItemQueueInternals>				mTargetWorkItemQueueInternals;
-				UInt32									mMaximumConcurrentWorkItems;
+										// Start successors that are now ready.  The first one that can be performed
+										//	right away is handed back to be performed next on this thread.
+										internals.mLock.lock();
+										for (SWorkItemGraphNode::Edge* edge = workItemGraphNode.mFirstEdge;
+												edge != nil; edge = edge->mNextEdge) {
+											// Check if ready
+											SWorkItemGraphNode&	successorWorkItemGraphNode =
+																		edge->mSuccessorWorkItemGraphNode;
+											if ((--successorWorkItemGraphNode.mPendingPredecessorsCount > 0) ||
+													successorWorkItemGraphNode.mIsCancelled)
+												// Not yet (or never)
+												continue;
+
+											// Ready
+											SWorkItemInfo*	workItemInfo =
+																	internals.createWorkItemInfo(
+																			successorWorkItemGraphNode);
+											if ((continuationWorkItemInfo == nil) &&
+													!sWorkItemScheduler->needsAdmission(*workItemInfo)) {
+												// Continuation
+												workItemInfo->mCancelAllCountDeep =
+														internals.mWorkItemQueueInternals.getCancelAllCountDeep();
+												continuationWorkItemInfo = workItemInfo;
+											} else
+												// Add to work item queue
+												sWorkItemScheduler->add(*workItemInfo);
+										}
+										workItemGraphNode.removeAllEdges();
 
-				SWorkItemQueueReference*				mWorkItemQueueReference;
-				TILockingArray<SWorkItemQueueReference>	mChildWorkItemQueueReferences;
+										// Note completed
+										internals.noteCompleted(workItemGraphNode);
+										internals.mLock.unlock();
 
-				TIArray<SWorkItemInfo>					mActiveWorkItemInfos;
-				TIArray<SWorkItemInfo>					mIdleWorkItemInfos;
-				CLock									mWorkItemInfosLock;
+										return continuationWorkItemInfo;
+									}
 
-		static	TIArray<SWorkItemThreadInfo>			mActiveWorkItemThreadInfos;
-		static	TIArray<SWorkItemThreadInfo>			mIdleWorkItemThreadInfos;
-		static	CLock									mWorkItemThreadInfosLock;
+		CWorkItemQueueInternals&							mWorkItemQueueInternals;
+		TNumericKeyDictionary<UInt64, SWorkItemGraphNode*>	mWorkItemGraphNodes;
+		UInt32												mIncompleteCount;
+		UInt32												mWaiterCount;
+		CLock												mLock;
+		CSemaphore											mSemaphore;
 };
 
-OR<CWorkItemQueueInternals>		CWorkItemQueueInternals::mMainWorkItemQueueInternals;
-TIArray<SWorkItemThreadInfo>	CWorkItemQueueInternals::mActiveWorkItemThreadInfos;
-TIArray<SWorkItemThreadInfo>	CWorkItemQueueInternals::mIdleWorkItemThreadInfos;
-CLock							CWorkItemQueueInternals::mWorkItemThreadInfosLock;
-
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
-// MARK: - SWorkItemQueueReference
+// MARK: - SParallelChunksInfo
+//	Chunks are claimed by the calling thread and by any helper work items that get to run.  The info is reference
+//		counted because a helper work item may not start until after the calling thread has moved on.
+
+struct SParallelChunksInfo {
+					// Lifecycle methods
+					SParallelChunksInfo(UInt32 startIndex, UInt32 endIndex, UInt32 chunkItemCount, UInt32 chunkCount,
+							CWorkItemQueue::ParallelChunkProc parallelChunkProc, void* userData) :
+						mStartIndex(startIndex), mEndIndex(endIndex), mChunkItemCount(chunkItemCount),
+								mChunkCount(chunkCount), mParallelChunkProc(parallelChunkProc), mUserData(userData),
+								mNextChunkIndex(0), mCompletedChunkCount(0), mReferenceCount(1)
+						{}
+
+					// Instance methods
+	void*			addReference()
+						{ mReferenceCount++; return this; }
+	void			removeReference()
+						{
+							// Check if last reference
+							if (--mReferenceCount == 0) {
+								// Done
+								SParallelChunksInfo*	THIS = this;
+								Delete(THIS);
+							}
+						}
+	void			performChunks()
+						{
+							// Claim chunks until there are none left
+							while (true) {
+								// Claim next chunk
+								UInt32	chunkIndex = mNextChunkIndex++;
+								if (chunkIndex >= mChunkCount)
+									// No more chunks
+									return;
+
+								// Perform chunk (clamping the end as a large chunk item count could overflow)
+								UInt32	startIndex = mStartIndex + chunkIndex * mChunkItemCount;
+								mParallelChunkProc(chunkIndex, startIndex,
+										startIndex + std::min<UInt32>(mChunkItemCount, mEndIndex - startIndex),
+										mUserData);
+
+								// Check if last chunk
+								if (++mCompletedChunkCount == mChunkCount)
+									// Signal
+									mSemaphore.signal();
+							}
+						}
+	bool			isCompleted() const
+						{ return mCompletedChunkCount == mChunkCount; }
+
+					// Class methods
+	static	void	performChunks(CWorkItem& workItem, void* userData)
+						{
+							// Setup
+							SParallelChunksInfo&	parallelChunksInfo = *((SParallelChunksInfo*) userData);
+
+							// Perform
+							parallelChunksInfo.performChunks();
+							parallelChunksInfo.removeReference();
+						}
+	static	void	cancelled(CWorkItem& workItem, void* userData)
+						{ ((SParallelChunksInfo*) userData)->removeReference(); }
 
-// MARK: Class methods
+	// Properties
+	UInt32								mStartIndex;
+	UInt32								mEndIndex;
+	UInt32								mChunkItemCount;
+	UInt32								mChunkCount;
+	CWorkItemQueue::ParallelChunkProc	mParallelChunkProc;
+	void*								mUserData;
+	std::atomic<UInt32>					mNextChunkIndex;
+	std::atomic<UInt32>					mCompletedChunkCount;
+	std::atomic<UInt32>					mReferenceCount;
+	CSemaphore							mSemaphore;
+};
 
 //----------------------------------------------------------------------------------------------------------------------
-UInt32 SWorkItemQueueReference::getActiveWorkItemInfosCountDeep()
 //----------------------------------------------------------------------------------------------------------------------
-{
-	return mWorkItemQueueInternals.getActiveWorkItemInfosCountDeep();
-}
+// MARK: - SParallelForInfo
 
-//----------------------------------------------------------------------------------------------------------------------
-OR<SWorkItemInfo> SWorkItemQueueReference::getNextWorkItemInfo()
-//----------------------------------------------------------------------------------------------------------------------
-{
-	return mWorkItemQueueInternals.getNextWorkItemInfo();
-}
+struct SParallelForInfo {
+					// Lifecycle methods
+					SParallelForInfo(CWorkItemQueue::ParallelForProc parallelForProc, void* userData) :
+						mParallelForProc(parallelForProc), mUserData(userData)
+						{}
+
+					// Class methods
+	static	void	performChunk(UInt32 chunkIndex, UInt32 startIndex, UInt32 endIndex, void* userData)
+						{
+							// Setup
+							SParallelForInfo&	parallelForInfo = *((SParallelForInfo*) userData);
+
+							// Perform
+							parallelForInfo.mParallelForProc(startIndex, endIndex, parallelForInfo.mUserData);
+						}
+
+	// Properties
+	CWorkItemQueue::ParallelForProc	mParallelForProc;
+	void*							mUserData;
+};
 
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
@@ -407,15 +1382,43 @@ CWorkItemQueue& CWorkItemQueue::main()
 
 	// Check if have main work item queue
 	if (sMainWorkItemQueue == nil) {
+		// Resolve pool info
+		if (sMainPoolInfo.mProcessorCoresCount == 0)
+			// Query the system
+			sMainPoolInfo.mProcessorCoresCount = CCoreServices::getTotalProcessorCoresCount();
+		if (sMainPoolInfo.mMaximumThreadCount == 0)
+			// Leave a core for the main thread
+			sMainPoolInfo.mMaximumThreadCount = std::max<UInt32>(sMainPoolInfo.mProcessorCoresCount, 2) - 1;
+		sMainPoolInfo.mMinimumThreadCount =
+				std::min<UInt32>(sMainPoolInfo.mMinimumThreadCount, sMainPoolInfo.mMaximumThreadCount);
+
 		// Create main work item queue
 		sCreatingMainWorkItemQueue = true;
-		sMainWorkItemQueue = new CWorkItemQueue(CCoreServices::getTotalProcessorCoresCount() - 1);
+		sMainWorkItemQueue = new CWorkItemQueue(sMainPoolInfo.mMaximumThreadCount);
 		sCreatingMainWorkItemQueue = false;
 	}
 
 	return *sMainWorkItemQueue;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+void CWorkItemQueue::setMainPoolInfo(const PoolInfo& poolInfo)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Must be called before the main work item queue is created
+	AssertFailIf(sWorkItemScheduler != nil);
+
+	// Store
+	sMainPoolInfo = poolInfo;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool CWorkItemQueue::performReadyWorkItem()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return (sWorkItemScheduler != nil) ? sWorkItemScheduler->performNext() : false;
+}
+
 // MARK: Lifecycle methods
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -426,12 +1429,17 @@ CWorkItemQueue::CWorkItemQueue(UInt32 maximumConcurrentWorkItems)
 	if (sCreatingMainWorkItemQueue) {
 		// Main work item queue
 		mInternals = new CWorkItemQueueInternals(maximumConcurrentWorkItems);
-		CWorkItemQueueInternals::mMainWorkItemQueueInternals = OR<CWorkItemQueueInternals>(*mInternals);
-	} else
+		sWorkItemScheduler =
+				new CWorkItemScheduler(*mInternals, sMainPoolInfo.mMinimumThreadCount, maximumConcurrentWorkItems,
+						sMainPoolInfo.mIdleTimeoutInterval, sMainPoolInfo.mProcessorCoresCount,
+						sMainPoolInfo.mPrewarm);
+	} else {
 		// Other Work Item Queue
 		mInternals =
 				new CWorkItemQueueInternals(maximumConcurrentWorkItems,
 						OR<CWorkItemQueueInternals>(*main().mInternals));
+		sWorkItemScheduler->addChild(*mInternals);
+	}
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -441,12 +1449,18 @@ CWorkItemQueue::CWorkItemQueue(CWorkItemQueue& targetWorkItemQueue, UInt32 maxim
 	mInternals =
 			new CWorkItemQueueInternals(maximumConcurrentWorkItems,
 					OR<CWorkItemQueueInternals>(*targetWorkItemQueue.mInternals));
+	sWorkItemScheduler->addChild(*mInternals);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 CWorkItemQueue::~CWorkItemQueue()
 //----------------------------------------------------------------------------------------------------------------------
 {
+	// Check if have target
+	if (mInternals->mTargetWorkItemQueueInternals.hasReference())
+		// Remove as child
+		sWorkItemScheduler->removeChild(*mInternals);
+
 	Delete(mInternals);
 }
 
@@ -457,21 +1471,20 @@ void CWorkItemQueue::add(CWorkItem& workItem, CWorkItem::Priority priority)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Add
-	mInternals->add(workItem, priority);
-
-	// Process work items
-	CWorkItemQueueInternals::processWorkItems();
+	sWorkItemScheduler->add(*new SWorkItemInfo(*mInternals, workItem, priority));
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-CWorkItem& CWorkItemQueue::add(CProcWorkItem::Proc proc, void* userData, CWorkItem::Priority priority)
+CWorkItem& CWorkItemQueue::add(CProcWorkItem::Proc proc, void* userData, CWorkItem::Priority priority,
+		CProcWorkItem::Proc cancelledProc)
 //----------------------------------------------------------------------------------------------------------------------
 {
-	// Add
-	CWorkItem&	workItem = mInternals->add(proc, userData, priority);
+	// Setup
+	SWorkItemInfo*	workItemInfo = new SWorkItemInfo(*mInternals, proc, userData, priority, cancelledProc);
+	CWorkItem&		workItem = *workItemInfo->mProcWorkItem;
 
-	// Process work items
-	CWorkItemQueueInternals::processWorkItems();
+	// Add
+	sWorkItemScheduler->add(*workItemInfo);
 
 	return workItem;
 }
@@ -480,7 +1493,19 @@ CWorkItem& CWorkItemQueue::add(CProcWorkItem::Proc proc, void* userData, CWorkIt
 void CWorkItemQueue::cancel(CWorkItem& workItem)
 //----------------------------------------------------------------------------------------------------------------------
 {
-// TODO
+	// Request cancel so an active work item can stop early and a ready one is skipped
+	workItem.requestCancel();
+
+	// Remove if waiting
+	sWorkItemScheduler->cancel(workItem);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CWorkItemQueue::cancelAll()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Cancel all
+	sWorkItemScheduler->cancelAll(*mInternals);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -488,7 +1513,7 @@ void CWorkItemQueue::pause()
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Pause
-	mInternals->pause();
+	mInternals->mIsPaused = true;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -496,8 +1521,168 @@ void CWorkItemQueue::resume()
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Resume
-	mInternals->resume();
+	mInternals->mIsPaused = false;
+
+	// Admit waiting work items
+	sWorkItemScheduler->resume();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CWorkItemQueue::parallelFor(UInt32 startIndex, UInt32 endIndex, ParallelForProc parallelForProc, void* userData,
+		UInt32 grainSize)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	SParallelForInfo	parallelForInfo(parallelForProc, userData);
+
+	// Perform
+	performParallelChunks(startIndex, endIndex,
+			getParallelChunkItemCount((endIndex > startIndex) ? endIndex - startIndex : 0, grainSize),
+			SParallelForInfo::performChunk, &parallelForInfo);
+}
+
+// MARK: Private methods
+
+//----------------------------------------------------------------------------------------------------------------------
+void CWorkItemQueue::performParallelChunks(UInt32 startIndex, UInt32 endIndex, UInt32 chunkItemCount,
+		ParallelChunkProc parallelChunkProc, void* userData)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	UInt32	count = (endIndex > startIndex) ? endIndex - startIndex : 0;
+	UInt32	chunkCount = getParallelChunkCount(count, chunkItemCount);
+
+	// Check chunk count
+	if (chunkCount <= 1) {
+		// Perform on this thread
+		if (chunkCount == 1)
+			// Perform
+			parallelChunkProc(0, startIndex, endIndex, userData);
+
+		return;
+	}
 
-	// Process work items
-	CWorkItemQueueInternals::processWorkItems();
+	// Add helpers.  Each helper claims chunks until there are none left so only enough to occupy the other threads
+	//	are needed.
+	SParallelChunksInfo*	parallelChunksInfo =
+									new SParallelChunksInfo(startIndex, endIndex, chunkItemCount, chunkCount,
+											parallelChunkProc, userData);
+	UInt32					helperCount =
+									std::min<UInt32>(chunkCount - 1,
+											std::min<UInt32>(sWorkItemScheduler->getMaximumWorkerCount(),
+													mInternals->mMaximumConcurrentWorkItems));
+	for (UInt32 i = 0; i < helperCount; i++)
+		// Add helper
+		add(SParallelChunksInfo::performChunks, parallelChunksInfo->addReference(), CWorkItem::kPriorityNormal,
+				SParallelChunksInfo::cancelled);
+
+	// Perform chunks on this thread
+	parallelChunksInfo->performChunks();
+
+	// Help with other work until the chunks claimed by helpers are done
+	while (!parallelChunksInfo->isCompleted()) {
+		// Perform a ready work item if there is one
+		if (!sWorkItemScheduler->performNext())
+			// Wait
+			parallelChunksInfo->mSemaphore.timedWaitFor(kHelpingWaitTimeInterval);
+	}
+
+	// Cleanup
+	parallelChunksInfo->removeReference();
+}
+
+// MARK: Private class methods
+
+//----------------------------------------------------------------------------------------------------------------------
+UInt32 CWorkItemQueue::getParallelChunkItemCount(UInt32 count, UInt32 grainSize)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Check if have grain size
+	if (grainSize > 0)
+		// Use grain size
+		return grainSize;
+
+	// Aim for a few chunks per thread (including the calling thread)
+	UInt32	chunkCount = (sWorkItemScheduler->getMaximumWorkerCount() + 1) * kParallelChunksPerThreadCount;
+
+	return std::max<UInt32>(getParallelChunkCount(count, chunkCount), 1);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CWorkItemGraph
+
+// MARK: Lifecycle methods
+
+//----------------------------------------------------------------------------------------------------------------------
+CWorkItemGraph::CWorkItemGraph(CWorkItemQueue& workItemQueue)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	mInternals = new CWorkItemGraphInternals(workItemQueue.getInternals());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CWorkItemGraph::~CWorkItemGraph()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Wait for all work items to complete
+	waitForAll();
+
+	Delete(mInternals);
+}
+
+// MARK: Instance methods
+
+//----------------------------------------------------------------------------------------------------------------------
+void CWorkItemGraph::add(CWorkItem& workItem, CWorkItem::Priority priority)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Add
+	mInternals->add(workItem, OI<CProcWorkItem>(), TNArray<R<CWorkItem> >(), priority);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CWorkItemGraph::add(CWorkItem& workItem, const TArray<R<CWorkItem> >& predecessorWorkItems,
+		CWorkItem::Priority priority)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Add
+	mInternals->add(workItem, OI<CProcWorkItem>(), predecessorWorkItems, priority);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CWorkItem& CWorkItemGraph::add(CProcWorkItem::Proc proc, void* userData, CWorkItem::Priority priority)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return add(proc, userData, TNArray<R<CWorkItem> >(), priority);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CWorkItem& CWorkItemGraph::add(CProcWorkItem::Proc proc, void* userData,
+		const TArray<R<CWorkItem> >& predecessorWorkItems, CWorkItem::Priority priority)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	OI<CProcWorkItem>	procWorkItem(new CProcWorkItem(proc, userData));
+
+	// Add
+	mInternals->add(*procWorkItem, procWorkItem, predecessorWorkItems, priority);
+
+	return *procWorkItem;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CWorkItemGraph::waitFor(CWorkItem& workItem)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Wait
+	mInternals->waitFor(OR<CWorkItem>(workItem));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void CWorkItemGraph::waitForAll()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Wait
+	mInternals->waitFor(OR<CWorkItem>());
 }
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include "CArray.h"
 #include "CWorkItem.h"
 #include "PlatformDefinitions.h"
+#include "TimeAndDate.h"
 
 /*!
 	The Basics:
@@ -24,7 +26,12 @@
 	When a Work Item is being performed, it transition to the active state.
 	When a Work Item has completed, it will transition to the completed state and the completed() method will be called.
 	When a Work Item has been cancelled, at some time in the future, it will transition to the cancelled state and the
-		cancelled() method will be called.
+		cancelled() method will be called.  A waiting Work Item is removed right away and will never be performed.  An
+		active Work Item is not interrupted, but can poll isCancelRequested() and return early.  If it calls
+		noteStoppedEarly() before returning, it transitions to the cancelled state instead of the completed state;
+		otherwise it ran to completion and transitions to the completed state.  When adding a proc, a cancelled proc
+		can also be given.  It is called instead of the proc if the Work Item is cancelled before being performed so the
+		userData can be cleaned up.
 	Subclass must override the perform() method and may also choose to override the completed() and cancelled() methods
 		if it is desired to be informed of those state changes.
 	Work Items can be configured to perform their own cleanup if desired.
@@ -37,6 +44,12 @@
 		Queue.
 	The Main Work Item Queue has a built-in maximum concurrent items limit of the number of processor cores minus one
 		(to try to leave the main thread available for UI and other minor work).
+	The threads behind the Main Work Item Queue are kept in a pool.  Threads are started on demand up to the maximum,
+		spin briefly and then park when they run out of work, and exit after sitting idle for the idle timeout
+		(but never below the minimum).  Call setMainPoolInfo() before first using main() to change the minimum and
+		maximum thread counts, the idle timeout or the processor cores count, or to pre-warm the minimum threads so
+		the first work items do not wait on thread creation.  Servers without a UI thread will typically want the
+		maximum to be the number of processor cores.
 
 
 	The Advanced:
@@ -59,9 +72,38 @@
 		that Work Item Queue as paused.  This only means that these Work Items will not be made active in the future and
 		does not affect Work Items already processing.  Subsequently, Work Items can be un-paused by calling the
 		resume() method on the Work Item Queue.
+	All Work Items in a Work Item Queue (and its child Work Item Queues) can be cancelled by calling the cancelAll()
+		method.  This cancels every Work Item added before the call that has not yet been made active.  Work Items
+		already active are not affected.
 
 	The Work Item Queue system also tracks the order in which Work Items are created and, everything else being equal,
 		will perform the Work Item created first.
+
+
+	Parallel For and Parallel Reduce:
+
+	parallelFor() splits an index range into chunks and performs them across the threads of a Work Item Queue.
+		parallelReduce() does the same, mapping each chunk to a value and then combining the values in chunk order (so
+		the combine proc need not be commutative).  Both return once every chunk has been performed.  Unless a grain
+		size is given, the range is split into a few chunks per thread so uneven chunks still balance out.
+	The calling thread performs chunks itself and only a few helper Work Items are added to claim chunks alongside
+		it.  Once no chunks are left to claim, the calling thread performs other ready Work Items until the last chunk
+		is done, so calling these from within a Work Item (including from within another parallelFor()) is safe.
+
+
+	Work Item Graphs:
+
+	A Work Item Graph adds Work Items to a Work Item Queue once the Work Items they depend on have completed.  This
+		allows multi-stage jobs (decode some files, then merge the results, then write an index) to be described up
+		front instead of being hand-wired with semaphores.  Predecessors must have been added to the same Work Item
+		Graph first, so every Work Item Graph is acyclic by construction.  When a Work Item completes, the first of its
+		successors to become ready is performed next on the same thread (unless its Work Item Queue is paused or
+		limited) so it can use what is still in the cache.  Any others are added to the Work Item Queue.
+	If a Work Item in a Work Item Graph is cancelled, every Work Item that depends on it (directly or through others)
+		is cancelled as well instead of being performed.
+	waitFor() and waitForAll() do not just block: the calling thread performs ready Work Items (from any Work Item
+		Queue) while it waits, so waiting from within a Work Item does not tie up a worker thread.  The Work Item Graph
+		owns the Work Items it creates from procs and keeps them until it is destroyed, which waits for all Work Items.
  */
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -69,6 +111,79 @@
 
 class CWorkItemQueueInternals;
 class CWorkItemQueue {
+	// Procs
+	public:
+		typedef	void	(*ParallelForProc)(UInt32 startIndex, UInt32 endIndex, void* userData);
+		typedef	void	(*ParallelChunkProc)(UInt32 chunkIndex, UInt32 startIndex, UInt32 endIndex, void* userData);
+
+	// Structs
+	public:
+		struct PoolInfo {
+			// Lifecycle methods
+			PoolInfo(UInt32 minimumThreadCount = 0, UInt32 maximumThreadCount = 0,
+					UniversalTimeInterval idleTimeoutInterval = 30.0, UInt32 processorCoresCount = 0,
+					bool prewarm = false) :
+				mMinimumThreadCount(minimumThreadCount), mMaximumThreadCount(maximumThreadCount),
+						mIdleTimeoutInterval(idleTimeoutInterval), mProcessorCoresCount(processorCoresCount),
+						mPrewarm(prewarm)
+				{}
+
+			// Properties
+			UInt32					mMinimumThreadCount;	// Threads kept alive once started
+			UInt32					mMaximumThreadCount;	// 0 means processor cores count minus one (at least 1)
+			UniversalTimeInterval	mIdleTimeoutInterval;	// Idle threads above the minimum exit after this
+			UInt32					mProcessorCoresCount;	// 0 means query the system
+			bool					mPrewarm;				// Start the minimum threads immediately
+		};
+
+		template <typename T> struct TParallelReduceProcs {
+			// Procs
+			typedef	T	(*MapProc)(UInt32 startIndex, UInt32 endIndex, const T& identity, void* userData);
+			typedef	T	(*CombineProc)(const T& value1, const T& value2, void* userData);
+
+				// Lifecycle methods
+				TParallelReduceProcs(MapProc mapProc, CombineProc combineProc, void* userData) :
+					mMapProc(mapProc), mCombineProc(combineProc), mUserData(userData)
+					{}
+
+				// Instance methods
+			T	map(UInt32 startIndex, UInt32 endIndex, const T& identity) const
+					{ return mMapProc(startIndex, endIndex, identity, mUserData); }
+			T	combine(const T& value1, const T& value2) const
+					{ return mCombineProc(value1, value2, mUserData); }
+
+			// Properties
+			MapProc		mMapProc;
+			CombineProc	mCombineProc;
+			void*		mUserData;
+		};
+
+	private:
+		template <typename T> struct ParallelReduceInfo {
+							// Lifecycle methods
+							ParallelReduceInfo(const T& identity, const TParallelReduceProcs<T>& parallelReduceProcs,
+									TNArray<T>& values) :
+								mIdentity(identity), mParallelReduceProcs(parallelReduceProcs), mValues(values)
+								{}
+
+							// Class methods
+			static	void	performChunk(UInt32 chunkIndex, UInt32 startIndex, UInt32 endIndex, void* userData)
+								{
+									// Setup
+									ParallelReduceInfo<T>&	parallelReduceInfo = *((ParallelReduceInfo<T>*) userData);
+
+									// Map
+									parallelReduceInfo.mValues[chunkIndex] =
+											parallelReduceInfo.mParallelReduceProcs.map(startIndex, endIndex,
+													parallelReduceInfo.mIdentity);
+								}
+
+			// Properties
+			const	T&							mIdentity;
+			const	TParallelReduceProcs<T>&	mParallelReduceProcs;
+					TNArray<T>&					mValues;
+		};
+
 	// Methods
 	public:
 								// Lifecycle methods
@@ -80,17 +195,98 @@ class CWorkItemQueue {
 								// Instance methods
 				void			add(CWorkItem& workItem, CWorkItem::Priority priority = CWorkItem::kPriorityNormal);
 				CWorkItem&		add(CProcWorkItem::Proc proc, void* userData,
-										CWorkItem::Priority priority = CWorkItem::kPriorityNormal);
+										CWorkItem::Priority priority = CWorkItem::kPriorityNormal,
+										CProcWorkItem::Proc cancelledProc = nil);
 
 				void			cancel(CWorkItem& workItem);
+				void			cancelAll();
 
 				void			pause();
 				void			resume();
 
+				void			parallelFor(UInt32 startIndex, UInt32 endIndex, ParallelForProc parallelForProc,
+										void* userData, UInt32 grainSize = 0);
+		template <typename T>
+				T				parallelReduce(UInt32 startIndex, UInt32 endIndex, const T& identity,
+										const TParallelReduceProcs<T>& parallelReduceProcs, UInt32 grainSize = 0)
+									{
+										// Setup
+										UInt32					count =
+																		(endIndex > startIndex) ?
+																				endIndex - startIndex : 0;
+										UInt32					chunkItemCount =
+																		getParallelChunkItemCount(count, grainSize);
+										UInt32					chunkCount =
+																		getParallelChunkCount(count, chunkItemCount);
+										TNArray<T>				values(identity, chunkCount);
+										ParallelReduceInfo<T>	parallelReduceInfo(identity, parallelReduceProcs,
+																		values);
+
+										// Map chunks
+										performParallelChunks(startIndex, endIndex, chunkItemCount,
+												ParallelReduceInfo<T>::performChunk, &parallelReduceInfo);
+
+										// Combine in chunk order
+										T	value = identity;
+										for (UInt32 i = 0; i < chunkCount; i++)
+											// Combine
+											value = parallelReduceProcs.combine(value, values[i]);
+
+										return value;
+									}
+
 								// Class methods
 		static	CWorkItemQueue&	main();
+		static	void			setMainPoolInfo(const PoolInfo& poolInfo);
+
+		static	bool			performReadyWorkItem();	// Performs a ready Work Item (if any) on the calling thread
+
+										// Internal-use only methods
+				CWorkItemQueueInternals&	getInternals() const
+												{ return *mInternals; }
+
+	private:
+								// Instance methods
+				void			performParallelChunks(UInt32 startIndex, UInt32 endIndex, UInt32 chunkItemCount,
+										ParallelChunkProc parallelChunkProc, void* userData);
+
+								// Class methods
+		static	UInt32			getParallelChunkItemCount(UInt32 count, UInt32 grainSize);
+		static	UInt32			getParallelChunkCount(UInt32 count, UInt32 chunkItemCount)
+									{ return count / chunkItemCount + (((count % chunkItemCount) != 0) ? 1 : 0); }
 
 	// Properties
+	public:
+		static	const	UniversalTimeInterval	kHelpingWaitTimeInterval;	// How often blocked helping waits recheck
+
 	private:
 		CWorkItemQueueInternals*	mInternals;
 };
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CWorkItemGraph
+
+class CWorkItemGraphInternals;
+class CWorkItemGraph {
+	// Methods
+	public:
+					// Lifecycle methods
+					CWorkItemGraph(CWorkItemQueue& workItemQueue = CWorkItemQueue::main());
+					~CWorkItemGraph();
+
+					// Instance methods
+		void		add(CWorkItem& workItem, CWorkItem::Priority priority = CWorkItem::kPriorityNormal);
+		void		add(CWorkItem& workItem, const TArray<R<CWorkItem> >& predecessorWorkItems,
+							CWorkItem::Priority priority = CWorkItem::kPriorityNormal);
+		CWorkItem&	add(CProcWorkItem::Proc proc, void* userData,
+							CWorkItem::Priority priority = CWorkItem::kPriorityNormal);
+		CWorkItem&	add(CProcWorkItem::Proc proc, void* userData, const TArray<R<CWorkItem> >& predecessorWorkItems,
+							CWorkItem::Priority priority = CWorkItem::kPriorityNormal);
+
+		void		waitFor(CWorkItem& workItem);
+		void		waitForAll();
+
+	// Properties
+	private:
+		CWorkItemGraphInternals*	mInternals;
+};
@@ -63,7 +63,7 @@ class CSemaphore {
 				// Instance methods
 		void	signal() const;
 		void	waitFor() const;
-		void	timedWaitFor(UniversalTimeInterval maxWaitTimeInterval) const;
+		bool	timedWaitFor(UniversalTimeInterval maxWaitTimeInterval) const;
 
 	// Properties
 	public:
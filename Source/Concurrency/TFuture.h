@@ -0,0 +1,760 @@
+//----------------------------------------------------------------------------------------------------------------------
+//	TFuture.h			©2021 Stevo Brock	All rights reserved.
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CArray.h"
+#include "ConcurrencyPrimitives.h"
+#include "CWorkItemQueue.h"
+#include "TResult.h"
+
+#include <atomic>
+
+#if defined(__cpp_impl_coroutine)
+	#include <coroutine>
+	#include <exception>
+#endif
+
+/*
+	A TPromise is the producing side of a result that will be available later and a TFuture is the consuming side.
+		A result is either a value or an SError and is set once; later attempts to set it are ignored.
+
+	then() performs a proc on a Work Item Queue with the value once it is available and returns a TFuture for what
+		the proc returns.  An error skips the proc and is passed straight through.  whenAll() and whenAny() combine
+		several TFutures.
+
+	cancel() settles a TFuture with SError::mCancelled (and so also everything derived from it through then(),
+		whenAll() or whenAny()) and requests cancellation of the TFutures it was derived from, all the way back to
+		their TPromises.  Producers can check isCancelRequested() to stop early.
+
+	wait() and getResult() help: while the result is not yet available, the calling thread performs ready Work Items.
+
+	When compiled as C++20, a TFuture can be co_awaited (giving the TIResult) and a coroutine can return a TFuture
+		(co_return a value or an SError).  A coroutine resumes on the main Work Item Queue, so awaiting never blocks
+		a thread.
+*/
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: CFutureInternals
+//	The part of the state shared between a TPromise and its TFutures that does not depend on the value type.
+
+class CFutureInternals {
+	// Procs
+	public:
+		typedef	void	(*SettledProc)(CFutureInternals& futureInternals, void* userData);
+
+	// Structs
+	protected:
+		struct Continuation {
+			// Lifecycle methods
+			Continuation(SettledProc settledProc, void* userData) :
+				mSettledProc(settledProc), mUserData(userData), mNextContinuation(nil)
+				{}
+
+			// Properties
+			SettledProc		mSettledProc;
+			void*			mUserData;
+			Continuation*	mNextContinuation;
+		};
+
+	private:
+		struct Source {
+			// Lifecycle methods
+			Source(CFutureInternals& futureInternals, Source* nextSource) :
+				mFutureInternals(futureInternals), mNextSource(nextSource)
+				{}
+
+			// Properties
+			CFutureInternals&	mFutureInternals;
+			Source*				mNextSource;
+		};
+
+	// Methods
+	public:
+						// Lifecycle methods
+						CFutureInternals() :
+							mReferenceCount(1), mIsSettled(false), mIsCancelRequested(false),
+									mFirstContinuation(nil), mLastContinuation(nil), mFirstSource(nil),
+									mWaiterCount(0)
+							{}
+		virtual			~CFutureInternals()
+							{
+								// Cleanup
+								while (mFirstContinuation != nil) {
+									// Delete this one
+									Continuation*	continuation = mFirstContinuation;
+									mFirstContinuation = continuation->mNextContinuation;
+									Delete(continuation);
+								}
+								while (mFirstSource != nil) {
+									// Release this one
+									Source*	source = mFirstSource;
+									mFirstSource = source->mNextSource;
+									source->mFutureInternals.removeReference();
+									Delete(source);
+								}
+							}
+
+						// Instance methods
+				void*	addReference()
+							{ mReferenceCount++; return this; }
+				void	removeReference()
+							{
+								// Check if last reference
+								if (--mReferenceCount == 0) {
+									// Done
+									CFutureInternals*	THIS = this;
+									Delete(THIS);
+								}
+							}
+
+				bool	isSettled() const
+							{ return mIsSettled; }
+				bool	isCancelRequested() const
+							{ return mIsCancelRequested; }
+
+				void	addSource(CFutureInternals& futureInternals)
+							{
+								// Add
+								mLock.lock();
+								mFirstSource =
+										new Source(*((CFutureInternals*) futureInternals.addReference()), mFirstSource);
+								mLock.unlock();
+							}
+				void	addSettledProc(SettledProc settledProc, void* userData)
+							{
+								// Check if settled
+								mLock.lock();
+								if (!mIsSettled) {
+									// Add continuation
+									Continuation*	continuation = new Continuation(settledProc, userData);
+									if (mLastContinuation != nil)
+										// Have last
+										mLastContinuation->mNextContinuation = continuation;
+									else
+										// First
+										mFirstContinuation = continuation;
+									mLastContinuation = continuation;
+									mLock.unlock();
+								} else {
+									// Already settled
+									mLock.unlock();
+									settledProc(*this, userData);
+								}
+							}
+				void	requestCancel()
+							{
+								// Note
+								mIsCancelRequested = true;
+
+								// Pass on to sources.  Sources are always created before what is derived from them so
+								//	locks are only ever taken from derived to source.
+								mLock.lock();
+								for (Source* source = mFirstSource; source != nil; source = source->mNextSource)
+									// Request cancel
+									source->mFutureInternals.requestCancel();
+								mLock.unlock();
+							}
+				void	wait()
+							{
+								// Help until settled
+								while (!mIsSettled) {
+									// Perform a ready work item if there is one
+									if (CWorkItemQueue::performReadyWorkItem())
+										// Check again
+										continue;
+
+									// Wait for settle.  The timeout lets us help again with work items that became
+									//	ready in the meantime.
+									mLock.lock();
+									if (mIsSettled) {
+										// Settled
+										mLock.unlock();
+										break;
+									}
+									mWaiterCount++;
+									mLock.unlock();
+
+									mSemaphore.timedWaitFor(CWorkItemQueue::kHelpingWaitTimeInterval);
+
+									mLock.lock();
+									mWaiterCount--;
+									mLock.unlock();
+								}
+							}
+
+	protected:
+						// Instance methods
+						// Must be called with the lock held.  Returns the continuations to be performed once unlocked.
+		Continuation*	settle()
+							{
+								// Update
+								mIsSettled = true;
+
+								// Wake waiters
+								for (UInt32 i = 0; i < mWaiterCount; i++)
+									// Signal
+									mSemaphore.signal();
+
+								// Detach continuations
+								Continuation*	continuation = mFirstContinuation;
+								mFirstContinuation = nil;
+								mLastContinuation = nil;
+
+								return continuation;
+							}
+				void	performContinuations(Continuation* continuation)
+							{
+								// Perform all
+								while (continuation != nil) {
+									// Perform this one
+									Continuation*	nextContinuation = continuation->mNextContinuation;
+									continuation->mSettledProc(*this, continuation->mUserData);
+									Delete(continuation);
+									continuation = nextContinuation;
+								}
+							}
+
+	// Properties
+	protected:
+		CLock				mLock;
+
+	private:
+		std::atomic<UInt32>	mReferenceCount;
+		std::atomic<bool>	mIsSettled;
+		std::atomic<bool>	mIsCancelRequested;
+		Continuation*		mFirstContinuation;
+		Continuation*		mLastContinuation;
+		Source*				mFirstSource;
+		UInt32				mWaiterCount;
+		CSemaphore			mSemaphore;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - TFutureInternals
+
+template <typename T> class TFutureInternals : public CFutureInternals {
+	// Methods
+	public:
+					// Lifecycle methods
+					TFutureInternals() : CFutureInternals(), mValue(nil), mError(nil) {}
+					~TFutureInternals()
+						{
+							// Cleanup
+							Delete(mValue);
+							Delete(mError);
+						}
+
+					// Instance methods
+		bool		setValue(const T& value)
+						{ return settle(new T(value), nil); }
+		bool		setError(const SError& error)
+						{ return settle(nil, new SError(error)); }
+		bool		setResult(const TIResult<T>& result)
+						{ return result.hasValue() ? setValue(result.getValue()) : setError(result.getError()); }
+
+		TIResult<T>	getResult()
+						{
+							// Wait
+							wait();
+
+							// A settled result never changes
+							return (mValue != nil) ? TIResult<T>(*mValue) : TIResult<T>(*mError);
+						}
+
+	private:
+					// Instance methods
+		bool		settle(T* value, SError* error)
+						{
+							// Check if already settled
+							mLock.lock();
+							if (isSettled()) {
+								// Already settled
+								mLock.unlock();
+								Delete(value);
+								Delete(error);
+
+								return false;
+							}
+
+							// Store and settle
+							mValue = value;
+							mError = error;
+							Continuation*	continuation = CFutureInternals::settle();
+							mLock.unlock();
+
+							// Perform continuations
+							performContinuations(continuation);
+
+							return true;
+						}
+
+	// Properties
+	private:
+		T*		mValue;
+		SError*	mError;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - TFuture
+
+template <typename T> class TFuture {
+	// Procs
+	public:
+		typedef	TIResult<T>	(*PerformProc)(void* userData);
+
+	// Structs
+	private:
+		struct PerformInfo {
+							// Lifecycle methods
+							PerformInfo(PerformProc performProc, void* userData) :
+								mFutureInternals(new TFutureInternals<T>()), mPerformProc(performProc),
+										mUserData(userData)
+								{}
+							~PerformInfo()
+								{ mFutureInternals->removeReference(); }
+
+							// Class methods
+			static	void	perform(CWorkItem& workItem, void* userData)
+								{
+									// Setup
+									PerformInfo*	performInfo = (PerformInfo*) userData;
+
+									// Check if cancelled
+									if (!performInfo->mFutureInternals->isCancelRequested())
+										// Perform
+										performInfo->mFutureInternals->setResult(
+												performInfo->mPerformProc(performInfo->mUserData));
+									else
+										// Cancelled
+										performInfo->mFutureInternals->setError(SError::mCancelled);
+
+									// Cleanup
+									Delete(performInfo);
+								}
+			static	void	cancelled(CWorkItem& workItem, void* userData)
+								{
+									// Setup
+									PerformInfo*	performInfo = (PerformInfo*) userData;
+
+									// Cancelled before performed
+									performInfo->mFutureInternals->setError(SError::mCancelled);
+
+									// Cleanup
+									Delete(performInfo);
+								}
+
+			// Properties
+			TFutureInternals<T>*	mFutureInternals;
+			PerformProc				mPerformProc;
+			void*					mUserData;
+		};
+
+		template <typename U> struct ThenInfo {
+			// Procs
+			typedef	TIResult<U>	(*ThenProc)(const T& value, void* userData);
+
+							// Lifecycle methods
+							ThenInfo(TFutureInternals<T>& futureInternals, TFutureInternals<U>& thenFutureInternals,
+									ThenProc thenProc, void* userData, CWorkItemQueue& workItemQueue) :
+								mFutureInternals(*((TFutureInternals<T>*) futureInternals.addReference())),
+										mThenFutureInternals(
+												*((TFutureInternals<U>*) thenFutureInternals.addReference())),
+										mThenProc(thenProc), mUserData(userData), mWorkItemQueue(workItemQueue)
+								{}
+							~ThenInfo()
+								{
+									// Cleanup
+									mFutureInternals.removeReference();
+									mThenFutureInternals.removeReference();
+								}
+
+							// Class methods
+			static	void	settled(CFutureInternals& futureInternals, void* userData)
+								{
+									// Setup
+									ThenInfo<U>*	thenInfo = (ThenInfo<U>*) userData;
+									TIResult<T>		result = thenInfo->mFutureInternals.getResult();
+
+									// Check situation
+									if (thenInfo->mThenFutureInternals.isSettled()) {
+										// Cancelled
+										Delete(thenInfo);
+									} else if (result.hasError()) {
+										// Pass on error
+										thenInfo->mThenFutureInternals.setError(result.getError());
+										Delete(thenInfo);
+									} else
+										// Perform
+										thenInfo->mWorkItemQueue.add(perform, thenInfo, CWorkItem::kPriorityNormal,
+												cancelled);
+								}
+			static	void	perform(CWorkItem& workItem, void* userData)
+								{
+									// Setup
+									ThenInfo<U>*	thenInfo = (ThenInfo<U>*) userData;
+
+									// Check if cancelled
+									if (!thenInfo->mThenFutureInternals.isSettled())
+										// Perform
+										thenInfo->mThenFutureInternals.setResult(
+												thenInfo->mThenProc(
+														thenInfo->mFutureInternals.getResult().getValue(),
+														thenInfo->mUserData));
+
+									// Cleanup
+									Delete(thenInfo);
+								}
+			static	void	cancelled(CWorkItem& workItem, void* userData)
+								{
+									// Setup
+									ThenInfo<U>*	thenInfo = (ThenInfo<U>*) userData;
+
+									// Cancelled before performed
+									thenInfo->mThenFutureInternals.setError(SError::mCancelled);
+
+									// Cleanup
+									Delete(thenInfo);
+								}
+
+			// Properties
+			TFutureInternals<T>&	mFutureInternals;
+			TFutureInternals<U>&	mThenFutureInternals;
+			ThenProc				mThenProc;
+			void*					mUserData;
+			CWorkItemQueue&			mWorkItemQueue;
+		};
+
+		template <typename W> struct WhenInfo {
+			// Procs
+			typedef	void	(*CompletedProc)(WhenInfo<W>& whenInfo);
+
+			// Structs
+			struct Index {
+				// Lifecycle methods
+				Index(WhenInfo<W>& whenInfo, CArray::ItemIndex index) : mWhenInfo(whenInfo), mIndex(index) {}
+
+				// Properties
+				WhenInfo<W>&		mWhenInfo;
+				CArray::ItemIndex	mIndex;
+			};
+
+							// Lifecycle methods
+							WhenInfo(const TArray<TFuture<T> >& futures, TFutureInternals<W>& whenFutureInternals,
+									CompletedProc completedProc) :
+								mFutures(futures),
+										mWhenFutureInternals(
+												*((TFutureInternals<W>*) whenFutureInternals.addReference())),
+										mCompletedProc(completedProc), mRemainingCount(futures.getCount() + 1)
+								{}
+							~WhenInfo()
+								{ mWhenFutureInternals.removeReference(); }
+
+							// Instance methods
+			void			addSettledProcs(CFutureInternals::SettledProc settledProc)
+								{
+									// Iterate futures.  We hold an extra count while adding since a settled proc can
+									//	be called right away (or from another thread) and would otherwise delete us
+									//	when the last one settles.
+									for (CArray::ItemIndex i = 0; i < mFutures.getCount(); i++) {
+										// Setup
+										TFutureInternals<T>&	futureInternals = *mFutures[i].mInternals;
+
+										// Add
+										mWhenFutureInternals.addSource(futureInternals);
+										futureInternals.addSettledProc(settledProc, new Index(*this, i));
+									}
+
+									// Done adding
+									removeRemaining();
+								}
+			void			removeRemaining()
+								{
+									// Check if last
+									if (--mRemainingCount == 0) {
+										// Complete
+										mCompletedProc(*this);
+
+										// Cleanup
+										WhenInfo<W>*	THIS = this;
+										Delete(THIS);
+									}
+								}
+
+							// Class methods
+			static	void	allSettled(CFutureInternals& futureInternals, void* userData)
+								{
+									// Setup
+									Index*			index = (Index*) userData;
+									WhenInfo<W>&	whenInfo = index->mWhenInfo;
+									TIResult<T>		result = ((TFutureInternals<T>&) futureInternals).getResult();
+									Delete(index);
+
+									// Check if have error
+									if (result.hasError())
+										// The first error settles
+										whenInfo.mWhenFutureInternals.setError(result.getError());
+
+									// Done with this one
+									whenInfo.removeRemaining();
+								}
+			static	void	allCompleted(WhenInfo<W>& whenInfo)
+								{
+									// Check if already settled by an error or cancel
+									if (whenInfo.mWhenFutureInternals.isSettled())
+										// Yes
+										return;
+
+									// Collect values
+									TNArray<T>	values;
+									for (CArray::ItemIndex i = 0; i < whenInfo.mFutures.getCount(); i++)
+										// Add value
+										values += whenInfo.mFutures[i].getResult().getValue();
+									whenInfo.mWhenFutureInternals.setValue(values);
+								}
+			static	void	anySettled(CFutureInternals& futureInternals, void* userData)
+								{
+									// Setup
+									Index*			index = (Index*) userData;
+									WhenInfo<W>&	whenInfo = index->mWhenInfo;
+
+									// The first to settle wins
+									whenInfo.mWhenFutureInternals.setValue(index->mIndex);
+									Delete(index);
+
+									// Done with this one
+									whenInfo.removeRemaining();
+								}
+			static	void	anyCompleted(WhenInfo<W>& whenInfo)
+								{}
+
+			// Properties
+			TNArray<TFuture<T> >	mFutures;
+			TFutureInternals<W>&	mWhenFutureInternals;
+			CompletedProc			mCompletedProc;
+			std::atomic<UInt32>		mRemainingCount;
+		};
+
+	// Methods
+	public:
+											// Lifecycle methods
+											TFuture(TFutureInternals<T>& futureInternals) :
+												mInternals((TFutureInternals<T>*) futureInternals.addReference())
+												{}
+											TFuture(const TFuture<T>& other) :
+												mInternals((TFutureInternals<T>*) other.mInternals->addReference())
+												{}
+											~TFuture()
+												{ mInternals->removeReference(); }
+
+											// Instance methods
+				bool						isReady() const
+												{ return mInternals->isSettled(); }
+				void						wait() const
+												{ mInternals->wait(); }
+				TIResult<T>					getResult() const
+												{ return mInternals->getResult(); }
+
+				void						cancel() const
+												{
+													// Request cancel and settle
+													mInternals->requestCancel();
+													mInternals->setError(SError::mCancelled);
+												}
+
+		template <typename U>
+				TFuture<U>					then(TIResult<U> (*thenProc)(const T& value, void* userData),
+													void* userData,
+													CWorkItemQueue& workItemQueue = CWorkItemQueue::main()) const
+												{
+													// Setup
+													TFuture<U>	thenFuture = newFuture<U>();
+													thenFuture.mInternals->addSource(*mInternals);
+
+													// Add settled proc
+													mInternals->addSettledProc(ThenInfo<U>::settled,
+															new ThenInfo<U>(*mInternals, *thenFuture.mInternals,
+																	thenProc, userData, workItemQueue));
+
+													return thenFuture;
+												}
+
+				TFuture<T>&					operator=(const TFuture<T>& other)
+												{
+													// Swap references
+													other.mInternals->addReference();
+													mInternals->removeReference();
+													mInternals = other.mInternals;
+
+													return *this;
+												}
+
+											// Class methods
+		static	TFuture<T>					perform(PerformProc performProc, void* userData,
+													CWorkItemQueue& workItemQueue = CWorkItemQueue::main(),
+													CWorkItem::Priority priority = CWorkItem::kPriorityNormal)
+												{
+													// Setup
+													PerformInfo*	performInfo =
+																			new PerformInfo(performProc, userData);
+													TFuture<T>		future(*performInfo->mFutureInternals);
+
+													// Add
+													workItemQueue.add(PerformInfo::perform, performInfo, priority,
+															PerformInfo::cancelled);
+
+													return future;
+												}
+		static	TFuture<TNArray<T> >		whenAll(const TArray<TFuture<T> >& futures)
+												{
+													// Setup
+													TFuture<TNArray<T> >	whenFuture = newFuture<TNArray<T> >();
+
+													// Check if have futures
+													if (!futures.isEmpty())
+														// Add settled procs
+														(new WhenInfo<TNArray<T> >(futures, *whenFuture.mInternals,
+																WhenInfo<TNArray<T> >::allCompleted))->
+																addSettledProcs(WhenInfo<TNArray<T> >::allSettled);
+													else
+														// Done
+														whenFuture.mInternals->setValue(TNArray<T>());
+
+													return whenFuture;
+												}
+		static	TFuture<CArray::ItemIndex>	whenAny(const TArray<TFuture<T> >& futures)
+												{
+													// Setup
+													TFuture<CArray::ItemIndex>	whenFuture =
+																						newFuture<CArray::ItemIndex>();
+
+													// Add settled procs
+													AssertFailIf(futures.isEmpty());
+													(new WhenInfo<CArray::ItemIndex>(futures, *whenFuture.mInternals,
+															WhenInfo<CArray::ItemIndex>::anyCompleted))->
+															addSettledProcs(WhenInfo<CArray::ItemIndex>::anySettled);
+
+													return whenFuture;
+												}
+
+	private:
+											// Class methods
+		template <typename U>
+		static	TFuture<U>					newFuture()
+												{
+													// Setup
+													TFutureInternals<U>*	futureInternals = new TFutureInternals<U>();
+													TFuture<U>				future(*futureInternals);
+													futureInternals->removeReference();
+
+													return future;
+												}
+
+#if defined(__cpp_impl_coroutine)
+	// Coroutine support
+	public:
+		struct promise_type {
+									// Lifecycle methods
+									promise_type() : mFutureInternals(new TFutureInternals<T>()) {}
+									~promise_type()
+										{ mFutureInternals->removeReference(); }
+
+									// Coroutine methods
+			TFuture<T>				get_return_object()
+										{ return TFuture<T>(*mFutureInternals); }
+			std::suspend_never		initial_suspend() noexcept
+										{ return std::suspend_never(); }
+			std::suspend_never		final_suspend() noexcept
+										{ return std::suspend_never(); }
+			void					return_value(const TIResult<T>& result)
+										{ mFutureInternals->setResult(result); }
+			void					unhandled_exception()
+										{ std::terminate(); }
+
+			// Properties
+			TFutureInternals<T>*	mFutureInternals;
+		};
+
+		struct Awaiter {
+							// Lifecycle methods
+							Awaiter(const TFuture<T>& future) : mFuture(future) {}
+
+							// Coroutine methods
+			bool			await_ready() const
+								{ return mFuture.isReady(); }
+			void			await_suspend(std::coroutine_handle<> coroutineHandle)
+								{ mFuture.mInternals->addSettledProc(settled, coroutineHandle.address()); }
+			TIResult<T>		await_resume() const
+								{ return mFuture.getResult(); }
+
+							// Class methods
+			static	void	settled(CFutureInternals& futureInternals, void* userData)
+								{ CWorkItemQueue::main().add(resume, userData, CWorkItem::kPriorityNormal, cancelled); }
+			static	void	resume(CWorkItem& workItem, void* userData)
+								{ std::coroutine_handle<>::from_address(userData).resume(); }
+			static	void	cancelled(CWorkItem& workItem, void* userData)
+								{
+									// Never strand the coroutine - queue the resume again
+									CWorkItemQueue::main().add(resume, userData, CWorkItem::kPriorityNormal, cancelled);
+								}
+
+			// Properties
+			TFuture<T>	mFuture;
+		};
+
+				Awaiter						operator co_await() const
+												{ return Awaiter(*this); }
+#endif
+
+	// Properties
+	private:
+		TFutureInternals<T>*	mInternals;
+
+	template <typename U> friend class TFuture;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - TPromise
+
+template <typename T> class TPromise {
+	// Methods
+	public:
+						// Lifecycle methods
+						TPromise() : mInternals(new TFutureInternals<T>()) {}
+						TPromise(const TPromise<T>& other) :
+							mInternals((TFutureInternals<T>*) other.mInternals->addReference())
+							{}
+						~TPromise()
+							{ mInternals->removeReference(); }
+
+						// Instance methods
+		TFuture<T>		getFuture() const
+							{ return TFuture<T>(*mInternals); }
+
+		bool			setValue(const T& value) const
+							{ return mInternals->setValue(value); }
+		bool			setError(const SError& error) const
+							{ return mInternals->setError(error); }
+		bool			setResult(const TIResult<T>& result) const
+							{ return mInternals->setResult(result); }
+		bool			cancel() const
+							{ return mInternals->setError(SError::mCancelled); }
+
+		bool			isCancelRequested() const
+							{ return mInternals->isCancelRequested(); }
+
+		TPromise<T>&	operator=(const TPromise<T>& other)
+							{
+								// Swap references
+								other.mInternals->addReference();
+								mInternals->removeReference();
+								mInternals = other.mInternals;
+
+								return *this;
+							}
+
+	// Properties
+	private:
+		TFutureInternals<T>*	mInternals;
+};
@@ -6,6 +6,7 @@
 
 #include "CArray.h"
 #include "ConcurrencyPrimitives.h"
+#include "TReadMostly.h"
 
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: TNLockingArray
@@ -300,3 +301,68 @@ template <typename T> class TILockingArray : public CArray {
 	private:
 		CReadPreferringLock	mLock;
 };
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - TNReadMostlyArray
+//	Reads take no lock and read a snapshot (see TReadMostly).  Each change copies the array, so this is for arrays
+//		that are read far more often than they change (observer lists, configuration).  Items are returned as copies
+//		since a reference would outlive the snapshot it points into.
+
+template <typename T> class TNReadMostlyArray {
+	// Methods
+	public:
+										// Lifecycle methods
+										TNReadMostlyArray() : mReadMostly(TNArray<T>()) {}
+
+										// Instance methods
+				CArray::ItemCount		getCount() const
+											{
+												// Read
+												typename TReadMostly<TNArray<T> >::Reader	reader(mReadMostly);
+
+												return reader->getCount();
+											}
+				bool					contains(const T& item) const
+											{
+												// Read
+												typename TReadMostly<TNArray<T> >::Reader	reader(mReadMostly);
+
+												return reader->contains(item);
+											}
+				T						getAt(CArray::ItemIndex index) const
+											{
+												// Read
+												typename TReadMostly<TNArray<T> >::Reader	reader(mReadMostly);
+
+												return reader->getAt(index);
+											}
+				TNArray<T>				getSnapshot() const
+											{ return mReadMostly.getSnapshot(); }
+
+				TNReadMostlyArray<T>&	add(const T& item)
+											{ mReadMostly.update(performAdd, (void*) &item); return *this; }
+				TNReadMostlyArray<T>&	remove(const T& item)
+											{ mReadMostly.update(performRemove, (void*) &item); return *this; }
+				TNReadMostlyArray<T>&	removeAll()
+											{ mReadMostly.update(performRemoveAll, nil); return *this; }
+
+				T						operator[](CArray::ItemIndex index) const
+											{ return getAt(index); }
+				TNReadMostlyArray<T>&	operator+=(const T& item)
+											{ return add(item); }
+				TNReadMostlyArray<T>&	operator-=(const T& item)
+											{ return remove(item); }
+
+	private:
+										// Class methods
+		static	void					performAdd(TNArray<T>& array, void* userData)
+											{ array.add(*((T*) userData)); }
+		static	void					performRemove(TNArray<T>& array, void* userData)
+											{ array.remove(*((T*) userData)); }
+		static	void					performRemoveAll(TNArray<T>& array, void* userData)
+											{ array.removeAll(); }
+
+	// Properties
+	private:
+		TReadMostly<TNArray<T> >	mReadMostly;
+};
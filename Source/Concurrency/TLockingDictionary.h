@@ -6,6 +6,7 @@
 
 #include "CDictionary.h"
 #include "ConcurrencyPrimitives.h"
+#include "TReadMostly.h"
 
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: TNLockingDictionary
@@ -136,3 +137,191 @@ template <typename T> class TNLockingArrayDictionary : public CDictionary {
 	private:
 		CReadPreferringLock	mLock;
 };
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - TNShardedLockingDictionary
+//	Spreads keys across kShardCount TNLockingDictionary shards by key hash value so operations on different keys
+//		rarely contend for the same lock.
+
+template <typename T> class TNShardedLockingDictionary {
+	// Procs
+	public:
+		typedef	typename TNLockingDictionary<T>::UpdateProc	UpdateProc;
+
+	// Methods
+	public:
+										// Lifecycle methods
+										TNShardedLockingDictionary(SValue::OpaqueEqualsProc opaqueEqualsProc = nil)
+											{
+												// Setup
+												for (UInt32 i = 0; i < kShardCount; i++)
+													// Create shard
+													mShards[i] = new TNLockingDictionary<T>(opaqueEqualsProc);
+											}
+										~TNShardedLockingDictionary()
+											{
+												// Cleanup
+												for (UInt32 i = 0; i < kShardCount; i++)
+													// Delete shard
+													Delete(mShards[i]);
+											}
+
+										// Instance methods
+				CDictionary::KeyCount	getKeyCount() const
+											{
+												// Sum shards
+												CDictionary::KeyCount	keyCount = 0;
+												for (UInt32 i = 0; i < kShardCount; i++)
+													// Add shard key count
+													keyCount += mShards[i]->getKeyCount();
+
+												return keyCount;
+											}
+
+		const	OR<T>					get(const CString& key) const
+											{ return getShard(key).get(key); }
+				void					set(const CString& key, const T& item)
+											{ getShard(key).set(key, item); }
+				void					update(const CString& key, UpdateProc updateProc, void* userData)
+											{ getShard(key).update(key, updateProc, userData); }
+				void					remove(const CString& key)
+											{ getShard(key).remove(key); }
+
+		const	OR<T>					operator[](const CString& key) const
+											{ return get(key); }
+
+	private:
+										// Instance methods
+				TNLockingDictionary<T>&	getShard(const CString& key) const
+											{ return *mShards[key.getHashValue() >> (32 - kShardBitCount)]; }
+
+	// Properties
+	private:
+		static	const	UInt32					kShardBitCount = 4;
+		static	const	UInt32					kShardCount = 1 << kShardBitCount;
+
+						TNLockingDictionary<T>*	mShards[kShardCount];
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - TNReadMostlyDictionary
+//	Lookups take no lock and read a snapshot (see TReadMostly).  Snapshots use persistent storage, so each change
+//		copies only the path to the changed key.  Values are returned as copies since a reference would outlive the
+//		snapshot it points into.
+
+template <typename T> class TNReadMostlyDictionary {
+	// Procs
+	public:
+		typedef	OI<T>	(*UpdateProc)(const OR<T>& currentValue, void* userData);
+
+	// Structs
+	private:
+		struct UpdateInfo {
+			// Lifecycle methods
+			UpdateInfo(const CString& key, const OR<T>& item, UpdateProc updateProc, void* userData) :
+				mKey(key), mItem(item), mUpdateProc(updateProc), mUserData(userData)
+				{}
+
+			// Properties
+			const	CString&	mKey;
+					OR<T>		mItem;
+					UpdateProc	mUpdateProc;
+					void*		mUserData;
+		};
+
+	// Methods
+	public:
+										// Lifecycle methods
+										TNReadMostlyDictionary(SValue::OpaqueEqualsProc opaqueEqualsProc = nil) :
+											mReadMostly(
+													CDictionary(CDictionary::kStoragePersistent,
+															(SValue::OpaqueCopyProc) copy, dispose, opaqueEqualsProc))
+											{}
+
+										// Instance methods
+				CDictionary::KeyCount	getKeyCount() const
+											{
+												// Read
+												typename TReadMostly<CDictionary>::Reader	reader(mReadMostly);
+
+												return reader->getKeyCount();
+											}
+				bool					contains(const CString& key) const
+											{
+												// Read
+												typename TReadMostly<CDictionary>::Reader	reader(mReadMostly);
+
+												return reader->contains(key);
+											}
+				OV<T>					get(const CString& key) const
+											{
+												// Read
+												typename TReadMostly<CDictionary>::Reader	reader(mReadMostly);
+												OV<SValue::Opaque>	opaque = reader->getOpaque(key);
+
+												return opaque.hasValue() ? OV<T>(*((T*) opaque.getValue())) : OV<T>();
+											}
+				CDictionary				getSnapshot() const
+											{ return mReadMostly.getSnapshot(); }
+
+				void					set(const CString& key, const T& item)
+											{
+												// Update
+												UpdateInfo	updateInfo(key, OR<T>((T&) item), nil, nil);
+												mReadMostly.update(performUpdate, &updateInfo);
+											}
+				void					update(const CString& key, UpdateProc updateProc, void* userData)
+											{
+												// Update
+												UpdateInfo	updateInfo(key, OR<T>(), updateProc, userData);
+												mReadMostly.update(performUpdate, &updateInfo);
+											}
+				void					remove(const CString& key)
+											{
+												// Update
+												UpdateInfo	updateInfo(key, OR<T>(), nil, nil);
+												mReadMostly.update(performUpdate, &updateInfo);
+											}
+
+				OV<T>					operator[](const CString& key) const
+											{ return get(key); }
+
+	private:
+										// Class methods
+		static			void			performUpdate(CDictionary& dictionary, void* userData)
+											{
+												// Setup
+												UpdateInfo*	updateInfo = (UpdateInfo*) userData;
+
+												// Check what to do
+												if (updateInfo->mItem.hasReference())
+													// Set
+													dictionary.set(updateInfo->mKey, new T(*updateInfo->mItem));
+												else if (updateInfo->mUpdateProc != nil) {
+													// Update
+													OV<SValue::Opaque>	opaque = dictionary.getOpaque(updateInfo->mKey);
+													OI<T>	updatedValue =
+																	updateInfo->mUpdateProc(
+																			opaque.hasValue() ?
+																					OR<T>(*((T*) opaque.getValue())) :
+																					OR<T>(),
+																			updateInfo->mUserData);
+													if (updatedValue.hasInstance())
+														// Store
+														dictionary.set(updateInfo->mKey, new T(*updatedValue));
+													else
+														// Remove
+														dictionary.remove(updateInfo->mKey);
+												} else
+													// Remove
+													dictionary.remove(updateInfo->mKey);
+											}
+		static			T*				copy(SValue::Opaque opaque)
+											{ return new T(*((T*) opaque)); }
+		static			void			dispose(SValue::Opaque opaque)
+											{ T* t = (T*) opaque; Delete(t); }
+
+	// Properties
+	private:
+		TReadMostly<CDictionary>	mReadMostly;
+};
@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------------------------------------------------
+//	TReadMostly.h			©2021 Stevo Brock	All rights reserved.
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "ConcurrencyPrimitives.h"
+
+#include <atomic>
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: TReadMostly
+//	Holds a value that is read far more often than it changes (RCU style).  Readers take no lock: a Reader registers
+//		in one of kReaderCountCount counters for the current epoch (picked per thread so concurrent readers rarely
+//		share a cache line), loads the current snapshot and reads it in place.  Writers are serialized, apply their
+//		change to a copy and publish it.
+//	Replaced snapshots are retired and freed after a grace period.  Writes flip the epoch, so readers registering
+//		afterwards use the other set of counters, and once every counter of the previous epoch has drained, no reader
+//		can still see a snapshot retired before that flip.  Readers are short, so under steady reads each write frees
+//		what was retired a write or two earlier.
+
+template <typename T> class TReadMostly {
+	// Procs
+	public:
+		typedef	void	(*UpdateProc)(T& t, void* userData);
+
+	// Reader
+	public:
+		class Reader {
+			// Methods
+			public:
+								// Lifecycle methods
+								Reader(const TReadMostly<T>& readMostly)
+									{
+										// Register in the current epoch (retry if it flipped meanwhile), then load
+										for (;;) {
+											// Register
+											UInt32	epoch = readMostly.mEpoch.load();
+											mReaderCount = &readMostly.getReaderCount(epoch);
+											(*mReaderCount)++;
+
+											// Check if still current
+											if (readMostly.mEpoch.load() == epoch)
+												// Registered
+												break;
+
+											// Retry
+											(*mReaderCount)--;
+										}
+										mT = readMostly.mT.load();
+									}
+								~Reader()
+									{ (*mReaderCount)--; }
+
+								// Instance methods
+				const	T&		operator*() const
+									{ return *mT; }
+				const	T*		operator->() const
+									{ return mT; }
+
+			// Properties
+			private:
+				std::atomic<UInt32>*	mReaderCount;
+				const	T*				mT;
+		};
+
+	// Structs
+	private:
+		struct ReaderCount {
+			// Properties
+			alignas(64)	std::atomic<UInt32>	mCount;
+		};
+
+		struct Retired {
+			// Lifecycle methods
+			Retired(T* t, Retired* next) : mT(t), mNext(next) {}
+
+			// Properties
+			T*			mT;
+			Retired*	mNext;
+		};
+
+	// Methods
+	public:
+								// Lifecycle methods
+								TReadMostly(const T& t) :
+									mT(new T(t)), mEpoch(0), mRetiredCurrent(nil), mRetiredPrevious(nil)
+									{
+										// Setup
+										for (UInt32 i = 0; i < kReaderCountCount; i++) {
+											// Reset
+											mReaderCounts[0][i].mCount = 0;
+											mReaderCounts[1][i].mCount = 0;
+										}
+									}
+								~TReadMostly()
+									{
+										// Cleanup
+										deleteRetired(mRetiredCurrent);
+										deleteRetired(mRetiredPrevious);
+
+										T*	t = mT.load();
+										Delete(t);
+									}
+
+								// Instance methods
+		T						getSnapshot() const
+									{ Reader reader(*this); return *reader; }
+		void					update(UpdateProc updateProc, void* userData)
+									{
+										// Update a copy
+										mUpdateLock.lock();
+										T*	t = new T(*mT.load());
+										updateProc(*t, userData);
+
+										// Publish and retire the previous snapshot
+										mRetiredCurrent = new Retired(mT.exchange(t), mRetiredCurrent);
+
+										// Advance epochs while all readers of the previous epoch are done
+										while (!haveReaders(mEpoch.load() ^ 1)) {
+											// Nothing retired before the last flip can still be in use
+											deleteRetired(mRetiredPrevious);
+											if (mRetiredCurrent == nil)
+												// Done
+												break;
+
+											// Flip so the current retired snapshots get their own grace period
+											mRetiredPrevious = mRetiredCurrent;
+											mRetiredCurrent = nil;
+											mEpoch.store(mEpoch.load() ^ 1);
+										}
+										mUpdateLock.unlock();
+									}
+
+	private:
+								// Instance methods
+		std::atomic<UInt32>&	getReaderCount(UInt32 epoch) const
+									{
+										// Assign each thread a counter the first time it reads
+										static			std::atomic<UInt32>	sNextIndex(0);
+										static	thread_local	UInt32		sIndex = sNextIndex++ % kReaderCountCount;
+
+										return mReaderCounts[epoch][sIndex].mCount;
+									}
+		bool					haveReaders(UInt32 epoch) const
+									{
+										// Check all counters for this epoch
+										for (UInt32 i = 0; i < kReaderCountCount; i++) {
+											// Check this counter
+											if (mReaderCounts[epoch][i].mCount.load() > 0)
+												// Have readers
+												return true;
+										}
+
+										return false;
+									}
+		void					deleteRetired(Retired*& retired)
+									{
+										// Delete all
+										while (retired != nil) {
+											// Delete this one
+											Retired*	next = retired->mNext;
+											Delete(retired->mT);
+											Delete(retired);
+											retired = next;
+										}
+									}
+
+	// Properties
+	private:
+		static	const	UInt32				kReaderCountCount = 16;
+
+						std::atomic<T*>		mT;
+						std::atomic<UInt32>	mEpoch;
+				mutable	ReaderCount			mReaderCounts[2][kReaderCountCount];
+						Retired*			mRetiredCurrent;
+						Retired*			mRetiredPrevious;
+						CLock				mUpdateLock;
+};
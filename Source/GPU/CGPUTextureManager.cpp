@@ -9,6 +9,8 @@
 #include "CWorkItemQueue.h"
 #include "TWrappers.h"
 
+#include <atomic>
+
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: SGPUTextureDataInfo
 
@@ -109,9 +111,16 @@ class CGPULoadableTextureReferenceInternals : public CGPUTextureReferenceInterna
 								if (mReferenceOptions & CGPUTextureManager::kReferenceOptionsLoadImmediately)
 									// Finish loading
 									finishLoading();
-								else
-									// Setup workItem
-									mGPUTextureManagerInfo.mWorkItemQueue.add(load, this);
+								else {
+									// Setup workItem (unless already queued)
+									mWorkItemLock.lock();
+									if (mWorkItem == nil)
+										// Queue
+										mWorkItem =
+												&mGPUTextureManagerInfo.mWorkItemQueue.add(load, this,
+														CWorkItem::kPriorityNormal, loadCancelled);
+									mWorkItemLock.unlock();
+								}
 							}
 				void	finishLoading()
 							{
@@ -133,12 +142,14 @@ class CGPULoadableTextureReferenceInternals : public CGPUTextureReferenceInterna
 							}
 				void	unload()
 							{
-								// Check for workItem
-								if (mWorkItem != nil) {
+								// Check for workItem.  Cancel while holding the lock so the workItem cannot finish and
+								//	be deleted in between.
+								mWorkItemLock.lock();
+								CWorkItem*	workItem = mWorkItem.exchange(nil);
+								if (workItem != nil)
 									// Cancel
-									mGPUTextureManagerInfo.mWorkItemQueue.cancel(*mWorkItem);
-									mWorkItem = nil;
-								}
+									mGPUTextureManagerInfo.mWorkItemQueue.cancel(*workItem);
+								mWorkItemLock.unlock();
 
 								// Check for render materia texture
 								if (mGPUTextureDataInfo != nil)
@@ -151,7 +162,19 @@ class CGPULoadableTextureReferenceInternals : public CGPUTextureReferenceInterna
 
 						// Instance methods
 				bool	isLoadingContinuing()
-							{ return mFinishLoadingTriggered || ((mWorkItem != nil) && !mWorkItem->isCancelled()); }
+							{
+								// Check if triggered
+								if (mFinishLoadingTriggered)
+									return true;
+
+								// Check workItem
+								mWorkItemLock.lock();
+								CWorkItem*	workItem = mWorkItem;
+								bool		isLoadingContinuing = (workItem != nil) && !workItem->isCancelRequested();
+								mWorkItemLock.unlock();
+
+								return isLoadingContinuing;
+							}
 
 						// Instance methods for subclasses to call
 				void	loadComplete(const CData& data, CGPUTexture::DataFormat dataFormat, S2DSizeU16 size)
@@ -170,6 +193,14 @@ class CGPULoadableTextureReferenceInternals : public CGPUTextureReferenceInterna
 												mGPUTextureManagerInfo.mGPU.registerTexture(mGPUTextureDataInfo->mData,
 														mGPUTextureDataInfo->mDataFormat, mGPUTextureDataInfo->mSize));
 							}
+				void	clearWorkItem(CWorkItem& workItem)
+							{
+								// Clear if still ours
+								CWorkItem*	expectedWorkItem = &workItem;
+								mWorkItemLock.lock();
+								mWorkItem.compare_exchange_strong(expectedWorkItem, nil);
+								mWorkItemLock.unlock();
+							}
 
 						// Instance methods for subclasses to implement or override
 		virtual	void	load() = 0;
@@ -182,9 +213,6 @@ class CGPULoadableTextureReferenceInternals : public CGPUTextureReferenceInterna
 																				*((CGPULoadableTextureReferenceInternals*)
 																						userData);
 
-								// Store
-								internals.mWorkItem = &workItem;
-
 								// Setup to load
 								internals.mLoadLock.lock();
 								if (!internals.getIsLoaded())
@@ -192,15 +220,34 @@ class CGPULoadableTextureReferenceInternals : public CGPUTextureReferenceInterna
 									internals.load();
 								internals.mLoadLock.unlock();
 
+								// Check if stopped early
+								if (workItem.isCancelRequested() && !internals.getIsLoaded())
+									// Stopped early
+									workItem.noteStoppedEarly();
+
 								// Finished
-								internals.mWorkItem = nil;
+								internals.clearWorkItem(workItem);
+							}
+		static	void	loadCancelled(CWorkItem& workItem, void* userData)
+							{
+								// Get info
+								CGPULoadableTextureReferenceInternals&	internals =
+																				*((CGPULoadableTextureReferenceInternals*)
+																						userData);
+
+								// Check if still recorded (unload() clears it before cancelling, and calls us while
+								//	holding the lock)
+								if (internals.mWorkItem == &workItem)
+									// Finished
+									internals.clearWorkItem(workItem);
 							}
 
 		OV<CGPUTexture::DataFormat>				mDataFormat;
 		CGPUTextureManager::ReferenceOptions	mReferenceOptions;
 
 		CLock									mLoadLock;
-		CWorkItem*								mWorkItem;
+		CLock									mWorkItemLock;
+		std::atomic<CWorkItem*>					mWorkItem;
 		bool									mFinishLoadingTriggered;
 		SGPUTextureDataInfo*					mGPUTextureDataInfo;
 };
@@ -13,8 +13,8 @@ class CCodecRegistryInternals {
 	public:
 		CCodecRegistryInternals() {}
 
-		TKeyConvertibleDictionary<OSType, CAudioCodec::Info>	mAudioCodecInfo;
-		TKeyConvertibleDictionary<OSType, CVideoCodec::Info>	mVideoCodecInfo;
+		TNumericKeyDictionary<OSType, CAudioCodec::Info>	mAudioCodecInfo;
+		TNumericKeyDictionary<OSType, CVideoCodec::Info>	mVideoCodecInfo;
 };
 
 CCodecRegistryInternals*	sCodecRegistryInternals = nil;
@@ -13,8 +13,8 @@ class CMediaDestinationInternals {
 	public:
 		CMediaDestinationInternals() {}
 
-		TKeyConvertibleDictionary<UInt32, I<CAudioProcessor> >	mAudioProcessors;
-		TKeyConvertibleDictionary<UInt32, I<CVideoProcessor> >	mVideoProcessors;
+		TNumericKeyDictionary<UInt32, I<CAudioProcessor> >	mAudioProcessors;
+		TNumericKeyDictionary<UInt32, I<CVideoProcessor> >	mVideoProcessors;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -19,7 +19,7 @@ class CMediaSourceRegistryInternals {
 	public:
 		CMediaSourceRegistryInternals() {}
 
-		TKeyConvertibleDictionary<OSType, SMediaSource::Info>	mMediaSourceInfo;
+		TNumericKeyDictionary<OSType, SMediaSource::Info>		mMediaSourceInfo;
 };
 
 CMediaSourceRegistryInternals*	sMediaSourceRegistryInternals = nil;
@@ -67,11 +67,8 @@ TIResult<CMediaSourceRegistry::IdentifyInfo> CMediaSourceRegistry::identify(
 		const I<CSeekableDataSource>& seekableDataSource, const CString& extension) const
 //----------------------------------------------------------------------------------------------------------------------
 {
-	TSet<CString>	mediaSourceTypes = sMediaSourceRegistryInternals->mMediaSourceInfo.getKeys();
-	for (TIteratorS<CString> iterator = mediaSourceTypes.getIterator(); iterator.hasValue(); iterator.advance()) {
-		// Get info
-		SMediaSource::Info&	mediaSourceInfo = *sMediaSourceRegistryInternals->mMediaSourceInfo[iterator->getUInt32()];
-
+	// Iterate all media sources
+	for (SMediaSource::Info& mediaSourceInfo : sMediaSourceRegistryInternals->mMediaSourceInfo) {
 		// Check extensions
 		if (mediaSourceInfo.getExtensions().contains(extension)) {
 			// Found by extension
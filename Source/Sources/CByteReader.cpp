@@ -133,12 +133,21 @@ OI<SError> CByteReader::readData(void* buffer, UInt64 byteCount) const
 TIResult<CData> CByteReader::readData(CData::Size byteCount) const
 //----------------------------------------------------------------------------------------------------------------------
 {
+	// Check if can perform read
+	if ((mInternals->mCurrentDataSourceOffset - mInternals->mInitialDataSourceOffset + byteCount) > mInternals->mSize)
+		// Can't read that many bytes
+		return TIResult<CData>(SError::mEndOfData);
+
 	// Read
-	CData		data(byteCount);
-	OI<SError>	error = readData(data.getMutableBytePtr(), byteCount);
-	ReturnValueIfError(error, TIResult<CData>(*error));
+	TIResult<CData>	dataResult =
+							mInternals->mSeekableDataSource->readData(mInternals->mCurrentDataSourceOffset,
+									byteCount);
+	ReturnValueIfResultError(dataResult, dataResult);
+
+	// Update
+	mInternals->mCurrentDataSourceOffset += byteCount;
 
-	return TIResult<CData>(data);
+	return dataResult;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -4,6 +4,7 @@
 
 #include "CDataSource.h"
 
+#include "CBase64.h"
 #include "CData.h"
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -32,6 +33,22 @@ TIResult<CData> CSeekableDataSource::readData()
 	return TIResult<CData>(data);
 }
 
+// MARK: Instance methods
+
+//----------------------------------------------------------------------------------------------------------------------
+TIResult<CData> CSeekableDataSource::readData(UInt64 position, CData::Size byteCount)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Setup
+	CData	data(byteCount);
+
+	// Read
+	OI<SError>	error = readData(position, data.getMutableBytePtr(), byteCount);
+	ReturnValueIfError(error, TIResult<CData>(*error));
+
+	return TIResult<CData>(data);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - CDataDataSourceInternals
@@ -88,3 +105,131 @@ OI<SError> CDataDataSource::readData(UInt64 position, void* buffer, CData::Size
 
 	return OI<SError>();
 }
+
+//----------------------------------------------------------------------------------------------------------------------
+TIResult<CData> CDataDataSource::readData(UInt64 position, CData::Size byteCount)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Preflight
+	AssertFailIf((position + byteCount) > mInternals->mData.getSize());
+	if ((position + byteCount) > mInternals->mData.getSize())
+		// Attempting to ready beyond end of data
+		return TIResult<CData>(SError::mEndOfData);
+
+	return TIResult<CData>(mInternals->mData.getSubData(position, byteCount));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CBase64DataSourceInternals
+
+class CBase64DataSourceInternals {
+	public:
+		CBase64DataSourceInternals(const I<CSeekableDataSource>& seekableDataSource,
+				CBase64DataSource::Operation operation, bool prettyPrint) :
+			mSeekableDataSource(seekableDataSource), mOperation(operation), mPrettyPrint(prettyPrint)
+			{}
+
+		TIResult<CData>	encode()
+							{
+								// Setup
+								UInt64			size = mSeekableDataSource->getSize();
+								CDataBuilder	dataBuilder(
+														(CData::Size) CBase64::getEncodedCharCount(size, mPrettyPrint));
+
+								// Chunks are whole pretty print lines so the output matches encoding all at once
+								UInt64	chunkByteCount = CBase64::kPrettyPrintLineByteCount * 1024;
+								for (UInt64 position = 0; position < size; position += chunkByteCount) {
+									// Read
+									UInt64			byteCount = std::min<UInt64>(chunkByteCount, size - position);
+									TIResult<CData>	dataResult = mSeekableDataSource->readData(position, byteCount);
+									ReturnValueIfResultError(dataResult, dataResult);
+
+									// Encode
+									UInt64	charCount = CBase64::getEncodedCharCount(byteCount, mPrettyPrint);
+									dataBuilder.commitBytes(
+											CBase64::encode(dataResult.getValue().getBytePtr(), byteCount,
+													(char*) dataBuilder.getWritableBytePtr(charCount),
+													mPrettyPrint));
+								}
+
+								return TIResult<CData>(dataBuilder.getData());
+							}
+		TIResult<CData>	decode()
+							{
+								// Setup
+								UInt64			size = mSeekableDataSource->getSize();
+								CDataBuilder	dataBuilder((CData::Size) CBase64::getDecodedByteCountMax(size));
+
+								// A partial group at the end of a chunk is carried to the front of the next
+								UInt64	chunkCharCount = 64 * 1024;
+								CData	unusedData;
+								for (UInt64 position = 0; position < size;) {
+									// Read
+									UInt64			charCount = std::min<UInt64>(chunkCharCount, size - position);
+									TIResult<CData>	dataResult = mSeekableDataSource->readData(position, charCount);
+									ReturnValueIfResultError(dataResult, dataResult);
+									position += charCount;
+
+									// Setup
+									CData			data =
+															unusedData.isEmpty() ?
+																	dataResult.getValue() :
+																	unusedData + dataResult.getValue();
+									const	char*	chars = (const char*) data.getBytePtr();
+											UInt64	dataCharCount = data.getSize();
+											void*	bytes =
+															dataBuilder.getWritableBytePtr(
+																	CBase64::getDecodedByteCountMax(dataCharCount));
+
+									// Decode
+									if ((position < size) && (::memchr(chars, '=', dataCharCount) == nil)) {
+										// More to come
+										UInt64	usedCharCount;
+										dataBuilder.commitBytes(
+												CBase64::decode(chars, dataCharCount, bytes, usedCharCount));
+										unusedData = data.getSubData((CData::ByteIndex) usedCharCount);
+									} else {
+										// Last chunk or padding (where decoding stops)
+										dataBuilder.commitBytes(CBase64::decode(chars, dataCharCount, bytes));
+										break;
+									}
+								}
+
+								return TIResult<CData>(dataBuilder.getData());
+							}
+
+		I<CSeekableDataSource>			mSeekableDataSource;
+		CBase64DataSource::Operation	mOperation;
+		bool							mPrettyPrint;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CBase64DataSource
+
+// Lifecycle methods
+
+//----------------------------------------------------------------------------------------------------------------------
+CBase64DataSource::CBase64DataSource(const I<CSeekableDataSource>& seekableDataSource, Operation operation,
+		bool prettyPrint)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	mInternals = new CBase64DataSourceInternals(seekableDataSource, operation, prettyPrint);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+CBase64DataSource::~CBase64DataSource()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	Delete(mInternals);
+}
+
+// CDataSource methods
+
+//----------------------------------------------------------------------------------------------------------------------
+TIResult<CData> CBase64DataSource::readData()
+//----------------------------------------------------------------------------------------------------------------------
+{
+	return (mInternals->mOperation == kOperationEncode) ? mInternals->encode() : mInternals->decode();
+}
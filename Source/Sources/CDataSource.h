@@ -37,6 +37,7 @@ class CSeekableDataSource : public CDataSource {
 		virtual	UInt64			getSize() const = 0;
 
 		virtual	OI<SError>		readData(UInt64 position, void* buffer, CData::Size byteCount) = 0;
+		virtual	TIResult<CData>	readData(UInt64 position, CData::Size byteCount);
 
 	// Properties
 	protected:
@@ -51,16 +52,46 @@ class CDataDataSourceInternals;
 class CDataDataSource : public CSeekableDataSource {
 	// Methods
 	public:
-					// Lifecycle methods
-					CDataDataSource(const CData& data);
-					~CDataDataSource();
+						// Lifecycle methods
+						CDataDataSource(const CData& data);
+						~CDataDataSource();
 
-					// CSeekableDataSource methods
-		UInt64		getSize() const;
+						// CSeekableDataSource methods
+		UInt64			getSize() const;
 
-		OI<SError>	readData(UInt64 position, void* buffer, CData::Size byteCount);
+		OI<SError>		readData(UInt64 position, void* buffer, CData::Size byteCount);
+		TIResult<CData>	readData(UInt64 position, CData::Size byteCount);
 
 	// Properties
 	private:
 		CDataDataSourceInternals*	mInternals;
 };
+
+//----------------------------------------------------------------------------------------------------------------------
+// MARK: - CBase64DataSource
+//	Encodes to or decodes from base64 while reading another seekable data source in chunks, so large payloads are
+//		converted without first being read into memory in full.
+
+class CBase64DataSourceInternals;
+class CBase64DataSource : public CDataSource {
+	// Enums
+	public:
+		enum Operation {
+			kOperationEncode,
+			kOperationDecode,
+		};
+
+	// Methods
+	public:
+						// Lifecycle methods
+						CBase64DataSource(const I<CSeekableDataSource>& seekableDataSource, Operation operation,
+								bool prettyPrint = false);
+						~CBase64DataSource();
+
+						// CDataSource methods
+		TIResult<CData>	readData();
+
+	// Properties
+	private:
+		CBase64DataSourceInternals*	mInternals;
+};
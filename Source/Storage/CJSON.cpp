@@ -17,14 +17,15 @@ static	SError	sInvalidTokenError(sErrorDomain, 2, CString(OSSTR("Invalid Token")
 //----------------------------------------------------------------------------------------------------------------------
 // MARK: - Local method declarations
 
-static	OI<SError>				sAddArrayOfDictionaries(CData& data, const TArray<CDictionary>& array);
-static	OI<SError>				sAddArrayOfStrings(CData& data, const TArray<CString>& array);
-static	OI<SError>				sAddDictionary(CData& data, const CDictionary& dictionary);
-static	void					sAddString(CData& data, const CString& string);
-
-static	TIResult<CDictionary>	sReadDictionary(const SInt8*& charPtr);
-static	TIResult<CString>		sReadString(const SInt8*& charPtr);
-static	TIResult<SValue>		sReadValue(const SInt8*& charPtr);
+static	OI<SError>				sAddArrayOfDictionaries(CDataBuilder& data, const TArray<CDictionary>& array);
+static	OI<SError>				sAddArrayOfStrings(CDataBuilder& data, const TArray<CString>& array);
+static	OI<SError>				sAddDictionary(CDataBuilder& data, const CDictionary& dictionary);
+static	void					sAddString(CDataBuilder& data, const CString& string);
+
+static	OI<SError>				sReadDictionary(const SInt8*& charPtr, const OR<CArena>& arena,
+										CDictionary& dictionary);
+static	CString					sReadString(const SInt8*& charPtr, OI<SError>& error);
+static	OI<SError>				sReadValue(const SInt8*& charPtr, const OR<CArena>& arena, SValue& value);
 static	void					sSkipWhitespace(const SInt8*& charPtr);
 static	OI<SError>				sValidateToken(const SInt8*& charPtr, char token, bool advance = false);
 
@@ -39,9 +40,25 @@ TIResult<CDictionary> CJSON::dictionaryFrom(const CData& data)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Read dictionary
-	const	SInt8*	charPtr = (const SInt8*) data.getBytePtr();
+	const	SInt8*		charPtr = (const SInt8*) data.getBytePtr();
+			CDictionary	dictionary;
+			OI<SError>	error = sReadDictionary(charPtr, OR<CArena>(), dictionary);
+	ReturnValueIfError(error, TIResult<CDictionary>(*error));
+
+	return TIResult<CDictionary>(dictionary);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+TIResult<CDictionary> CJSON::dictionaryFrom(const CData& data, CArena& arena)
+//----------------------------------------------------------------------------------------------------------------------
+{
+	// Read dictionary
+	const	SInt8*		charPtr = (const SInt8*) data.getBytePtr();
+			CDictionary	dictionary(arena);
+			OI<SError>	error = sReadDictionary(charPtr, OR<CArena>(arena), dictionary);
+	ReturnValueIfError(error, TIResult<CDictionary>(*error));
 
-	return sReadDictionary(charPtr);
+	return TIResult<CDictionary>(dictionary);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -49,7 +66,7 @@ TIResult<CData> CJSON::dataFrom(const CDictionary& dictionary)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Setup
-	CData	data;
+	CDataBuilder	data;
 
 	// Add dictionary
 	OI<SError>	error = sAddDictionary(data, dictionary);
@@ -57,7 +74,7 @@ TIResult<CData> CJSON::dataFrom(const CDictionary& dictionary)
 		// Error
 		return TIResult<CData>(*error);
 
-	return TIResult<CData>(data);
+	return TIResult<CData>(data.getData());
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -65,7 +82,7 @@ TIResult<CData> CJSON::dataFrom(const CDictionary& dictionary)
 // MARK: Local method definitions
 
 //----------------------------------------------------------------------------------------------------------------------
-OI<SError> sAddArrayOfDictionaries(CData& data, const TArray<CDictionary>& array)
+OI<SError> sAddArrayOfDictionaries(CDataBuilder& data, const TArray<CDictionary>& array)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Start
@@ -89,7 +106,7 @@ OI<SError> sAddArrayOfDictionaries(CData& data, const TArray<CDictionary>& array
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-OI<SError> sAddArrayOfStrings(CData& data, const TArray<CString>& array)
+OI<SError> sAddArrayOfStrings(CDataBuilder& data, const TArray<CString>& array)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Start
@@ -113,7 +130,7 @@ OI<SError> sAddArrayOfStrings(CData& data, const TArray<CString>& array)
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-OI<SError> sAddDictionary(CData& data, const CDictionary& dictionary)
+OI<SError> sAddDictionary(CDataBuilder& data, const CDictionary& dictionary)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Start
@@ -175,52 +192,52 @@ OI<SError> sAddDictionary(CData& data, const CDictionary& dictionary)
 
 			case SValue::kFloat32:
 				// Float32
-				data += CString(iterator->mValue.getFloat32()).getData();
+				data.append(CString(iterator->mValue.getFloat32()));
 				break;
 
 			case SValue::kFloat64:
 				// Float64
-				data += CString(iterator->mValue.getFloat64()).getData();
+				data.append(CString(iterator->mValue.getFloat64()));
 				break;
 
 			case SValue::kSInt8:
 				// SInt8
-				data += CString(iterator->mValue.getSInt8()).getData();
+				data.append(CString(iterator->mValue.getSInt8()));
 				break;
 
 			case SValue::kSInt16:
 				// SInt16
-				data += CString(iterator->mValue.getSInt16()).getData();
+				data.append(CString(iterator->mValue.getSInt16()));
 				break;
 
 			case SValue::kSInt32:
 				// SInt32
-				data += CString(iterator->mValue.getSInt32()).getData();
+				data.append(CString(iterator->mValue.getSInt32()));
 				break;
 
 			case SValue::kSInt64:
 				// SInt64
-				data += CString(iterator->mValue.getSInt64()).getData();
+				data.append(CString(iterator->mValue.getSInt64()));
 				break;
 
 			case SValue::kUInt8:
 				// UInt8
-				data += CString(iterator->mValue.getUInt8()).getData();
+				data.append(CString(iterator->mValue.getUInt8()));
 				break;
 
 			case SValue::kUInt16:
 				// UInt16
-				data += CString(iterator->mValue.getUInt16()).getData();
+				data.append(CString(iterator->mValue.getUInt16()));
 				break;
 
 			case SValue::kUInt32:
 				// UInt32
-				data += CString(iterator->mValue.getUInt32()).getData();
+				data.append(CString(iterator->mValue.getUInt32()));
 				break;
 
 			case SValue::kUInt64:
 				// UInt64
-				data += CString(iterator->mValue.getUInt64()).getData();
+				data.append(CString(iterator->mValue.getUInt64()));
 				break;
 
 			case SValue::kData:
@@ -237,11 +254,11 @@ OI<SError> sAddDictionary(CData& data, const CDictionary& dictionary)
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void sAddString(CData& data, const CString& string)
+void sAddString(CDataBuilder& data, const CString& string)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	data.appendBytes("\"", 1);
-	data +=
+	data.append(
 			string
 					.replacingSubStrings(CString(OSSTR("\\")), CString(OSSTR("\\\\")))
 					.replacingSubStrings(CString(OSSTR("\t")), CString(OSSTR("\\t")))
@@ -250,49 +267,43 @@ void sAddString(CData& data, const CString& string)
 					.replacingSubStrings(CString(OSSTR("\f")), CString(OSSTR("\\f")))
 					.replacingSubStrings(CString(OSSTR("\b")), CString(OSSTR("\\b")))
 					.replacingSubStrings(CString(OSSTR("/")), CString(OSSTR("\\/")))
-					.replacingSubStrings(CString(OSSTR("\"")), CString(OSSTR("\\\"")))
-					.getData(CString::kEncodingUTF8);
+					.replacingSubStrings(CString(OSSTR("\"")), CString(OSSTR("\\\""))));
 	data.appendBytes("\"", 1);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-TIResult<CDictionary> sReadDictionary(const SInt8*& charPtr)
+OI<SError> sReadDictionary(const SInt8*& charPtr, const OR<CArena>& arena, CDictionary& dictionary)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Validate start token
 	OI<SError>	error = sValidateToken(charPtr, '{', true);
-	ReturnValueIfError(error, TIResult<CDictionary>(*error));
+	ReturnErrorIfError(error);
 
 	// Skip whitespace
 	sSkipWhitespace(charPtr);
 
 	// Iterate entries
-	CDictionary	dictionary;
+	SValue	value(SValue::mEmpty);
 	while (true) {
 		// Inspect token
 		if (*charPtr == '\"') {
 			// Read key
-			TIResult<CString>	keyResult = sReadString(charPtr);
-			ReturnValueIfResultError(keyResult, TIResult<CDictionary>(keyResult.getError()));
+			CString	key = sReadString(charPtr, error);
+			ReturnErrorIfError(error);
 
 			// Skip whitespace
 			sSkipWhitespace(charPtr);
 
 			// Validate token
 			error = sValidateToken(charPtr, ':', true);
-			ReturnValueIfError(error, TIResult<CDictionary>(*error));
+			ReturnErrorIfError(error);
 
 			// Read value
-			TIResult<SValue>	valueResult = sReadValue(charPtr);
-			ReturnValueIfResultError(valueResult, TIResult<CDictionary>(valueResult.getError()));
+			error = sReadValue(charPtr, arena, value);
+			ReturnErrorIfError(error);
 
-			// Check if got value
-			if (valueResult.hasValue())
-				// Store
-				dictionary.set(keyResult.getValue(), valueResult.getValue());
-
-			// Skip whitespace
-			sSkipWhitespace(charPtr);
+			// Store
+			dictionary.set(key, value);
 
 			// Check next token
 			if (*charPtr == ',') {
@@ -302,80 +313,84 @@ TIResult<CDictionary> sReadDictionary(const SInt8*& charPtr)
 				sSkipWhitespace(charPtr);
 			} else if (*charPtr != '}')
 				// Invalid token
-				return TIResult<CDictionary>(sInvalidTokenError);
+				return OI<SError>(sInvalidTokenError);
 		} else if (*charPtr == '}') {
 			// End
 			charPtr++;
 
-			return TIResult<CDictionary>(dictionary);
+			return OI<SError>();
 		} else
 			// Invalid token
-			return TIResult<CDictionary>(sInvalidTokenError);
+			return OI<SError>(sInvalidTokenError);
 	}
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-TIResult<CString> sReadString(const SInt8*& charPtr)
+CString sReadString(const SInt8*& charPtr, OI<SError>& error)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Validate opening "
-	OI<SError>	error = sValidateToken(charPtr, '\"', true);
-	ReturnValueIfError(error, TIResult<CString>(*error));
+	error = sValidateToken(charPtr, '\"', true);
+	ReturnValueIfError(error, CString::mEmpty);
 
 	// Scan looking for closing "
 	const	SInt8*	startCharPtr = charPtr;
-	while (true) {
+			bool	hasEscapes = false;
+	while (*charPtr != '\"') {
 		// Check character
-		if ((*charPtr == '\\') && (*(charPtr + 1) == '\"'))
-			// Not the quotes we're looking for
+		if (*charPtr == '\\') {
+			// Escape sequence, skip the escaped character as well so an escaped " does not end the string
+			hasEscapes = true;
 			charPtr += 2;
-		else if (*charPtr == '\"') {
-			// End quote
-			charPtr++;
-
-			return TIResult<CString>(
-					CString((char*) startCharPtr, (CString::Length) (charPtr - startCharPtr - 1),
-									CString::kEncodingUTF8)
-							.replacingSubStrings(CString(OSSTR("\\\"")), CString(OSSTR("\"")))
-							.replacingSubStrings(CString(OSSTR("\\/")), CString(OSSTR("/")))
-							.replacingSubStrings(CString(OSSTR("\\b")), CString(OSSTR("\b")))
-							.replacingSubStrings(CString(OSSTR("\\f")), CString(OSSTR("\f")))
-							.replacingSubStrings(CString(OSSTR("\\n")), CString(OSSTR("\n")))
-							.replacingSubStrings(CString(OSSTR("\\r")), CString(OSSTR("\r")))
-							.replacingSubStrings(CString(OSSTR("\\t")), CString(OSSTR("\t")))
-							.replacingSubStrings(CString(OSSTR("\\\\")), CString(OSSTR("\\"))));
 		} else
 			// One more char
 			charPtr++;
 	}
+
+	// Setup
+	const	char*			chars = (const char*) startCharPtr;
+			CString::Length	charsCount = (CString::Length) (charPtr - startCharPtr);
+	charPtr++;
+
+	// Check for escapes
+	if (!hasEscapes)
+		// Create string
+		return CString(chars, charsCount, CString::kEncodingUTF8);
+
+	// Create string and replace escapes
+	return CString(chars, charsCount, CString::kEncodingUTF8)
+			.replacingSubStrings(CString(OSSTR("\\\"")), CString(OSSTR("\"")))
+			.replacingSubStrings(CString(OSSTR("\\/")), CString(OSSTR("/")))
+			.replacingSubStrings(CString(OSSTR("\\b")), CString(OSSTR("\b")))
+			.replacingSubStrings(CString(OSSTR("\\f")), CString(OSSTR("\f")))
+			.replacingSubStrings(CString(OSSTR("\\n")), CString(OSSTR("\n")))
+			.replacingSubStrings(CString(OSSTR("\\r")), CString(OSSTR("\r")))
+			.replacingSubStrings(CString(OSSTR("\\t")), CString(OSSTR("\t")))
+			.replacingSubStrings(CString(OSSTR("\\\\")), CString(OSSTR("\\")));
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-TIResult<SValue> sReadValue(const SInt8*& charPtr)
+OI<SError> sReadValue(const SInt8*& charPtr, const OR<CArena>& arena, SValue& value)
 //----------------------------------------------------------------------------------------------------------------------
 {
 	// Skip whitespace
 	sSkipWhitespace(charPtr);
 
 	// Check token
+	OI<SError>	error;
 	if (*charPtr == '\"') {
 		// String
-		TIResult<CString>	result = sReadString(charPtr);
-		ReturnValueIfResultError(result, TIResult<SValue>(result.getError()));
-
-		// Skip whitespace
-		sSkipWhitespace(charPtr);
+		CString	string = sReadString(charPtr, error);
+		ReturnErrorIfError(error);
 
-		return TIResult<SValue>(SValue(result.getValue()));
+		value = arena.hasReference() ? SValue(string, *arena) : SValue(string);
 	} else if (*charPtr == '{') {
 		// Dictionary
-		TIResult<CDictionary>	result = sReadDictionary(charPtr);
-		ReturnValueIfResultError(result, TIResult<SValue>(result.getError()));
+		CDictionary	dictionary = arena.hasReference() ? CDictionary(*arena) : CDictionary();
+		error = sReadDictionary(charPtr, arena, dictionary);
+		ReturnErrorIfError(error);
 
-		// Skip whitespace
-		sSkipWhitespace(charPtr);
-
-		return TIResult<SValue>(SValue(result.getValue()));
+		value = arena.hasReference() ? SValue(dictionary, *arena) : SValue(dictionary);
 	} else if (*charPtr == '[') {
 		// Array
 		charPtr++;
@@ -385,12 +400,15 @@ TIResult<SValue> sReadValue(const SInt8*& charPtr)
 
 		if (*charPtr == '{') {
 			// Array of dictionaries
-			TNArray<CDictionary>	array;
+			TNArray<CDictionary>	array =
+											arena.hasReference() ?
+													TNArray<CDictionary>(*arena) : TNArray<CDictionary>();
 			while (true) {
 				// Read dictionary
-				TIResult<CDictionary>	result = sReadDictionary(charPtr);
-				ReturnValueIfResultError(result, TIResult<SValue>(result.getError()));
-				array += result.getValue();
+				CDictionary	dictionary = arena.hasReference() ? CDictionary(*arena) : CDictionary();
+				error = sReadDictionary(charPtr, arena, dictionary);
+				ReturnErrorIfError(error);
+				array += dictionary;
 
 				// Skip whitespace
 				sSkipWhitespace(charPtr);
@@ -406,22 +424,21 @@ TIResult<SValue> sReadValue(const SInt8*& charPtr)
 					// End of array
 					charPtr++;
 
-					// Skip whitespace
-					sSkipWhitespace(charPtr);
-
-					return TIResult<SValue>(SValue(array));
+					break;
 				} else
 					// Invalid token
-					return TIResult<SValue>(sInvalidTokenError);
+					return OI<SError>(sInvalidTokenError);
 			}
+
+			value = arena.hasReference() ? SValue(array, *arena) : SValue(array);
 		} else if (*charPtr == '\"') {
 			// Array of strings
-			TNArray<CString>	array;
+			TNArray<CString>	array = arena.hasReference() ? TNArray<CString>(*arena) : TNArray<CString>();
 			while (true) {
 				// Read string
-				TIResult<CString>	result = sReadString(charPtr);
-				ReturnValueIfResultError(result, TIResult<SValue>(result.getError()));
-				array += result.getValue();
+				CString	string = sReadString(charPtr, error);
+				ReturnErrorIfError(error);
+				array += string;
 
 				// Skip whitespace
 				sSkipWhitespace(charPtr);
@@ -437,49 +454,38 @@ TIResult<SValue> sReadValue(const SInt8*& charPtr)
 					// End of array
 					charPtr++;
 
-					// Skip whitespace
-					sSkipWhitespace(charPtr);
-
-					return TIResult<SValue>(SValue(array));
+					break;
 				} else
 					// Invalid token
-					return TIResult<SValue>(sInvalidTokenError);
+					return OI<SError>(sInvalidTokenError);
 			}
+
+			value = arena.hasReference() ? SValue(array, *arena) : SValue(array);
 		} else if (*charPtr == ']') {
 			// Empty array
 			charPtr++;
 
-			// Skip whitespace
-			sSkipWhitespace(charPtr);
-
-			return TIResult<SValue>(SValue(TNArray<CDictionary>()));
+			value =
+					arena.hasReference() ?
+							SValue(TNArray<CDictionary>(), *arena) : SValue(TNArray<CDictionary>());
 		} else
 			// Invalid token
-			return TIResult<SValue>(sInvalidTokenError);
+			return OI<SError>(sInvalidTokenError);
 	} else if (::memcmp(charPtr, "true", 4) == 0) {
 		// True
 		charPtr += 4;
 
-		// Skip whitespace
-		sSkipWhitespace(charPtr);
-
-		return TIResult<SValue>(SValue(true));
+		value = SValue(true);
 	} else if (::memcmp(charPtr, "false", 5) == 0) {
 		// False
 		charPtr += 5;
 
-		// Skip whitespace
-		sSkipWhitespace(charPtr);
-
-		return TIResult<SValue>(SValue(false));
+		value = SValue(false);
 	} else if (::memcmp(charPtr, "null", 4) == 0) {
 		// Null
 		charPtr += 4;
 
-		// Skip whitespace
-		sSkipWhitespace(charPtr);
-
-		return TIResult<SValue>(SValue::mEmpty);
+		value = SValue::mEmpty;
 	} else {
 		// Number
 		const	SInt8*	startCharPtr = charPtr;
@@ -491,16 +497,24 @@ TIResult<SValue> sReadValue(const SInt8*& charPtr)
 			charPtr++;
 		}
 
-		// Skip whitespace
-		sSkipWhitespace(charPtr);
+		// Copy to a terminated buffer
+		char	buffer[64];
+		UInt32	length = std::min<UInt32>((UInt32) (charPtr - startCharPtr), sizeof(buffer) - 1);
+		::memcpy(buffer, startCharPtr, length);
+		buffer[length] = 0;
 
 		if (isFloat)
 			// Float
-			return TIResult<SValue>(CString((char*) startCharPtr, (UInt32) (charPtr - startCharPtr)).getFloat64());
+			value = SValue((Float64) ::strtod(buffer, nil));
 		else
 			// Integer
-			return TIResult<SValue>(CString((char*) startCharPtr, (UInt32) (charPtr - startCharPtr)).getSInt64());
+			value = SValue((SInt64) ::strtoll(buffer, nil, 10));
 	}
+
+	// Skip whitespace
+	sSkipWhitespace(charPtr);
+
+	return OI<SError>();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
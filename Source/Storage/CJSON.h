@@ -15,5 +15,6 @@ class CJSON {
 	public:
 		// Class methods
 		static	TIResult<CDictionary>	dictionaryFrom(const CData& data);
+		static	TIResult<CDictionary>	dictionaryFrom(const CData& data, CArena& arena);
 		static	TIResult<CData>			dataFrom(const CDictionary& dictionary);
 };